@@ -7,12 +7,35 @@
  */
 
 #include "ai_engine.h"
+#include "batch_scheduler.h"
+#include "cuda_graph_cache.h"
+#include "device_allocator.h"
+#include "diffusion_pipeline.h"
+#include "engine_cache.h"
+#include "generation_cache.h"
+#include "image_ops.h"
+#include "image_sink.h"
+#include "model_registry.h"
+#include "model_residency.h"
+#include "tracer.h"
+#include "weight_loader.h"
 #include "logger.h"
 #include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <limits>
+#include <mutex>
 #include <sstream>
 #include <random>
 #include <chrono>
 #include <cstring>
+#include <deque>
+#include <thread>
+
+#ifdef __linux__
+    #include <pthread.h>
+    #include <sched.h>
+#endif
 
 // CUDA/TensorRT headers (include in production)
 // #include <cuda_runtime.h>
@@ -21,6 +44,53 @@
 
 namespace AIForge {
 
+// In production: derive from NV_TENSORRT_MAJOR/MINOR/PATCH
+static const char* const TENSORRT_VERSION = "8.6.1";
+
+// CUDA stream and device of the current inference worker (nullptr / -1
+// outside the worker pools)
+static thread_local void* t_workerStream = nullptr;
+static thread_local int t_workerDevice = -1;
+
+// Progress callback of the submitImageGeneration job running on this thread
+static thread_local const std::function<void(float)>* t_jobProgress = nullptr;
+
+// Routing cost, in units of one queued request
+static const float ROUTE_COST_UTILIZATION = 1.0f;   // Per 100% GPU utilization
+static const float ROUTE_COST_NOT_RESIDENT = 2.0f;  // Weights must be paged in first
+static const float ROUTE_COST_NO_MEMORY = 4.0f;     // Paging in would evict other models
+static const float ROUTE_COST_THROTTLED = 2.0f;     // Clocks reduced for thermal or power limits
+static const float ROUTE_COST_FAULTED = 100.0f;     // Xid error seen: last resort only
+
+// Simulated LLM: a small vocabulary stands in for the model's tokenizer, and
+// each token keeps 128 KB of KV state (32 layers of 2 x 8 heads x 128 dims
+// in FP16)
+static const char* const SIMULATED_VOCABULARY[] = {
+    "<eos>", "the", "a", "of", "and", "in", "with", "over", "model", "image",
+    "light", "color", "studio", "forge", "scene", "soft", "bright", "detail",
+    "sky", "city", "night", "glow", "shadow", "river", "stone", "glass",
+    "metal", "cloud", "fire", "wave", "render", "."
+};
+static const int32_t SIMULATED_VOCABULARY_SIZE =
+    static_cast<int32_t>(sizeof(SIMULATED_VOCABULARY) / sizeof(SIMULATED_VOCABULARY[0]));
+static const int32_t SIMULATED_EOS_TOKEN = 0;
+static const size_t SIMULATED_KV_BYTES_PER_TOKEN = 128 * 1024;
+
+/**
+ * @struct ModelReplica
+ * @brief A model's weights on one device (a full copy or one shard)
+ */
+struct ModelReplica {
+    int deviceId = 0;
+    size_t layerBegin = 0;              // Layer range held; [0, layers) unless sharded
+    size_t layerEnd = 0;
+    float share = 1.0f;                 // Fraction of the model's VRAM
+    std::vector<void*> deviceWeights;   // Per tensor, nullptr until uploaded
+    std::vector<void*> hostWeights;     // Per tensor, pinned copy while offloaded
+    size_t uploadedLayers = 0;          // Next layer to page in, in order
+    std::mutex weightMutex;
+};
+
 /**
  * @class AIModel
  * @brief Internal representation of a loaded AI model
@@ -31,13 +101,102 @@ public:
     void* engineData;       // TensorRT engine
     void* cudaStream;       // CUDA stream for async ops
     bool isReady;
-
-    AIModel() : engineData(nullptr), cudaStream(nullptr), isReady(false) {}
+    std::string contentHash; // Model file hash for the engine cache
+    std::string fingerprint; // Identifies the model content in the generation caches
+    size_t baseMemoryUsage; // VRAM usage before precision optimization
+    std::unique_ptr<WeightLoader> weights; // Mapped SafeTensors/GGUF file, shared by replicas
+    std::map<int, std::unique_ptr<ModelReplica>> replicas; // By device
+    mutable std::mutex infoMutex; // Guards the info fields optimizeModel changes once published
+
+    AIModel() : engineData(nullptr), cudaStream(nullptr), isReady(false), baseMemoryUsage(0) {}
     ~AIModel() {
         // Cleanup would happen here
     }
+
+    ModelInfo getInfo() const {
+        std::lock_guard<std::mutex> lock(infoMutex);
+        return info;
+    }
+
+    size_t memoryUsageMB() const {
+        std::lock_guard<std::mutex> lock(infoMutex);
+        return info.memoryUsage;
+    }
+
+    ModelReplica* replica(int deviceId) const {
+        auto it = replicas.find(deviceId);
+        return it == replicas.end() ? nullptr : it->second.get();
+    }
+
+    size_t replicaSizeMB(const ModelReplica& replica) const {
+        return static_cast<size_t>(std::ceil(memoryUsageMB() * replica.share));
+    }
 };
 
+/**
+ * @brief Split text into simulated vocabulary tokens
+ */
+static std::vector<int32_t> simulatedTokenize(const std::string& text) {
+    // In production: the model's BPE/SentencePiece tokenizer
+    std::vector<int32_t> tokens;
+    std::istringstream words(text);
+    std::string word;
+    while (words >> word) {
+        tokens.push_back(1 + static_cast<int32_t>(
+            std::hash<std::string>()(word) % (SIMULATED_VOCABULARY_SIZE - 1)));
+    }
+    return tokens;
+}
+
+/**
+ * @brief Text piece of a simulated vocabulary token
+ */
+static std::string simulatedDetokenize(int32_t token) {
+    if (token <= SIMULATED_EOS_TOKEN || token >= SIMULATED_VOCABULARY_SIZE) {
+        return std::string();
+    }
+    return std::string(" ") + SIMULATED_VOCABULARY[token];
+}
+
+/**
+ * @brief Residency manager key of a model's replica on a device
+ */
+static std::string replicaKey(const std::string& modelId, int deviceId) {
+    return modelId + "@" + std::to_string(deviceId);
+}
+
+/**
+ * @brief Identify a file by path, size and modification time
+ */
+static std::string fileFingerprint(const std::string& filepath) {
+    std::error_code ec;
+    const auto size = std::filesystem::file_size(filepath, ec);
+    const auto modified = std::filesystem::last_write_time(filepath, ec);
+    return filepath + "@" + std::to_string(ec ? 0 : size) + "@" +
+           std::to_string(modified.time_since_epoch().count());
+}
+
+/**
+ * @brief Check a string's suffix (std::string::ends_with is C++20)
+ */
+static bool hasSuffix(const std::string& text, const char* suffix) {
+    const size_t length = std::char_traits<char>::length(suffix);
+    return text.size() >= length && text.compare(text.size() - length, length, suffix) == 0;
+}
+
+/**
+ * @brief Estimate VRAM usage of an engine built at the given precision
+ */
+static size_t optimizedMemoryUsage(size_t baseUsage, PrecisionMode precision) {
+    // FP16 typically uses ~50% less memory
+    if (precision == PrecisionMode::FP16) {
+        return static_cast<size_t>(baseUsage * 0.6f);
+    } else if (precision == PrecisionMode::INT8) {
+        return static_cast<size_t>(baseUsage * 0.3f);
+    }
+    return baseUsage;
+}
+
 // Helper function implementations
 std::string modelTypeToString(ModelType type) {
     switch (type) {
@@ -76,7 +235,28 @@ AIEngine::AIEngine()
     , m_cudaContext(nullptr)
     , m_tensorrtContext(nullptr)
     , m_progressCallback(nullptr)
+    , m_batchingDegraded(false)
+    , m_nextJobId(1)
+    , m_eagerSteps(0)
 {
+    // Created once and never replaced, so requests use it without locking;
+    // setBatchingConfig only starts and stops it
+    m_batchScheduler = std::make_unique<BatchScheduler>(
+        [this](const InferenceConfig& batchConfig,
+               const std::vector<std::vector<float>>& inputs) {
+            return runInferenceBatch(batchConfig, inputs);
+        },
+        [this](const InferenceConfig& batchConfig, JobPriority priority,
+               std::function<void()> run, std::function<void()> onCancel) {
+            WorkerPool* pool = getWorkerPool(routeRequest(batchConfig.modelId));
+            if (!pool) {
+                return false;
+            }
+            // Members are cancelled through the scheduler, not this pool job
+            return pool->submit(m_nextJobId++, priority, std::move(run),
+                                std::move(onCancel));
+        });
+
     LOG_INFO("AIEngine", "AI Engine created");
 }
 
@@ -85,24 +265,87 @@ AIEngine::~AIEngine() {
 }
 
 bool AIEngine::initialize(int deviceId) {
+    return initialize(std::vector<int>{deviceId});
+}
+
+bool AIEngine::initialize(const std::vector<int>& deviceIds) {
     if (m_initialized) {
         LOG_WARNING("AIEngine", "Already initialized");
         return true;
     }
 
-    LOG_INFO("AIEngine", "Initializing AI Engine on device " + std::to_string(deviceId));
+    if (deviceIds.empty()) {
+        LOG_ERROR("AIEngine", "No devices given");
+        return false;
+    }
+
+    std::string deviceList;
+    for (int deviceId : deviceIds) {
+        deviceList += (deviceList.empty() ? "" : ", ") + std::to_string(deviceId);
+    }
+    LOG_INFO("AIEngine", "Initializing AI Engine on device(s) " + deviceList);
+
+    m_deviceIds.clear();
+    m_devices.clear();
+
+    for (int deviceId : deviceIds) {
+        if (m_devices.count(deviceId)) {
+            continue;
+        }
+
+        // Initialize CUDA
+        // In production: cudaSetDevice(deviceId);
+        // Check for CUDA availability; the runtime creates the device's
+        // primary context on first use
+        bool cudaAvailable = true; // Simulate
+
+        if (!cudaAvailable) {
+            LOG_ERROR("AIEngine", "CUDA not available on device " + std::to_string(deviceId));
+            continue;
+        }
+
+        // Engines are architecture specific, so the cache key needs the device's
+        // compute capability
+        // In production: cudaGetDeviceProperties(&prop, deviceId);
+        //                capability = prop.major + "." + prop.minor
+        DeviceState state;
+        state.computeCapability = "12.0"; // RTX 50-series (simulated)
+
+        // In production: cudaMemGetInfo(&freeBytes, &totalBytes);
+        state.memoryMB = 32768; // 32 GB (simulated)
+
+        // HardwareMonitor indexes GPUs in NVML order; in production the
+        // CUDA device is matched by PCI bus id (cudaDeviceGetPCIBusId)
+        for (const GPUTopology& topology : m_topology) {
+            if (static_cast<int>(topology.deviceId) == deviceId) {
+                state.numaNode = topology.numaNode;
+                state.cpus = topology.cpus;
+            }
+        }
 
-    m_deviceId = deviceId;
+        // Replicas share the primary device's engines
+        if (!m_deviceIds.empty() && state.computeCapability != m_computeCapability) {
+            LOG_WARNING("AIEngine", "Skipping device " + std::to_string(deviceId) +
+                        ": compute capability " + state.computeCapability +
+                        " differs from device " + std::to_string(m_deviceIds.front()) +
+                        " (" + m_computeCapability + ")");
+            continue;
+        }
+        if (m_deviceIds.empty()) {
+            m_computeCapability = state.computeCapability;
+        }
 
-    // Initialize CUDA
-    // In production: cudaSetDevice(deviceId);
-    // Check for CUDA availability and create context
-    bool cudaAvailable = true; // Simulate
+        // In production: cudaDeviceCanAccessPeer / cudaDeviceEnablePeerAccess
+        // between devices so shard activations move over NVLink or PCIe P2P
+        m_devices[deviceId] = state;
+        m_deviceIds.push_back(deviceId);
+    }
 
-    if (!cudaAvailable) {
-        LOG_ERROR("AIEngine", "CUDA not available on device " + std::to_string(deviceId));
+    if (m_deviceIds.empty()) {
+        LOG_ERROR("AIEngine", "No usable CUDA device");
         return false;
     }
+    m_deviceId = m_deviceIds.front();
 
     // Create CUDA context (simulated)
     m_cudaContext = reinterpret_cast<void*>(0x1234); // Placeholder
@@ -111,10 +354,96 @@ bool AIEngine::initialize(int deviceId) {
     // In production: Create IRuntime, IBuilder, etc.
     m_tensorrtContext = reinterpret_cast<void*>(0x5678); // Placeholder
 
+    m_engineCache = std::make_unique<EngineCache>();
+    m_engineCache->configure(m_engineCacheConfig);
+
+    m_embeddingCache = std::make_unique<EmbeddingCache>();
+    m_embeddingCache->setCapacity(m_generationCacheConfig.embeddingCacheMB * 1024 * 1024);
+    m_resultCache = std::make_unique<ResultCache>();
+    m_resultCache->configure(m_generationCacheConfig);
+
+    m_residency = std::make_unique<ResidencyManager>(
+        [this](const std::string& replicaKey, ResidencyState from, ResidencyState to) {
+            return transitionModel(replicaKey, from, to);
+        });
+    m_residency->start(m_residencyConfig);
+
+    m_graphCache = std::make_unique<CudaGraphCache>([this](CudaGraph& graph) {
+        // In production: cudaGraphExecDestroy(graph.graphExec);
+        freeCudaMemory(graph.workspace);
+    });
+    m_graphCache->setConfig(m_cudaGraphConfig);
+
+    for (int deviceId : m_deviceIds) {
+        m_residency->setDeviceBudget(deviceId, residencyBudgetMB(deviceId));
+
+        auto allocator = std::make_unique<DeviceAllocator>(deviceId,
+            [deviceId](size_t size) {
+                // In production: cudaSetDevice(deviceId); cudaMalloc(&ptr, size);
+                (void)deviceId;
+                return malloc(size); // Fallback to CPU memory for template
+            },
+            [](void* ptr) {
+                // In production: cudaFree(ptr);
+                free(ptr);
+            });
+        allocator->setConfig(m_deviceAllocatorConfig);
+        m_deviceAllocators[deviceId] = std::move(allocator);
+
+        // Start the inference worker pool for this device
+        WorkerPoolConfig poolConfig = m_workerPoolConfig;
+        poolConfig.name = "InferencePool" + std::to_string(deviceId);
+        auto onThreadStart = m_workerPoolConfig.onThreadStart;
+        std::vector<int> cpus = m_numaConfig.pinWorkers ? m_devices[deviceId].cpus : std::vector<int>();
+        if (!cpus.empty()) {
+            LOG_INFO("AIEngine", "Device " + std::to_string(deviceId) + " workers pinned to NUMA node " +
+                     std::to_string(m_devices[deviceId].numaNode) + " (" +
+                     std::to_string(cpus.size()) + " CPUs)");
+        }
+        poolConfig.onThreadStart = [deviceId, onThreadStart, cpus](unsigned int workerIndex) {
+            // Pin before the first allocation, so first-touch pages and the
+            // CUDA context's host-side state land on the GPU's node
+#ifdef __linux__
+            if (!cpus.empty()) {
+                cpu_set_t set;
+                CPU_ZERO(&set);
+                for (int cpu : cpus) {
+                    if (cpu >= 0 && cpu < CPU_SETSIZE) {
+                        CPU_SET(cpu, &set);
+                    }
+                }
+                if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+                    LOG_WARNING("AIEngine", "Could not pin worker " + std::to_string(workerIndex) +
+                                " of device " + std::to_string(deviceId));
+                }
+            }
+#else
+            (void)cpus; // In production on Windows: SetThreadGroupAffinity
+#endif
+
+            // In production: cudaSetDevice(deviceId) so every worker binds to its GPU,
+            // then cudaStreamCreateWithFlags(&stream, cudaStreamNonBlocking)
+            t_workerDevice = deviceId;
+            t_workerStream = reinterpret_cast<void*>(static_cast<uintptr_t>(0x1000 + workerIndex));
+            if (onThreadStart) {
+                onThreadStart(workerIndex);
+            }
+        };
+        auto pool = std::make_unique<WorkerPool>();
+        pool->start(poolConfig);
+        m_workerPools[deviceId] = std::move(pool);
+    }
+
     m_initialized = true;
+
+    if (m_batchingConfig.enabled) {
+        setBatchingConfig(m_batchingConfig);
+    }
+
     LOG_INFO("AIEngine", "AI Engine initialized successfully");
-    LOG_INFO("AIEngine", "CUDA Device: " + std::to_string(deviceId));
-    LOG_INFO("AIEngine", "TensorRT Version: 8.6.1 (simulated)");
+    LOG_INFO("AIEngine", "CUDA Device(s): " + std::to_string(m_deviceIds.size()) +
+             " (primary " + std::to_string(m_deviceId) + ")");
+    LOG_INFO("AIEngine", "TensorRT Version: " + std::string(TENSORRT_VERSION) + " (simulated)");
 
     return true;
 }
@@ -126,15 +455,48 @@ void AIEngine::shutdown() {
 
     LOG_INFO("AIEngine", "Shutting down AI Engine");
 
-    // Unload all models
-    std::vector<std::string> modelIds;
-    for (const auto& pair : m_models) {
-        modelIds.push_back(pair.first);
+    // Stop batching first so no batch runs against a model being unloaded
+    m_batchScheduler->stop();
+
+    // Text generators step on the models too; their requests fail here
+    std::map<std::string, std::shared_ptr<TextGenerator>> generators;
+    {
+        std::lock_guard<std::mutex> lock(m_textGeneratorMutex);
+        generators.swap(m_textGenerators);
+    }
+    for (auto& pair : generators) {
+        pair.second->stop("Engine shut down");
+    }
+    generators.clear();
+
+    // Queued pipeline jobs fail; stages finish what they are running
+    std::unique_ptr<DiffusionPipeline> pipeline;
+    {
+        std::lock_guard<std::mutex> lock(m_pipelineMutex);
+        pipeline = std::move(m_pipeline);
+    }
+    if (pipeline) {
+        pipeline->stop();
+    }
+    pipeline.reset();
+
+    // Cancel queued requests and wait for running ones to finish
+    for (auto& pair : m_workerPools) {
+        pair.second->stop();
+    }
+    m_workerPools.clear();
+
+    if (m_residency) {
+        m_residency->stop();
     }
 
-    for (const auto& id : modelIds) {
-        unloadModel(id);
+    // Unload all models; no request is left to hold them, so they are
+    // destroyed here
+    auto models = m_models.snapshot();
+    for (const auto& pair : *models) {
+        unloadModel(pair.first);
     }
+    models.reset();
 
     // Cleanup CUDA/TensorRT contexts
     if (m_cudaContext) {
@@ -147,6 +509,21 @@ void AIEngine::shutdown() {
         m_tensorrtContext = nullptr;
     }
 
+    m_residency.reset();
+
+    // Graphs give their workspaces back to the allocators, so go first
+    m_graphCache.reset();
+    m_embeddingCache.reset();
+
+    // Releases cached blocks; anything still allocated falls back to raw frees
+    m_deviceAllocators.clear();
+
+    m_deviceIds.clear();
+    {
+        std::lock_guard<std::mutex> lock(m_deviceMutex);
+        m_devices.clear();
+    }
+
     m_initialized = false;
     LOG_INFO("AIEngine", "AI Engine shutdown complete");
 }
@@ -177,15 +554,15 @@ ModelFormat AIEngine::detectModelFormat(const std::string& filepath) {
     std::string lower = filepath;
     std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
 
-    if (lower.ends_with(".onnx")) {
+    if (hasSuffix(lower, ".onnx")) {
         return ModelFormat::ONNX;
-    } else if (lower.ends_with(".trt") || lower.ends_with(".engine")) {
+    } else if (hasSuffix(lower, ".trt") || hasSuffix(lower, ".engine")) {
         return ModelFormat::TENSORRT;
-    } else if (lower.ends_with(".pt") || lower.ends_with(".pth")) {
+    } else if (hasSuffix(lower, ".pt") || hasSuffix(lower, ".pth")) {
         return ModelFormat::PYTORCH;
-    } else if (lower.ends_with(".safetensors")) {
+    } else if (hasSuffix(lower, ".safetensors")) {
         return ModelFormat::SAFETENSORS;
-    } else if (lower.ends_with(".gguf")) {
+    } else if (hasSuffix(lower, ".gguf")) {
         return ModelFormat::GGUF;
     }
 
@@ -193,7 +570,7 @@ ModelFormat AIEngine::detectModelFormat(const std::string& filepath) {
 }
 
 std::string AIEngine::generateModelId() {
-    static int counter = 0;
+    static std::atomic<int> counter{0};
     auto now = std::chrono::system_clock::now();
     auto timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
         now.time_since_epoch()).count();
@@ -202,12 +579,13 @@ std::string AIEngine::generateModelId() {
 }
 
 std::string AIEngine::loadModel(const std::string& filepath, const std::string& name,
-                               ModelType type) {
+                               ModelType type, ModelPlacement placement) {
     if (!m_initialized) {
         LOG_ERROR("AIEngine", "Cannot load model: engine not initialized");
         return "";
     }
 
+    TRACE_SCOPE_DETAIL("AIEngine", "loadModel", filepath);
     LOG_INFO("AIEngine", "Loading model: " + filepath);
 
     // Detect format
@@ -222,8 +600,8 @@ std::string AIEngine::loadModel(const std::string& filepath, const std::string&
         type = detectModelType(filepath);
     }
 
-    // Create model instance
-    auto model = std::make_unique<AIModel>();
+    // Create model instance; its resources go when the last handle does
+    ModelHandle model(new AIModel(), [this](AIModel* unloaded) { destroyModel(unloaded); });
     model->info.id = generateModelId();
     model->info.name = name;
     model->info.filepath = filepath;
@@ -231,6 +609,7 @@ std::string AIEngine::loadModel(const std::string& filepath, const std::string&
     model->info.format = format;
     model->info.isLoaded = false;
     model->info.isOptimized = false;
+    model->info.isResident = false;
 
     // Simulate loading process
     LOG_INFO("AIEngine", "Model format: " + modelFormatToString(format));
@@ -240,285 +619,2496 @@ std::string AIEngine::loadModel(const std::string& filepath, const std::string&
     // - ONNX: Use ONNX parser to build TensorRT engine
     // - TensorRT: Deserialize engine from file
     // - PyTorch: Load with PyTorch C++ API
-    // - SafeTensors: Parse and load weights
-    // - GGUF: Custom loader for GGUF format
+    // - SafeTensors/GGUF: mapped below; weights reach the GPU on first use
 
     // Simulate memory allocation
     model->info.memoryUsage = 2048 + (rand() % 4096); // 2-6 GB
+
+    if (format == ModelFormat::SAFETENSORS || format == ModelFormat::GGUF) {
+        std::error_code ec;
+        if (std::filesystem::exists(filepath, ec)) {
+            // Parse only the tensor index; payloads stay on disk until uploaded
+            auto weights = std::make_unique<WeightLoader>();
+            if (!weights->open(filepath, format)) {
+                LOG_ERROR("AIEngine", "Failed to load weights: " + weights->getLastError());
+                return "";
+            }
+
+            const size_t mb = 1024 * 1024;
+            model->info.memoryUsage = static_cast<size_t>((weights->getTotalTensorBytes() + mb - 1) / mb);
+            model->weights = std::move(weights);
+        } else {
+            LOG_WARNING("AIEngine", "Weight file not found, simulating: " + filepath);
+        }
+    }
+    model->baseMemoryUsage = model->info.memoryUsage;
     model->info.inputShape = {1, 3, 512, 512};
     model->info.outputShape = {1, 3, 512, 512};
 
+    // Pick up a previously built engine for this exact model content. Mapped
+    // weight files are hashed in optimizeModel instead, so loading them never
+    // reads the whole payload up front.
+    if (format != ModelFormat::TENSORRT && !model->weights &&
+        m_engineCache && m_engineCache->isEnabled()) {
+        model->contentHash = EngineCache::hashFile(filepath);
+
+        PrecisionMode cachedPrecision = m_engineCacheConfig.loadPrecision;
+        if (cachedPrecision == PrecisionMode::AUTO) {
+            cachedPrecision = PrecisionMode::FP16;
+        }
+
+        std::vector<char> engineBlob;
+        if (!model->contentHash.empty() &&
+            m_engineCache->load(makeEngineCacheKey(*model, cachedPrecision), engineBlob)) {
+            // In production: runtime->deserializeCudaEngine(blob.data(), blob.size())
+            model->info.isOptimized = true;
+            model->info.memoryUsage = optimizedMemoryUsage(model->baseMemoryUsage, cachedPrecision);
+            LOG_INFO("AIEngine", "Using cached " + precisionModeToString(cachedPrecision) +
+                     " engine (" + std::to_string(engineBlob.size() / 1024) + " KB)");
+        }
+    }
+
+    // The content hash when the engine cache computed one; otherwise the
+    // file's path, size and modification time stand in without reading it
+    model->fingerprint = !model->contentHash.empty() ? model->contentHash : fileFingerprint(filepath);
+
     // Mark as loaded
     model->info.isLoaded = true;
     model->isReady = true;
 
+    model->info.devices = placeModel(model->info.memoryUsage, placement);
+    model->info.placement = placement;
+
     std::string modelId = model->info.id;
-    m_models[modelId] = std::move(model);
+    bool lazyWeights = model->weights != nullptr;
+    AIModel& loaded = *model;
+
+    // Published complete, and before the replicas are made resident, since
+    // residency transitions look the model up
+    createReplicas(loaded);
+    m_models.insert(modelId, model);
+    if (!lazyWeights) {
+        // Engines built at load time occupy VRAM immediately, on every replica
+        for (const auto& pair : loaded.replicas) {
+            std::string error;
+            if (!m_residency->acquire(replicaKey(modelId, pair.first), false, &error)) {
+                LOG_ERROR("AIEngine", "Cannot load model: " + error);
+                m_models.remove(modelId);
+                return "";
+            }
+            m_residency->release(replicaKey(modelId, pair.first));
+        }
+    }
+
+    std::string deviceList;
+    for (int deviceId : loaded.info.devices) {
+        deviceList += (deviceList.empty() ? "" : ", ") + std::to_string(deviceId);
+    }
+    const char* placementName = placement == ModelPlacement::SHARD ? "sharded across" :
+                                placement == ModelPlacement::REPLICATE ? "replicated on" : "placed on";
+    LOG_INFO("AIEngine", "Model " + std::string(placementName) + " device(s) " + deviceList);
 
     LOG_INFO("AIEngine", "Model loaded successfully: " + modelId);
-    LOG_INFO("AIEngine", "VRAM usage: " + std::to_string(m_models[modelId]->info.memoryUsage) + " MB");
+    LOG_INFO("AIEngine", "VRAM usage: " + std::to_string(loaded.memoryUsageMB()) + " MB");
 
     return modelId;
 }
 
 bool AIEngine::unloadModel(const std::string& modelId) {
-    auto it = m_models.find(modelId);
-    if (it == m_models.end()) {
+    // New requests stop finding the model; running ones keep their handles
+    // and the last of them destroys it
+    ModelHandle model = m_models.remove(modelId);
+    if (!model) {
         LOG_WARNING("AIEngine", "Model not found: " + modelId);
         return false;
     }
 
     LOG_INFO("AIEngine", "Unloading model: " + modelId);
 
-    // Cleanup model resources
-    // In production: Free CUDA memory, destroy TensorRT engines, etc.
+    // Its generator's running and waiting requests fail
+    std::shared_ptr<TextGenerator> generator;
+    {
+        std::lock_guard<std::mutex> lock(m_textGeneratorMutex);
+        auto it = m_textGenerators.find(modelId);
+        if (it != m_textGenerators.end()) {
+            generator = std::move(it->second);
+            m_textGenerators.erase(it);
+        }
+    }
+    if (generator) {
+        generator->stop("Model unloaded");
+    }
 
-    m_models.erase(it);
+    model.reset();
     LOG_INFO("AIEngine", "Model unloaded successfully");
 
     return true;
 }
 
+void AIEngine::destroyModel(AIModel* model) {
+    const std::string modelId = model->info.id;
+
+    // Cleanup model resources
+    // In production: destroy TensorRT engines, etc.
+    for (const auto& pair : model->replicas) {
+        // Waits for a transfer in flight, after which no transition can
+        // look the model up again
+        if (m_residency) {
+            m_residency->unregisterModel(replicaKey(modelId, pair.first));
+        }
+        releaseModelWeights(*model, pair.first);
+    }
+    if (m_graphCache) {
+        m_graphCache->invalidateModel(modelId);
+    }
+
+    m_models.forget(modelId);
+    delete model;
+}
+
 bool AIEngine::optimizeModel(const std::string& modelId, PrecisionMode precision) {
-    auto it = m_models.find(modelId);
-    if (it == m_models.end()) {
+    TRACE_SCOPE_DETAIL("AIEngine", "optimizeModel", modelId);
+    ModelHandle model = m_models.find(modelId);
+    if (!model) {
         LOG_ERROR("AIEngine", "Model not found: " + modelId);
         return false;
     }
 
-    AIModel* model = it->second.get();
-
-    if (model->info.isOptimized) {
+    if (model->getInfo().isOptimized) {
         LOG_WARNING("AIEngine", "Model already optimized: " + modelId);
         return true;
     }
 
+    // RTX-class hardware always supports FP16
+    if (precision == PrecisionMode::AUTO) {
+        precision = PrecisionMode::FP16;
+    }
+
     LOG_INFO("AIEngine", "Optimizing model with " + precisionModeToString(precision));
 
-    // In production, TensorRT optimization would happen here:
-    // 1. Create builder and network
-    // 2. Set precision mode (FP16/INT8)
-    // 3. Build optimized engine
-    // 4. Serialize and cache engine
+    bool cacheUsable = m_engineCache && m_engineCache->isEnabled() &&
+                       model->info.format != ModelFormat::TENSORRT;
+    if (cacheUsable && model->contentHash.empty()) {
+        model->contentHash = EngineCache::hashFile(model->info.filepath);
+    }
+    cacheUsable = cacheUsable && !model->contentHash.empty();
 
-    // Simulate optimization time
-    if (m_progressCallback) {
-        for (int i = 0; i <= 100; i += 10) {
-            m_progressCallback(i / 100.0f);
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
-        }
+    EngineCacheKey cacheKey;
+    std::vector<char> engineBlob;
+    if (cacheUsable) {
+        cacheKey = makeEngineCacheKey(*model, precision);
     }
 
-    model->info.isOptimized = true;
+    if (cacheUsable && m_engineCache->load(cacheKey, engineBlob)) {
+        // In production: runtime->deserializeCudaEngine(blob.data(), blob.size())
+        LOG_INFO("AIEngine", "Engine cache hit, skipping build");
+    } else {
+        // In production, TensorRT optimization would happen here:
+        // 1. Create builder and network
+        // 2. Set precision mode (FP16/INT8)
+        // 3. Build optimized engine
+        // 4. Serialize engine (builder->buildSerializedNetwork) for the cache
+
+        // Simulate optimization time
+        if (m_progressCallback) {
+            for (int i = 0; i <= 100; i += 10) {
+                m_progressCallback(i / 100.0f);
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            }
+        }
 
-    // FP16 typically uses ~50% less memory
-    if (precision == PrecisionMode::FP16) {
-        model->info.memoryUsage = static_cast<size_t>(model->info.memoryUsage * 0.6f);
-    } else if (precision == PrecisionMode::INT8) {
-        model->info.memoryUsage = static_cast<size_t>(model->info.memoryUsage * 0.3f);
+        if (cacheUsable) {
+            // Simulated serialized engine
+            std::string header = "AIForge simulated engine: " + model->info.name +
+                                 " " + precisionModeToString(precision);
+            engineBlob.assign(header.begin(), header.end());
+            m_engineCache->store(cacheKey, engineBlob);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(model->infoMutex);
+        model->info.isOptimized = true;
+        model->info.memoryUsage = optimizedMemoryUsage(model->baseMemoryUsage, precision);
+    }
+    // Captured graphs reference the old engine's kernels
+    m_graphCache->invalidateModel(modelId);
+    for (const auto& pair : model->replicas) {
+        m_residency->updateModelSize(replicaKey(modelId, pair.first),
+                                     model->replicaSizeMB(*pair.second));
     }
 
     LOG_INFO("AIEngine", "Model optimized successfully");
-    LOG_INFO("AIEngine", "New VRAM usage: " + std::to_string(model->info.memoryUsage) + " MB");
+    LOG_INFO("AIEngine", "New VRAM usage: " + std::to_string(model->memoryUsageMB()) + " MB");
 
     return true;
 }
 
-ModelInfo AIEngine::getModelInfo(const std::string& modelId) const {
-    auto it = m_models.find(modelId);
-    if (it != m_models.end()) {
-        return it->second->info;
+EngineCacheKey AIEngine::makeEngineCacheKey(const AIModel& model,
+                                            PrecisionMode precision) const {
+    EngineCacheKey key;
+    key.modelHash = model.contentHash;
+    key.precision = precision;
+    key.computeCapability = m_computeCapability;
+    key.tensorrtVersion = TENSORRT_VERSION;
+    return key;
+}
+
+void AIEngine::setEngineCacheConfig(const EngineCacheConfig& config) {
+    m_engineCacheConfig = config;
+    if (m_engineCache) {
+        m_engineCache->configure(config);
     }
-    return ModelInfo();
 }
 
-std::vector<ModelInfo> AIEngine::getLoadedModels() const {
-    std::vector<ModelInfo> infos;
-    infos.reserve(m_models.size());
+void AIEngine::setGenerationCacheConfig(const GenerationCacheConfig& config) {
+    m_generationCacheConfig = config;
+    if (m_embeddingCache) {
+        m_embeddingCache->setCapacity(config.embeddingCacheMB * 1024 * 1024);
+    }
+    if (m_resultCache) {
+        m_resultCache->configure(config);
+    }
+}
 
-    for (const auto& pair : m_models) {
-        infos.push_back(pair.second->info);
+GenerationCacheStats AIEngine::getGenerationCacheStats() const {
+    GenerationCacheStats stats;
+    if (m_embeddingCache) {
+        m_embeddingCache->getStats(stats);
+    }
+    if (m_resultCache) {
+        m_resultCache->getStats(stats);
     }
+    return stats;
+}
 
-    return infos;
+void AIEngine::clearGenerationCaches() {
+    if (m_embeddingCache) {
+        m_embeddingCache->clear();
+    }
+    if (m_resultCache) {
+        m_resultCache->clear();
+    }
 }
 
-InferenceResult AIEngine::runInference(const InferenceConfig& config,
-                                      const std::vector<float>& inputData) {
-    InferenceResult result;
-    result.success = false;
+std::string AIEngine::makeResultCacheKey(const AIModel& model, const std::string& prompt,
+                                         const InferenceConfig& config) const {
+    // Without a seed the request asks for a new image every time
+    if (config.seed == 0) {
+        return std::string();
+    }
 
-    if (!m_initialized) {
-        result.errorMessage = "Engine not initialized";
-        LOG_ERROR("AIEngine", result.errorMessage);
-        return result;
+    // Everything that changes the pixels, with the free-form prompt last
+    char guidance[32];
+    std::snprintf(guidance, sizeof(guidance), "%a", config.guidanceScale);
+    return model.fingerprint + "|" + TENSORRT_VERSION + "|" +
+           precisionModeToString(config.precision) + "|" +
+           std::to_string(config.width) + "x" + std::to_string(config.height) + "|" +
+           std::to_string(std::max(config.batchSize, 1)) + "|" +
+           std::to_string(config.numInferenceSteps) + "|" + guidance + "|" +
+           std::to_string(config.seed) + "|" + prompt;
+}
+
+EngineCacheStats AIEngine::getEngineCacheStats() const {
+    if (!m_engineCache) {
+        return EngineCacheStats();
     }
+    return m_engineCache->getStats();
+}
 
-    auto it = m_models.find(config.modelId);
-    if (it == m_models.end()) {
-        result.errorMessage = "Model not found: " + config.modelId;
-        LOG_ERROR("AIEngine", result.errorMessage);
-        return result;
+/**
+ * @brief Whether a model can run without paging in: any replica, or every shard
+ */
+static bool isModelResident(const ResidencyManager* residency, const AIModel& model) {
+    if (!residency || model.replicas.empty()) {
+        return false;
     }
+    bool all = true;
+    bool any = false;
+    for (const auto& pair : model.replicas) {
+        bool resident = residency->getState(replicaKey(model.info.id, pair.first)) ==
+                        ResidencyState::RESIDENT;
+        all = all && resident;
+        any = any || resident;
+    }
+    return model.info.placement == ModelPlacement::SHARD ? all : any;
+}
 
-    AIModel* model = it->second.get();
+ModelInfo AIEngine::getModelInfo(const std::string& modelId) const {
+    ModelHandle model = m_models.find(modelId);
+    if (model) {
+        ModelInfo info = model->getInfo();
+        info.isResident = isModelResident(m_residency.get(), *model);
+        return info;
+    }
+    return ModelInfo();
+}
 
-    LOG_INFO("AIEngine", "Running inference on model: " + config.modelId);
+std::vector<ModelInfo> AIEngine::getLoadedModels() const {
+    auto models = m_models.snapshot();
+    std::vector<ModelInfo> infos;
+    infos.reserve(models->size());
 
-    auto startTime = std::chrono::high_resolution_clock::now();
+    for (const auto& pair : *models) {
+        infos.push_back(pair.second->getInfo());
+        infos.back().isResident = isModelResident(m_residency.get(), *pair.second);
+    }
 
-    // In production, actual inference would happen here:
-    // 1. Copy input data to GPU
-    // 2. Execute TensorRT engine
-    // 3. Copy output data back to CPU
-    // 4. Post-process results
+    return infos;
+}
 
-    // Simulate inference time (depends on model type)
-    int inferenceTimeMs = 50 + (rand() % 200);
-    std::this_thread::sleep_for(std::chrono::milliseconds(inferenceTimeMs));
+bool AIEngine::uploadModelWeights(const std::string& modelId) {
+    ModelHandle model = m_models.find(modelId);
+    if (!model) {
+        LOG_ERROR("AIEngine", "Model not found: " + modelId);
+        return false;
+    }
 
-    auto endTime = std::chrono::high_resolution_clock::now();
-    result.inferenceTime = std::chrono::duration<float, std::milli>(
-        endTime - startTime).count();
+    // Every replica, so the first request lands warm wherever it is routed
+    for (const auto& pair : model->replicas) {
+        std::string error;
+        if (!m_residency || !m_residency->acquire(replicaKey(modelId, pair.first), false, &error)) {
+            LOG_ERROR("AIEngine", m_residency ? error : "Engine not initialized");
+            return false;
+        }
+        m_residency->release(replicaKey(modelId, pair.first));
+    }
+    return true;
+}
 
-    // Simulate output
-    result.outputData.resize(512 * 512 * 3);
-    result.success = true;
-    result.memoryUsed = model->info.memoryUsage;
+std::vector<int> AIEngine::placeModel(size_t sizeMB, ModelPlacement& placement) const {
+    if (m_deviceIds.size() == 1 && placement != ModelPlacement::SINGLE_DEVICE) {
+        placement = ModelPlacement::REPLICATE; // Same thing with one device
+    }
 
-    LOG_INFO("AIEngine", "Inference completed in " +
-             std::to_string(result.inferenceTime) + " ms");
+    if (placement == ModelPlacement::AUTO) {
+        bool fitsEverywhere = true;
+        for (int deviceId : m_deviceIds) {
+            fitsEverywhere = fitsEverywhere && sizeMB <= residencyBudgetMB(deviceId);
+        }
+        placement = fitsEverywhere ? ModelPlacement::REPLICATE : ModelPlacement::SHARD;
+    }
 
-    return result;
+    std::vector<int> devices;
+    if (placement == ModelPlacement::SINGLE_DEVICE) {
+        // Most budget left after the weights already resident there
+        int best = m_deviceId;
+        long long bestFree = std::numeric_limits<long long>::min();
+        for (int deviceId : m_deviceIds) {
+            long long freeMB = static_cast<long long>(residencyBudgetMB(deviceId)) -
+                               static_cast<long long>(m_residency->getResidentMB(deviceId));
+            if (freeMB > bestFree) {
+                bestFree = freeMB;
+                best = deviceId;
+            }
+        }
+        devices.push_back(best);
+    } else {
+        devices = m_deviceIds;
+        std::sort(devices.begin(), devices.end());
+    }
+    return devices;
 }
 
-std::future<InferenceResult> AIEngine::runInferenceAsync(
-    const InferenceConfig& config,
-    const std::vector<float>& inputData) {
+void AIEngine::createReplicas(AIModel& model) {
+    const bool sharded = model.info.placement == ModelPlacement::SHARD;
+    const size_t shardCount = model.info.devices.size();
+    const size_t tensorCount = model.weights ? model.weights->getTensors().size() : 0;
+    const size_t layerCount = model.weights ? model.weights->getLayers().size() : 0;
+    const int64_t totalBytes = model.weights ? model.weights->getTotalTensorBytes() : 0;
+
+    // Shards take contiguous layer ranges of roughly equal size, so each
+    // device runs one stage of the pipeline
+    size_t layer = 0;
+    int64_t assignedBytes = 0;
+    for (size_t shard = 0; shard < shardCount; shard++) {
+        auto replica = std::make_unique<ModelReplica>();
+        replica->deviceId = model.info.devices[shard];
+        replica->deviceWeights.assign(tensorCount, nullptr);
+        replica->hostWeights.assign(tensorCount, nullptr);
+        replica->layerBegin = 0;
+        replica->layerEnd = layerCount;
+
+        if (sharded) {
+            replica->layerBegin = layer;
+            if (model.weights && totalBytes > 0) {
+                const bool last = shard + 1 == shardCount;
+                const int64_t target = totalBytes * static_cast<int64_t>(shard + 1) /
+                                       static_cast<int64_t>(shardCount);
+                int64_t shardBytes = 0;
+                while (layer < layerCount &&
+                       (last || assignedBytes + shardBytes < target)) {
+                    shardBytes += model.weights->getLayers()[layer].sizeBytes;
+                    layer++;
+                }
+                assignedBytes += shardBytes;
+                replica->share = static_cast<float>(shardBytes) / static_cast<float>(totalBytes);
+            } else {
+                replica->share = 1.0f / static_cast<float>(shardCount);
+            }
+            replica->layerEnd = layer;
+        }
+        replica->uploadedLayers = replica->layerBegin;
 
-    return std::async(std::launch::async, [this, config, inputData]() {
-        return runInference(config, inputData);
-    });
+        m_residency->registerModel(replicaKey(model.info.id, replica->deviceId),
+                                   replica->deviceId, model.replicaSizeMB(*replica));
+        model.replicas[replica->deviceId] = std::move(replica);
+    }
 }
 
-InferenceResult AIEngine::generateImage(const std::string& modelId,
-                                       const std::string& prompt,
-                                       const InferenceConfig& config) {
-    InferenceResult result;
-    result.success = false;
+bool AIEngine::ensureWeightsResident(AIModel& model, int deviceId) {
+    ModelReplica* replica = model.replica(deviceId);
+    if (!model.weights || !replica) {
+        return true; // Simulated model, nothing to page in
+    }
 
-    LOG_INFO("AIEngine", "Generating image from prompt: " + prompt);
+    std::lock_guard<std::mutex> lock(replica->weightMutex);
 
-    auto it = m_models.find(modelId);
-    if (it == m_models.end()) {
-        result.errorMessage = "Model not found";
-        return result;
+    const WeightLoader& weights = *model.weights;
+    const auto& tensors = weights.getTensors();
+    const auto& layers = weights.getLayers();
+    if (replica->uploadedLayers == replica->layerEnd) {
+        return true;
     }
 
-    // In production:
-    // 1. Tokenize prompt
-    // 2. Run text encoder
-    // 3. Run diffusion model for N steps
-    // 4. Decode latents to image
-
     auto startTime = std::chrono::high_resolution_clock::now();
-
-    // Simulate diffusion steps
-    for (int step = 0; step < config.numInferenceSteps; step++) {
-        if (m_progressCallback) {
-            m_progressCallback(static_cast<float>(step) / config.numInferenceSteps);
+    size_t firstLayer = replica->uploadedLayers;
+
+    // Upload layer by layer in file order, reading the next layer ahead while
+    // the current one is copied
+    weights.prefetchLayer(firstLayer);
+    for (size_t layer = firstLayer; layer < replica->layerEnd; layer++) {
+        if (layer + 1 < replica->layerEnd) {
+            weights.prefetchLayer(layer + 1);
         }
-        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        TRACE_GPU_SCOPE("AIEngine", "H2D weights", deviceId, nullptr);
+
+        for (size_t index : layers[layer].tensors) {
+            const WeightTensorInfo& tensor = tensors[index];
+            if (replica->deviceWeights[index] || tensor.sizeBytes == 0) {
+                continue;
+            }
+
+            void* devicePtr = allocateCudaMemory(static_cast<size_t>(tensor.sizeBytes), deviceId);
+            if (!devicePtr) {
+                LOG_ERROR("AIEngine", "Out of device memory uploading " + tensor.name +
+                          " to device " + std::to_string(deviceId));
+                return false;
+            }
+
+            // In production: cudaMemcpyAsync from a pinned staging buffer on the
+            // model stream; reading the mapping faults the pages in from disk
+            std::memcpy(devicePtr, weights.getTensorData(tensor),
+                        static_cast<size_t>(tensor.sizeBytes));
+            replica->deviceWeights[index] = devicePtr;
+        }
+
+        // The GPU copy is authoritative now; drop the host pages so peak
+        // RSS stays around one layer. Replicas on other devices fault them
+        // back in from the page cache.
+        weights.releaseLayer(layer);
+        replica->uploadedLayers = layer + 1;
     }
 
     auto endTime = std::chrono::high_resolution_clock::now();
-    result.inferenceTime = std::chrono::duration<float, std::milli>(
-        endTime - startTime).count();
+    float uploadTime = std::chrono::duration<float, std::milli>(endTime - startTime).count();
+    LOG_INFO("AIEngine", "Uploaded " + std::to_string(replica->layerEnd - firstLayer) +
+             " layers of " + model.info.id + " to device " + std::to_string(deviceId) +
+             " in " + std::to_string(uploadTime) + " ms");
 
-    // Simulate generated image (512x512 RGB)
-    result.imageWidth = 512;
-    result.imageHeight = 512;
-    result.imageChannels = 3;
-    result.imageData.resize(512 * 512 * 3);
+    return true;
+}
 
-    // Fill with gradient pattern for demonstration
-    for (int y = 0; y < 512; y++) {
-        for (int x = 0; x < 512; x++) {
-            int idx = (y * 512 + x) * 3;
-            result.imageData[idx + 0] = static_cast<unsigned char>((x * 255) / 512);
-            result.imageData[idx + 1] = static_cast<unsigned char>((y * 255) / 512);
-            result.imageData[idx + 2] = 128;
+void AIEngine::releaseModelWeights(AIModel& model, int deviceId) {
+    ModelReplica* replica = model.replica(deviceId);
+    if (!replica) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(replica->weightMutex);
+    for (void*& devicePtr : replica->deviceWeights) {
+        if (devicePtr) {
+            freeCudaMemory(devicePtr);
+            devicePtr = nullptr;
+        }
+    }
+    for (size_t i = 0; i < replica->hostWeights.size(); i++) {
+        if (replica->hostWeights[i]) {
+            freeHostMemory(replica->hostWeights[i],
+                           static_cast<size_t>(model.weights->getTensors()[i].sizeBytes));
+            replica->hostWeights[i] = nullptr;
         }
     }
+    replica->uploadedLayers = replica->layerBegin;
+}
 
-    result.success = true;
-    result.memoryUsed = it->second->info.memoryUsage;
+void AIEngine::offloadModelToHost(AIModel& model, int deviceId) {
+    ModelReplica* replica = model.replica(deviceId);
+    if (!replica) {
+        return;
+    }
 
-    LOG_INFO("AIEngine", "Image generated in " +
-             std::to_string(result.inferenceTime) + " ms");
+    std::lock_guard<std::mutex> lock(replica->weightMutex);
 
-    return result;
-}
+    // In production: the TensorRT engine's weights are refitted from the
+    // host copy on restore (IRefitter) instead of rebuilding the engine
+    TRACE_GPU_SCOPE("AIEngine", "D2H offload", deviceId, nullptr);
+    for (size_t i = 0; i < replica->deviceWeights.size(); i++) {
+        void* devicePtr = replica->deviceWeights[i];
+        if (!devicePtr) {
+            continue;
+        }
 
-InferenceResult AIEngine::upscaleImage(const std::string& modelId,
-                                      const std::vector<unsigned char>& inputImage,
-                                      int width, int height, int scaleFactor) {
-    InferenceResult result;
-    result.success = false;
+        size_t bytes = static_cast<size_t>(model.weights->getTensors()[i].sizeBytes);
+        void* hostPtr = allocateHostMemory(bytes, deviceId);
+        if (!hostPtr) {
+            continue; // No host copy: re-read from the file on restore
+        }
 
-    LOG_INFO("AIEngine", "Upscaling image: " + std::to_string(width) + "x" +
-             std::to_string(height) + " by " + std::to_string(scaleFactor) + "x");
+        // In production: cudaMemcpyAsync(hostPtr, devicePtr, bytes,
+        //                cudaMemcpyDeviceToHost, stream) then synchronize
+        std::memcpy(hostPtr, devicePtr, bytes);
+        replica->hostWeights[i] = hostPtr;
+    }
 
-    auto it = m_models.find(modelId);
-    if (it == m_models.end()) {
-        result.errorMessage = "Model not found";
-        return result;
+    for (void*& devicePtr : replica->deviceWeights) {
+        if (devicePtr) {
+            freeCudaMemory(devicePtr);
+            devicePtr = nullptr;
+        }
     }
+    replica->uploadedLayers = replica->layerBegin;
+}
 
-    auto startTime = std::chrono::high_resolution_clock::now();
+bool AIEngine::restoreModelFromHost(AIModel& model, int deviceId) {
+    ModelReplica* replica = model.replica(deviceId);
+    if (!replica) {
+        return false;
+    }
 
-    // In production: Run super-resolution model
-    std::this_thread::sleep_for(std::chrono::milliseconds(100 + (rand() % 200)));
+    {
+        std::lock_guard<std::mutex> lock(replica->weightMutex);
+        TRACE_GPU_SCOPE("AIEngine", "H2D restore", deviceId, nullptr);
+
+        for (size_t i = 0; i < replica->hostWeights.size(); i++) {
+            void* hostPtr = replica->hostWeights[i];
+            if (!hostPtr) {
+                continue;
+            }
+
+            size_t bytes = static_cast<size_t>(model.weights->getTensors()[i].sizeBytes);
+            void* devicePtr = allocateCudaMemory(bytes, deviceId);
+            if (!devicePtr) {
+                LOG_ERROR("AIEngine", "Out of device memory restoring " + model.info.id +
+                          " on device " + std::to_string(deviceId));
+                return false;
+            }
+
+            // In production: cudaMemcpyAsync host-to-device at full PCIe bandwidth,
+            // since the source is pinned
+            std::memcpy(devicePtr, hostPtr, bytes);
+            replica->deviceWeights[i] = devicePtr;
+
+            freeHostMemory(hostPtr, bytes);
+            replica->hostWeights[i] = nullptr;
+        }
+    }
 
-    auto endTime = std::chrono::high_resolution_clock::now();
+    // Anything that never made it to the host copy comes from the file
+    return ensureWeightsResident(model, deviceId);
+}
+
+std::vector<ResidencyLease> AIEngine::acquireModel(const AIModel& model, bool allowOffload,
+                                                   std::string& error, int* deviceId) {
+    std::vector<ResidencyLease> leases;
+    if (!m_residency) {
+        error = "Engine not initialized";
+        return leases;
+    }
+    const std::string& modelId = model.info.id;
+
+    // Stay on the worker's own GPU when it holds the model; synchronous
+    // callers are routed here
+    int target = t_workerDevice;
+    if (!model.replica(target)) {
+        target = selectDevice(model);
+    }
+    if (deviceId) {
+        *deviceId = target;
+    }
+
+    // Shards are pinned in ascending device order, so two callers never
+    // wait on each other's devices
+    std::vector<int> devices;
+    if (model.info.placement == ModelPlacement::SHARD) {
+        devices = model.info.devices;
+    } else {
+        devices.push_back(target);
+    }
+
+    for (int device : devices) {
+        std::string key = replicaKey(modelId, device);
+        if (!m_residency->acquire(key, allowOffload, &error)) {
+            leases.clear();
+            return leases;
+        }
+        leases.emplace_back(m_residency.get(), key);
+    }
+    return leases;
+}
+
+bool AIEngine::transitionModel(const std::string& replicaKey, ResidencyState from,
+                               ResidencyState to) {
+    size_t separator = replicaKey.rfind('@');
+    if (separator == std::string::npos) {
+        return false;
+    }
+    // The transfer being in flight holds off the model's teardown, so no
+    // reference is needed (taking one could make this thread its destroyer)
+    AIModel* found = m_models.findRetained(replicaKey.substr(0, separator));
+    if (!found) {
+        return false;
+    }
+    AIModel& model = *found;
+    int deviceId = std::stoi(replicaKey.substr(separator + 1));
+
+    // Graphs hold the weight addresses they were captured with
+    if (to != ResidencyState::RESIDENT && m_graphCache) {
+        m_graphCache->invalidateModel(model.info.id, deviceId);
+    }
+
+    switch (to) {
+        case ResidencyState::RESIDENT:
+            // In production: deserialize the TensorRT engine on the replica's
+            // device and allocate its activation memory before the weights arrive
+            if (from == ResidencyState::OFFLOADED) {
+                return restoreModelFromHost(model, deviceId);
+            }
+            return ensureWeightsResident(model, deviceId);
+
+        case ResidencyState::OFFLOADED:
+            if (model.weights) {
+                offloadModelToHost(model, deviceId);
+            }
+            // In production: also copy the engine's weights of models built
+            // from ONNX/PyTorch to pinned host memory
+            return true;
+
+        case ResidencyState::EVICTED:
+        default:
+            // In production: destroy the TensorRT engine; the cached
+            // serialized engine makes the next load fast
+            releaseModelWeights(model, deviceId);
+            return true;
+    }
+}
+
+size_t AIEngine::residencyBudgetMB(int deviceId) const {
+    if (m_residencyConfig.vramBudgetMB > 0) {
+        return m_residencyConfig.vramBudgetMB;
+    }
+    // Leave headroom for activations, CUDA graphs and the renderer
+    auto it = m_devices.find(deviceId);
+    return it == m_devices.end() ? 0 : it->second.memoryMB * 9 / 10;
+}
+
+void AIEngine::setResidencyConfig(const ResidencyConfig& config) {
+    m_residencyConfig = config;
+    if (m_residency) {
+        m_residency->setConfig(config);
+        for (int deviceId : m_deviceIds) {
+            m_residency->setDeviceBudget(deviceId, residencyBudgetMB(deviceId));
+        }
+    }
+}
+
+ResidencyStats AIEngine::getResidencyStats() const {
+    if (!m_residency) {
+        return ResidencyStats();
+    }
+    return m_residency->getStats();
+}
+
+void AIEngine::updateDeviceMetrics(const std::vector<GPUMetrics>& gpus) {
+    // In production: NVML indices follow PCI bus order, CUDA ordinals may
+    // not; match on nvmlDeviceGetPciInfo / cudaDeviceGetPCIBusId
+    std::lock_guard<std::mutex> lock(m_deviceMutex);
+    for (const auto& gpu : gpus) {
+        auto it = m_devices.find(static_cast<int>(gpu.deviceId));
+        if (it == m_devices.end()) {
+            continue;
+        }
+        it->second.gpuUtilization = gpu.gpuUtilization;
+        it->second.memoryUsedMB = gpu.memoryUsed;
+        if (gpu.memoryTotal > 0) {
+            it->second.memoryMB = gpu.memoryTotal;
+        }
+        it->second.hasMetrics = true;
+    }
+}
+
+void AIEngine::handleGPUEvent(const GPUEvent& event) {
+    bool degraded = false;
+    {
+        std::lock_guard<std::mutex> lock(m_deviceMutex);
+        auto it = m_devices.find(static_cast<int>(event.deviceId));
+        if (it == m_devices.end()) {
+            return;
+        }
+
+        DeviceState& state = it->second;
+        switch (event.type) {
+            case GPUEventType::THERMAL_THROTTLE:
+            case GPUEventType::POWER_THROTTLE:
+            case GPUEventType::THROTTLE_CLEARED:
+                state.throttleReasons = event.throttleReasons;
+                break;
+            case GPUEventType::MEMORY_PRESSURE:
+                state.memoryPressure = true;
+                break;
+            case GPUEventType::MEMORY_PRESSURE_CLEARED:
+                state.memoryPressure = false;
+                break;
+            case GPUEventType::XID_ERROR:
+                state.xidErrors++;
+                LOG_ERROR("AIEngine", "Device " + std::to_string(event.deviceId) +
+                          " reported Xid " + std::to_string(event.xid) +
+                          "; routing new requests elsewhere");
+                break;
+        }
+
+        for (const auto& pair : m_devices) {
+            if ((pair.second.throttleReasons & (THROTTLE_THERMAL_MASK | THROTTLE_POWER_MASK)) ||
+                pair.second.memoryPressure) {
+                degraded = true;
+            }
+        }
+    }
+
+    // Smaller batches cut activation memory and per-batch latency while a
+    // device is slowed down or short of VRAM
+    std::lock_guard<std::mutex> lock(m_batchingMutex);
+    if (degraded == m_batchingDegraded) {
+        return;
+    }
+    m_batchingDegraded = degraded;
+    if (m_batchScheduler->isRunning()) {
+        BatchingConfig config = effectiveBatchingConfig();
+        m_batchScheduler->setConfig(config);
+        LOG_INFO("AIEngine", "Batch size limit now " + std::to_string(config.maxBatchSize) +
+                 (degraded ? " (GPU throttled or under memory pressure)" : ""));
+    }
+}
+
+BatchingConfig AIEngine::effectiveBatchingConfig() const {
+    BatchingConfig config = m_batchingConfig;
+    if (m_batchingDegraded) {
+        config.maxBatchSize = std::max(1, config.maxBatchSize / 2);
+    }
+    return config;
+}
+
+std::vector<DeviceStatus> AIEngine::getDeviceStatus() const {
+    std::vector<DeviceStatus> statuses;
+    for (int deviceId : m_deviceIds) {
+        DeviceStatus status;
+        status.deviceId = deviceId;
+        {
+            std::lock_guard<std::mutex> lock(m_deviceMutex);
+            const DeviceState& state = m_devices.at(deviceId);
+            status.gpuUtilization = state.gpuUtilization;
+            status.memoryUsedMB = state.memoryUsedMB;
+            status.memoryTotalMB = state.memoryMB;
+            status.routedRequests = state.routedRequests;
+            status.throttleReasons = state.throttleReasons;
+            status.memoryPressure = state.memoryPressure;
+            status.xidErrors = state.xidErrors;
+            status.numaNode = state.numaNode;
+        }
+        status.residentMB = m_residency ? m_residency->getResidentMB(deviceId) : 0;
+        status.budgetMB = residencyBudgetMB(deviceId);
+        auto pool = m_workerPools.find(deviceId);
+        if (pool != m_workerPools.end()) {
+            status.outstandingJobs = pool->second->getOutstandingCount();
+        }
+        statuses.push_back(status);
+    }
+    return statuses;
+}
+
+int AIEngine::selectDevice(const AIModel& model) const {
+    if (model.info.devices.empty()) {
+        return m_deviceId;
+    }
+    if (model.info.placement == ModelPlacement::SHARD || model.info.devices.size() == 1) {
+        return model.info.devices.front(); // Pipeline entry
+    }
+
+    int best = model.info.devices.front();
+    float bestCost = std::numeric_limits<float>::max();
+    for (int deviceId : model.info.devices) {
+        float cost = 0.0f;
+        auto pool = m_workerPools.find(deviceId);
+        if (pool != m_workerPools.end()) {
+            cost += static_cast<float>(pool->second->getOutstandingCount());
+        }
+
+        bool resident = m_residency &&
+                        m_residency->getState(replicaKey(model.info.id, deviceId)) ==
+                        ResidencyState::RESIDENT;
+        size_t replicaMB = model.replicaSizeMB(*model.replica(deviceId));
+        {
+            std::lock_guard<std::mutex> lock(m_deviceMutex);
+            const DeviceState& state = m_devices.at(deviceId);
+            if (state.hasMetrics) {
+                cost += ROUTE_COST_UTILIZATION * state.gpuUtilization / 100.0f;
+                if (!resident && state.memoryUsedMB + replicaMB > state.memoryMB) {
+                    cost += ROUTE_COST_NO_MEMORY;
+                }
+            }
+            if (!resident && state.memoryPressure) {
+                cost += ROUTE_COST_NO_MEMORY;
+            }
+            if (state.throttleReasons & (THROTTLE_THERMAL_MASK | THROTTLE_POWER_MASK)) {
+                cost += ROUTE_COST_THROTTLED;
+            }
+            if (state.xidErrors > 0) {
+                cost += ROUTE_COST_FAULTED;
+            }
+        }
+        if (!resident) {
+            cost += ROUTE_COST_NOT_RESIDENT;
+        }
+
+        if (cost < bestCost) {
+            bestCost = cost;
+            best = deviceId;
+        }
+    }
+    return best;
+}
+
+int AIEngine::routeRequest(const std::string& modelId) {
+    ModelHandle model = m_models.find(modelId);
+    int deviceId = model ? selectDevice(*model) : m_deviceId;
+
+    std::lock_guard<std::mutex> lock(m_deviceMutex);
+    auto state = m_devices.find(deviceId);
+    if (state != m_devices.end()) {
+        state->second.routedRequests++;
+    }
+    return deviceId;
+}
+
+void AIEngine::prefetchModel(const std::string& modelId, int deviceId) {
+    ModelHandle model = m_models.find(modelId);
+    if (!m_residency || !model) {
+        return;
+    }
+    for (const auto& pair : model->replicas) {
+        if (pair.first == deviceId || model->info.placement == ModelPlacement::SHARD) {
+            m_residency->prefetch(replicaKey(modelId, pair.first));
+        }
+    }
+}
+
+/**
+ * @brief Output tensor shape of one inference request
+ *
+ * Image generators produce the requested size; the model's stored output
+ * shape only holds their 512x512 default.
+ */
+static TensorShape inferenceOutputShape(const AIModel& model, const InferenceConfig& config) {
+    TensorShape shape;
+    for (int dim : model.info.outputShape) {
+        if (shape.ndim < TensorShape::MAX_DIMS) {
+            shape.dims[shape.ndim++] = dim;
+        }
+    }
+    if (model.info.type == ModelType::TEXT_TO_IMAGE && shape.ndim == 4 &&
+        config.width > 0 && config.height > 0) {
+        shape.dims[2] = config.height;
+        shape.dims[3] = config.width;
+    }
+    return shape;
+}
+
+InferenceResult AIEngine::runInference(const InferenceConfig& config,
+                                      const std::vector<float>& inputData) {
+    // Convenience path for host vectors: wrap the buffers in views and run
+    // the zero-copy overload, allocating the output exactly once
+    std::vector<float> outputData;
+    TensorView output;
+    ModelHandle model = m_models.find(config.modelId);
+    if (model) {
+        TensorShape outputShape = inferenceOutputShape(*model, config);
+        outputData.resize(outputShape.numElements());
+        output = TensorView(outputData.data(), DataType::FLOAT32, outputShape);
+    }
+
+    ConstTensorView input(inputData.data(), DataType::FLOAT32,
+                          {static_cast<int64_t>(inputData.size())});
+
+    InferenceResult result = runInference(config, input, output);
+    if (result.success) {
+        result.outputData = std::move(outputData);
+    }
+    return result;
+}
+
+InferenceResult AIEngine::runInference(const InferenceConfig& config,
+                                      const ConstTensorView& input,
+                                      const TensorView& output) {
+    InferenceResult result;
+    result.success = false;
+
+    if (!m_initialized) {
+        result.errorMessage = "Engine not initialized";
+        LOG_ERROR("AIEngine", result.errorMessage);
+        return result;
+    }
+
+    // Held until the end, so an unload meanwhile does not free the model
+    ModelHandle model = m_models.find(config.modelId);
+    if (!model) {
+        result.errorMessage = "Model not found: " + config.modelId;
+        LOG_ERROR("AIEngine", result.errorMessage);
+        return result;
+    }
+
+    const size_t outputElements = inferenceOutputShape(*model, config).numElements();
+    if (!output.isValid() || output.dtype != DataType::FLOAT32 ||
+        output.numElements() < outputElements) {
+        result.errorMessage = "Output buffer too small: model needs " +
+                              std::to_string(outputElements) + " float32 elements";
+        LOG_ERROR("AIEngine", result.errorMessage);
+        return result;
+    }
+
+    if (WorkerPool::isCurrentJobCancelled()) {
+        result.errorMessage = "Cancelled";
+        return result;
+    }
+
+    int deviceId = m_deviceId;
+    std::vector<ResidencyLease> leases = acquireModel(*model, config.useVRAMOffload,
+                                                      result.errorMessage, &deviceId);
+    if (leases.empty()) {
+        LOG_ERROR("AIEngine", result.errorMessage);
+        return result;
+    }
+
+    LOG_DEBUGF("AIEngine", "Running inference on model: %s (device %d)",
+               config.modelId.c_str(), deviceId);
+    TRACE_SCOPE_DETAIL("AIEngine", "runInference", config.modelId);
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    // In production, actual inference would happen here, binding the
+    // caller's buffers directly instead of staging through the host heap:
+    // 1. DEVICE input/output: pass the pointers to context->setTensorAddress()
+    //    PINNED_HOST: cudaMemcpyAsync on the model stream
+    //    HOST: copy through a pinned staging buffer
+    // 2. Execute TensorRT engine (enqueueV3 on the model stream)
+    // 3. Copy output back only if the output view is not DEVICE memory
+    // 4. Post-process results
+    // Sharded models run one stage per device, handing activations to the
+    // next shard with cudaMemcpyPeerAsync and an event between the streams
+    (void)input;
+
+    // Simulate inference time (depends on model type)
+    int inferenceTimeMs = 50 + (rand() % 200);
+    {
+        TRACE_GPU_SCOPE("AIEngine", "enqueue", deviceId, nullptr);
+        std::this_thread::sleep_for(std::chrono::milliseconds(inferenceTimeMs));
+    }
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+    result.inferenceTime = std::chrono::duration<float, std::milli>(
+        endTime - startTime).count();
+
+    // Simulate output, written straight into the caller's buffer
+    std::memset(output.data, 0, outputElements * sizeof(float));
+    result.success = true;
+    result.memoryUsed = model->memoryUsageMB();
+
+    LOG_INFOF("AIEngine", "Inference completed in %f ms", result.inferenceTime);
+
+    return result;
+}
+
+std::future<InferenceResult> AIEngine::runInferenceAsync(
+    const InferenceConfig& config,
+    const std::vector<float>& inputData) {
+
+    return submitInference(config, inputData).result;
+}
+
+std::future<InferenceResult> AIEngine::runInferenceAsync(
+    const InferenceConfig& config,
+    std::vector<float>&& inputData) {
+
+    return submitInference(config, std::move(inputData)).result;
+}
+
+InferenceTicket AIEngine::submitInference(const InferenceConfig& config,
+                                          std::vector<float> inputData) {
+    InferenceTicket ticket;
+    ticket.jobId = m_nextJobId++;
+
+    if (m_batchScheduler->isRunning()) {
+        // Batches are routed when they launch; warm the likely device meanwhile
+        ModelHandle model = m_models.find(config.modelId);
+        if (model) {
+            prefetchModel(config.modelId, selectDevice(*model));
+        }
+        ticket.result = m_batchScheduler->submit(ticket.jobId, config, std::move(inputData));
+        return ticket;
+    }
+
+    // Start bringing the model into VRAM while the request waits in the queue
+    int deviceId = routeRequest(config.modelId);
+    prefetchModel(config.modelId, deviceId);
+
+    auto promise = std::make_shared<std::promise<InferenceResult>>();
+    ticket.result = promise->get_future();
+
+    WorkerPool* pool = getWorkerPool(deviceId);
+    if (!pool) {
+        InferenceResult result;
+        result.success = false;
+        result.errorMessage = "Engine not initialized";
+        promise->set_value(std::move(result));
+        return ticket;
+    }
+
+    // std::function needs a copyable callable, so the input travels by shared_ptr
+    auto input = std::make_shared<std::vector<float>>(std::move(inputData));
+    bool queued = pool->submit(ticket.jobId, config.priority,
+        [this, config, input, promise] {
+            try {
+                promise->set_value(runInference(config, *input));
+            } catch (...) {
+                promise->set_exception(std::current_exception());
+            }
+        },
+        [promise] {
+            InferenceResult result;
+            result.success = false;
+            result.errorMessage = "Cancelled";
+            promise->set_value(std::move(result));
+        });
+
+    if (!queued) {
+        InferenceResult result;
+        result.success = false;
+        result.errorMessage = "Inference queue full";
+        promise->set_value(std::move(result));
+    }
+
+    return ticket;
+}
+
+bool AIEngine::cancelInference(uint64_t jobId) {
+    if (m_batchScheduler->cancel(jobId)) {
+        return true;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_pipelineMutex);
+        if (m_pipeline && m_pipeline->cancel(jobId)) {
+            return true;
+        }
+    }
+
+    for (auto& pair : m_workerPools) {
+        if (pair.second->cancel(jobId)) {
+            return true;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_textGeneratorMutex);
+    for (auto& pair : m_textGenerators) {
+        if (pair.second->cancel(jobId)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+WorkerPool* AIEngine::getWorkerPool(int deviceId) {
+    auto it = m_workerPools.find(deviceId);
+    if (it == m_workerPools.end() || !it->second->isRunning()) {
+        return nullptr;
+    }
+    return it->second.get();
+}
+
+std::future<InferenceResult> AIEngine::runInferenceAsync(
+    const InferenceConfig& config,
+    const ConstTensorView& input,
+    const TensorView& output) {
+
+    auto promise = std::make_shared<std::promise<InferenceResult>>();
+    std::future<InferenceResult> future = promise->get_future();
+
+    int deviceId = routeRequest(config.modelId);
+    WorkerPool* pool = getWorkerPool(deviceId);
+    if (!pool) {
+        InferenceResult result;
+        result.success = false;
+        result.errorMessage = "Engine not initialized";
+        promise->set_value(std::move(result));
+        return future;
+    }
+
+    prefetchModel(config.modelId, deviceId);
+
+    // Views are captured by value; the buffers they point to stay with the caller
+    bool queued = pool->submit(m_nextJobId++, config.priority,
+        [this, config, input, output, promise] {
+            try {
+                promise->set_value(runInference(config, input, output));
+            } catch (...) {
+                promise->set_exception(std::current_exception());
+            }
+        },
+        [promise] {
+            InferenceResult result;
+            result.success = false;
+            result.errorMessage = "Cancelled";
+            promise->set_value(std::move(result));
+        });
+
+    if (!queued) {
+        InferenceResult result;
+        result.success = false;
+        result.errorMessage = "Inference queue full";
+        promise->set_value(std::move(result));
+    }
+
+    return future;
+}
+
+TensorView AIEngine::allocateTensor(const TensorShape& shape, DataType dtype,
+                                    MemoryLocation location) {
+    TensorView tensor(nullptr, dtype, shape, location, m_deviceId);
+    size_t bytes = tensor.sizeBytes();
+    if (bytes == 0) {
+        return tensor;
+    }
+
+    switch (location) {
+        case MemoryLocation::DEVICE:
+            tensor.data = allocateCudaMemory(bytes);
+            break;
+        case MemoryLocation::PINNED_HOST:
+            // In production: cudaHostAlloc(&ptr, bytes, cudaHostAllocPortable);
+            tensor.data = malloc(bytes);
+            break;
+        case MemoryLocation::HOST:
+        default:
+            tensor.data = malloc(bytes);
+            break;
+    }
+
+    if (!tensor.data) {
+        LOG_ERROR("AIEngine", "Failed to allocate tensor of " + std::to_string(bytes) + " bytes");
+    }
+
+    return tensor;
+}
+
+void AIEngine::freeTensor(TensorView& tensor) {
+    if (!tensor.data) {
+        return;
+    }
+
+    switch (tensor.location) {
+        case MemoryLocation::DEVICE:
+            freeCudaMemory(tensor.data);
+            break;
+        case MemoryLocation::PINNED_HOST:
+            // In production: cudaFreeHost(ptr);
+            free(tensor.data);
+            break;
+        case MemoryLocation::HOST:
+        default:
+            free(tensor.data);
+            break;
+    }
+
+    tensor.data = nullptr;
+}
+
+WorkerPoolStats AIEngine::getWorkerPoolStats(int deviceId) const {
+    auto it = m_workerPools.find(deviceId);
+    if (it == m_workerPools.end()) {
+        return WorkerPoolStats();
+    }
+    return it->second->getStats();
+}
+
+std::vector<InferenceResult> AIEngine::runInferenceBatch(
+    const InferenceConfig& config,
+    const std::vector<std::vector<float>>& inputs) {
+
+    std::vector<InferenceResult> results(inputs.size());
+    for (auto& result : results) {
+        result.success = false;
+    }
+
+    if (inputs.empty()) {
+        return results;
+    }
+
+    std::string error;
+    ModelHandle model = m_models.find(config.modelId);
+    if (!m_initialized) {
+        error = "Engine not initialized";
+    } else if (!model) {
+        error = "Model not found: " + config.modelId;
+    }
+
+    if (!error.empty()) {
+        LOG_ERROR("AIEngine", error);
+        for (auto& result : results) {
+            result.errorMessage = error;
+        }
+        return results;
+    }
+
+    int deviceId = m_deviceId;
+    std::vector<ResidencyLease> leases = acquireModel(*model, config.useVRAMOffload,
+                                                      error, &deviceId);
+    if (leases.empty()) {
+        LOG_ERROR("AIEngine", error);
+        for (auto& result : results) {
+            result.errorMessage = error;
+        }
+        return results;
+    }
+
+    LOG_DEBUGF("AIEngine", "Running batched inference on model: %s (batch size %zu)",
+               config.modelId.c_str(), inputs.size());
+    TRACE_SCOPE_DETAIL("AIEngine", "runInferenceBatch", config.modelId);
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    // In production, the batch runs as a single engine execution:
+    // 1. Gather inputs into one contiguous [N, ...] device tensor
+    // 2. Set the batch dimension on the execution context's input binding
+    // 3. Execute TensorRT engine once for the whole batch
+    // 4. Copy output back and slice it per batch item
+
+    // Simulate batched execution: one launch, cost grows sub-linearly with N
+    int baseTimeMs = 50 + (rand() % 200);
+    int batchTimeMs = baseTimeMs + static_cast<int>(baseTimeMs * 0.15f * (inputs.size() - 1));
+    {
+        TRACE_GPU_SCOPE("AIEngine", "enqueue", deviceId, nullptr);
+        std::this_thread::sleep_for(std::chrono::milliseconds(batchTimeMs));
+    }
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+    float batchTime = std::chrono::duration<float, std::milli>(
+        endTime - startTime).count();
+
+    // Split the simulated [N, ...] output back out per request; merged
+    // requests agree on every field that shapes it (see BatchScheduler)
+    const size_t outputElements = inferenceOutputShape(*model, config).numElements();
+    for (auto& result : results) {
+        result.outputData.resize(outputElements);
+        result.inferenceTime = batchTime;
+        result.memoryUsed = model->memoryUsageMB();
+        result.success = true;
+    }
+
+    LOG_INFOF("AIEngine", "Batched inference completed in %f ms", batchTime);
+
+    return results;
+}
+
+void AIEngine::setBatchingConfig(const BatchingConfig& config) {
+    std::lock_guard<std::mutex> lock(m_batchingMutex);
+    m_batchingConfig = config;
+
+    if (!config.enabled) {
+        m_batchScheduler->stop();
+    } else if (!m_initialized) {
+        // Started by initialize()
+        return;
+    } else if (m_batchScheduler->isRunning()) {
+        m_batchScheduler->setConfig(effectiveBatchingConfig());
+    } else {
+        m_batchScheduler->start(effectiveBatchingConfig());
+    }
+}
+
+BatchingStats AIEngine::getBatchingStats() const {
+    return m_batchScheduler->getStats();
+}
+
+InferenceResult AIEngine::generateImage(const std::string& modelId,
+                                       const std::string& prompt,
+                                       const InferenceConfig& config) {
+    std::vector<unsigned char> imageData(
+        config.width > 0 && config.height > 0 ? static_cast<size_t>(config.width) * config.height * 3 : 0);
+    TensorView output(imageData.data(), DataType::UINT8, {config.height, config.width, 3});
+
+    InferenceResult result = generateImage(modelId, prompt, config, output);
+    if (result.success) {
+        result.imageData = std::move(imageData);
+    }
+    return result;
+}
+
+InferenceResult AIEngine::generateImage(const std::string& modelId,
+                                       const std::string& prompt,
+                                       const InferenceConfig& config,
+                                       const TensorView& outputImage) {
+    return generateImageInto(modelId, prompt, config, outputImage, nullptr, 0);
+}
+
+InferenceResult AIEngine::generateImage(const std::string& modelId,
+                                       const std::string& prompt,
+                                       const InferenceConfig& config,
+                                       const InteropImage& image,
+                                       uint64_t generation) {
+    if (!image.isValid()) {
+        InferenceResult result;
+        result.success = false;
+        result.errorMessage = "Interop image not imported";
+        LOG_ERROR("AIEngine", result.errorMessage);
+        return result;
+    }
+    if (image.handles.width != config.width || image.handles.height != config.height) {
+        InferenceResult result;
+        result.success = false;
+        result.errorMessage = "Interop image is " + std::to_string(image.handles.width) + "x" +
+                              std::to_string(image.handles.height) + ", request is " +
+                              std::to_string(config.width) + "x" + std::to_string(config.height);
+        LOG_ERROR("AIEngine", result.errorMessage);
+        return result;
+    }
+    return generateImageInto(modelId, prompt, config, image.view(), &image, generation);
+}
+
+uint64_t AIEngine::submitImageGeneration(const std::string& modelId,
+                                        const std::string& prompt,
+                                        const InferenceConfig& config,
+                                        ImageJobCallbacks callbacks) {
+    const uint64_t jobId = m_nextJobId++;
+    auto job = std::make_shared<ImageJobCallbacks>(std::move(callbacks));
+    auto fail = [job](const std::string& message) {
+        InferenceResult result;
+        result.success = false;
+        result.errorMessage = message;
+        if (job->finished) {
+            job->finished(std::move(result));
+        }
+    };
+
+    // Start bringing the model into VRAM while the request waits in the queue
+    int deviceId = routeRequest(modelId);
+    WorkerPool* pool = getWorkerPool(deviceId);
+    if (!pool) {
+        fail("Engine not initialized");
+        return jobId;
+    }
+    prefetchModel(modelId, deviceId);
+
+    bool queued = pool->submit(jobId, config.priority,
+        [this, modelId, prompt, config, job] {
+            t_jobProgress = job->progress ? &job->progress : nullptr;
+            InferenceResult result;
+            try {
+                result = generateImage(modelId, prompt, config);
+            } catch (const std::exception& e) {
+                result.success = false;
+                result.errorMessage = e.what();
+            }
+            t_jobProgress = nullptr;
+            if (job->finished) {
+                job->finished(std::move(result));
+            }
+        },
+        [fail] { fail("Cancelled"); });
+
+    if (!queued) {
+        fail("Inference queue full");
+    }
+    return jobId;
+}
+
+bool AIEngine::importInteropImage(const InteropHandles& handles, InteropImage& image, int deviceId) {
+    if (!m_initialized) {
+        LOG_ERROR("AIEngine", "Cannot import interop image: engine not initialized");
+        return false;
+    }
+    if (handles.width <= 0 || handles.height <= 0 || handles.channels <= 0 ||
+        handles.memoryBytes < static_cast<size_t>(handles.width) * handles.height * handles.channels) {
+        LOG_ERROR("AIEngine", "Interop image handles describe no usable buffer");
+        return false;
+    }
+    if (deviceId < 0) {
+        deviceId = m_deviceId;
+    }
+    if (!m_devices.count(deviceId)) {
+        LOG_ERROR("AIEngine", "Interop import on unknown device " + std::to_string(deviceId));
+        return false;
+    }
+
+    // In production:
+    // 1. cudaGetDeviceProperties(&prop, deviceId); memcmp(prop.uuid, handles.deviceUUID, 16)
+    //    so the memory is imported on the GPU that allocated it
+    // 2. cudaExternalMemoryHandleDesc memDesc = {}; memDesc.type =
+    //    cudaExternalMemoryHandleTypeOpaqueFd (OpaqueWin32 on Windows,
+    //    D3D12Resource for DX12); memDesc.handle.fd = handles.memoryHandle;
+    //    memDesc.size = handles.memoryBytes; memDesc.flags = cudaExternalMemoryDedicated;
+    //    cudaImportExternalMemory(&extMem, &memDesc)   // CUDA now owns the fd
+    // 3. cudaExternalMemoryBufferDesc bufDesc = {0, handles.memoryBytes, 0};
+    //    cudaExternalMemoryGetMappedBuffer(&devicePointer, extMem, &bufDesc)
+    // 4. cudaExternalSemaphoreHandleDesc semDesc = {}; semDesc.type =
+    //    cudaExternalSemaphoreHandleTypeTimelineSemaphoreFd (D3D12Fence for DX12);
+    //    cudaImportExternalSemaphore(&extSem, &semDesc)
+    // Simulated: the renderer's "handle" is the buffer address itself
+    image.handles = handles;
+    image.deviceId = deviceId;
+    image.externalMemory = reinterpret_cast<void*>(0xe000);
+    image.externalSemaphore = reinterpret_cast<void*>(0xe100);
+    image.devicePointer = reinterpret_cast<void*>(handles.memoryHandle);
+
+    LOG_INFO("AIEngine", "Imported " + std::to_string(handles.width) + "x" +
+             std::to_string(handles.height) + " interop image on device " + std::to_string(deviceId));
+    return true;
+}
+
+void AIEngine::releaseInteropImage(InteropImage& image) {
+    if (!image.isValid()) {
+        return;
+    }
+
+    // In production: cudaStreamSynchronize on the streams that used it, then
+    // cudaDestroyExternalSemaphore(extSem); cudaFree(devicePointer);
+    // cudaDestroyExternalMemory(extMem)
+    image = InteropImage();
+}
+
+InferenceResult AIEngine::generateImageInto(const std::string& modelId,
+                                           const std::string& prompt,
+                                           const InferenceConfig& config,
+                                           const TensorView& outputImage,
+                                           const InteropImage* interop,
+                                           uint64_t generation) {
+    InferenceResult result;
+    result.success = false;
+
+    LOG_INFO("AIEngine", "Generating image from prompt: " + prompt);
+    TRACE_SCOPE_DETAIL("AIEngine", "generateImage", modelId);
+
+    ModelHandle model = m_models.find(modelId);
+    if (!model) {
+        result.errorMessage = "Model not found";
+        return result;
+    }
+
+    const int width = config.width;
+    const int height = config.height;
+    // RGB, or RGBA with opaque alpha for render targets that cannot sample RGB8
+    const int channels = outputImage.shape.ndim == 3 && outputImage.shape.dims[2] == 4 ? 4 : 3;
+    if (width <= 0 || height <= 0 || width % 8 != 0 || height % 8 != 0) {
+        result.errorMessage = "Image size must be a positive multiple of 8, got " +
+                              std::to_string(width) + "x" + std::to_string(height);
+        LOG_ERROR("AIEngine", result.errorMessage);
+        return result;
+    }
+    if (!outputImage.isValid() || outputImage.dtype != DataType::UINT8 ||
+        outputImage.numElements() < static_cast<size_t>(width) * height * channels) {
+        result.errorMessage = "Output image buffer too small: need " +
+                              std::to_string(width) + "x" + std::to_string(height) +
+                              "x" + std::to_string(channels) + " uint8";
+        LOG_ERROR("AIEngine", result.errorMessage);
+        return result;
+    }
+
+    // A repeat of a seeded request is answered without paging the model in.
+    // Interop images are skipped: the renderer waits on the decode's signal.
+    const std::string resultKey = m_resultCache && m_resultCache->isEnabled() && !interop ?
+        makeResultCacheKey(*model, prompt, config) : std::string();
+    CachedImage cached;
+    if (!resultKey.empty() && m_resultCache->load(resultKey, cached) &&
+        cached.width == width && cached.height == height && cached.channels == 3) {
+        // In production: cudaMemcpy host-to-device when the output is DEVICE memory
+        ConstTensorView cachedView(cached.pixels.data(), DataType::UINT8, {height, width, 3});
+        if (channels == 3) {
+            std::memcpy(outputImage.data, cached.pixels.data(), cached.pixels.size());
+        } else {
+            convertColor(cachedView, outputImage, ColorConversion::ADD_ALPHA);
+        }
+        result.imageWidth = width;
+        result.imageHeight = height;
+        result.imageChannels = channels;
+        result.success = true;
+        LOG_INFO("AIEngine", "Image served from the result cache");
+        return result;
+    }
+
+    int deviceId = m_deviceId;
+    std::vector<ResidencyLease> leases = acquireModel(*model, config.useVRAMOffload,
+                                                      result.errorMessage, &deviceId);
+    if (leases.empty()) {
+        LOG_ERROR("AIEngine", result.errorMessage);
+        return result;
+    }
+
+    // In production the three stages run back to back on the worker stream;
+    // the VAE writes into outputImage directly when it is DEVICE or
+    // PINNED_HOST memory. submitPipelinedGeneration overlaps them instead.
+    void* stream = deviceId == t_workerDevice ? t_workerStream : nullptr;
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    std::vector<uint16_t> embeddings;
+    encodePrompt(*model, prompt, config, deviceId, stream, embeddings);
+
+    std::vector<uint16_t> latents;
+    if (!denoiseLatents(modelId, config, deviceId, stream, embeddings,
+                        [] { return WorkerPool::isCurrentJobCancelled(); },
+                        latents, result.errorMessage)) {
+        return result;
+    }
+
+    decodeLatents(latents, config, outputImage, interop, generation, deviceId, stream);
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+    result.inferenceTime = std::chrono::duration<float, std::milli>(
+        endTime - startTime).count();
+
+    result.imageWidth = width;
+    result.imageHeight = height;
+    result.imageChannels = channels;
+
+    if (!resultKey.empty()) {
+        // Stored as RGB whatever the output layout; DEVICE output is copied
+        // back first in production
+        cached.width = width;
+        cached.height = height;
+        cached.channels = 3;
+        cached.pixels.resize(static_cast<size_t>(width) * height * 3);
+        TensorView cachedView(cached.pixels.data(), DataType::UINT8, {height, width, 3});
+        if (channels == 3) {
+            std::memcpy(cached.pixels.data(), outputImage.data, cached.pixels.size());
+        } else {
+            convertColor(ConstTensorView(outputImage.data, DataType::UINT8, {height, width, channels}),
+                         cachedView, ColorConversion::DROP_ALPHA);
+        }
+        m_resultCache->store(resultKey, cached);
+    }
+
+    result.success = true;
+    result.memoryUsed = model->memoryUsageMB();
+
+    LOG_INFOF("AIEngine", "Image generated in %f ms", result.inferenceTime);
+
+    return result;
+}
+
+void AIEngine::encodePrompt(const AIModel& model, const std::string& prompt,
+                            const InferenceConfig& config, int deviceId, void* stream,
+                            std::vector<uint16_t>& embeddings) {
+    // CLIP-style encoder: 77 tokens x 768 features in FP16, with an empty
+    // prompt's embeddings first for classifier-free guidance
+    const size_t promptElements = 77 * 768;
+    std::vector<std::string> prompts;
+    if (config.guidanceScale > 1.0f) {
+        prompts.push_back(std::string());
+    }
+    prompts.push_back(prompt);
+
+    std::vector<uint16_t> encoded;
+    encoded.reserve(prompts.size() * promptElements);
+    for (const std::string& text : prompts) {
+        const std::string key = model.fingerprint + "|" + std::to_string(deviceId) + "|" +
+                                precisionModeToString(config.precision) + "|" + text;
+        if (m_embeddingCache && m_embeddingCache->lookup(key, encoded)) {
+            continue;
+        }
+
+        // In production: tokenize on the host, cudaMemcpyAsync the token IDs
+        // and enqueueV3 the text encoder on the stream
+        TRACE_GPU_SCOPE("AIEngine", "text encoder", deviceId, stream);
+        std::this_thread::sleep_for(std::chrono::milliseconds(8));
+        const size_t offset = encoded.size();
+        encoded.resize(offset + promptElements);
+        std::mt19937 rng(static_cast<unsigned int>(std::hash<std::string>()(text)));
+        for (size_t i = offset; i < encoded.size(); i++) {
+            encoded[i] = static_cast<uint16_t>(rng());
+        }
+        if (m_embeddingCache) {
+            m_embeddingCache->store(key, &encoded[offset], promptElements);
+        }
+    }
+
+    // Every batch item conditions on the same prompt
+    const size_t batchSize = static_cast<size_t>(std::max(config.batchSize, 1));
+    embeddings.clear();
+    embeddings.reserve(encoded.size() * batchSize);
+    for (size_t copy = 0; copy < prompts.size(); copy++) {
+        for (size_t item = 0; item < batchSize; item++) {
+            embeddings.insert(embeddings.end(), encoded.begin() + copy * promptElements,
+                              encoded.begin() + (copy + 1) * promptElements);
+        }
+    }
+}
+
+bool AIEngine::denoiseLatents(const std::string& modelId, const InferenceConfig& config,
+                              int deviceId, void* stream, const std::vector<uint16_t>& embeddings,
+                              const std::function<bool()>& cancelled,
+                              std::vector<uint16_t>& latents, std::string& error) {
+    const int width = config.width;
+    const int height = config.height;
+
+    // UNet activations for one step: 4-channel latents at 1/8 resolution plus
+    // intermediate feature maps, FP16, for every batch item
+    const int batchSize = std::max(config.batchSize, 1);
+    const size_t latentElements = static_cast<size_t>(width / 8) * (height / 8) * 4 * batchSize;
+    const size_t stepWorkspaceBytes = latentElements * sizeof(uint16_t) * 20;
+
+    // In production: seeded Gaussian noise generated on the stream
+    latents.assign(latentElements, 0);
+    (void)embeddings;
+
+    // Every step has the same shapes, so capture one and replay it
+    std::shared_ptr<CudaGraph> stepGraph;
+    if (m_graphCache) {
+        CudaGraphKey key;
+        key.modelId = modelId;
+        key.deviceId = deviceId;
+        key.width = width;
+        key.height = height;
+        key.batchSize = batchSize;
+        key.precision = config.precision;
+
+        stepGraph = m_graphCache->getOrCapture(key, [&](CudaGraph& graph) {
+            TRACE_SCOPE("AIEngine", "captureStepGraph");
+            // Graph kernels address this buffer on every replay, so it is
+            // owned by the graph rather than taken from the allocator per step
+            graph.workspace = allocateCudaMemory(stepWorkspaceBytes, deviceId);
+            if (!graph.workspace) {
+                return false;
+            }
+            graph.workspaceBytes = stepWorkspaceBytes;
+
+            // In production (capture needs a non-default stream, so sync
+            // callers capture on a temporary one; launches may use any stream):
+            // 1. context->setDeviceMemory(graph.workspace) so enqueue allocates nothing
+            // 2. cudaStreamBeginCapture(stream, cudaStreamCaptureModeThreadLocal)
+            // 3. enqueueV3 the UNet, then the scheduler update kernel; timestep
+            //    and sigma are read from a small device buffer, not baked in
+            // 4. cudaStreamEndCapture(stream, &graph) and cudaGraphInstantiate
+            graph.graphExec = reinterpret_cast<void*>(0x9abc); // Placeholder
+            return true;
+        });
+    }
+
+    // Simulate diffusion steps
+    for (int step = 0; step < config.numInferenceSteps; step++) {
+        if (cancelled()) {
+            error = "Cancelled";
+            return false;
+        }
+        reportProgress(static_cast<float>(step) / config.numInferenceSteps);
+
+        TRACE_SCOPE("AIEngine", stepGraph ? "diffusionStep (graph)" : "diffusionStep (eager)");
+        TRACE_GPU_SCOPE("AIEngine", "diffusionStep", deviceId, stream);
+
+        if (stepGraph) {
+            // In production: cudaMemcpyAsync this step's timestep into the
+            // parameter buffer, then cudaGraphLaunch(graphExec, stream)
+            std::this_thread::sleep_for(std::chrono::milliseconds(16));
+            m_graphCache->recordReplay();
+            continue;
+        }
+
+        // Eager path: one launch per kernel, with TensorRT's per-enqueue
+        // scratch coming from the caching allocator
+        void* workspace = allocateCudaMemory(stepWorkspaceBytes, deviceId);
+        if (!workspace) {
+            error = "Out of device memory for diffusion workspace";
+            LOG_ERROR("AIEngine", error);
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        freeCudaMemory(workspace);
+        m_eagerSteps++;
+    }
+    return true;
+}
+
+void AIEngine::decodeLatents(const std::vector<uint16_t>& latents, const InferenceConfig& config,
+                             const TensorView& outputImage, const InteropImage* interop,
+                             uint64_t generation, int deviceId, void* stream) {
+    const int width = config.width;
+    const int height = config.height;
+    const int channels = outputImage.shape.ndim == 3 && outputImage.shape.dims[2] == 4 ? 4 : 3;
+    (void)latents;
+
+    if (interop) {
+        // In production, on the stream around the VAE decode:
+        // cudaExternalSemaphoreWaitParams wait = {}; wait.params.fence.value =
+        //     interopWriteWaitValue(generation);
+        // cudaWaitExternalSemaphoresAsync(&extSem, &wait, 1, stream)
+        // ... decode into interop->devicePointer ...
+        // cudaExternalSemaphoreSignalParams signal = {}; signal.params.fence.value =
+        //     interopWrittenValue(generation);
+        // cudaSignalExternalSemaphoresAsync(&extSem, &signal, 1, stream)
+        // No host copy and no stream synchronize: the renderer waits on the GPU
+        LOG_DEBUG("AIEngine", "Interop image generation " + std::to_string(generation) +
+                  " signals " + std::to_string(interopWrittenValue(generation)));
+    }
+
+    {
+        // In production: enqueueV3 the VAE decoder on the latents
+        TRACE_GPU_SCOPE("AIEngine", "VAE decode", deviceId, stream);
+        std::this_thread::sleep_for(std::chrono::milliseconds(12));
+    }
+
+    // In production: the VAE decode's [-1, 1] float CHW output is converted
+    // to pixels with launchTensorToImage (mean and stddev 0.5) on the stream,
+    // then copied device-to-host and synchronized unless the output is
+    // device memory
+    TRACE_GPU_SCOPE("AIEngine", outputImage.location == MemoryLocation::DEVICE ?
+                    "tensorToImage (device)" : "D2H image", deviceId, stream);
+
+    // Fill with gradient pattern for demonstration
+    unsigned char* pixels = static_cast<unsigned char*>(outputImage.data);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            int idx = (y * width + x) * channels;
+            pixels[idx + 0] = static_cast<unsigned char>((x * 255) / width);
+            pixels[idx + 1] = static_cast<unsigned char>((y * 255) / height);
+            pixels[idx + 2] = 128;
+            if (channels == 4) {
+                pixels[idx + 3] = 255;
+            }
+        }
+    }
+}
+
+DiffusionPipeline* AIEngine::getDiffusionPipeline() {
+    std::lock_guard<std::mutex> lock(m_pipelineMutex);
+    if (!m_initialized) {
+        return nullptr;
+    }
+    if (m_pipeline) {
+        return m_pipeline.get();
+    }
+
+    m_pipeline = std::make_unique<DiffusionPipeline>(
+        [this](DiffusionJob& job, void* stream) {
+            job.model = m_models.find(job.modelId);
+            if (!job.model) {
+                job.result.errorMessage = "Model not found";
+                return false;
+            }
+            // Held until the job is delivered, so the UNet never waits on a page-in
+            job.deviceId = m_deviceId;
+            job.leases = acquireModel(*job.model, job.config.useVRAMOffload,
+                                      job.result.errorMessage, &job.deviceId);
+            if (job.leases.empty()) {
+                LOG_ERROR("AIEngine", job.result.errorMessage);
+                return false;
+            }
+            encodePrompt(*job.model, job.prompt, job.config, job.deviceId, stream, job.embeddings);
+            return true;
+        },
+        [this](DiffusionJob& job, void* stream) {
+            t_jobProgress = job.callbacks.progress ? &job.callbacks.progress : nullptr;
+            bool ok = denoiseLatents(job.modelId, job.config, job.deviceId, stream, job.embeddings,
+                                     [&job] { return job.cancelled.load(); },
+                                     job.latents, job.result.errorMessage);
+            t_jobProgress = nullptr;
+            std::vector<uint16_t>().swap(job.embeddings);
+            return ok;
+        },
+        [this](DiffusionJob& job, void* stream) {
+            // In production: decoded into the stage's pinned staging block
+            // so the D2H copy runs at full bandwidth
+            const int width = job.config.width;
+            const int height = job.config.height;
+            job.image.resize(static_cast<size_t>(width) * height * 3);
+            decodeLatents(job.latents, job.config,
+                          TensorView(job.image.data(), DataType::UINT8, {height, width, 3}),
+                          nullptr, 0, job.deviceId, stream);
+            std::vector<uint16_t>().swap(job.latents);
+
+            // Time in the pipeline, queueing between the stages included
+            job.result.inferenceTime = std::chrono::duration<float, std::milli>(
+                std::chrono::steady_clock::now() - job.submitTime).count();
+            const std::string resultKey = m_resultCache && m_resultCache->isEnabled() ?
+                makeResultCacheKey(*job.model, job.prompt, job.config) : std::string();
+            if (!resultKey.empty()) {
+                CachedImage cached;
+                cached.width = width;
+                cached.height = height;
+                cached.channels = 3;
+                cached.pixels = job.image;
+                m_resultCache->store(resultKey, cached);
+            }
+
+            job.result.imageData = std::move(job.image);
+            job.result.imageWidth = width;
+            job.result.imageHeight = height;
+            job.result.imageChannels = 3;
+            job.result.memoryUsed = job.model->memoryUsageMB();
+            return true;
+        });
+    m_pipeline->start(m_pipelineConfig);
+    return m_pipeline.get();
+}
+
+uint64_t AIEngine::submitPipelinedGeneration(const std::string& modelId,
+                                            const std::string& prompt,
+                                            const InferenceConfig& config,
+                                            ImageJobCallbacks callbacks) {
+    const uint64_t jobId = m_nextJobId++;
+    auto fail = [&callbacks](const std::string& message) {
+        LOG_ERROR("AIEngine", message);
+        InferenceResult result;
+        result.success = false;
+        result.errorMessage = message;
+        if (callbacks.finished) {
+            callbacks.finished(std::move(result));
+        }
+    };
+
+    if (config.width <= 0 || config.height <= 0 || config.width % 8 != 0 || config.height % 8 != 0) {
+        fail("Image size must be a positive multiple of 8, got " +
+             std::to_string(config.width) + "x" + std::to_string(config.height));
+        return jobId;
+    }
+    DiffusionPipeline* pipeline = getDiffusionPipeline();
+    if (!pipeline) {
+        fail("Engine not initialized");
+        return jobId;
+    }
+
+    // Repeats of seeded requests skip the pipeline
+    ModelHandle model = m_models.find(modelId);
+    const std::string resultKey = model && m_resultCache && m_resultCache->isEnabled() ?
+        makeResultCacheKey(*model, prompt, config) : std::string();
+    CachedImage cached;
+    if (!resultKey.empty() && m_resultCache->load(resultKey, cached) &&
+        cached.width == config.width && cached.height == config.height && cached.channels == 3) {
+        InferenceResult result;
+        result.success = true;
+        result.imageWidth = cached.width;
+        result.imageHeight = cached.height;
+        result.imageChannels = cached.channels;
+        result.imageData = std::move(cached.pixels);
+        if (callbacks.finished) {
+            callbacks.finished(std::move(result));
+        }
+        return jobId;
+    }
+    model.reset();
+    prefetchModel(modelId, routeRequest(modelId));
+
+    auto job = std::make_unique<DiffusionJob>();
+    job->jobId = jobId;
+    job->modelId = modelId;
+    job->prompt = prompt;
+    job->config = config;
+    job->callbacks = std::move(callbacks);
+    pipeline->submit(std::move(job));
+    return jobId;
+}
+
+std::vector<InferenceResult> AIEngine::generateImages(const std::string& modelId,
+                                                      const std::vector<std::string>& prompts,
+                                                      const InferenceConfig& config) {
+    std::vector<std::future<InferenceResult>> futures;
+    futures.reserve(prompts.size());
+    for (const std::string& prompt : prompts) {
+        auto promise = std::make_shared<std::promise<InferenceResult>>();
+        futures.push_back(promise->get_future());
+
+        ImageJobCallbacks callbacks;
+        callbacks.finished = [promise](InferenceResult&& result) {
+            promise->set_value(std::move(result));
+        };
+        submitPipelinedGeneration(modelId, prompt, config, std::move(callbacks));
+    }
+
+    std::vector<InferenceResult> results;
+    results.reserve(futures.size());
+    for (auto& future : futures) {
+        results.push_back(future.get());
+    }
+    return results;
+}
+
+void AIEngine::setDiffusionPipelineConfig(const DiffusionPipelineConfig& config) {
+    std::lock_guard<std::mutex> lock(m_pipelineMutex);
+    m_pipelineConfig = config;
+    if (m_pipeline) {
+        m_pipeline->setConfig(config);
+    }
+}
+
+DiffusionPipelineStats AIEngine::getDiffusionPipelineStats() const {
+    std::lock_guard<std::mutex> lock(m_pipelineMutex);
+    return m_pipeline ? m_pipeline->getStats() : DiffusionPipelineStats();
+}
+
+InferenceResult AIEngine::upscaleImage(const std::string& modelId,
+                                      const std::vector<unsigned char>& inputImage,
+                                      int width, int height, int scaleFactor) {
+    if (width <= 0 || height <= 0 || scaleFactor < 1) {
+        InferenceResult result;
+        result.success = false;
+        result.errorMessage = "Invalid upscale of " + std::to_string(width) + "x" +
+                              std::to_string(height) + " by " + std::to_string(scaleFactor) + "x";
+        LOG_ERROR("AIEngine", result.errorMessage);
+        return result;
+    }
+    if (inputImage.size() < static_cast<size_t>(width) * height * 3) {
+        InferenceResult result;
+        result.success = false;
+        result.errorMessage = "Input image smaller than " + std::to_string(width) + "x" +
+                              std::to_string(height) + " RGB";
+        LOG_ERROR("AIEngine", result.errorMessage);
+        return result;
+    }
+
+    std::vector<unsigned char> imageData(
+        static_cast<size_t>(width) * scaleFactor * height * scaleFactor * 3);
+    ConstTensorView input(inputImage.data(), DataType::UINT8, {height, width, 3});
+    TensorView output(imageData.data(), DataType::UINT8,
+                      {static_cast<int64_t>(height) * scaleFactor,
+                       static_cast<int64_t>(width) * scaleFactor, 3});
+
+    InferenceResult result = upscaleImage(modelId, input, scaleFactor, output);
+    if (result.success) {
+        result.imageData = std::move(imageData);
+    }
+    return result;
+}
+
+InferenceResult AIEngine::upscaleImage(const std::string& modelId,
+                                      const ConstTensorView& inputImage,
+                                      int scaleFactor,
+                                      const TensorView& outputImage) {
+    InferenceResult result;
+    result.success = false;
+
+    if (inputImage.shape.ndim != 3 || inputImage.dtype != DataType::UINT8) {
+        result.errorMessage = "Input image must be a uint8 HWC tensor";
+        LOG_ERROR("AIEngine", result.errorMessage);
+        return result;
+    }
+
+    const int height = static_cast<int>(inputImage.shape.dims[0]);
+    const int width = static_cast<int>(inputImage.shape.dims[1]);
+    const int channels = static_cast<int>(inputImage.shape.dims[2]);
+    if (width <= 0 || height <= 0 || channels <= 0 || scaleFactor < 1) {
+        result.errorMessage = "Invalid upscale of " + std::to_string(width) + "x" +
+                              std::to_string(height) + " by " + std::to_string(scaleFactor) + "x";
+        LOG_ERROR("AIEngine", result.errorMessage);
+        return result;
+    }
+
+    LOG_INFO("AIEngine", "Upscaling image: " + std::to_string(width) + "x" +
+             std::to_string(height) + " by " + std::to_string(scaleFactor) + "x");
+
+    ModelHandle model = m_models.find(modelId);
+    if (!model) {
+        result.errorMessage = "Model not found";
+        return result;
+    }
+
+    size_t outputElements = static_cast<size_t>(width) * scaleFactor *
+                            height * scaleFactor * channels;
+    if (!outputImage.isValid() || outputImage.dtype != DataType::UINT8 ||
+        outputImage.numElements() < outputElements) {
+        result.errorMessage = "Output image buffer too small: need " +
+                              std::to_string(outputElements) + " uint8 elements";
+        LOG_ERROR("AIEngine", result.errorMessage);
+        return result;
+    }
+
+    std::vector<ResidencyLease> leases = acquireModel(*model, false, result.errorMessage);
+    if (leases.empty()) {
+        LOG_ERROR("AIEngine", result.errorMessage);
+        return result;
+    }
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    // In production: Run super-resolution model, with imageToTensor feeding
+    // its input and tensorToImage writing its output. A DEVICE input (for
+    // example the output view of generateImage) is consumed in place, so
+    // generation and upscaling chain without a host round trip.
+    std::this_thread::sleep_for(std::chrono::milliseconds(100 + (rand() % 200)));
+
+    // Lanczos resize stands in for the model's output. Device buffers are
+    // host allocations here, so the stand-in reads them through host views.
+    ConstTensorView source(inputImage.data, DataType::UINT8, inputImage.shape);
+    TensorView upscaled(outputImage.data, DataType::UINT8,
+                        {static_cast<int64_t>(height) * scaleFactor,
+                         static_cast<int64_t>(width) * scaleFactor, channels});
+    if (!resizeImage(source, upscaled, ResizeFilter::LANCZOS3)) {
+        result.errorMessage = "Failed to resize image";
+        return result;
+    }
+
+    auto endTime = std::chrono::high_resolution_clock::now();
     result.inferenceTime = std::chrono::duration<float, std::milli>(
         endTime - startTime).count();
 
     // Output upscaled image
     result.imageWidth = width * scaleFactor;
     result.imageHeight = height * scaleFactor;
-    result.imageChannels = 3;
-    result.imageData.resize(result.imageWidth * result.imageHeight * 3);
+    result.imageChannels = channels;
 
     result.success = true;
-    result.memoryUsed = it->second->info.memoryUsage;
+    result.memoryUsed = model->memoryUsageMB();
 
-    LOG_INFO("AIEngine", "Image upscaled in " +
-             std::to_string(result.inferenceTime) + " ms");
+    LOG_INFOF("AIEngine", "Image upscaled in %f ms", result.inferenceTime);
 
     return result;
 }
 
+InferenceResult AIEngine::upscaleImageTiled(const std::string& modelId,
+                                           const ConstTensorView& inputImage,
+                                           int scaleFactor,
+                                           ImageRowSink& sink,
+                                           const TileConfig& tiling) {
+    InferenceResult result;
+    result.success = false;
+
+    if (!inputImage.data || inputImage.shape.ndim != 3 || inputImage.dtype != DataType::UINT8 ||
+        inputImage.shape.dims[2] < 1 || inputImage.shape.dims[2] > 4 || scaleFactor < 1) {
+        result.errorMessage = "Input image must be a uint8 HWC tensor with 1-4 channels";
+        LOG_ERROR("AIEngine", result.errorMessage);
+        return result;
+    }
+
+    const int height = static_cast<int>(inputImage.shape.dims[0]);
+    const int width = static_cast<int>(inputImage.shape.dims[1]);
+    const int channels = static_cast<int>(inputImage.shape.dims[2]);
+
+    TileGrid grid;
+    if (!grid.build(width, height, tiling)) {
+        result.errorMessage = "Invalid tile configuration";
+        return result;
+    }
+
+    ModelHandle model = m_models.find(modelId);
+    if (!model) {
+        result.errorMessage = "Model not found";
+        return result;
+    }
+
+    // Held for the whole image so the model stays resident between tiles
+    int deviceId = m_deviceId;
+    std::vector<ResidencyLease> leases = acquireModel(*model, false, result.errorMessage, &deviceId);
+    if (leases.empty()) {
+        LOG_ERROR("AIEngine", result.errorMessage);
+        return result;
+    }
+
+    LOG_INFO("AIEngine", "Tiled upscale: " + std::to_string(width) + "x" +
+             std::to_string(height) + " by " + std::to_string(scaleFactor) + "x in " +
+             std::to_string(grid.count()) + " tiles");
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    TileBlender blender;
+    if (!blender.begin(grid, scaleFactor, channels, sink)) {
+        result.errorMessage = "Image sink rejected the output";
+        LOG_ERROR("AIEngine", result.errorMessage);
+        return result;
+    }
+
+    // On a worker, waiting for jobs of its own pool could deadlock it, so
+    // the tiles run inline on this worker's stream instead
+    WorkerPool* pool = t_workerStream ? nullptr : getWorkerPool(deviceId);
+    const size_t maxInFlight = tiling.maxInFlight > 0 ? static_cast<size_t>(tiling.maxInFlight) :
+                               2 * static_cast<size_t>(std::max(1u, m_workerPoolConfig.numThreads));
+
+    struct TileJob {
+        uint64_t jobId = 0;
+        int row = 0;
+        int column = 0;
+        std::shared_ptr<std::vector<unsigned char>> pixels;
+        std::future<bool> done;
+    };
+    std::deque<TileJob> inFlight;
+    int nextTile = 0;
+    bool ok = true;
+
+    while (ok && (nextTile < grid.count() || !inFlight.empty())) {
+        // Keep every worker's stream busy, but never hold more than
+        // maxInFlight tile outputs
+        while (nextTile < grid.count() && inFlight.size() < maxInFlight) {
+            TileJob job;
+            job.row = nextTile / grid.columns();
+            job.column = nextTile % grid.columns();
+            const TileRect rect = grid.tile(job.row, job.column);
+            job.pixels = std::make_shared<std::vector<unsigned char>>(
+                static_cast<size_t>(rect.width) * scaleFactor * rect.height * scaleFactor * channels);
+            auto promise = std::make_shared<std::promise<bool>>();
+            job.done = promise->get_future();
+
+            // The input view is captured by value; the caller's buffer
+            // outlives every job because all of them finish before we return
+            auto run = [this, inputImage, rect, scaleFactor, deviceId,
+                        pixels = job.pixels, promise] {
+                bool tileOk = false;
+                try {
+                    tileOk = upscaleTile(inputImage, rect, scaleFactor, *pixels, deviceId);
+                } catch (const std::exception& e) {
+                    LOG_ERROR("AIEngine", std::string("Tile upscale failed: ") + e.what());
+                }
+                promise->set_value(tileOk);
+            };
+
+            if (!pool) {
+                run();
+            } else {
+                job.jobId = m_nextJobId++;
+                if (!pool->submit(job.jobId, JobPriority::NORMAL, run,
+                                  [promise] { promise->set_value(false); })) {
+                    result.errorMessage = "Inference queue full";
+                    ok = false;
+                    break;
+                }
+            }
+            inFlight.push_back(std::move(job));
+            nextTile++;
+        }
+        if (!ok || inFlight.empty()) {
+            break;
+        }
+
+        TileJob& job = inFlight.front();
+        if (!job.done.get()) {
+            result.errorMessage = "Tile " + std::to_string(job.row) + "," +
+                                  std::to_string(job.column) + " failed";
+            ok = false;
+        } else if (!blender.addTile(job.row, job.column, job.pixels->data())) {
+            result.errorMessage = "Image sink failed";
+            ok = false;
+        }
+        inFlight.pop_front();
+    }
+
+    // Queued tiles still read the caller's input: cancel or wait for them
+    for (TileJob& job : inFlight) {
+        if (pool) {
+            pool->cancel(job.jobId);
+        }
+        job.done.wait();
+    }
+
+    if (ok && !blender.finish()) {
+        result.errorMessage = "Image sink failed to finish";
+        ok = false;
+    }
+    if (!ok) {
+        LOG_ERROR("AIEngine", "Tiled upscale failed: " + result.errorMessage);
+        return result;
+    }
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+    result.inferenceTime = std::chrono::duration<float, std::milli>(
+        endTime - startTime).count();
+
+    result.imageWidth = width * scaleFactor;
+    result.imageHeight = height * scaleFactor;
+    result.imageChannels = channels;
+    result.success = true;
+    result.memoryUsed = model->memoryUsageMB();
+
+    LOG_INFOF("AIEngine", "Tiled upscale finished in %f ms", result.inferenceTime);
+
+    return result;
+}
+
+bool AIEngine::upscaleTile(const ConstTensorView& inputImage, const TileRect& rect,
+                           int scaleFactor, std::vector<unsigned char>& output, int deviceId) {
+    const int channels = static_cast<int>(inputImage.shape.dims[2]);
+    const size_t imageRowBytes = static_cast<size_t>(inputImage.shape.dims[1]) * channels;
+    const size_t tileRowBytes = static_cast<size_t>(rect.width) * channels;
+    void* stream = deviceId == t_workerDevice ? t_workerStream : nullptr;
+
+    // In production: the rows are gathered into the worker's pinned staging
+    // block and sent with cudaMemcpy2DAsync on this worker's stream, then
+    // launchImageToTensor fills the model input. Other workers' tiles are
+    // in inference or download on their own streams meanwhile.
+    std::vector<unsigned char> tile(tileRowBytes * rect.height);
+    {
+        TRACE_GPU_SCOPE("AIEngine", "H2D tile", deviceId, stream);
+        const unsigned char* source = static_cast<const unsigned char*>(inputImage.data) +
+                                      rect.y * imageRowBytes + static_cast<size_t>(rect.x) * channels;
+        for (int y = 0; y < rect.height; y++) {
+            std::memcpy(&tile[y * tileRowBytes], source + y * imageRowBytes, tileRowBytes);
+        }
+    }
+
+    if (WorkerPool::isCurrentJobCancelled()) {
+        return false;
+    }
+
+    // In production: enqueue the super-resolution engine on the stream, then
+    // launchTensorToImage and cudaMemcpyAsync the tile back before a
+    // cudaStreamSynchronize. A Lanczos resize stands in for the model.
+    TRACE_GPU_SCOPE("AIEngine", "upscale tile", deviceId, stream);
+    ConstTensorView tileView(tile.data(), DataType::UINT8, {rect.height, rect.width, channels});
+    TensorView outputView(output.data(), DataType::UINT8,
+                          {static_cast<int64_t>(rect.height) * scaleFactor,
+                           static_cast<int64_t>(rect.width) * scaleFactor, channels});
+    return resizeImage(tileView, outputView, ResizeFilter::LANCZOS3);
+}
+
+uint64_t AIEngine::submitTextGeneration(const std::string& modelId,
+                                       const std::string& prompt,
+                                       const InferenceConfig& config,
+                                       TextGenerationCallbacks callbacks) {
+    const uint64_t jobId = m_nextJobId++;
+    std::vector<int32_t> tokens = simulatedTokenize(prompt);
+
+    std::string error;
+    std::shared_ptr<TextGenerator> generator = m_initialized ?
+        getTextGenerator(modelId, error) : nullptr;
+    if (!generator) {
+        if (error.empty()) {
+            error = "Engine not initialized";
+        }
+        LOG_ERROR("AIEngine", error);
+        TextGenerationResult result;
+        result.errorMessage = error;
+        result.promptTokens = static_cast<int>(tokens.size());
+        result.finishReason = FinishReason::FAILED;
+        if (callbacks.finished) {
+            callbacks.finished(std::move(result));
+        }
+        return jobId;
+    }
+
+    SamplingParams params;
+    params.maxTokens = config.maxTokens;
+    params.temperature = config.temperature;
+    params.seed = config.seed;
+    generator->submit(jobId, std::move(tokens), params, std::move(callbacks));
+    return jobId;
+}
+
+void AIEngine::setTextGeneratorConfig(const TextGeneratorConfig& config) {
+    std::lock_guard<std::mutex> lock(m_textGeneratorMutex);
+    m_textGeneratorConfig = config;
+}
+
+TextGenerationStats AIEngine::getTextGenerationStats(const std::string& modelId) const {
+    std::lock_guard<std::mutex> lock(m_textGeneratorMutex);
+    auto it = m_textGenerators.find(modelId);
+    return it != m_textGenerators.end() ? it->second->getStats() : TextGenerationStats();
+}
+
+std::shared_ptr<TextGenerator> AIEngine::getTextGenerator(const std::string& modelId,
+                                                          std::string& error) {
+    std::lock_guard<std::mutex> lock(m_textGeneratorMutex);
+    auto it = m_textGenerators.find(modelId);
+    if (it != m_textGenerators.end()) {
+        return it->second;
+    }
+
+    ModelHandle model = m_models.find(modelId);
+    if (!model) {
+        error = "Model not found: " + modelId;
+        return nullptr;
+    }
+    if (model->getInfo().type != ModelType::TEXT_GENERATION) {
+        error = "Not a text generation model: " + modelId;
+        return nullptr;
+    }
+
+    auto generator = std::make_shared<TextGenerator>(
+        [this, modelId](const std::vector<TextGenerator::StepSlot>& slots,
+                        std::vector<std::vector<float>>& logits, std::string& stepError) {
+            return runTextStep(modelId, slots, logits, stepError);
+        },
+        simulatedDetokenize, SIMULATED_EOS_TOKEN);
+    if (!generator->start(m_textGeneratorConfig, SIMULATED_KV_BYTES_PER_TOKEN)) {
+        error = "Failed to create the KV cache for " + modelId;
+        return nullptr;
+    }
+
+    LOG_INFO("AIEngine", "Text generator started for model: " + modelId);
+    m_textGenerators[modelId] = generator;
+    return generator;
+}
+
+bool AIEngine::runTextStep(const std::string& modelId,
+                           const std::vector<TextGenerator::StepSlot>& slots,
+                           std::vector<std::vector<float>>& logits, std::string& error) {
+    ModelHandle model = m_models.find(modelId);
+    if (!model) {
+        error = "Model not found: " + modelId;
+        return false;
+    }
+
+    // Held for the step only, so the model can be evicted between requests
+    int deviceId = m_deviceId;
+    std::vector<ResidencyLease> leases = acquireModel(*model, false, error, &deviceId);
+    if (leases.empty()) {
+        return false;
+    }
+
+    size_t stepTokens = 0;
+    for (const TextGenerator::StepSlot& slot : slots) {
+        stepTokens += static_cast<size_t>(slot.tokenCount);
+    }
+
+    // In production: one enqueueV3 over all slots, the tokens packed into a
+    // single ragged batch with per-slot positions; paged attention reads and
+    // appends each slot's KV through its block table, and only the last
+    // position of each sampling slot is projected to logits. Decodes are
+    // memory-bound, so the step costs about the same for 1 or 32 sequences.
+    TRACE_GPU_SCOPE("AIEngine", "decode step", deviceId, nullptr);
+    std::this_thread::sleep_for(std::chrono::microseconds(1500 + 20 * stepTokens));
+
+    // Pseudo-random logits stand in for the model's output; end of sequence
+    // grows likelier with length
+    logits.clear();
+    for (const TextGenerator::StepSlot& slot : slots) {
+        if (!slot.sample) {
+            continue;
+        }
+        const int position = slot.position + slot.tokenCount;
+        std::mt19937 rng(static_cast<unsigned int>(
+            slot.sequenceId * 7919u + slot.tokens[slot.tokenCount - 1] * 31u + position));
+        std::normal_distribution<float> noise(0.0f, 2.0f);
+        std::vector<float> row(SIMULATED_VOCABULARY_SIZE);
+        for (float& logit : row) {
+            logit = noise(rng);
+        }
+        row[SIMULATED_EOS_TOKEN] = -6.0f + 0.02f * position;
+        logits.push_back(std::move(row));
+    }
+    return true;
+}
+
 size_t AIEngine::getVRAMUsage() const {
-    size_t totalUsage = 0;
-    for (const auto& pair : m_models) {
-        totalUsage += pair.second->info.memoryUsage;
+    // Offloaded and evicted models hold no VRAM
+    if (!m_residency) {
+        return 0;
     }
-    return totalUsage;
+    return m_residency->getStats().residentMB;
 }
 
 void AIEngine::setProgressCallback(std::function<void(float)> callback) {
     m_progressCallback = callback;
 }
 
-void* AIEngine::allocateCudaMemory(size_t size) {
+void AIEngine::reportProgress(float progress) const {
+    if (m_progressCallback) {
+        m_progressCallback(progress);
+    }
+    if (t_jobProgress) {
+        (*t_jobProgress)(progress);
+    }
+}
+
+void* AIEngine::allocateCudaMemory(size_t size, int deviceId) {
+    if (deviceId < 0) {
+        deviceId = t_workerDevice >= 0 ? t_workerDevice : m_deviceId;
+    }
+
+    auto it = m_deviceAllocators.find(deviceId);
+    if (it != m_deviceAllocators.end()) {
+        // A worker's stream belongs to its own device
+        void* stream = deviceId == t_workerDevice ? t_workerStream : nullptr;
+        return it->second->allocate(size, stream);
+    }
+
     // In production: cudaMalloc(&ptr, size);
     return malloc(size); // Fallback to CPU memory for template
 }
 
 void AIEngine::freeCudaMemory(void* ptr) {
+    for (auto& pair : m_deviceAllocators) {
+        if (pair.second->free(ptr)) {
+            return;
+        }
+    }
+
     // In production: cudaFree(ptr);
     free(ptr);
 }
 
+void* AIEngine::allocateHostMemory(size_t size, int deviceId) {
+    int node = -1;
+    if (m_numaConfig.localHostMemory) {
+        std::lock_guard<std::mutex> lock(m_deviceMutex);
+        auto it = m_devices.find(deviceId);
+        if (it != m_devices.end()) {
+            node = it->second.numaNode;
+        }
+    }
+
+    // In production, on a known node:
+    //   ptr = numa_alloc_onnode(size, node);
+    //   cudaHostRegister(ptr, size, cudaHostRegisterPortable);
+    // otherwise cudaHostAlloc(&ptr, size, cudaHostAllocPortable), which
+    // places the pages wherever the calling thread first touches them
+    (void)node;
+    return malloc(size);
+}
+
+void AIEngine::freeHostMemory(void* ptr, size_t size) {
+    // In production: cudaHostUnregister(ptr) + numa_free(ptr, size) for
+    // node-local memory, cudaFreeHost(ptr) otherwise
+    (void)size;
+    free(ptr);
+}
+
+void AIEngine::setCudaGraphConfig(const CudaGraphConfig& config) {
+    m_cudaGraphConfig = config;
+    if (m_graphCache) {
+        m_graphCache->setConfig(config);
+    }
+}
+
+CudaGraphStats AIEngine::getCudaGraphStats() const {
+    CudaGraphStats stats;
+    if (m_graphCache) {
+        stats = m_graphCache->getStats();
+    }
+    stats.eagerSteps = m_eagerSteps;
+    return stats;
+}
+
+void AIEngine::setDeviceAllocatorConfig(const DeviceAllocatorConfig& config) {
+    m_deviceAllocatorConfig = config;
+    for (auto& pair : m_deviceAllocators) {
+        pair.second->setConfig(config);
+    }
+}
+
+DeviceAllocatorStats AIEngine::getDeviceAllocatorStats(int deviceId) const {
+    auto it = m_deviceAllocators.find(deviceId);
+    if (it == m_deviceAllocators.end()) {
+        return DeviceAllocatorStats();
+    }
+    return it->second->getStats();
+}
+
+void AIEngine::trimDeviceMemory() {
+    for (auto& pair : m_deviceAllocators) {
+        pair.second->trim();
+    }
+}
+
 } // namespace AIForge
@@ -10,7 +10,15 @@
  * - Multi-model management (Text-to-Image, LLM, Diffusion models)
  * - TensorRT optimization and engine serialization
  * - CUDA stream management for async inference
+ * - CUDA graph replay of fixed-shape diffusion steps
+ * - Prompt embedding and seeded-result caches that skip repeated work
  * - Dynamic batching and memory management
+ * - Staged diffusion pipeline overlapping text encoding, denoising and VAE decode
+ * - Multi-GPU model placement and least-loaded request routing
+ * - NUMA-local worker threads and host staging memory
+ * - Zero-copy image output into renderer memory shared with CUDA
+ * - Tiled upscaling of images of any size into streaming row sinks
+ * - Token-streaming LLM generation with continuous batching
  * - Support for .safetensors and .gguf formats
  * - FP16/INT8 quantization support
  */
@@ -24,6 +32,16 @@
 #include <functional>
 #include <map>
 #include <future>
+#include <atomic>
+#include <mutex>
+#include <cstdint>
+#include "worker_pool.h"
+#include "tensor.h"
+#include "hardware_monitor.h"
+#include "gpu_interop.h"
+#include "model_registry.h"
+#include "text_generator.h"
+#include "tile_blender.h"
 
 namespace AIForge {
 
@@ -63,6 +81,17 @@ enum class PrecisionMode {
     AUTO                // Automatic selection based on hardware
 };
 
+/**
+ * @enum ModelPlacement
+ * @brief How a model is spread over the engine's GPUs
+ */
+enum class ModelPlacement {
+    AUTO,               // Replicate if it fits every device, otherwise shard
+    SINGLE_DEVICE,      // One copy on the device with the most free budget
+    REPLICATE,          // A full copy per device; requests go to the least loaded
+    SHARD               // Layers split across all devices, run as a pipeline
+};
+
 /**
  * @struct ModelInfo
  * @brief Metadata for loaded AI models
@@ -78,6 +107,9 @@ struct ModelInfo {
     std::vector<int> outputShape;
     bool isLoaded;
     bool isOptimized;           // TensorRT optimized
+    bool isResident;            // Weights currently held in VRAM
+    ModelPlacement placement;   // Resolved placement (never AUTO)
+    std::vector<int> devices;   // Devices holding a replica or shard
 };
 
 /**
@@ -91,9 +123,12 @@ struct InferenceConfig {
     int maxTokens = 512;        // For text generation
     float temperature = 1.0f;   // For sampling
     int numInferenceSteps = 50; // For diffusion models
+    int width = 512;            // Generated image size (multiple of 8)
+    int height = 512;
     float guidanceScale = 7.5f; // For guided diffusion
     unsigned int seed = 0;      // Random seed (0 = random)
     bool useVRAMOffload = false; // Offload to system RAM if needed
+    JobPriority priority = JobPriority::NORMAL; // Queue priority for async requests
 };
 
 /**
@@ -112,6 +147,264 @@ struct InferenceResult {
     size_t memoryUsed = 0;              // Peak VRAM used in MB
 };
 
+/**
+ * @struct EngineCacheConfig
+ * @brief Configuration for the persistent TensorRT engine cache
+ */
+struct EngineCacheConfig {
+    bool enabled = true;
+    std::string directory = "engine_cache";
+    size_t maxSizeMB = 20480;       // Evict least-recently-used engines beyond this
+    PrecisionMode loadPrecision = PrecisionMode::FP16; // Engine loadModel looks for
+};
+
+/**
+ * @struct EngineCacheStats
+ * @brief Engine cache counters
+ */
+struct EngineCacheStats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t stores = 0;
+    size_t evictions = 0;
+    size_t entries = 0;
+    size_t sizeBytes = 0;
+};
+
+/**
+ * @enum ResidencyState
+ * @brief Where a model's weights currently live
+ */
+enum class ResidencyState {
+    RESIDENT,           // In VRAM, ready to run
+    OFFLOADED,          // In pinned host memory
+    EVICTED             // Only in the source file
+};
+
+/**
+ * @struct ResidencyConfig
+ * @brief Configuration for VRAM-budgeted model residency
+ */
+struct ResidencyConfig {
+    size_t vramBudgetMB = 0;            // Per device, for model weights (0 = 90% of VRAM)
+    size_t hostOffloadBudgetMB = 16384; // Pinned host memory for offloaded models
+    bool prefetch = true;               // Bring models in when requests are queued
+};
+
+/**
+ * @struct ResidencyStats
+ * @brief Model residency counters
+ */
+struct ResidencyStats {
+    size_t residentModels = 0;
+    size_t offloadedModels = 0;
+    size_t evictedModels = 0;
+    size_t residentMB = 0;
+    size_t offloadedMB = 0;
+    size_t budgetMB = 0;                // Sum over devices
+    size_t loads = 0;                   // Made resident from the source file
+    size_t hostReloads = 0;             // Made resident from pinned host memory
+    size_t offloads = 0;
+    size_t evictions = 0;               // Dropped without a host copy
+    size_t prefetches = 0;
+};
+
+/**
+ * @struct DeviceAllocatorConfig
+ * @brief Configuration for the caching device memory allocator
+ */
+struct DeviceAllocatorConfig {
+    bool enabled = true;            // false = every allocation goes to the driver
+    size_t maxCachedMB = 4096;      // Release freed blocks beyond this
+};
+
+/**
+ * @struct DeviceAllocatorStats
+ * @brief Caching allocator counters for one device
+ */
+struct DeviceAllocatorStats {
+    size_t reservedBytes = 0;       // Held from the driver (in use + cached)
+    size_t peakReservedBytes = 0;
+    size_t allocatedBytes = 0;      // Blocks handed out (rounded sizes)
+    size_t requestedBytes = 0;      // Bytes callers asked for
+    size_t cachedBytes = 0;         // Freed blocks kept for reuse
+    size_t allocations = 0;
+    size_t cacheHits = 0;
+    size_t deviceAllocations = 0;   // cudaMalloc calls
+    size_t deviceFrees = 0;         // cudaFree calls
+    size_t failedAllocations = 0;
+    size_t trims = 0;
+    float cacheHitRate = 0.0f;
+    float fragmentation = 0.0f;     // 1 - requested / reserved
+};
+
+/**
+ * @struct DeviceStatus
+ * @brief Load of one engine device as seen by the request router
+ */
+struct DeviceStatus {
+    int deviceId = 0;
+    float gpuUtilization = 0.0f;    // Last HardwareMonitor sample (0-100)
+    size_t memoryUsedMB = 0;        // Last sample, all processes
+    size_t memoryTotalMB = 0;
+    size_t residentMB = 0;          // Model weights resident on this device
+    size_t budgetMB = 0;            // Model weight budget
+    size_t outstandingJobs = 0;     // Queued plus running requests
+    size_t routedRequests = 0;      // Requests (or batches) routed here since initialize
+    uint32_t throttleReasons = 0;   // GPUThrottleReason bits from the last event
+    bool memoryPressure = false;
+    size_t xidErrors = 0;
+    int numaNode = -1;              // Host node closest to the device (-1 = unknown)
+};
+
+/**
+ * @struct NUMAPlacementConfig
+ * @brief Placement of host threads and memory relative to each GPU
+ *
+ * On multi-socket hosts a GPU sits behind one socket's PCIe root; staging
+ * buffers and workers on the other socket pay a cross-socket hop on every
+ * copy. Requires device topology from setDeviceTopology.
+ */
+struct NUMAPlacementConfig {
+    bool pinWorkers = true;         // Bind each device's workers to the CPUs of its node
+    bool localHostMemory = true;    // Allocate offloaded weights on the device's node
+};
+
+/**
+ * @struct CudaGraphConfig
+ * @brief Configuration for CUDA graph capture of diffusion steps
+ */
+struct CudaGraphConfig {
+    bool enabled = true;            // Capture one step per shape and replay it
+    size_t maxGraphs = 16;          // Each graph pins its step workspace
+};
+
+/**
+ * @struct CudaGraphStats
+ * @brief CUDA graph cache counters
+ */
+struct CudaGraphStats {
+    size_t captures = 0;
+    size_t hits = 0;                // Requests that reused a captured graph
+    size_t replays = 0;             // Steps run as a single graph launch
+    size_t eagerSteps = 0;          // Steps launched kernel by kernel
+    size_t captureFailures = 0;
+    size_t invalidations = 0;       // Dropped because the model's weights moved
+    size_t evictions = 0;
+    size_t cachedGraphs = 0;
+    size_t workspaceBytes = 0;      // Device memory held by cached graphs
+};
+
+/**
+ * @struct GenerationCacheConfig
+ * @brief Configuration for the text embedding and generated image caches
+ */
+struct GenerationCacheConfig {
+    size_t embeddingCacheMB = 256;      // VRAM for text encoder outputs (0 = disabled)
+    bool resultCacheEnabled = false;    // Persist images of seeded requests
+    std::string resultCacheDirectory = "result_cache";
+    size_t resultCacheMaxMB = 4096;     // Evict least-recently-used images beyond this
+};
+
+/**
+ * @struct GenerationCacheStats
+ * @brief Embedding and image cache counters
+ */
+struct GenerationCacheStats {
+    size_t embeddingHits = 0;           // Text encoder passes skipped
+    size_t embeddingMisses = 0;
+    size_t embeddingEvictions = 0;
+    size_t embeddingEntries = 0;
+    size_t embeddingBytes = 0;          // VRAM held by cached embeddings
+    size_t resultHits = 0;              // Generations answered from disk
+    size_t resultMisses = 0;
+    size_t resultStores = 0;
+    size_t resultEvictions = 0;
+};
+
+/**
+ * @struct InferenceTicket
+ * @brief Handle for a submitted asynchronous inference request
+ */
+struct InferenceTicket {
+    uint64_t jobId = 0;                     // Pass to AIEngine::cancelInference
+    std::future<InferenceResult> result;
+};
+
+/**
+ * @struct ImageJobCallbacks
+ * @brief Notifications for one AIEngine::submitImageGeneration request
+ *
+ * Both run on the inference worker (or on the submitting thread when the
+ * request is rejected), so callers hand off to their own thread.
+ */
+struct ImageJobCallbacks {
+    std::function<void(float)> progress;                // Fraction of denoising steps done
+    std::function<void(InferenceResult&&)> finished;   // Exactly once, also on cancel or rejection
+};
+
+/**
+ * @struct BatchingConfig
+ * @brief Configuration for dynamic request batching
+ */
+struct BatchingConfig {
+    bool enabled = false;
+    int maxBatchSize = 8;           // Flush a model queue once this many requests wait
+    unsigned int maxWaitMs = 5;     // Batching window measured from the oldest request
+};
+
+/**
+ * @struct BatchingStats
+ * @brief Counters describing batching efficiency
+ */
+struct BatchingStats {
+    size_t requestsSubmitted = 0;
+    size_t batchesExecuted = 0;
+    size_t requestsExecuted = 0;
+    size_t largestBatch = 0;
+    float averageBatchSize = 0.0f;
+    float averageQueueTime = 0.0f;  // In milliseconds
+};
+
+/**
+ * @struct DiffusionPipelineConfig
+ * @brief Queue limits of the staged diffusion pipeline
+ */
+struct DiffusionPipelineConfig {
+    int queueDepth = 2;             // Jobs buffered between two stages
+    int maxQueuedJobs = 64;         // Jobs waiting for the text encoder
+};
+
+/**
+ * @struct PipelineStageStats
+ * @brief Counters of one diffusion pipeline stage
+ */
+struct PipelineStageStats {
+    size_t jobs = 0;
+    float busyTime = 0.0f;          // In milliseconds, running jobs
+    float idleTime = 0.0f;          // Waiting for input: a bubble on this stage's stream
+    float blockedTime = 0.0f;       // Waiting for room in the next stage's queue
+    float averageTime = 0.0f;       // Milliseconds per job
+    float utilization = 0.0f;       // Busy fraction since the pipeline started
+    size_t queueDepth = 0;          // Jobs waiting for this stage now
+    size_t maxQueueDepth = 0;
+};
+
+/**
+ * @struct DiffusionPipelineStats
+ * @brief Counters of the staged diffusion pipeline
+ */
+struct DiffusionPipelineStats {
+    PipelineStageStats encode;      // Tokenizer and text encoder
+    PipelineStageStats denoise;     // UNet steps
+    PipelineStageStats decode;      // VAE decode and D2H copy
+    size_t submitted = 0;
+    size_t completed = 0;
+    size_t failed = 0;              // Including cancelled
+    float imagesPerSecond = 0.0f;   // Completed per second since the pipeline started
+    float averageLatency = 0.0f;    // Milliseconds from submission to delivery
+};
+
 /**
  * @class AIEngine
  * @brief Main AI inference engine class
@@ -137,6 +430,19 @@ public:
      */
     bool initialize(int deviceId = 0);
 
+    /**
+     * @brief Initialize CUDA and TensorRT on several GPUs
+     *
+     * Every device gets its own worker pool, caching allocator and VRAM
+     * budget. The first device is the primary one: engines are built for
+     * its architecture, and devices of a different compute capability are
+     * skipped.
+     *
+     * @param deviceIds GPU device IDs to use
+     * @return true if at least one device was initialized
+     */
+    bool initialize(const std::vector<int>& deviceIds);
+
     /**
      * @brief Shutdown and cleanup resources
      */
@@ -147,10 +453,25 @@ public:
      * @param filepath Path to model file
      * @param name Display name for the model
      * @param type Type of model (auto-detected if UNKNOWN)
+     * @param placement How to spread the model over the engine's devices
      * @return Model ID if successful, empty string otherwise
      */
     std::string loadModel(const std::string& filepath, const std::string& name,
-                          ModelType type = ModelType::UNKNOWN);
+                          ModelType type = ModelType::UNKNOWN,
+                          ModelPlacement placement = ModelPlacement::AUTO);
+
+    /**
+     * @brief Page a model's weights to the GPU now instead of on first use
+     *
+     * SafeTensors and GGUF models are memory-mapped by loadModel and only
+     * their tensor index is read. Weights are uploaded layer by layer on the
+     * first inference; call this to take that cost up front. Other idle
+     * models may be evicted to stay within the VRAM budget.
+     *
+     * @param modelId ID of model
+     * @return true if all weights are resident (or the model has none to page)
+     */
+    bool uploadModelWeights(const std::string& modelId);
 
     /**
      * @brief Unload a model from memory
@@ -161,12 +482,47 @@ public:
 
     /**
      * @brief Optimize model with TensorRT
+     *
+     * Reuses a cached engine for the same model content, precision, GPU
+     * architecture and TensorRT version when one exists; otherwise builds
+     * the engine and adds it to the cache.
+     *
      * @param modelId ID of model to optimize
      * @param precision Target precision mode
      * @return true if optimization successful
      */
     bool optimizeModel(const std::string& modelId, PrecisionMode precision);
 
+    /**
+     * @brief Configure the persistent engine cache
+     * @param config Cache configuration (applied immediately if initialized)
+     */
+    void setEngineCacheConfig(const EngineCacheConfig& config);
+
+    /**
+     * @brief Get engine cache statistics
+     * @return EngineCacheStats structure
+     */
+    EngineCacheStats getEngineCacheStats() const;
+
+    /**
+     * @brief Configure model residency
+     *
+     * Loaded models share a per-device VRAM budget. Using a model that is
+     * not resident first evicts least-recently-used idle models: to pinned
+     * host memory if their last request set useVRAMOffload, otherwise back
+     * to their source file. Evicted models reload transparently.
+     *
+     * @param config Residency configuration (applied immediately if initialized)
+     */
+    void setResidencyConfig(const ResidencyConfig& config);
+
+    /**
+     * @brief Get model residency statistics
+     * @return ResidencyStats structure
+     */
+    ResidencyStats getResidencyStats() const;
+
     /**
      * @brief Get information about a loaded model
      * @param modelId ID of model
@@ -180,6 +536,52 @@ public:
      */
     std::vector<ModelInfo> getLoadedModels() const;
 
+    /**
+     * @brief Feed live device load into request routing
+     *
+     * Call with HardwareMonitor samples; devices the engine does not use
+     * are ignored.
+     *
+     * @param gpus Latest per-GPU metrics
+     */
+    void updateDeviceMetrics(const std::vector<GPUMetrics>& gpus);
+
+    /**
+     * @brief React to a GPU health event
+     *
+     * Throttled, memory-starved or faulted devices cost more in request
+     * routing, so work shifts to other replicas, and while any engine device
+     * is throttled or under memory pressure the batching limit is halved.
+     * Safe to call from the HardwareMonitor event callback.
+     *
+     * @param event Event from HardwareMonitor
+     */
+    void handleGPUEvent(const GPUEvent& event);
+
+    /**
+     * @brief Provide the PCIe/NUMA placement of each GPU (before initialize)
+     * @param topology From HardwareMonitor::getGPUTopology
+     */
+    void setDeviceTopology(const std::vector<GPUTopology>& topology) { m_topology = topology; }
+
+    /**
+     * @brief Configure NUMA-aware placement
+     * @param config Placement configuration (takes effect on initialize)
+     */
+    void setNUMAPlacementConfig(const NUMAPlacementConfig& config) { m_numaConfig = config; }
+
+    /**
+     * @brief Get the devices the engine runs on
+     * @return Device IDs, primary first
+     */
+    std::vector<int> getDeviceIds() const { return m_deviceIds; }
+
+    /**
+     * @brief Get per-device load
+     * @return One DeviceStatus per engine device
+     */
+    std::vector<DeviceStatus> getDeviceStatus() const;
+
     /**
      * @brief Run synchronous inference
      * @param config Inference configuration
@@ -189,6 +591,22 @@ public:
     InferenceResult runInference(const InferenceConfig& config,
                                 const std::vector<float>& inputData);
 
+    /**
+     * @brief Run synchronous inference on caller-owned buffers
+     *
+     * Zero-copy variant: input and output may be host, pinned-host or device
+     * memory. The output is written into the caller's buffer and
+     * InferenceResult::outputData stays empty.
+     *
+     * @param config Inference configuration
+     * @param input Input tensor view
+     * @param output Output tensor view (float32, at least the model's output size)
+     * @return InferenceResult with timing and status
+     */
+    InferenceResult runInference(const InferenceConfig& config,
+                                const ConstTensorView& input,
+                                const TensorView& output);
+
     /**
      * @brief Run asynchronous inference
      * @param config Inference configuration
@@ -198,6 +616,142 @@ public:
     std::future<InferenceResult> runInferenceAsync(const InferenceConfig& config,
                                                    const std::vector<float>& inputData);
 
+    /**
+     * @brief Run asynchronous inference, taking ownership of the input
+     * @param config Inference configuration
+     * @param inputData Input tensor data (moved, not copied)
+     * @return Future containing InferenceResult
+     */
+    std::future<InferenceResult> runInferenceAsync(const InferenceConfig& config,
+                                                   std::vector<float>&& inputData);
+
+    /**
+     * @brief Submit asynchronous inference with a cancellation handle
+     *
+     * The request is queued at config.priority on the worker pool of the
+     * least-loaded device holding the model.
+     * If the queue stays full for the pool's submit timeout, the returned
+     * future resolves immediately with an error.
+     *
+     * @param config Inference configuration
+     * @param inputData Input tensor data (moved into the request)
+     * @return Ticket holding the job ID and result future
+     */
+    InferenceTicket submitInference(const InferenceConfig& config,
+                                    std::vector<float> inputData);
+
+    /**
+     * @brief Run asynchronous inference on caller-owned buffers
+     *
+     * Both buffers must stay valid until the future resolves. View requests
+     * bypass dynamic batching.
+     *
+     * @param config Inference configuration
+     * @param input Input tensor view
+     * @param output Output tensor view
+     * @return Future containing InferenceResult
+     */
+    std::future<InferenceResult> runInferenceAsync(const InferenceConfig& config,
+                                                   const ConstTensorView& input,
+                                                   const TensorView& output);
+
+    /**
+     * @brief Cancel a submitted inference request
+     *
+     * Queued requests resolve with a "Cancelled" error. Requests already
+     * running stop at the next cancellation point.
+     *
+     * @param jobId ID from InferenceTicket
+     * @return true if the request was found
+     */
+    bool cancelInference(uint64_t jobId);
+
+    /**
+     * @brief Configure the per-device inference worker pools
+     * @param config Pool configuration (takes effect on initialize)
+     */
+    void setWorkerPoolConfig(const WorkerPoolConfig& config) { m_workerPoolConfig = config; }
+
+    /**
+     * @brief Get worker pool statistics for a device
+     * @param deviceId GPU device ID
+     * @return WorkerPoolStats structure
+     */
+    WorkerPoolStats getWorkerPoolStats(int deviceId) const;
+
+    /**
+     * @brief Run one batched inference over several inputs
+     * @param config Inference configuration shared by all inputs
+     * @param inputs One input tensor per batch item
+     * @return One InferenceResult per input, in the same order
+     */
+    std::vector<InferenceResult> runInferenceBatch(const InferenceConfig& config,
+                                                   const std::vector<std::vector<float>>& inputs);
+
+    /**
+     * @brief Configure dynamic batching for asynchronous inference
+     *
+     * When enabled, runInferenceAsync requests for the same model that arrive
+     * within the batching window are merged into one runInferenceBatch call.
+     *
+     * @param config Batching configuration
+     */
+    void setBatchingConfig(const BatchingConfig& config);
+
+    /**
+     * @brief Get current batching configuration
+     * @return BatchingConfig structure
+     */
+    BatchingConfig getBatchingConfig() const { return m_batchingConfig; }
+
+    /**
+     * @brief Get batching statistics
+     * @return BatchingStats structure (all zero if batching never enabled)
+     */
+    BatchingStats getBatchingStats() const;
+
+    /**
+     * @brief Configure CUDA graph capture for diffusion step loops
+     *
+     * generateImage captures one denoising step (UNet plus scheduler
+     * update) per model, resolution, batch size and precision, then replays
+     * it for every step. Each concurrent request of the same shape uses its
+     * own graph instance; graphs are dropped when the model's weights move.
+     *
+     * @param config Graph configuration (applied immediately if initialized)
+     */
+    void setCudaGraphConfig(const CudaGraphConfig& config);
+
+    /**
+     * @brief Get CUDA graph statistics
+     * @return CudaGraphStats structure
+     */
+    CudaGraphStats getCudaGraphStats() const;
+
+    /**
+     * @brief Configure the embedding and generated image caches
+     *
+     * Text encoder outputs are kept in VRAM per model and prompt, so a
+     * repeated prompt skips the encoder. Images of requests with a fixed
+     * seed are stored on disk under a hash of the model content, prompt
+     * and every setting that changes the pixels, so an exact repeat is a
+     * file read instead of a generation.
+     *
+     * @param config Cache configuration (applied immediately if initialized)
+     */
+    void setGenerationCacheConfig(const GenerationCacheConfig& config);
+
+    /**
+     * @brief Get embedding and image cache statistics
+     * @return GenerationCacheStats structure
+     */
+    GenerationCacheStats getGenerationCacheStats() const;
+
+    /**
+     * @brief Drop every cached embedding and image
+     */
+    void clearGenerationCaches();
+
     /**
      * @brief Generate image from text prompt
      * @param modelId Text-to-image model ID
@@ -209,6 +763,122 @@ public:
                                  const std::string& prompt,
                                  const InferenceConfig& config);
 
+    /**
+     * @brief Generate image from text prompt into a caller-owned buffer
+     * @param modelId Text-to-image model ID
+     * @param prompt Text description
+     * @param config Additional inference configuration
+     * @param outputImage Destination uint8 HWC view of config.height x
+     *                    config.width x 3 or 4 (alpha is opaque; imageData
+     *                    stays empty)
+     * @return InferenceResult with image dimensions
+     */
+    InferenceResult generateImage(const std::string& modelId,
+                                 const std::string& prompt,
+                                 const InferenceConfig& config,
+                                 const TensorView& outputImage);
+
+    /**
+     * @brief Generate image from text prompt into a renderer-shared image
+     *
+     * The decode writes the shared buffer on the GPU after the renderer has
+     * released the previous generation, and the renderer's copy is ordered
+     * after the write by the shared semaphore, so the image never crosses
+     * PCIe or touches host memory. The call returns once the work is
+     * enqueued; present the image with RenderEngine::consumeSharedImage.
+     *
+     * @param modelId Text-to-image model ID
+     * @param prompt Text description
+     * @param config Additional inference configuration (size must match the image)
+     * @param image Image from importInteropImage
+     * @param generation Generation number (see gpu_interop.h), one more per image
+     * @return InferenceResult with image dimensions (imageData stays empty)
+     */
+    InferenceResult generateImage(const std::string& modelId,
+                                 const std::string& prompt,
+                                 const InferenceConfig& config,
+                                 const InteropImage& image,
+                                 uint64_t generation);
+
+    /**
+     * @brief Submit text-to-image generation without blocking
+     *
+     * Runs generateImage on the worker pool of the least-loaded device
+     * holding the model, at config.priority. The finished callback receives
+     * the result with its imageData, which the caller may keep without
+     * copying.
+     *
+     * @param modelId Text-to-image model ID
+     * @param prompt Text description
+     * @param config Additional inference configuration
+     * @param callbacks Progress and completion notifications
+     * @return Job ID (pass to cancelInference)
+     */
+    uint64_t submitImageGeneration(const std::string& modelId,
+                                   const std::string& prompt,
+                                   const InferenceConfig& config,
+                                   ImageJobCallbacks callbacks);
+
+    /**
+     * @brief Submit text-to-image generation to the staged pipeline
+     *
+     * The pipeline runs the text encoder, the UNet steps and the VAE decode
+     * of different requests at once, each stage on its own stream, so the
+     * next prompt is encoded and the previous image decoded and copied back
+     * while this one denoises. Suited to queues of prompts; a single request
+     * gains nothing over submitImageGeneration.
+     *
+     * @param modelId Text-to-image model ID
+     * @param prompt Text description
+     * @param config Additional inference configuration
+     * @param callbacks Progress and completion notifications, on the pipeline's
+     *                  stage threads (or the caller's, when answered from the
+     *                  result cache or rejected)
+     * @return Job ID (pass to cancelInference)
+     */
+    uint64_t submitPipelinedGeneration(const std::string& modelId,
+                                       const std::string& prompt,
+                                       const InferenceConfig& config,
+                                       ImageJobCallbacks callbacks);
+
+    /**
+     * @brief Generate one image per prompt through the staged pipeline
+     * @param modelId Text-to-image model ID
+     * @param prompts Text descriptions
+     * @param config Inference configuration shared by all prompts
+     * @return One result per prompt, in order, each with its imageData
+     */
+    std::vector<InferenceResult> generateImages(const std::string& modelId,
+                                                const std::vector<std::string>& prompts,
+                                                const InferenceConfig& config);
+
+    /**
+     * @brief Configure the staged diffusion pipeline's queues
+     * @param config Queue limits (applied immediately if running)
+     */
+    void setDiffusionPipelineConfig(const DiffusionPipelineConfig& config);
+
+    /**
+     * @brief Get staged diffusion pipeline counters
+     * @return DiffusionPipelineStats structure
+     */
+    DiffusionPipelineStats getDiffusionPipelineStats() const;
+
+    /**
+     * @brief Import a renderer-exported image into CUDA
+     * @param handles From RenderEngine::createSharedImage
+     * @param image Receives the imported image
+     * @param deviceId CUDA device (-1 = primary); must be the renderer's GPU
+     * @return true if imported
+     */
+    bool importInteropImage(const InteropHandles& handles, InteropImage& image, int deviceId = -1);
+
+    /**
+     * @brief Release an imported image (before the renderer destroys it)
+     * @param image Image from importInteropImage (reset on return)
+     */
+    void releaseInteropImage(InteropImage& image);
+
     /**
      * @brief Upscale an image using AI
      * @param modelId Upscaling model ID
@@ -222,6 +892,110 @@ public:
                                 const std::vector<unsigned char>& inputImage,
                                 int width, int height, int scaleFactor);
 
+    /**
+     * @brief Upscale an image between caller-owned buffers
+     * @param modelId Upscaling model ID
+     * @param inputImage Input uint8 HWC view (may be generateImage's output)
+     * @param scaleFactor Upscaling factor (2x, 4x, etc.)
+     * @param outputImage Destination uint8 HWC view (imageData stays empty)
+     * @return InferenceResult with upscaled dimensions
+     */
+    InferenceResult upscaleImage(const std::string& modelId,
+                                const ConstTensorView& inputImage,
+                                int scaleFactor,
+                                const TensorView& outputImage);
+
+    /**
+     * @brief Upscale an image of any size tile by tile into a row sink
+     *
+     * Overlapping tiles run on the device's workers, each on its own
+     * stream, so one tile's upload, another's inference and a third's
+     * download overlap. Seams are cross-faded and finished rows reach the
+     * sink in order: neither the GPU nor the host ever holds the whole
+     * output, only the tiles in flight and one band of output rows.
+     *
+     * @param modelId Upscaling model ID
+     * @param inputImage Input uint8 HWC view
+     * @param scaleFactor Upscaling factor (2x, 4x, etc.)
+     * @param sink Receives the output rows, on the calling thread
+     * @param tiling Tile size, overlap and pipeline depth
+     * @return InferenceResult with upscaled dimensions (imageData stays empty)
+     */
+    InferenceResult upscaleImageTiled(const std::string& modelId,
+                                      const ConstTensorView& inputImage,
+                                      int scaleFactor,
+                                      ImageRowSink& sink,
+                                      const TileConfig& tiling = TileConfig());
+
+    /**
+     * @brief Submit text generation, streaming tokens as they are sampled
+     *
+     * The request joins the model's running batch at its next decode step
+     * and leaves it as soon as it finishes, so short requests are never held
+     * up by long ones. Uses config.maxTokens, temperature and seed.
+     *
+     * @param modelId Text generation model ID
+     * @param prompt Prompt text
+     * @param config Sampling configuration
+     * @param callbacks Token and completion notifications, on the model's
+     *                  generator thread
+     * @return Job ID (pass to cancelInference)
+     */
+    uint64_t submitTextGeneration(const std::string& modelId,
+                                  const std::string& prompt,
+                                  const InferenceConfig& config,
+                                  TextGenerationCallbacks callbacks);
+
+    /**
+     * @brief Configure batching and KV cache limits of text generation
+     * @param config Applies to generators created after the call
+     */
+    void setTextGeneratorConfig(const TextGeneratorConfig& config);
+
+    /**
+     * @brief Get text generation counters of a model
+     * @param modelId Text generation model ID
+     * @return TextGenerationStats (zeros if nothing was generated yet)
+     */
+    TextGenerationStats getTextGenerationStats(const std::string& modelId) const;
+
+    /**
+     * @brief Configure the caching device allocator
+     * @param config Allocator configuration (applied immediately if initialized)
+     */
+    void setDeviceAllocatorConfig(const DeviceAllocatorConfig& config);
+
+    /**
+     * @brief Get caching allocator statistics for a device
+     * @param deviceId GPU device ID
+     * @return DeviceAllocatorStats structure
+     */
+    DeviceAllocatorStats getDeviceAllocatorStats(int deviceId) const;
+
+    /**
+     * @brief Return cached device memory to the driver
+     *
+     * Call before handing VRAM to another process or library; cached blocks
+     * are otherwise reused by later allocations.
+     */
+    void trimDeviceMemory();
+
+    /**
+     * @brief Allocate a tensor buffer for use with the view-based API
+     * @param shape Tensor shape
+     * @param dtype Element type
+     * @param location Host, pinned-host or device memory
+     * @return View of the new buffer (data is nullptr on failure)
+     */
+    TensorView allocateTensor(const TensorShape& shape, DataType dtype,
+                              MemoryLocation location);
+
+    /**
+     * @brief Free a buffer returned by allocateTensor
+     * @param tensor View to free (data is reset to nullptr)
+     */
+    void freeTensor(TensorView& tensor);
+
     /**
      * @brief Check if engine is initialized
      * @return true if initialized
@@ -230,7 +1004,7 @@ public:
 
     /**
      * @brief Get current VRAM usage
-     * @return VRAM used by AI engine in MB
+     * @return VRAM used by resident models in MB
      */
     size_t getVRAMUsage() const;
 
@@ -241,12 +1015,282 @@ public:
     void setProgressCallback(std::function<void(float)> callback);
 
 private:
+    /**
+     * @struct DeviceState
+     * @brief Per-device properties and last load sample
+     */
+    struct DeviceState {
+        std::string computeCapability;  // e.g. "12.0"
+        size_t memoryMB = 0;            // Total VRAM
+        float gpuUtilization = 0.0f;    // From updateDeviceMetrics
+        size_t memoryUsedMB = 0;
+        bool hasMetrics = false;
+        size_t routedRequests = 0;
+        uint32_t throttleReasons = 0;   // From handleGPUEvent
+        bool memoryPressure = false;
+        size_t xidErrors = 0;
+        int numaNode = -1;              // From setDeviceTopology
+        std::vector<int> cpus;          // CPUs of that node
+    };
+
     bool m_initialized;
-    int m_deviceId;
+    int m_deviceId;                     // Primary device
+    std::vector<int> m_deviceIds;
+    std::map<int, DeviceState> m_devices;
+    mutable std::mutex m_deviceMutex;   // Guards the load fields of m_devices
     void* m_cudaContext;        // Opaque CUDA context
     void* m_tensorrtContext;    // Opaque TensorRT context
-    std::map<std::string, std::unique_ptr<class AIModel>> m_models;
+    ModelRegistry m_models;             // Resolved by every request, from any thread
     std::function<void(float)> m_progressCallback;
+    BatchingConfig m_batchingConfig;
+    std::unique_ptr<class BatchScheduler> m_batchScheduler; // Lives as long as the engine
+    bool m_batchingDegraded;            // Batch limit reduced for GPU health
+    std::mutex m_batchingMutex;         // Serializes scheduler start/stop against GPU events
+    DiffusionPipelineConfig m_pipelineConfig;
+    std::unique_ptr<class DiffusionPipeline> m_pipeline;    // Started by the first submission
+    mutable std::mutex m_pipelineMutex;
+    WorkerPoolConfig m_workerPoolConfig;
+    std::vector<GPUTopology> m_topology;
+    NUMAPlacementConfig m_numaConfig;
+    std::map<int, std::unique_ptr<WorkerPool>> m_workerPools; // One pool per CUDA device
+    std::atomic<uint64_t> m_nextJobId;
+    EngineCacheConfig m_engineCacheConfig;
+    std::unique_ptr<class EngineCache> m_engineCache;
+    std::string m_computeCapability;    // Of m_deviceId, e.g. "12.0"
+    ResidencyConfig m_residencyConfig;
+    std::unique_ptr<class ResidencyManager> m_residency;
+    DeviceAllocatorConfig m_deviceAllocatorConfig;
+    std::map<int, std::unique_ptr<class DeviceAllocator>> m_deviceAllocators; // One per CUDA device
+    CudaGraphConfig m_cudaGraphConfig;
+    std::unique_ptr<class CudaGraphCache> m_graphCache;
+    std::atomic<size_t> m_eagerSteps;
+    GenerationCacheConfig m_generationCacheConfig;
+    std::unique_ptr<class EmbeddingCache> m_embeddingCache;
+    std::unique_ptr<class ResultCache> m_resultCache;
+    TextGeneratorConfig m_textGeneratorConfig;
+    std::map<std::string, std::shared_ptr<TextGenerator>> m_textGenerators; // One per LLM
+    mutable std::mutex m_textGeneratorMutex;
+
+    /**
+     * @brief Shared generateImage body
+     * @param interop Semaphore to wait on and signal around the decode, or nullptr
+     * @param generation Interop generation when interop is set
+     */
+    InferenceResult generateImageInto(const std::string& modelId,
+                                      const std::string& prompt,
+                                      const InferenceConfig& config,
+                                      const TensorView& outputImage,
+                                      const InteropImage* interop,
+                                      uint64_t generation);
+
+    /**
+     * @brief Tokenize a prompt and run the text encoder (or reuse its output)
+     * @param embeddings Receives the FP16 text embeddings (unconditional first
+     *                   when guided)
+     * @param stream Stream to run on (nullptr = default)
+     */
+    void encodePrompt(const class AIModel& model, const std::string& prompt,
+                      const InferenceConfig& config, int deviceId, void* stream,
+                      std::vector<uint16_t>& embeddings);
+
+    /**
+     * @brief Run the UNet steps from noise to denoised latents
+     * @param cancelled Polled before every step
+     * @param latents Receives the FP16 latents
+     * @param error Receives the reason on failure
+     * @return false if cancelled or out of memory
+     */
+    bool denoiseLatents(const std::string& modelId, const InferenceConfig& config,
+                        int deviceId, void* stream, const std::vector<uint16_t>& embeddings,
+                        const std::function<bool()>& cancelled,
+                        std::vector<uint16_t>& latents, std::string& error);
+
+    /**
+     * @brief Run the VAE decode into an image and copy it out
+     * @param outputImage Destination (RGB or RGBA uint8)
+     * @param interop Semaphore to wait on and signal around the decode, or nullptr
+     * @param generation Interop generation when interop is set
+     */
+    void decodeLatents(const std::vector<uint16_t>& latents, const InferenceConfig& config,
+                       const TensorView& outputImage, const InteropImage* interop,
+                       uint64_t generation, int deviceId, void* stream);
+
+    /**
+     * @brief Key of a generated image in the result cache
+     * @return Key string, or empty if the request is not cacheable (no seed)
+     */
+    std::string makeResultCacheKey(const class AIModel& model, const std::string& prompt,
+                                   const InferenceConfig& config) const;
+
+    /**
+     * @brief Start the staged diffusion pipeline if it is not running
+     * @return Pipeline, or nullptr if the engine is not initialized
+     */
+    class DiffusionPipeline* getDiffusionPipeline();
+
+    /**
+     * @brief Report progress to the global and the current job's callback
+     * @param progress Progress (0.0 to 1.0)
+     */
+    void reportProgress(float progress) const;
+
+    /**
+     * @brief Upscale one tile of an image on the calling worker's stream
+     * @param inputImage Whole input image
+     * @param rect Tile region
+     * @param scaleFactor Upscaling factor
+     * @param output Receives the tile's (width * scale) x (height * scale) pixels
+     * @param deviceId Device the model is resident on
+     * @return false if the tile failed or its job was cancelled
+     */
+    bool upscaleTile(const ConstTensorView& inputImage, const TileRect& rect,
+                     int scaleFactor, std::vector<unsigned char>& output, int deviceId);
+
+    /**
+     * @brief Get or start the text generator of a model
+     * @param modelId Text generation model ID
+     * @param error Receives the reason on failure
+     * @return Generator, or nullptr if it could not be started
+     */
+    std::shared_ptr<TextGenerator> getTextGenerator(const std::string& modelId, std::string& error);
+
+    /**
+     * @brief Run one batched decode step of a model (the generator's executor)
+     * @param modelId Model the generator belongs to
+     * @param slots Sequences of the step
+     * @param logits Receives one logit vector per sampling slot
+     * @param error Receives the reason on failure
+     * @return true if the step ran
+     */
+    bool runTextStep(const std::string& modelId,
+                     const std::vector<TextGenerator::StepSlot>& slots,
+                     std::vector<std::vector<float>>& logits, std::string& error);
+
+    /**
+     * @brief Build the engine cache key for a model
+     * @param model Model to key
+     * @param precision Engine precision
+     * @return Cache key (modelHash empty if the file could not be hashed)
+     */
+    struct EngineCacheKey makeEngineCacheKey(const class AIModel& model,
+                                             PrecisionMode precision) const;
+
+    /**
+     * @brief Make a model resident and keep it so while the leases are held
+     *
+     * Runs on the calling worker's device when it holds a replica, otherwise
+     * on the least-loaded one. Sharded models pin every shard.
+     *
+     * @param model Model, held through a handle until the leases are released
+     * @param allowOffload Model may go to pinned host memory when evicted later
+     * @param error Receives the failure reason
+     * @param deviceId Optional, receives the device the request runs on
+     * @return One lease per replica or shard used (empty on failure)
+     */
+    std::vector<class ResidencyLease> acquireModel(const class AIModel& model, bool allowOffload,
+                                                   std::string& error, int* deviceId = nullptr);
+
+    /**
+     * @brief Release a model's replicas and free it (deleter of its handles)
+     *
+     * Runs once the model is unloaded and no request holds it any more.
+     *
+     * @param model Model to destroy
+     */
+    void destroyModel(class AIModel* model);
+
+    /**
+     * @brief Move a replica's weights between residency states
+     * @param replicaKey Residency key from replicaKey()
+     * @param from Current state
+     * @param to Target state
+     * @return true if moved
+     */
+    bool transitionModel(const std::string& replicaKey, ResidencyState from, ResidencyState to);
+
+    /**
+     * @brief Get a device's model VRAM budget from m_residencyConfig
+     * @param deviceId GPU device ID
+     * @return Budget in MB
+     */
+    size_t residencyBudgetMB(int deviceId) const;
+
+    /**
+     * @brief Choose the devices of a new model
+     * @param sizeMB Size of the whole model
+     * @param placement Requested placement; AUTO is resolved in place
+     * @return Device IDs, ascending
+     */
+    std::vector<int> placeModel(size_t sizeMB, ModelPlacement& placement) const;
+
+    /**
+     * @brief Create a model's per-device replicas (or shards) and register them
+     * @param model Model with placement and devices set
+     */
+    void createReplicas(class AIModel& model);
+
+    /**
+     * @brief Pick the least-loaded device holding a model
+     * @param model Model to run
+     * @return Device ID (the first shard's device for sharded models)
+     */
+    int selectDevice(const class AIModel& model) const;
+
+    /**
+     * @brief Route a request and count it against the chosen device
+     * @param modelId Model ID
+     * @return Device ID (m_deviceId if the model is unknown)
+     */
+    int routeRequest(const std::string& modelId);
+
+    /**
+     * @brief Queue background prefetch of the replicas a request will use
+     * @param modelId Model ID
+     * @param deviceId Device the request was routed to
+     */
+    void prefetchModel(const std::string& modelId, int deviceId);
+
+    /**
+     * @brief Copy a replica's uploaded weights to pinned host memory and free VRAM
+     * @param model Model to offload
+     * @param deviceId Device of the replica
+     */
+    void offloadModelToHost(class AIModel& model, int deviceId);
+
+    /**
+     * @brief Copy a replica's offloaded weights back to VRAM
+     * @param model Model to restore
+     * @param deviceId Device of the replica
+     * @return true if all weights are resident
+     */
+    bool restoreModelFromHost(class AIModel& model, int deviceId);
+
+    /**
+     * @brief Upload any weights of a mapped model's replica not yet on its GPU
+     * @param model Model to page in
+     * @param deviceId Device of the replica
+     * @return true if all weights are resident
+     */
+    bool ensureWeightsResident(class AIModel& model, int deviceId);
+
+    /**
+     * @brief Free a replica's uploaded and offloaded weights
+     * @param model Model to release
+     * @param deviceId Device of the replica
+     */
+    void releaseModelWeights(class AIModel& model, int deviceId);
+
+    /**
+     * @brief Get the worker pool of a device
+     * @param deviceId GPU device ID
+     * @return Worker pool, or nullptr if none is running
+     */
+    WorkerPool* getWorkerPool(int deviceId);
+
+    /**
+     * @brief Batching configuration adjusted for GPU health (m_batchingMutex must be held)
+     */
+    BatchingConfig effectiveBatchingConfig() const;
 
     /**
      * @brief Detect model type from file
@@ -269,17 +1313,41 @@ private:
     std::string generateModelId();
 
     /**
-     * @brief Allocate CUDA memory
+     * @brief Allocate CUDA memory through the caching allocator
+     *
+     * Blocks are cached per stream; the calling worker's stream is used
+     * when the worker belongs to the target device.
+     *
      * @param size Size in bytes
+     * @param deviceId Target device (-1 = the calling worker's, or the primary)
      * @return Pointer to allocated memory
      */
-    void* allocateCudaMemory(size_t size);
+    void* allocateCudaMemory(size_t size, int deviceId = -1);
 
     /**
-     * @brief Free CUDA memory
+     * @brief Return CUDA memory to the caching allocator
      * @param ptr Pointer to free
      */
     void freeCudaMemory(void* ptr);
+
+    /**
+     * @brief Allocate pinned host memory for a device's staging or offload copies
+     *
+     * Placed on the device's NUMA node when localHostMemory is set and the
+     * node is known.
+     *
+     * @param size Size in bytes
+     * @param deviceId Device the memory feeds
+     * @return Pointer, or nullptr on failure
+     */
+    void* allocateHostMemory(size_t size, int deviceId);
+
+    /**
+     * @brief Free memory from allocateHostMemory
+     * @param ptr Pointer to free
+     * @param size Size passed to allocateHostMemory
+     */
+    void freeHostMemory(void* ptr, size_t size);
 };
 
 /**
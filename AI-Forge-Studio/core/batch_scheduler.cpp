@@ -0,0 +1,384 @@
+/**
+ * @file batch_scheduler.cpp
+ * @brief Implementation of dynamic request batching
+ */
+
+#include "batch_scheduler.h"
+#include "logger.h"
+#include <algorithm>
+
+namespace AIForge {
+
+BatchScheduler::BatchScheduler(BatchExecutor executor, BatchLauncher launcher)
+    : m_executor(std::move(executor))
+    , m_launcher(std::move(launcher))
+    , m_pendingCount(0)
+    , m_totalQueueTime(0.0)
+    , m_running(false)
+{
+}
+
+BatchScheduler::~BatchScheduler() {
+    stop();
+}
+
+void BatchScheduler::start(const BatchingConfig& config) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_running) {
+        return;
+    }
+
+    m_config = config;
+    m_running = true;
+    m_dispatcherThread = std::thread(&BatchScheduler::dispatchLoop, this);
+
+    LOG_INFO("BatchScheduler", "Batching enabled (max batch " +
+             std::to_string(config.maxBatchSize) + ", window " +
+             std::to_string(config.maxWaitMs) + " ms)");
+}
+
+void BatchScheduler::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_running) {
+            return;
+        }
+        m_running = false;
+    }
+
+    m_condition.notify_all();
+    if (m_dispatcherThread.joinable()) {
+        m_dispatcherThread.join();
+    }
+
+    // Fail anything that never made it into a batch
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& pair : m_queues) {
+        for (auto& request : pair.second) {
+            InferenceResult result;
+            result.success = false;
+            result.errorMessage = "Batch scheduler stopped";
+            request.promise.set_value(std::move(result));
+        }
+    }
+    m_queues.clear();
+    m_pendingCount = 0;
+
+    LOG_INFO("BatchScheduler", "Batching disabled");
+}
+
+bool BatchScheduler::isRunning() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_running;
+}
+
+void BatchScheduler::setConfig(const BatchingConfig& config) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_config = config;
+    }
+    m_condition.notify_all();
+}
+
+std::future<InferenceResult> BatchScheduler::submit(uint64_t jobId,
+                                                    const InferenceConfig& config,
+                                                    std::vector<float> inputData) {
+    PendingRequest request;
+    request.jobId = jobId;
+    request.config = config;
+    request.inputData = std::move(inputData);
+    request.enqueueTime = Clock::now();
+    std::future<InferenceResult> future = request.promise.get_future();
+
+    bool wakeDispatcher = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_running) {
+            InferenceResult result;
+            result.success = false;
+            result.errorMessage = "Batch scheduler not running";
+            request.promise.set_value(std::move(result));
+            return future;
+        }
+
+        auto& queue = m_queues[config.modelId];
+        queue.push_back(std::move(request));
+        m_pendingCount++;
+        m_stats.requestsSubmitted++;
+
+        // The dispatcher only needs waking early when this request changes
+        // the earliest deadline or fills a batch
+        wakeDispatcher = queue.size() == 1 ||
+                         static_cast<int>(queue.size()) >= m_config.maxBatchSize;
+    }
+
+    if (wakeDispatcher) {
+        m_condition.notify_one();
+    }
+
+    return future;
+}
+
+bool BatchScheduler::cancel(uint64_t jobId) {
+    std::promise<InferenceResult> promise;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        bool found = false;
+        for (auto it = m_queues.begin(); it != m_queues.end() && !found; ++it) {
+            auto& queue = it->second;
+            for (auto reqIt = queue.begin(); reqIt != queue.end(); ++reqIt) {
+                if (reqIt->jobId == jobId) {
+                    promise = std::move(reqIt->promise);
+                    queue.erase(reqIt);
+                    m_pendingCount--;
+                    found = true;
+                    break;
+                }
+            }
+        }
+
+        // Already merged: mark it so the batch skips or discards it
+        auto launched = m_launched.find(jobId);
+        if (!found && launched != m_launched.end()) {
+            for (auto& request : *launched->second) {
+                if (request.jobId == jobId) {
+                    found = takePromiseLocked(request, promise);
+                    break;
+                }
+            }
+        }
+        if (!found) {
+            return false;
+        }
+    }
+
+    InferenceResult result;
+    result.success = false;
+    result.errorMessage = "Cancelled";
+    promise.set_value(std::move(result));
+    return true;
+}
+
+bool BatchScheduler::takePromiseLocked(PendingRequest& request,
+                                       std::promise<InferenceResult>& promise) {
+    if (request.resolved) {
+        return false;
+    }
+    request.resolved = true;
+    promise = std::move(request.promise);
+    m_launched.erase(request.jobId);
+    return true;
+}
+
+size_t BatchScheduler::getPendingCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_pendingCount;
+}
+
+BatchingStats BatchScheduler::getStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    BatchingStats stats = m_stats;
+    if (stats.batchesExecuted > 0) {
+        stats.averageBatchSize = static_cast<float>(stats.requestsExecuted) /
+                                 stats.batchesExecuted;
+    }
+    if (stats.requestsExecuted > 0) {
+        stats.averageQueueTime = static_cast<float>(m_totalQueueTime /
+                                                    stats.requestsExecuted);
+    }
+    return stats;
+}
+
+bool BatchScheduler::isBatchCompatible(const InferenceConfig& a, const InferenceConfig& b) {
+    // Seeds may differ per sample; everything that shapes the execution or
+    // its output tensors must match
+    return a.modelId == b.modelId &&
+           a.precision == b.precision &&
+           a.width == b.width &&
+           a.height == b.height &&
+           a.maxTokens == b.maxTokens &&
+           a.temperature == b.temperature &&
+           a.numInferenceSteps == b.numInferenceSteps &&
+           a.guidanceScale == b.guidanceScale &&
+           a.useVRAMOffload == b.useVRAMOffload;
+}
+
+BatchScheduler::Clock::time_point BatchScheduler::nextDeadline() const {
+    auto window = std::chrono::milliseconds(m_config.maxWaitMs);
+    Clock::time_point deadline = Clock::time_point::max();
+
+    for (const auto& pair : m_queues) {
+        if (!pair.second.empty()) {
+            deadline = std::min(deadline, pair.second.front().enqueueTime + window);
+        }
+    }
+
+    return deadline;
+}
+
+BatchScheduler::BatchPtr BatchScheduler::takeReadyBatch(Clock::time_point now) {
+    auto window = std::chrono::milliseconds(m_config.maxWaitMs);
+    size_t maxBatch = static_cast<size_t>(std::max(1, m_config.maxBatchSize));
+
+    for (auto it = m_queues.begin(); it != m_queues.end(); ++it) {
+        auto& queue = it->second;
+        if (queue.empty()) {
+            continue;
+        }
+
+        bool full = queue.size() >= maxBatch;
+        bool expired = now >= queue.front().enqueueTime + window;
+        if (!full && !expired) {
+            continue;
+        }
+
+        // Take the oldest request and every compatible one behind it,
+        // preserving arrival order for the requests left in the queue
+        auto batch = std::make_shared<Batch>();
+        const InferenceConfig head = queue.front().config;
+        for (auto reqIt = queue.begin(); reqIt != queue.end() && batch->size() < maxBatch;) {
+            if (isBatchCompatible(head, reqIt->config)) {
+                m_launched[reqIt->jobId] = batch;
+                batch->push_back(std::move(*reqIt));
+                reqIt = queue.erase(reqIt);
+            } else {
+                ++reqIt;
+            }
+        }
+
+        m_pendingCount -= batch->size();
+        if (queue.empty()) {
+            m_queues.erase(it);
+        }
+        return batch;
+    }
+
+    return nullptr;
+}
+
+void BatchScheduler::dispatchLoop() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (m_running) {
+        BatchPtr batch = takeReadyBatch(Clock::now());
+        if (batch) {
+            lock.unlock();
+            launchBatch(std::move(batch));
+            lock.lock();
+            continue;
+        }
+
+        Clock::time_point deadline = nextDeadline();
+        if (deadline == Clock::time_point::max()) {
+            m_condition.wait(lock);
+        } else {
+            m_condition.wait_until(lock, deadline);
+        }
+    }
+}
+
+void BatchScheduler::failBatch(const BatchPtr& batch, const std::string& message) {
+    std::vector<std::promise<InferenceResult>> promises;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto& request : *batch) {
+            std::promise<InferenceResult> promise;
+            if (takePromiseLocked(request, promise)) {
+                promises.push_back(std::move(promise));
+            }
+        }
+    }
+
+    for (auto& promise : promises) {
+        InferenceResult result;
+        result.success = false;
+        result.errorMessage = message;
+        promise.set_value(std::move(result));
+    }
+}
+
+void BatchScheduler::launchBatch(BatchPtr batch) {
+    if (!m_launcher) {
+        executeBatch(batch);
+        return;
+    }
+
+    JobPriority priority = JobPriority::BATCH;
+    for (const auto& request : *batch) {
+        priority = std::min(priority, request.config.priority);
+    }
+
+    const InferenceConfig config = batch->front().config;
+    bool queued = m_launcher(config, priority,
+        [this, batch] { executeBatch(batch); },
+        [this, batch] { failBatch(batch, "Cancelled"); });
+
+    if (!queued) {
+        failBatch(batch, "Inference queue full");
+    }
+}
+
+void BatchScheduler::executeBatch(const BatchPtr& batch) {
+    // Requests cancelled while the batch waited for a worker are left out
+    std::vector<size_t> members;
+    std::vector<std::vector<float>> inputs;
+    Clock::time_point started = Clock::now();
+    double queueTime = 0.0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (size_t i = 0; i < batch->size(); i++) {
+            PendingRequest& request = (*batch)[i];
+            if (request.resolved) {
+                continue;
+            }
+            queueTime += std::chrono::duration<double, std::milli>(
+                started - request.enqueueTime).count();
+            inputs.push_back(std::move(request.inputData));
+            members.push_back(i);
+        }
+    }
+    if (members.empty()) {
+        return;
+    }
+
+    InferenceConfig batchConfig = (*batch)[members.front()].config;
+    batchConfig.batchSize = static_cast<int>(members.size());
+
+    std::vector<InferenceResult> results;
+    try {
+        results = m_executor(batchConfig, inputs);
+    } catch (const std::exception& e) {
+        LOG_ERROR("BatchScheduler", std::string("Batch execution failed: ") + e.what());
+    }
+
+    // Members cancelled during execution already resolved; drop their results
+    std::vector<std::pair<std::promise<InferenceResult>, InferenceResult>> resolved;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (size_t k = 0; k < members.size(); k++) {
+            std::promise<InferenceResult> promise;
+            if (!takePromiseLocked((*batch)[members[k]], promise)) {
+                continue;
+            }
+            InferenceResult result;
+            if (k < results.size()) {
+                result = std::move(results[k]);
+            } else {
+                result.success = false;
+                result.errorMessage = "Batch execution returned no result";
+            }
+            resolved.emplace_back(std::move(promise), std::move(result));
+        }
+
+        m_stats.batchesExecuted++;
+        m_stats.requestsExecuted += members.size();
+        m_stats.largestBatch = std::max(m_stats.largestBatch, members.size());
+        m_totalQueueTime += queueTime;
+    }
+
+    for (auto& pair : resolved) {
+        pair.first.set_value(std::move(pair.second));
+    }
+}
+
+} // namespace AIForge
@@ -0,0 +1,224 @@
+/**
+ * @file batch_scheduler.h
+ * @brief Dynamic request batching for AI inference
+ *
+ * Collects inference requests per model and merges requests that arrive
+ * within a short time window into a single batched execution. Results are
+ * split back out to each caller's future.
+ *
+ * Features:
+ * - Per-model request queues
+ * - Configurable batching window and maximum batch size
+ * - Compatibility check so only requests with matching settings are merged
+ * - Batching statistics for tuning
+ */
+
+#ifndef BATCH_SCHEDULER_H
+#define BATCH_SCHEDULER_H
+
+#include "ai_engine.h"
+#include "worker_pool.h"
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <future>
+#include <functional>
+#include <chrono>
+#include <memory>
+
+namespace AIForge {
+
+/**
+ * @class BatchScheduler
+ * @brief Merges concurrent inference requests for the same model
+ *
+ * A single dispatcher thread watches all model queues. A queue is flushed
+ * when it reaches the maximum batch size or when its oldest request has
+ * waited for the batching window.
+ */
+class BatchScheduler {
+public:
+    /**
+     * @brief Function executing one merged batch
+     *
+     * Receives the shared configuration (with batchSize set to the number of
+     * merged requests) and one input tensor per request. Must return one
+     * result per input, in the same order.
+     */
+    using BatchExecutor = std::function<std::vector<InferenceResult>(
+        const InferenceConfig&, const std::vector<std::vector<float>>&)>;
+
+    /**
+     * @brief Function handing a ready batch to an execution thread
+     *
+     * Receives the batch's config (for routing), its highest member priority,
+     * the work to run and a handler to call instead if the work is cancelled
+     * before it starts. Returns false if the work could not be queued.
+     * Without a launcher, batches run on the dispatcher thread.
+     */
+    using BatchLauncher = std::function<bool(const InferenceConfig&, JobPriority,
+                                             std::function<void()>, std::function<void()>)>;
+
+    /**
+     * @brief Construct scheduler with the function that executes batches
+     * @param executor Batch execution function
+     * @param launcher Optional function scheduling batch execution
+     */
+    explicit BatchScheduler(BatchExecutor executor, BatchLauncher launcher = nullptr);
+    ~BatchScheduler();
+
+    // Disable copy and move
+    BatchScheduler(const BatchScheduler&) = delete;
+    BatchScheduler& operator=(const BatchScheduler&) = delete;
+    BatchScheduler(BatchScheduler&&) = delete;
+    BatchScheduler& operator=(BatchScheduler&&) = delete;
+
+    /**
+     * @brief Start the dispatcher thread
+     * @param config Batching window and size limits
+     */
+    void start(const BatchingConfig& config);
+
+    /**
+     * @brief Stop the dispatcher and fail all pending requests
+     */
+    void stop();
+
+    /**
+     * @brief Check if dispatcher is running
+     * @return true if running
+     */
+    bool isRunning() const;
+
+    /**
+     * @brief Update batching window and size limits
+     * @param config New configuration
+     */
+    void setConfig(const BatchingConfig& config);
+
+    /**
+     * @brief Queue a request for batched execution
+     * @param jobId Caller-assigned ID used for cancellation
+     * @param config Inference configuration
+     * @param inputData Input tensor data (moved into the queue)
+     * @return Future resolved when the batch containing this request completes
+     */
+    std::future<InferenceResult> submit(uint64_t jobId, const InferenceConfig& config,
+                                        std::vector<float> inputData);
+
+    /**
+     * @brief Cancel a request, queued or merged into an unfinished batch
+     *
+     * The request resolves as cancelled at once. A batch that has not
+     * started runs without it; a running batch's result for it is dropped.
+     *
+     * @param jobId ID passed to submit()
+     * @return true if the request had not completed and has been cancelled
+     */
+    bool cancel(uint64_t jobId);
+
+    /**
+     * @brief Get number of requests waiting across all models
+     * @return Pending request count
+     */
+    size_t getPendingCount() const;
+
+    /**
+     * @brief Get batching statistics
+     * @return BatchingStats structure
+     */
+    BatchingStats getStats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct PendingRequest {
+        uint64_t jobId;
+        InferenceConfig config;
+        std::vector<float> inputData;
+        std::promise<InferenceResult> promise;
+        Clock::time_point enqueueTime;
+        bool resolved = false;          // Promise already set (cancelled)
+    };
+
+    using Batch = std::vector<PendingRequest>;
+    using BatchPtr = std::shared_ptr<Batch>;
+
+    BatchExecutor m_executor;
+    BatchLauncher m_launcher;
+    BatchingConfig m_config;
+    std::map<std::string, std::deque<PendingRequest>> m_queues;
+    std::map<uint64_t, BatchPtr> m_launched;    // Merged requests by job ID, until resolved
+    size_t m_pendingCount;
+    BatchingStats m_stats;
+    double m_totalQueueTime;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bool m_running;
+    std::thread m_dispatcherThread;
+
+    /**
+     * @brief Dispatcher loop run on the background thread
+     */
+    void dispatchLoop();
+
+    /**
+     * @brief Remove the next ready batch from the queues (lock must be held)
+     *
+     * Its requests move to m_launched, so they stay cancellable.
+     *
+     * @param now Current time
+     * @return The batch, or null if none is ready
+     */
+    BatchPtr takeReadyBatch(Clock::time_point now);
+
+    /**
+     * @brief Get the earliest time at which a queue becomes ready
+     * @return Deadline of the oldest pending request
+     */
+    Clock::time_point nextDeadline() const;
+
+    /**
+     * @brief Hand a batch to the launcher, or execute it inline
+     * @param batch Requests to execute together
+     */
+    void launchBatch(BatchPtr batch);
+
+    /**
+     * @brief Execute a batch's uncancelled requests and fulfil their promises
+     * @param batch Requests to execute together
+     */
+    void executeBatch(const BatchPtr& batch);
+
+    /**
+     * @brief Resolve every uncancelled request in a batch with an error
+     * @param batch Requests to fail
+     * @param message Error message
+     */
+    void failBatch(const BatchPtr& batch, const std::string& message);
+
+    /**
+     * @brief Take the promise of a launched request still awaiting a result
+     * @param request Request in a launched batch (lock must be held)
+     * @param promise Receives the promise
+     * @return false if the request was already resolved
+     */
+    bool takePromiseLocked(PendingRequest& request, std::promise<InferenceResult>& promise);
+
+    /**
+     * @brief Check whether two requests may share a batch
+     * @param a First configuration
+     * @param b Second configuration
+     * @return true if settings affecting execution match
+     */
+    static bool isBatchCompatible(const InferenceConfig& a, const InferenceConfig& b);
+};
+
+} // namespace AIForge
+
+#endif // BATCH_SCHEDULER_H
@@ -0,0 +1,168 @@
+/**
+ * @file cuda_graph_cache.cpp
+ * @brief Implementation of the CUDA graph cache
+ */
+
+#include "cuda_graph_cache.h"
+#include "logger.h"
+#include <tuple>
+#include <vector>
+
+namespace AIForge {
+
+bool CudaGraphKey::operator<(const CudaGraphKey& other) const {
+    return std::tie(modelId, deviceId, width, height, batchSize, precision) <
+           std::tie(other.modelId, other.deviceId, other.width, other.height,
+                    other.batchSize, other.precision);
+}
+
+CudaGraphCache::CudaGraphCache(ReleaseFunction release)
+    : m_release(std::move(release))
+    , m_clock(0)
+{
+}
+
+CudaGraphCache::~CudaGraphCache() {
+    clear();
+}
+
+void CudaGraphCache::setConfig(const CudaGraphConfig& config) {
+    std::vector<std::shared_ptr<CudaGraph>> dropped;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_config = config;
+        if (!config.enabled) {
+            for (auto& pair : m_graphs) {
+                dropped.push_back(std::move(pair.second.graph));
+            }
+            m_graphs.clear();
+        } else {
+            evictLocked(dropped);
+        }
+    }
+}
+
+std::shared_ptr<CudaGraph> CudaGraphCache::getOrCapture(const CudaGraphKey& key,
+                                                        const CaptureFunction& capture) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_config.enabled) {
+            return nullptr;
+        }
+
+        auto range = m_graphs.equal_range(key);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (!it->second.graph->inUse) {
+                it->second.lastUsed = ++m_clock;
+                m_stats.hits++;
+                return checkOut(it->second.graph);
+            }
+        }
+    }
+
+    // Capture outside the lock: it allocates the workspace and instantiates
+    // the graph, which takes milliseconds
+    ReleaseFunction release = m_release;
+    std::shared_ptr<CudaGraph> graph(new CudaGraph(), [release](CudaGraph* captured) {
+        if (release) {
+            release(*captured);
+        }
+        delete captured;
+    });
+    graph->deviceId = key.deviceId;
+    graph->inUse = true;
+
+    if (!capture(*graph)) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.captureFailures++;
+        LOG_WARNING("CudaGraphCache", "Capture failed for " + key.modelId + " at " +
+                    std::to_string(key.width) + "x" + std::to_string(key.height) +
+                    ", running steps eagerly");
+        return nullptr;
+    }
+
+    // Declared before the lock so evicted graphs are released after it
+    std::vector<std::shared_ptr<CudaGraph>> dropped;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.captures++;
+
+    Entry entry;
+    entry.graph = graph;
+    entry.lastUsed = ++m_clock;
+    m_graphs.emplace(key, entry);
+    evictLocked(dropped);
+
+    LOG_INFO("CudaGraphCache", "Captured step graph for " + key.modelId + " (" +
+             std::to_string(key.width) + "x" + std::to_string(key.height) + ", batch " +
+             std::to_string(key.batchSize) + ", " + precisionModeToString(key.precision) +
+             ", device " + std::to_string(key.deviceId) + ")");
+    return checkOut(graph);
+}
+
+std::shared_ptr<CudaGraph> CudaGraphCache::checkOut(const std::shared_ptr<CudaGraph>& graph) {
+    // The handle keeps the graph alive; dropping it makes the graph idle again.
+    // The cache outlives every handle (the engine releases them first).
+    graph->inUse = true;
+    return std::shared_ptr<CudaGraph>(graph.get(), [this, graph](CudaGraph*) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        graph->inUse = false;
+    });
+}
+
+void CudaGraphCache::recordReplay() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.replays++;
+}
+
+void CudaGraphCache::invalidateModel(const std::string& modelId, int deviceId) {
+    std::vector<std::shared_ptr<CudaGraph>> dropped;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto it = m_graphs.begin(); it != m_graphs.end();) {
+            if (it->first.modelId == modelId && (deviceId < 0 || it->first.deviceId == deviceId)) {
+                dropped.push_back(std::move(it->second.graph));
+                it = m_graphs.erase(it);
+                m_stats.invalidations++;
+            } else {
+                ++it;
+            }
+        }
+    }
+}
+
+void CudaGraphCache::clear() {
+    std::vector<std::shared_ptr<CudaGraph>> dropped;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto& pair : m_graphs) {
+            dropped.push_back(std::move(pair.second.graph));
+        }
+        m_graphs.clear();
+    }
+}
+
+void CudaGraphCache::evictLocked(std::vector<std::shared_ptr<CudaGraph>>& dropped) {
+    while (m_graphs.size() > m_config.maxGraphs) {
+        auto oldest = m_graphs.begin();
+        for (auto it = m_graphs.begin(); it != m_graphs.end(); ++it) {
+            if (it->second.lastUsed < oldest->second.lastUsed) {
+                oldest = it;
+            }
+        }
+        dropped.push_back(std::move(oldest->second.graph));
+        m_graphs.erase(oldest);
+        m_stats.evictions++;
+    }
+}
+
+CudaGraphStats CudaGraphCache::getStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    CudaGraphStats stats = m_stats;
+    stats.cachedGraphs = m_graphs.size();
+    for (const auto& pair : m_graphs) {
+        stats.workspaceBytes += pair.second.graph->workspaceBytes;
+    }
+    return stats;
+}
+
+} // namespace AIForge
@@ -0,0 +1,162 @@
+/**
+ * @file cuda_graph_cache.h
+ * @brief Cache of captured CUDA graphs for fixed-shape step loops
+ *
+ * A diffusion denoising step launches dozens of kernels, and at 512x512 the
+ * launch and host-sync overhead is a large share of the step time. The step
+ * has the same shape on every iteration, so it is captured into a CUDA graph
+ * once and replayed with a single cudaGraphLaunch per step.
+ *
+ * A graph bakes in every pointer it touches, so each cached graph owns its
+ * workspace for its whole lifetime and is replayed by one request at a
+ * time; concurrent requests of the same shape get their own instances.
+ * Graphs of a model are dropped whenever its weights move.
+ *
+ * Features:
+ * - Keyed by model, device, resolution, batch size and precision
+ * - Graph-owned workspace with stable addresses across replays
+ * - Exclusive checkout, one instance per concurrent request
+ * - Least-recently-used eviction beyond a configured graph count
+ * - Invalidation per model (and device) on eviction, unload or rebuild
+ */
+
+#ifndef CUDA_GRAPH_CACHE_H
+#define CUDA_GRAPH_CACHE_H
+
+#include "ai_engine.h"
+#include <string>
+#include <map>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <functional>
+#include <cstdint>
+
+namespace AIForge {
+
+/**
+ * @struct CudaGraphKey
+ * @brief Identifies a captured step graph
+ */
+struct CudaGraphKey {
+    std::string modelId;
+    int deviceId = 0;
+    int width = 0;
+    int height = 0;
+    int batchSize = 1;
+    PrecisionMode precision = PrecisionMode::FP16;
+
+    bool operator<(const CudaGraphKey& other) const;
+};
+
+/**
+ * @struct CudaGraph
+ * @brief An instantiated graph and the memory it was captured against
+ */
+struct CudaGraph {
+    void* graphExec = nullptr;      // cudaGraphExec_t
+    void* workspace = nullptr;      // Device memory referenced by the graph
+    size_t workspaceBytes = 0;
+    int deviceId = 0;
+    bool inUse = false;             // Checked out by a request (cache lock)
+};
+
+/**
+ * @class CudaGraphCache
+ * @brief In-memory store of instantiated step graphs
+ */
+class CudaGraphCache {
+public:
+    /**
+     * @brief Records one step into a graph; returns false if capture failed
+     */
+    using CaptureFunction = std::function<bool(CudaGraph& graph)>;
+
+    /**
+     * @brief Destroys a graph and frees its workspace
+     */
+    using ReleaseFunction = std::function<void(CudaGraph& graph)>;
+
+    /**
+     * @brief Construct cache
+     * @param release Called once for every graph when its last user lets go
+     */
+    explicit CudaGraphCache(ReleaseFunction release);
+    ~CudaGraphCache();
+
+    // Disable copy and move
+    CudaGraphCache(const CudaGraphCache&) = delete;
+    CudaGraphCache& operator=(const CudaGraphCache&) = delete;
+    CudaGraphCache(CudaGraphCache&&) = delete;
+    CudaGraphCache& operator=(CudaGraphCache&&) = delete;
+
+    /**
+     * @brief Apply configuration (a lower graph limit evicts immediately)
+     * @param config Graph cache configuration
+     */
+    void setConfig(const CudaGraphConfig& config);
+
+    /**
+     * @brief Check out an idle graph for a key, capturing a new one if none is idle
+     *
+     * The graph belongs to the caller until the returned handle is dropped,
+     * and stays valid until then even if it is invalidated or evicted.
+     *
+     * @param key Graph key
+     * @param capture Records the step (called without the cache lock)
+     * @return Graph handle, or nullptr if disabled or capture failed
+     */
+    std::shared_ptr<CudaGraph> getOrCapture(const CudaGraphKey& key, const CaptureFunction& capture);
+
+    /**
+     * @brief Record one replay of a cached graph
+     */
+    void recordReplay();
+
+    /**
+     * @brief Drop the graphs of a model
+     * @param modelId Model ID
+     * @param deviceId Device to drop (-1 = all devices)
+     */
+    void invalidateModel(const std::string& modelId, int deviceId = -1);
+
+    /**
+     * @brief Drop every graph
+     */
+    void clear();
+
+    /**
+     * @brief Get graph cache statistics
+     * @return CudaGraphStats structure
+     */
+    CudaGraphStats getStats() const;
+
+private:
+    struct Entry {
+        std::shared_ptr<CudaGraph> graph;
+        uint64_t lastUsed = 0;
+    };
+
+    ReleaseFunction m_release;
+    CudaGraphConfig m_config;
+    std::multimap<CudaGraphKey, Entry> m_graphs;
+    uint64_t m_clock;
+    CudaGraphStats m_stats;
+
+    mutable std::mutex m_mutex;
+
+    /**
+     * @brief Wrap a graph in a handle that checks it back in when dropped
+     */
+    std::shared_ptr<CudaGraph> checkOut(const std::shared_ptr<CudaGraph>& graph);
+
+    /**
+     * @brief Evict least-recently-used graphs down to maxGraphs (lock must be held)
+     * @param dropped Receives the evicted graphs, to be released after unlocking
+     */
+    void evictLocked(std::vector<std::shared_ptr<CudaGraph>>& dropped);
+};
+
+} // namespace AIForge
+
+#endif // CUDA_GRAPH_CACHE_H
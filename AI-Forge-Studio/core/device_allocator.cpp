@@ -0,0 +1,224 @@
+/**
+ * @file device_allocator.cpp
+ * @brief Implementation of the caching GPU memory allocator
+ */
+
+#include "device_allocator.h"
+#include "logger.h"
+#include <algorithm>
+#include <vector>
+
+namespace AIForge {
+
+namespace {
+constexpr size_t MIN_BLOCK_SIZE = 512;
+constexpr size_t SMALL_SIZE_LIMIT = 1024 * 1024;
+constexpr size_t LARGE_ROUNDING = 2 * 1024 * 1024;
+}
+
+DeviceAllocator::DeviceAllocator(int deviceId, RawAllocFunction rawAlloc, RawFreeFunction rawFree)
+    : m_deviceId(deviceId)
+    , m_rawAlloc(std::move(rawAlloc))
+    , m_rawFree(std::move(rawFree))
+{
+}
+
+DeviceAllocator::~DeviceAllocator() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    trimLocked(0);
+
+    if (!m_activeBlocks.empty()) {
+        // Still owned by their callers; they are freed with the raw free later
+        LOG_WARNING("DeviceAllocator", "Device " + std::to_string(m_deviceId) + ": " +
+                    std::to_string(m_activeBlocks.size()) + " blocks still in use at shutdown");
+    }
+}
+
+void DeviceAllocator::setConfig(const DeviceAllocatorConfig& config) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_config = config;
+    trimLocked(config.enabled ? config.maxCachedMB * 1024 * 1024 : 0);
+}
+
+size_t DeviceAllocator::roundSize(size_t size) {
+    if (size <= MIN_BLOCK_SIZE) {
+        return MIN_BLOCK_SIZE;
+    }
+    if (size <= SMALL_SIZE_LIMIT) {
+        return (size + MIN_BLOCK_SIZE - 1) / MIN_BLOCK_SIZE * MIN_BLOCK_SIZE;
+    }
+    return (size + LARGE_ROUNDING - 1) / LARGE_ROUNDING * LARGE_ROUNDING;
+}
+
+void* DeviceAllocator::takeCachedLocked(size_t blockSize, void* stream, size_t& foundSize) {
+    auto poolIt = m_freeBlocks.find(stream);
+    if (poolIt == m_freeBlocks.end()) {
+        return nullptr;
+    }
+
+    // Best fit, but never hand out a block more than 25% larger than needed
+    auto& pool = poolIt->second;
+    auto it = pool.lower_bound(blockSize);
+    if (it == pool.end() || it->first > blockSize + blockSize / 4) {
+        return nullptr;
+    }
+
+    void* ptr = it->second;
+    foundSize = it->first;
+    pool.erase(it);
+    return ptr;
+}
+
+void* DeviceAllocator::allocate(size_t size, void* stream) {
+    if (size == 0) {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.allocations++;
+
+    const size_t blockSize = roundSize(size);
+
+    size_t cachedSize = 0;
+    void* ptr = m_config.enabled ? takeCachedLocked(blockSize, stream, cachedSize) : nullptr;
+    if (ptr) {
+        m_stats.cacheHits++;
+        Block& block = m_activeBlocks[ptr];
+        block.size = cachedSize;
+        block.requested = size;
+        block.stream = stream;
+        m_stats.cachedBytes -= block.size;
+        m_stats.allocatedBytes += block.size;
+        m_stats.requestedBytes += size;
+        return ptr;
+    }
+
+    ptr = m_rawAlloc(blockSize);
+    if (!ptr && m_stats.cachedBytes > 0) {
+        // Out of memory: give the cache back to the driver and retry once
+        LOG_WARNING("DeviceAllocator", "Allocation of " + std::to_string(blockSize) +
+                    " bytes failed, releasing cache and retrying");
+        trimLocked(0);
+        ptr = m_rawAlloc(blockSize);
+    }
+    if (!ptr) {
+        m_stats.failedAllocations++;
+        return nullptr;
+    }
+
+    m_stats.deviceAllocations++;
+    Block block;
+    block.size = blockSize;
+    block.requested = size;
+    block.stream = stream;
+    m_activeBlocks[ptr] = block;
+
+    m_stats.reservedBytes += blockSize;
+    m_stats.peakReservedBytes = std::max(m_stats.peakReservedBytes, m_stats.reservedBytes);
+    m_stats.allocatedBytes += blockSize;
+    m_stats.requestedBytes += size;
+    return ptr;
+}
+
+bool DeviceAllocator::free(void* ptr) {
+    if (!ptr) {
+        return true;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_activeBlocks.find(ptr);
+    if (it == m_activeBlocks.end()) {
+        return false;
+    }
+
+    Block block = it->second;
+    m_activeBlocks.erase(it);
+    m_stats.allocatedBytes -= block.size;
+    m_stats.requestedBytes -= block.requested;
+
+    if (!m_config.enabled) {
+        m_rawFree(ptr);
+        m_stats.deviceFrees++;
+        m_stats.reservedBytes -= block.size;
+        return true;
+    }
+
+    // In production, memory used on another stream needs recordStream-style
+    // events before reuse; keeping pools per allocating stream avoids that
+    // for the common case of one stream per worker
+    m_freeBlocks[block.stream].emplace(block.size, ptr);
+    m_stats.cachedBytes += block.size;
+
+    const size_t limit = m_config.maxCachedMB * 1024 * 1024;
+    if (m_stats.cachedBytes > limit) {
+        trimLocked(limit);
+    }
+    return true;
+}
+
+void DeviceAllocator::trim(size_t keepBytes) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    size_t before = m_stats.cachedBytes;
+    trimLocked(keepBytes);
+    m_stats.trims++;
+
+    if (before > m_stats.cachedBytes) {
+        LOG_INFO("DeviceAllocator", "Device " + std::to_string(m_deviceId) + ": released " +
+                 std::to_string((before - m_stats.cachedBytes) / (1024 * 1024)) + " MB of cached memory");
+    }
+}
+
+void DeviceAllocator::trimLocked(size_t keepBytes) {
+    if (m_stats.cachedBytes <= keepBytes) {
+        return;
+    }
+
+    // Largest blocks first: fewest driver calls for the most memory
+    struct Cached {
+        size_t size;
+        void* stream;
+        std::multimap<size_t, void*>::iterator it;
+    };
+    std::vector<Cached> cached;
+    for (auto& pool : m_freeBlocks) {
+        for (auto it = pool.second.begin(); it != pool.second.end(); ++it) {
+            cached.push_back({it->first, pool.first, it});
+        }
+    }
+    std::sort(cached.begin(), cached.end(), [](const Cached& a, const Cached& b) {
+        return a.size > b.size;
+    });
+
+    for (const auto& entry : cached) {
+        if (m_stats.cachedBytes <= keepBytes) {
+            break;
+        }
+        m_rawFree(entry.it->second);
+        m_freeBlocks[entry.stream].erase(entry.it);
+        m_stats.deviceFrees++;
+        m_stats.cachedBytes -= entry.size;
+        m_stats.reservedBytes -= entry.size;
+    }
+
+    for (auto it = m_freeBlocks.begin(); it != m_freeBlocks.end();) {
+        it = it->second.empty() ? m_freeBlocks.erase(it) : std::next(it);
+    }
+}
+
+DeviceAllocatorStats DeviceAllocator::getStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    DeviceAllocatorStats stats = m_stats;
+
+    // Share of reserved memory not backing a caller's bytes: cached blocks
+    // plus rounding slack inside blocks in use
+    if (stats.reservedBytes > 0) {
+        stats.fragmentation = 1.0f - static_cast<float>(stats.requestedBytes) /
+                                     static_cast<float>(stats.reservedBytes);
+    }
+    if (stats.allocations > 0) {
+        stats.cacheHitRate = static_cast<float>(stats.cacheHits) / stats.allocations;
+    }
+    return stats;
+}
+
+} // namespace AIForge
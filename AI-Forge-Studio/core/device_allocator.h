@@ -0,0 +1,140 @@
+/**
+ * @file device_allocator.h
+ * @brief Caching GPU memory allocator
+ *
+ * cudaMalloc and cudaFree synchronize the device, so allocating activation
+ * and I/O buffers per inference step stalls the pipeline. This allocator
+ * keeps freed blocks in per-stream pools and hands them out again without
+ * touching the driver.
+ *
+ * Features:
+ * - Size classes: 512 B granularity up to 1 MB, 2 MB granularity above
+ * - Best-fit reuse with bounded internal fragmentation
+ * - Per-stream free lists, so reuse never needs cross-stream synchronization
+ * - Cache size limit, OOM retry after releasing the cache, explicit trim()
+ * - Reserved / in-use / requested byte accounting for fragmentation stats
+ */
+
+#ifndef DEVICE_ALLOCATOR_H
+#define DEVICE_ALLOCATOR_H
+
+#include "ai_engine.h"
+#include <map>
+#include <unordered_map>
+#include <mutex>
+#include <functional>
+
+namespace AIForge {
+
+/**
+ * @class DeviceAllocator
+ * @brief Size-class caching allocator for one CUDA device
+ */
+class DeviceAllocator {
+public:
+    /**
+     * @brief Raw device allocation function (cudaMalloc in production)
+     */
+    using RawAllocFunction = std::function<void*(size_t)>;
+
+    /**
+     * @brief Raw device free function (cudaFree in production)
+     */
+    using RawFreeFunction = std::function<void(void*)>;
+
+    /**
+     * @brief Construct allocator for a device
+     * @param deviceId GPU device ID
+     * @param rawAlloc Uncached allocation function
+     * @param rawFree Uncached free function
+     */
+    DeviceAllocator(int deviceId, RawAllocFunction rawAlloc, RawFreeFunction rawFree);
+
+    /**
+     * @brief Release all cached blocks (blocks still in use are left alone)
+     */
+    ~DeviceAllocator();
+
+    // Disable copy and move
+    DeviceAllocator(const DeviceAllocator&) = delete;
+    DeviceAllocator& operator=(const DeviceAllocator&) = delete;
+    DeviceAllocator(DeviceAllocator&&) = delete;
+    DeviceAllocator& operator=(DeviceAllocator&&) = delete;
+
+    /**
+     * @brief Apply configuration (a lower cache limit trims immediately)
+     * @param config Allocator configuration
+     */
+    void setConfig(const DeviceAllocatorConfig& config);
+
+    /**
+     * @brief Allocate device memory
+     * @param size Size in bytes
+     * @param stream Stream the memory will be used on (nullptr = default stream)
+     * @return Device pointer, or nullptr if out of memory
+     */
+    void* allocate(size_t size, void* stream = nullptr);
+
+    /**
+     * @brief Return memory to the cache of the stream it was allocated on
+     * @param ptr Pointer from allocate()
+     * @return false if the pointer was not allocated here
+     */
+    bool free(void* ptr);
+
+    /**
+     * @brief Release cached blocks back to the driver
+     * @param keepBytes Cached bytes to retain (largest blocks are released first)
+     */
+    void trim(size_t keepBytes = 0);
+
+    /**
+     * @brief Get allocator statistics
+     * @return DeviceAllocatorStats structure
+     */
+    DeviceAllocatorStats getStats() const;
+
+    /**
+     * @brief Round a request up to its size class
+     * @param size Requested size in bytes
+     * @return Block size that will be reserved
+     */
+    static size_t roundSize(size_t size);
+
+private:
+    struct Block {
+        size_t size = 0;            // Rounded block size
+        size_t requested = 0;       // Caller's size while in use
+        void* stream = nullptr;
+    };
+
+    int m_deviceId;
+    RawAllocFunction m_rawAlloc;
+    RawFreeFunction m_rawFree;
+    DeviceAllocatorConfig m_config;
+
+    std::unordered_map<void*, Block> m_activeBlocks;
+    // Per stream: block size -> cached pointer
+    std::map<void*, std::multimap<size_t, void*>> m_freeBlocks;
+    DeviceAllocatorStats m_stats;
+
+    mutable std::mutex m_mutex;
+
+    /**
+     * @brief Find a cached block (lock must be held)
+     * @param blockSize Rounded size needed
+     * @param stream Stream whose pool to search
+     * @param foundSize Receives the size of the block found
+     * @return Pointer, or nullptr on miss
+     */
+    void* takeCachedLocked(size_t blockSize, void* stream, size_t& foundSize);
+
+    /**
+     * @brief Release cached blocks until at most keepBytes remain (lock must be held)
+     */
+    void trimLocked(size_t keepBytes);
+};
+
+} // namespace AIForge
+
+#endif // DEVICE_ALLOCATOR_H
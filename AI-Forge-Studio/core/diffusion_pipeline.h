@@ -0,0 +1,175 @@
+/**
+ * @file diffusion_pipeline.h
+ * @brief Staged text-to-image pipeline overlapping requests across streams
+ *
+ * Running a request as "encode, N UNet steps, decode" on one stream leaves
+ * the GPU idle between the stages and between requests: the text encoder
+ * and the VAE are small kernels waiting on host work, and the D2H copy of
+ * the image shares nothing with the next request's encode. The pipeline
+ * gives each stage its own thread and stream, so request N+1 is encoded and
+ * request N-1 decoded and copied back while request N denoises. Bounded
+ * queues between the stages keep a fast stage from running ahead and
+ * holding the memory of jobs the UNet cannot reach yet.
+ *
+ * Features:
+ * - Three stages (text encoder, UNet, VAE decode + D2H) on separate streams
+ * - Bounded inter-stage queues with backpressure
+ * - Per-stage busy, idle and blocked time for finding bubbles
+ * - Cancellation of queued and running jobs
+ *
+ * Thread-safe: submit, cancel, setConfig and getStats may be called from
+ * any thread. Stages and callbacks run on the stage threads.
+ */
+
+#ifndef DIFFUSION_PIPELINE_H
+#define DIFFUSION_PIPELINE_H
+
+#include "ai_engine.h"
+#include "model_registry.h"
+#include "model_residency.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+
+namespace AIForge {
+
+/**
+ * @struct DiffusionJob
+ * @brief One request travelling through the pipeline's stages
+ */
+struct DiffusionJob {
+    uint64_t jobId = 0;
+    std::string modelId;
+    std::string prompt;
+    InferenceConfig config;
+    ImageJobCallbacks callbacks;
+    std::chrono::steady_clock::time_point submitTime;
+    std::atomic<bool> cancelled{false};
+
+    // Set by the stages; the model stays resident until the job is delivered
+    ModelHandle model;
+    std::vector<ResidencyLease> leases;
+    int deviceId = -1;
+    std::vector<uint16_t> embeddings;       // Text encoder output
+    std::vector<uint16_t> latents;          // UNet output
+    std::vector<unsigned char> image;       // VAE output
+    InferenceResult result;                 // errorMessage set by a failing stage
+};
+
+/**
+ * @class DiffusionPipeline
+ * @brief Runs the stages of successive text-to-image jobs concurrently
+ */
+class DiffusionPipeline {
+public:
+    enum Stage { ENCODE, DENOISE, DECODE, STAGE_COUNT };
+
+    /**
+     * @brief Function running one stage of a job
+     *
+     * Receives the job and the stage's stream. Returns false (with
+     * job.result.errorMessage set) to fail the job; later stages are skipped.
+     */
+    using StageFunction = std::function<bool(DiffusionJob&, void*)>;
+
+    /**
+     * @brief Construct a pipeline from its stage functions
+     * @param encode Tokenizer and text encoder
+     * @param denoise UNet steps
+     * @param decode VAE decode and copy back; fills job.result on success
+     */
+    DiffusionPipeline(StageFunction encode, StageFunction denoise, StageFunction decode);
+    ~DiffusionPipeline();
+
+    // Disable copy and move
+    DiffusionPipeline(const DiffusionPipeline&) = delete;
+    DiffusionPipeline& operator=(const DiffusionPipeline&) = delete;
+    DiffusionPipeline(DiffusionPipeline&&) = delete;
+    DiffusionPipeline& operator=(DiffusionPipeline&&) = delete;
+
+    /**
+     * @brief Start the stage threads
+     * @param config Queue limits
+     */
+    void start(const DiffusionPipelineConfig& config);
+
+    /**
+     * @brief Stop the stage threads and fail every unfinished job
+     */
+    void stop();
+
+    /**
+     * @brief Check if the stage threads are running
+     */
+    bool isRunning() const;
+
+    /**
+     * @brief Update queue limits
+     */
+    void setConfig(const DiffusionPipelineConfig& config);
+
+    /**
+     * @brief Queue a job for the text encoder
+     * @param job Job with its ID, request and callbacks set
+     * @return false if stopped or full (finished has then been called)
+     */
+    bool submit(std::unique_ptr<DiffusionJob> job);
+
+    /**
+     * @brief Cancel a queued or running job
+     * @param jobId ID of the job
+     * @return true if found; it finishes with "Cancelled" at its next check
+     */
+    bool cancel(uint64_t jobId);
+
+    /**
+     * @brief Get pipeline counters
+     */
+    DiffusionPipelineStats getStats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+    using JobPtr = std::unique_ptr<DiffusionJob>;
+
+    struct StageState {
+        StageFunction run;
+        std::deque<JobPtr> queue;           // Input of the stage
+        std::condition_variable hasInput;
+        std::condition_variable hasRoom;
+        PipelineStageStats stats;
+        double busyMs = 0.0;
+        double idleMs = 0.0;
+        double blockedMs = 0.0;
+        std::thread thread;
+    };
+
+    void stageLoop(int stage);
+
+    // Capacity of a stage's input queue
+    size_t capacity(int stage) const;
+
+    void deliver(JobPtr job, bool success);
+
+    DiffusionPipelineConfig m_config;
+    std::array<StageState, STAGE_COUNT> m_stages;
+    std::unordered_map<uint64_t, DiffusionJob*> m_live;    // Submitted and not yet delivered
+    DiffusionPipelineStats m_stats;
+    double m_latencyMs;
+    Clock::time_point m_startTime;
+    bool m_running;
+    mutable std::mutex m_mutex;
+};
+
+} // namespace AIForge
+
+#endif // DIFFUSION_PIPELINE_H
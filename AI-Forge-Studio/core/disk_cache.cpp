@@ -0,0 +1,270 @@
+/**
+ * @file disk_cache.cpp
+ * @brief Implementation of the directory-backed LRU entry store
+ */
+
+#include "disk_cache.h"
+#include "logger.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace AIForge {
+
+namespace {
+constexpr uint32_t MAX_KEY_LENGTH = 65536;
+constexpr uint64_t FNV_PRIME = 0x100000001b3ULL;
+}
+
+DiskCache::DiskCache(const char* module, const char* magic, uint32_t version, const char* extension)
+    : m_module(module)
+    , m_version(version)
+    , m_extension(extension)
+    , m_maxBytes(0)
+    , m_totalBytes(0)
+{
+    std::memcpy(m_magic, magic, sizeof(m_magic));
+}
+
+bool DiskCache::open(const std::string& directory, size_t maxBytes) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_directory.clear();
+    m_entries.clear();
+    m_index.clear();
+    m_totalBytes = 0;
+    m_maxBytes = maxBytes;
+
+    std::error_code ec;
+    fs::create_directories(directory, ec);
+    if (ec || !fs::is_directory(directory, ec)) {
+        LOG_WARNING(m_module, "Cannot use cache directory: " + directory);
+        return false;
+    }
+
+    // The only directory scan: order what is there by last use
+    struct Found {
+        std::string fileName;
+        uint64_t size;
+        fs::file_time_type lastUsed;
+    };
+    std::vector<Found> found;
+    for (const auto& item : fs::directory_iterator(directory, ec)) {
+        if (!item.is_regular_file(ec) || item.path().extension() != m_extension) {
+            continue;
+        }
+        found.push_back({item.path().filename().string(), item.file_size(ec), item.last_write_time(ec)});
+    }
+    std::sort(found.begin(), found.end(), [](const Found& a, const Found& b) {
+        return a.lastUsed > b.lastUsed;
+    });
+
+    m_directory = directory;
+    for (const Found& entry : found) {
+        m_entries.push_back(Entry{entry.fileName, entry.size});
+        m_index[entry.fileName] = std::prev(m_entries.end());
+        m_totalBytes += entry.size;
+    }
+
+    LOG_INFO(m_module, "Cache at " + directory + ": " + std::to_string(m_entries.size()) +
+             " entries, " + std::to_string(m_totalBytes / (1024 * 1024)) + " of " +
+             std::to_string(maxBytes / (1024 * 1024)) + " MB");
+    evictLocked(maxBytes);
+    return true;
+}
+
+void DiskCache::close() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_directory.clear();
+    m_entries.clear();
+    m_index.clear();
+    m_totalBytes = 0;
+}
+
+bool DiskCache::isOpen() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return !m_directory.empty();
+}
+
+std::string DiskCache::pathOf(const std::string& fileName) const {
+    return (fs::path(m_directory) / fileName).string();
+}
+
+bool DiskCache::load(const std::string& fileName, const std::string& key, const BodyReader& readBody) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_directory.empty()) {
+        return false;
+    }
+
+    std::string path = pathOf(fileName);
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        m_stats.misses++;
+        return false;
+    }
+
+    std::error_code ec;
+    const uintmax_t fileSize = fs::file_size(path, ec);
+
+    char magic[4];
+    uint32_t version = 0;
+    uint32_t keyLength = 0;
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(&version), sizeof(version));
+    file.read(reinterpret_cast<char*>(&keyLength), sizeof(keyLength));
+
+    std::string storedKey;
+    bool valid = file && !ec && std::equal(magic, magic + 4, m_magic) &&
+                 version == m_version && keyLength < MAX_KEY_LENGTH;
+    if (valid) {
+        storedKey.resize(keyLength);
+        file.read(&storedKey[0], keyLength);
+        valid = static_cast<bool>(file);
+    }
+    if (valid && storedKey != key) {
+        // Another key hashed to this name: leave its entry alone
+        m_stats.misses++;
+        return false;
+    }
+    if (valid) {
+        const uintmax_t headerSize = static_cast<uintmax_t>(file.tellg());
+        valid = headerSize <= fileSize && readBody(file, fileSize - headerSize);
+    }
+    file.close();
+
+    if (!valid) {
+        // Corrupt or stale entry: drop it so the next store replaces it
+        LOG_WARNING(m_module, "Discarding invalid cache entry: " + path);
+        fs::remove(path, ec);
+        forgetLocked(fileName);
+        m_stats.misses++;
+        return false;
+    }
+
+    auto it = m_index.find(fileName);
+    if (it != m_index.end()) {
+        m_entries.splice(m_entries.begin(), m_entries, it->second);
+    } else {
+        // Written by another process since open
+        trackLocked(fileName, fileSize);
+    }
+    fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+
+    m_stats.hits++;
+    return true;
+}
+
+bool DiskCache::store(const std::string& fileName, const std::string& key, const BodyWriter& writeBody) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_directory.empty()) {
+        return false;
+    }
+
+    std::string path = pathOf(fileName);
+    std::string tempPath = path + ".tmp";
+    uint64_t size = 0;
+
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            LOG_ERROR(m_module, "Cannot write cache entry: " + tempPath);
+            return false;
+        }
+
+        uint32_t keyLength = static_cast<uint32_t>(key.size());
+        file.write(m_magic, sizeof(m_magic));
+        file.write(reinterpret_cast<const char*>(&m_version), sizeof(m_version));
+        file.write(reinterpret_cast<const char*>(&keyLength), sizeof(keyLength));
+        file.write(key.data(), keyLength);
+        writeBody(file);
+        size = static_cast<uint64_t>(file.tellp());
+
+        if (!file) {
+            LOG_ERROR(m_module, "Failed writing cache entry: " + tempPath);
+            file.close();
+            std::error_code ec;
+            fs::remove(tempPath, ec);
+            return false;
+        }
+    }
+
+    // Rename is atomic, so readers never see a partially written entry
+    std::error_code ec;
+    fs::rename(tempPath, path, ec);
+    if (ec) {
+        LOG_ERROR(m_module, "Failed to commit cache entry: " + path);
+        fs::remove(tempPath, ec);
+        return false;
+    }
+
+    forgetLocked(fileName);
+    trackLocked(fileName, size);
+    m_stats.stores++;
+    evictLocked(m_maxBytes);
+    return true;
+}
+
+void DiskCache::evictToSize(size_t maxBytes) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    evictLocked(maxBytes);
+}
+
+DiskCacheStats DiskCache::getStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    DiskCacheStats stats = m_stats;
+    stats.entries = m_entries.size();
+    stats.sizeBytes = static_cast<size_t>(m_totalBytes);
+    return stats;
+}
+
+void DiskCache::trackLocked(const std::string& fileName, uint64_t size) {
+    m_entries.push_front(Entry{fileName, size});
+    m_index[fileName] = m_entries.begin();
+    m_totalBytes += size;
+}
+
+void DiskCache::forgetLocked(const std::string& fileName) {
+    auto it = m_index.find(fileName);
+    if (it == m_index.end()) {
+        return;
+    }
+    m_totalBytes -= it->second->size;
+    m_entries.erase(it->second);
+    m_index.erase(it);
+}
+
+void DiskCache::evictLocked(size_t maxBytes) {
+    std::error_code ec;
+    while (m_totalBytes > maxBytes && !m_entries.empty()) {
+        const Entry& victim = m_entries.back();
+        // Dropped from the index even if removal fails, so one stuck file
+        // cannot stall eviction
+        fs::remove(pathOf(victim.fileName), ec);
+        LOG_INFO(m_module, "Evicted " + victim.fileName);
+        m_totalBytes -= victim.size;
+        m_index.erase(victim.fileName);
+        m_entries.pop_back();
+        m_stats.evictions++;
+    }
+}
+
+uint64_t DiskCache::fnv1a(const void* data, size_t size, uint64_t hash) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+std::string DiskCache::toHex(uint64_t hash) {
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(hash));
+    return hex;
+}
+
+} // namespace AIForge
@@ -0,0 +1,175 @@
+/**
+ * @file disk_cache.h
+ * @brief Size-bounded directory of self-validating cache entries
+ *
+ * The engine cache and the generated image cache store different payloads
+ * the same way: one file per key, a header carrying the full key so a
+ * stale or colliding file is recognized, atomic replacement, and eviction
+ * of the least recently used files beyond a size limit. DiskCache is that
+ * shared part; its owners choose the file names and encode the bodies.
+ *
+ * Entry layout: magic (4 bytes), format version (uint32), key length
+ * (uint32), key string, then the owner's body. The directory is scanned
+ * once when opened; afterwards sizes and recency are tracked in memory,
+ * and hits refresh the file modification time so the order survives
+ * restarts.
+ *
+ * Features:
+ * - Header validation and atomic writes (temporary file, then rename)
+ * - O(1) least-recently-used bookkeeping with a running size total
+ * - 64-bit FNV-1a hashing for content hashes and file names
+ *
+ * Thread-safe: every member may be called from any thread.
+ */
+
+#ifndef DISK_CACHE_H
+#define DISK_CACHE_H
+
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace AIForge {
+
+/**
+ * @struct DiskCacheStats
+ * @brief Counters and current contents of a DiskCache
+ */
+struct DiskCacheStats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t stores = 0;
+    size_t evictions = 0;
+    size_t entries = 0;
+    size_t sizeBytes = 0;
+};
+
+/**
+ * @class DiskCache
+ * @brief Least-recently-used store of entry files in one directory
+ */
+class DiskCache {
+public:
+    /**
+     * @brief Read an entry body
+     *
+     * Called with the stream positioned after the key and the number of
+     * bytes left in the file; returns false if the body is invalid.
+     */
+    using BodyReader = std::function<bool(std::istream&, uint64_t)>;
+
+    /**
+     * @brief Write an entry body after the header
+     */
+    using BodyWriter = std::function<void(std::ostream&)>;
+
+    /**
+     * @param module Name used in log messages
+     * @param magic Four bytes identifying the owner's entries
+     * @param version Body format version; entries of other versions are dropped
+     * @param extension Entry file extension, including the dot
+     */
+    DiskCache(const char* module, const char* magic, uint32_t version, const char* extension);
+    ~DiskCache() = default;
+
+    // Disable copy and move
+    DiskCache(const DiskCache&) = delete;
+    DiskCache& operator=(const DiskCache&) = delete;
+    DiskCache(DiskCache&&) = delete;
+    DiskCache& operator=(DiskCache&&) = delete;
+
+    /**
+     * @brief Use a directory, creating it, and index the entries in it
+     * @param directory Cache directory
+     * @param maxBytes Size limit; existing entries beyond it are evicted
+     * @return true if the directory is usable
+     */
+    bool open(const std::string& directory, size_t maxBytes);
+
+    /**
+     * @brief Stop using the directory (entries stay on disk)
+     */
+    void close();
+
+    /**
+     * @brief Check if a directory is open
+     */
+    bool isOpen() const;
+
+    /**
+     * @brief Load an entry
+     * @param fileName Entry file name (without directory)
+     * @param key Full key; an entry stored under another key is a miss
+     * @param readBody Reads and validates the body
+     * @return true on hit
+     */
+    bool load(const std::string& fileName, const std::string& key, const BodyReader& readBody);
+
+    /**
+     * @brief Store an entry, replacing any with the same file name, then
+     *        evict down to the size limit
+     * @param fileName Entry file name (without directory)
+     * @param key Full key
+     * @param writeBody Writes the body
+     * @return true if stored
+     */
+    bool store(const std::string& fileName, const std::string& key, const BodyWriter& writeBody);
+
+    /**
+     * @brief Remove least-recently-used entries until under a size
+     * @param maxBytes Size in bytes
+     */
+    void evictToSize(size_t maxBytes);
+
+    /**
+     * @brief Get counters and current contents
+     */
+    DiskCacheStats getStats() const;
+
+    /**
+     * @brief Continue a 64-bit FNV-1a hash over more bytes
+     * @param hash Hash so far (FNV_OFFSET to start)
+     */
+    static uint64_t fnv1a(const void* data, size_t size, uint64_t hash = FNV_OFFSET);
+
+    /**
+     * @brief Format a 64-bit hash as 16 hex digits
+     */
+    static std::string toHex(uint64_t hash);
+
+    static constexpr uint64_t FNV_OFFSET = 0xcbf29ce484222325ULL;
+
+private:
+    struct Entry {
+        std::string fileName;
+        uint64_t size;
+    };
+
+    const char* m_module;
+    char m_magic[4];
+    uint32_t m_version;
+    std::string m_extension;
+
+    std::string m_directory;        // Empty while closed
+    size_t m_maxBytes;
+    uint64_t m_totalBytes;
+    std::list<Entry> m_entries;     // Most recently used first
+    std::unordered_map<std::string, std::list<Entry>::iterator> m_index;
+    DiskCacheStats m_stats;
+    mutable std::mutex m_mutex;
+
+    std::string pathOf(const std::string& fileName) const;
+
+    // Index bookkeeping (lock must be held)
+    void trackLocked(const std::string& fileName, uint64_t size);
+    void forgetLocked(const std::string& fileName);
+    void evictLocked(size_t maxBytes);
+};
+
+} // namespace AIForge
+
+#endif // DISK_CACHE_H
@@ -0,0 +1,129 @@
+/**
+ * @file engine_cache.cpp
+ * @brief Implementation of the persistent engine cache
+ *
+ * Entry body (after the DiskCache header with magic "AFEC"): engine size
+ * (uint64), engine bytes.
+ */
+
+#include "engine_cache.h"
+#include "logger.h"
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <algorithm>
+#include <cstdint>
+
+namespace AIForge {
+
+namespace {
+constexpr char ENTRY_MAGIC[4] = {'A', 'F', 'E', 'C'};
+constexpr uint32_t ENTRY_VERSION = 1;
+constexpr const char* ENTRY_EXTENSION = ".engine";
+constexpr size_t HASH_CHUNK_SIZE = 4 * 1024 * 1024;
+}
+
+std::string EngineCacheKey::toFileName() const {
+    std::string cc = computeCapability;
+    std::replace(cc.begin(), cc.end(), '.', '_');
+    std::string trt = tensorrtVersion;
+    std::replace(trt.begin(), trt.end(), '.', '_');
+
+    return modelHash + "_" + precisionModeToString(precision) +
+           "_sm" + cc + "_trt" + trt + ENTRY_EXTENSION;
+}
+
+std::string EngineCacheKey::toString() const {
+    return modelHash + "|" + precisionModeToString(precision) + "|" +
+           computeCapability + "|" + tensorrtVersion;
+}
+
+EngineCache::EngineCache()
+    : m_store("EngineCache", ENTRY_MAGIC, ENTRY_VERSION, ENTRY_EXTENSION)
+{
+}
+
+bool EngineCache::configure(const EngineCacheConfig& config) {
+    if (!config.enabled) {
+        m_store.close();
+        return false;
+    }
+    return m_store.open(config.directory, config.maxSizeMB * 1024 * 1024);
+}
+
+std::string EngineCache::hashFile(const std::string& filepath) {
+    std::ifstream file(filepath, std::ios::binary);
+    if (!file.is_open()) {
+        return "";
+    }
+
+    uint64_t hash = DiskCache::FNV_OFFSET;
+    std::vector<char> buffer(HASH_CHUNK_SIZE);
+    while (file) {
+        file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        hash = DiskCache::fnv1a(buffer.data(), static_cast<size_t>(file.gcount()), hash);
+    }
+    return DiskCache::toHex(hash);
+}
+
+bool EngineCache::load(const EngineCacheKey& key, std::vector<char>& engineData) {
+    if (key.modelHash.empty()) {
+        return false;
+    }
+
+    bool hit = m_store.load(key.toFileName(), key.toString(),
+                            [&engineData](std::istream& file, uint64_t remaining) {
+        uint64_t engineSize = 0;
+        file.read(reinterpret_cast<char*>(&engineSize), sizeof(engineSize));
+        // A truncated or corrupt header must not size the allocation
+        if (!file || remaining < sizeof(engineSize) || engineSize != remaining - sizeof(engineSize)) {
+            return false;
+        }
+        engineData.resize(static_cast<size_t>(engineSize));
+        file.read(engineData.data(), static_cast<std::streamsize>(engineSize));
+        return static_cast<uint64_t>(file.gcount()) == engineSize;
+    });
+    if (!hit) {
+        engineData.clear();
+    }
+    return hit;
+}
+
+bool EngineCache::store(const EngineCacheKey& key, const std::vector<char>& engineData) {
+    if (key.modelHash.empty()) {
+        return false;
+    }
+
+    bool stored = m_store.store(key.toFileName(), key.toString(), [&engineData](std::ostream& file) {
+        uint64_t engineSize = engineData.size();
+        file.write(reinterpret_cast<const char*>(&engineSize), sizeof(engineSize));
+        file.write(engineData.data(), static_cast<std::streamsize>(engineData.size()));
+    });
+    if (stored) {
+        LOG_INFO("EngineCache", "Cached engine " + key.toFileName() + " (" +
+                 std::to_string(engineData.size() / 1024) + " KB)");
+    }
+    return stored;
+}
+
+void EngineCache::evictToSize(size_t maxBytes) {
+    m_store.evictToSize(maxBytes);
+}
+
+void EngineCache::clear() {
+    m_store.evictToSize(0);
+}
+
+EngineCacheStats EngineCache::getStats() const {
+    const DiskCacheStats store = m_store.getStats();
+    EngineCacheStats stats;
+    stats.hits = store.hits;
+    stats.misses = store.misses;
+    stats.stores = store.stores;
+    stats.evictions = store.evictions;
+    stats.entries = store.entries;
+    stats.sizeBytes = store.sizeBytes;
+    return stats;
+}
+
+} // namespace AIForge
@@ -0,0 +1,127 @@
+/**
+ * @file engine_cache.h
+ * @brief Persistent on-disk cache for optimized TensorRT engines
+ *
+ * Building a TensorRT engine from an ONNX or PyTorch model takes minutes;
+ * deserializing a cached one takes seconds. Engines are only valid for the
+ * exact model, precision, GPU architecture and TensorRT version they were
+ * built with, so all four form the cache key.
+ *
+ * Features:
+ * - Content hash of the model file (not its path or timestamp)
+ * - Self-validating, atomically written entries in a DiskCache
+ * - Size-bounded with least-recently-used eviction
+ */
+
+#ifndef ENGINE_CACHE_H
+#define ENGINE_CACHE_H
+
+#include "ai_engine.h"
+#include "disk_cache.h"
+#include <string>
+#include <vector>
+
+namespace AIForge {
+
+/**
+ * @struct EngineCacheKey
+ * @brief Identifies a serialized engine
+ */
+struct EngineCacheKey {
+    std::string modelHash;          // Content hash of the source model file
+    PrecisionMode precision = PrecisionMode::FP16;
+    std::string computeCapability;  // e.g. "12.0"
+    std::string tensorrtVersion;    // e.g. "8.6.1"
+
+    /**
+     * @brief Build the cache file name for this key
+     * @return File name (without directory)
+     */
+    std::string toFileName() const;
+
+    /**
+     * @brief Serialize the key for storage in the entry header
+     * @return Key string
+     */
+    std::string toString() const;
+};
+
+/**
+ * @class EngineCache
+ * @brief Directory-backed store of serialized engines
+ */
+class EngineCache {
+public:
+    EngineCache();
+    ~EngineCache() = default;
+
+    // Disable copy and move
+    EngineCache(const EngineCache&) = delete;
+    EngineCache& operator=(const EngineCache&) = delete;
+    EngineCache(EngineCache&&) = delete;
+    EngineCache& operator=(EngineCache&&) = delete;
+
+    /**
+     * @brief Apply configuration and create the cache directory
+     * @param config Cache configuration
+     * @return true if the cache is usable
+     */
+    bool configure(const EngineCacheConfig& config);
+
+    /**
+     * @brief Check if caching is enabled and the directory is usable
+     * @return true if enabled
+     */
+    bool isEnabled() const { return m_store.isOpen(); }
+
+    /**
+     * @brief Compute the content hash of a model file
+     *
+     * Streams the file through 64-bit FNV-1a in large chunks, so memory use
+     * stays constant regardless of model size.
+     *
+     * @param filepath Path to model file
+     * @return Hex digest, or empty string if the file cannot be read
+     */
+    static std::string hashFile(const std::string& filepath);
+
+    /**
+     * @brief Load a serialized engine
+     * @param key Cache key
+     * @param engineData Receives the serialized engine
+     * @return true on cache hit
+     */
+    bool load(const EngineCacheKey& key, std::vector<char>& engineData);
+
+    /**
+     * @brief Store a serialized engine, evicting old entries if needed
+     * @param key Cache key
+     * @param engineData Serialized engine
+     * @return true if stored
+     */
+    bool store(const EngineCacheKey& key, const std::vector<char>& engineData);
+
+    /**
+     * @brief Remove least-recently-used entries until under the size limit
+     * @param maxBytes Size limit in bytes
+     */
+    void evictToSize(size_t maxBytes);
+
+    /**
+     * @brief Remove all cache entries
+     */
+    void clear();
+
+    /**
+     * @brief Get cache statistics
+     * @return EngineCacheStats structure
+     */
+    EngineCacheStats getStats() const;
+
+private:
+    DiskCache m_store;
+};
+
+} // namespace AIForge
+
+#endif // ENGINE_CACHE_H
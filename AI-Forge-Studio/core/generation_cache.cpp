@@ -0,0 +1,175 @@
+/**
+ * @file generation_cache.cpp
+ * @brief Implementation of the embedding and generated image caches
+ *
+ * Image entry body (after the DiskCache header with magic "AFRC"): width,
+ * height, channels (int32 each), pixel size (uint64), pixels. File names
+ * are a hash of the key, so the header's key also catches collisions.
+ */
+
+#include "generation_cache.h"
+#include "logger.h"
+#include <istream>
+#include <ostream>
+
+namespace AIForge {
+
+namespace {
+constexpr char ENTRY_MAGIC[4] = {'A', 'F', 'R', 'C'};
+constexpr uint32_t ENTRY_VERSION = 1;
+constexpr const char* ENTRY_EXTENSION = ".img";
+}
+
+EmbeddingCache::EmbeddingCache()
+    : m_maxBytes(0)
+    , m_bytes(0)
+    , m_hits(0)
+    , m_misses(0)
+    , m_evictions(0)
+{
+}
+
+void EmbeddingCache::setCapacity(size_t maxBytes) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_maxBytes = maxBytes;
+    evictLocked(maxBytes);
+}
+
+bool EmbeddingCache::lookup(const std::string& key, std::vector<uint16_t>& output) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_maxBytes == 0) {
+        return false;
+    }
+
+    auto it = m_index.find(key);
+    if (it == m_index.end()) {
+        m_misses++;
+        return false;
+    }
+
+    // In production: a cudaMemcpyAsync device-to-device into the step's
+    // embedding buffer, on the caller's stream
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+    const std::vector<uint16_t>& data = it->second->data;
+    output.insert(output.end(), data.begin(), data.end());
+    m_hits++;
+    return true;
+}
+
+void EmbeddingCache::store(const std::string& key, const uint16_t* embedding, size_t elements) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const size_t bytes = elements * sizeof(uint16_t);
+    if (bytes > m_maxBytes || m_index.count(key)) {
+        return;
+    }
+
+    // In production: the copy lives in a block from the device allocator
+    evictLocked(m_maxBytes - bytes);
+    m_entries.push_front(Entry{key, std::vector<uint16_t>(embedding, embedding + elements)});
+    m_index[key] = m_entries.begin();
+    m_bytes += bytes;
+}
+
+void EmbeddingCache::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    evictLocked(0);
+}
+
+void EmbeddingCache::getStats(GenerationCacheStats& stats) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    stats.embeddingHits = m_hits;
+    stats.embeddingMisses = m_misses;
+    stats.embeddingEvictions = m_evictions;
+    stats.embeddingEntries = m_entries.size();
+    stats.embeddingBytes = m_bytes;
+}
+
+void EmbeddingCache::evictLocked(size_t maxBytes) {
+    while (m_bytes > maxBytes && !m_entries.empty()) {
+        m_bytes -= m_entries.back().data.size() * sizeof(uint16_t);
+        m_index.erase(m_entries.back().key);
+        m_entries.pop_back();
+        m_evictions++;
+    }
+}
+
+ResultCache::ResultCache()
+    : m_store("ResultCache", ENTRY_MAGIC, ENTRY_VERSION, ENTRY_EXTENSION)
+{
+}
+
+bool ResultCache::configure(const GenerationCacheConfig& config) {
+    if (!config.resultCacheEnabled) {
+        m_store.close();
+        return false;
+    }
+    return m_store.open(config.resultCacheDirectory, config.resultCacheMaxMB * 1024 * 1024);
+}
+
+bool ResultCache::isEnabled() const {
+    return m_store.isOpen();
+}
+
+std::string ResultCache::hashString(const std::string& text) {
+    return DiskCache::toHex(DiskCache::fnv1a(text.data(), text.size()));
+}
+
+bool ResultCache::load(const std::string& key, CachedImage& image) {
+    if (key.empty()) {
+        return false;
+    }
+
+    bool hit = m_store.load(hashString(key) + ENTRY_EXTENSION, key,
+                            [&image](std::istream& file, uint64_t remaining) {
+        int32_t dims[3] = {0, 0, 0};
+        uint64_t pixelSize = 0;
+        file.read(reinterpret_cast<char*>(dims), sizeof(dims));
+        file.read(reinterpret_cast<char*>(&pixelSize), sizeof(pixelSize));
+        const uint64_t headerSize = sizeof(dims) + sizeof(pixelSize);
+        if (!file || dims[0] <= 0 || dims[1] <= 0 || dims[2] <= 0 ||
+            pixelSize != static_cast<uint64_t>(dims[0]) * dims[1] * dims[2] ||
+            remaining < headerSize || pixelSize != remaining - headerSize) {
+            return false;
+        }
+        image.pixels.resize(static_cast<size_t>(pixelSize));
+        file.read(reinterpret_cast<char*>(image.pixels.data()), static_cast<std::streamsize>(pixelSize));
+        image.width = dims[0];
+        image.height = dims[1];
+        image.channels = dims[2];
+        return static_cast<uint64_t>(file.gcount()) == pixelSize;
+    });
+    if (!hit) {
+        image = CachedImage();
+    }
+    return hit;
+}
+
+bool ResultCache::store(const std::string& key, const CachedImage& image) {
+    if (key.empty() ||
+        image.pixels.size() != static_cast<size_t>(image.width) * image.height * image.channels) {
+        return false;
+    }
+
+    return m_store.store(hashString(key) + ENTRY_EXTENSION, key, [&image](std::ostream& file) {
+        int32_t dims[3] = {image.width, image.height, image.channels};
+        uint64_t pixelSize = image.pixels.size();
+        file.write(reinterpret_cast<const char*>(dims), sizeof(dims));
+        file.write(reinterpret_cast<const char*>(&pixelSize), sizeof(pixelSize));
+        file.write(reinterpret_cast<const char*>(image.pixels.data()),
+                   static_cast<std::streamsize>(pixelSize));
+    });
+}
+
+void ResultCache::clear() {
+    m_store.evictToSize(0);
+}
+
+void ResultCache::getStats(GenerationCacheStats& stats) const {
+    const DiskCacheStats store = m_store.getStats();
+    stats.resultHits = store.hits;
+    stats.resultMisses = store.misses;
+    stats.resultStores = store.stores;
+    stats.resultEvictions = store.evictions;
+}
+
+} // namespace AIForge
@@ -0,0 +1,174 @@
+/**
+ * @file generation_cache.h
+ * @brief Content-addressed caches for text embeddings and generated images
+ *
+ * Users re-render variations of the same prompt, so most text encoder
+ * passes recompute an embedding the engine already had, and a request with
+ * the same model, prompt, seed and settings reproduces an image bit for
+ * bit. Two caches cut that work out: an LRU of embeddings kept in VRAM
+ * next to the UNet, and a disk store of finished images keyed by a hash of
+ * everything that determines their pixels.
+ *
+ * Features:
+ * - Size-bounded LRU of embeddings per model content, device and prompt
+ * - Image entries in a DiskCache, like engines: self-validating, atomically
+ *   written and evicted least recently used first
+ *
+ * Thread-safe: every member may be called from any thread.
+ */
+
+#ifndef GENERATION_CACHE_H
+#define GENERATION_CACHE_H
+
+#include "ai_engine.h"
+#include "disk_cache.h"
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+
+namespace AIForge {
+
+/**
+ * @class EmbeddingCache
+ * @brief Least-recently-used store of text encoder outputs
+ */
+class EmbeddingCache {
+public:
+    EmbeddingCache();
+    ~EmbeddingCache() = default;
+
+    // Disable copy and move
+    EmbeddingCache(const EmbeddingCache&) = delete;
+    EmbeddingCache& operator=(const EmbeddingCache&) = delete;
+    EmbeddingCache(EmbeddingCache&&) = delete;
+    EmbeddingCache& operator=(EmbeddingCache&&) = delete;
+
+    /**
+     * @brief Set the memory limit, evicting down to it
+     * @param maxBytes Limit in bytes (0 disables the cache)
+     */
+    void setCapacity(size_t maxBytes);
+
+    /**
+     * @brief Append a cached embedding to a buffer
+     * @param key Model content, device, precision and prompt
+     * @param output Receives the embedding after its current contents
+     * @return true on hit
+     */
+    bool lookup(const std::string& key, std::vector<uint16_t>& output);
+
+    /**
+     * @brief Cache an embedding, evicting the least recently used
+     * @param key Model content, device, precision and prompt
+     * @param embedding Encoder output (not cached if larger than the limit)
+     */
+    void store(const std::string& key, const uint16_t* embedding, size_t elements);
+
+    /**
+     * @brief Remove every entry
+     */
+    void clear();
+
+    /**
+     * @brief Add this cache's counters to engine statistics
+     */
+    void getStats(GenerationCacheStats& stats) const;
+
+private:
+    struct Entry {
+        std::string key;
+        std::vector<uint16_t> data;
+    };
+
+    // Evict from the back (lock must be held)
+    void evictLocked(size_t maxBytes);
+
+    size_t m_maxBytes;
+    size_t m_bytes;
+    std::list<Entry> m_entries;     // Most recently used first
+    std::unordered_map<std::string, std::list<Entry>::iterator> m_index;
+    size_t m_hits;
+    size_t m_misses;
+    size_t m_evictions;
+    mutable std::mutex m_mutex;
+};
+
+/**
+ * @struct CachedImage
+ * @brief A generated image read from or written to the result cache
+ */
+struct CachedImage {
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    std::vector<unsigned char> pixels;
+};
+
+/**
+ * @class ResultCache
+ * @brief Directory-backed store of generated images
+ */
+class ResultCache {
+public:
+    ResultCache();
+    ~ResultCache() = default;
+
+    // Disable copy and move
+    ResultCache(const ResultCache&) = delete;
+    ResultCache& operator=(const ResultCache&) = delete;
+    ResultCache(ResultCache&&) = delete;
+    ResultCache& operator=(ResultCache&&) = delete;
+
+    /**
+     * @brief Apply configuration and create the cache directory
+     * @param config Cache configuration
+     * @return true if the cache is usable
+     */
+    bool configure(const GenerationCacheConfig& config);
+
+    /**
+     * @brief Check if caching is enabled and the directory is usable
+     */
+    bool isEnabled() const;
+
+    /**
+     * @brief Load a cached image
+     * @param key Full request key
+     * @param image Receives the image
+     * @return true on hit
+     */
+    bool load(const std::string& key, CachedImage& image);
+
+    /**
+     * @brief Store an image, evicting old entries if needed
+     * @param key Full request key
+     * @param image Image to store
+     * @return true if stored
+     */
+    bool store(const std::string& key, const CachedImage& image);
+
+    /**
+     * @brief Remove all cache entries
+     */
+    void clear();
+
+    /**
+     * @brief Add this cache's counters to engine statistics
+     */
+    void getStats(GenerationCacheStats& stats) const;
+
+    /**
+     * @brief 64-bit FNV-1a hex digest of a string
+     */
+    static std::string hashString(const std::string& text);
+
+private:
+    DiskCache m_store;
+};
+
+} // namespace AIForge
+
+#endif // GENERATION_CACHE_H
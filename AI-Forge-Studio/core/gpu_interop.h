@@ -0,0 +1,87 @@
+/**
+ * @file gpu_interop.h
+ * @brief CUDA / graphics API memory and semaphore sharing
+ *
+ * Lets the AI engine write generated images straight into memory the
+ * renderer presents from, instead of copying them to the host and
+ * uploading them again. The renderer exports a device buffer and a
+ * timeline semaphore (Vulkan external memory / DX12 shared handles), the
+ * engine imports both into CUDA, and the two sides order their work on the
+ * GPU through the semaphore without the CPU waiting on either.
+ *
+ * Semaphore protocol for a shared image, per generation k (starting at 0):
+ * - the engine waits for 2k (the renderer is done with generation k-1),
+ *   writes the image and signals 2k + 1
+ * - the renderer waits for 2k + 1, copies the buffer into its texture on
+ *   the GPU and signals 2k + 2
+ */
+
+#ifndef GPU_INTEROP_H
+#define GPU_INTEROP_H
+
+#include "tensor.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace AIForge {
+
+/**
+ * @enum ExternalHandleType
+ * @brief OS handle kind carrying the shared objects
+ */
+enum class ExternalHandleType {
+    OPAQUE_FD,          // Linux: VK_EXTERNAL_*_HANDLE_TYPE_OPAQUE_FD_BIT
+    OPAQUE_WIN32        // Windows: NT handles (Vulkan OPAQUE_WIN32 or D3D12 shared)
+};
+
+/**
+ * @struct InteropHandles
+ * @brief What the renderer exports for one shared image
+ */
+struct InteropHandles {
+    ExternalHandleType handleType = ExternalHandleType::OPAQUE_FD;
+    intptr_t memoryHandle = -1;     // Shared buffer; ownership passes to CUDA on import
+    size_t memoryBytes = 0;         // Allocation size, which may exceed the pixel data
+    intptr_t semaphoreHandle = -1;  // Timeline semaphore
+    uint8_t deviceUUID[16] = {};    // Physical device; CUDA must import on the same GPU
+    int width = 0;
+    int height = 0;
+    int channels = 0;               // Tightly packed uint8 HWC rows
+};
+
+/**
+ * @struct InteropImage
+ * @brief A shared image imported into CUDA
+ */
+struct InteropImage {
+    InteropHandles handles;
+    int deviceId = 0;               // CUDA device the handles were imported on
+    void* externalMemory = nullptr;     // cudaExternalMemory_t
+    void* externalSemaphore = nullptr;  // cudaExternalSemaphore_t
+    void* devicePointer = nullptr;      // Mapped from externalMemory
+
+    /**
+     * @brief Device view of the image for the engine to write into
+     */
+    TensorView view() const {
+        return TensorView(devicePointer, DataType::UINT8,
+                          {handles.height, handles.width, handles.channels},
+                          MemoryLocation::DEVICE, deviceId);
+    }
+
+    bool isValid() const { return devicePointer != nullptr; }
+};
+
+/**
+ * @brief Semaphore value the engine waits for before writing a generation
+ */
+inline uint64_t interopWriteWaitValue(uint64_t generation) { return 2 * generation; }
+
+/**
+ * @brief Semaphore value signalled once a generation is written
+ */
+inline uint64_t interopWrittenValue(uint64_t generation) { return 2 * generation + 1; }
+
+} // namespace AIForge
+
+#endif // GPU_INTEROP_H
@@ -11,6 +11,10 @@
 #include <thread>
 #include <atomic>
 #include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <fstream>
 
 // Platform-specific includes
 #ifdef _WIN32
@@ -18,8 +22,8 @@
     #include <psapi.h>
 #else
     #include <unistd.h>
+    #include <fcntl.h>
     #include <sys/sysinfo.h>
-    #include <fstream>
 #endif
 
 // NVML headers (would be included in production build)
@@ -34,13 +38,129 @@ struct NVMLDevice {
     unsigned int index;
 };
 
+/**
+ * @brief History slot; the sample is stored as relaxed atomic words so a
+ *        reader racing the writer sees a torn copy and retries, never a data race
+ */
+struct HardwareMonitor::TelemetrySlot {
+    static constexpr size_t WORDS = (sizeof(TelemetrySample) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    // 2 * position + 1 while being written, 2 * position + 2 once complete
+    std::atomic<uint64_t> sequence{0};
+    std::atomic<uint64_t> words[WORDS] = {};
+};
+
+/**
+ * @brief History ring; readers load the current one once per call
+ */
+struct HardwareMonitor::TelemetryRing {
+    explicit TelemetryRing(size_t size) : slots(new TelemetrySlot[size]), mask(size - 1) {}
+
+    std::unique_ptr<TelemetrySlot[]> slots;
+    size_t mask;
+    std::atomic<uint64_t> head{0};          // Samples written
+};
+
+std::string gpuEventTypeToString(GPUEventType type) {
+    switch (type) {
+        case GPUEventType::THERMAL_THROTTLE:        return "Thermal throttle";
+        case GPUEventType::POWER_THROTTLE:          return "Power throttle";
+        case GPUEventType::THROTTLE_CLEARED:        return "Throttle cleared";
+        case GPUEventType::MEMORY_PRESSURE:         return "Memory pressure";
+        case GPUEventType::MEMORY_PRESSURE_CLEARED: return "Memory pressure cleared";
+        case GPUEventType::XID_ERROR:               return "Xid error";
+        default:                                    return "Unknown";
+    }
+}
+
+namespace {
+// Simulated limits; in production throttling is reported by the driver
+constexpr float SIMULATED_THERMAL_LIMIT_C = 87.0f;
+constexpr float SIMULATED_POWER_LIMIT_W = 450.0f;
+
+// /proc/stat holds one line per logical CPU; 32 KB covers ~300 of them
+constexpr size_t PROC_STAT_BUFFER_SIZE = 32 * 1024;
+
+/**
+ * @brief Parse a sysfs CPU or node list such as "0-3,8-11"
+ */
+std::vector<int> parseCPUList(const std::string& text) {
+    std::vector<int> ids;
+    const char* cursor = text.c_str();
+    while (*cursor) {
+        char* end = nullptr;
+        long first = std::strtol(cursor, &end, 10);
+        if (end == cursor) {
+            break;
+        }
+        long last = first;
+        cursor = end;
+        if (*cursor == '-') {
+            last = std::strtol(cursor + 1, &end, 10);
+            cursor = end;
+        }
+        for (long id = first; id <= last; id++) {
+            ids.push_back(static_cast<int>(id));
+        }
+        while (*cursor == ',' || *cursor == '\n' || *cursor == ' ') {
+            cursor++;
+        }
+    }
+    return ids;
+}
+
+/**
+ * @brief Read the first line of a small sysfs file
+ * @return false if the file does not exist
+ */
+bool readSysfsLine(const std::string& path, std::string& line) {
+    std::ifstream file(path);
+    return file.is_open() && static_cast<bool>(std::getline(file, line));
+}
+
+/**
+ * @brief Extract one metric from a sample
+ * @return false if the sample has no such device
+ */
+bool telemetryValue(const TelemetrySample& sample, TelemetryMetric metric,
+                    unsigned int deviceIndex, float& value) {
+    if (metric == TelemetryMetric::CPU_UTILIZATION) {
+        value = sample.cpuUtilization;
+        return true;
+    }
+    if (deviceIndex >= sample.gpuCount) {
+        return false;
+    }
+
+    const GPUSample& gpu = sample.gpus[deviceIndex];
+    switch (metric) {
+        case TelemetryMetric::GPU_UTILIZATION:        value = gpu.gpuUtilization; break;
+        case TelemetryMetric::GPU_MEMORY_UTILIZATION: value = gpu.memoryUtilization; break;
+        case TelemetryMetric::GPU_MEMORY_USED:        value = static_cast<float>(gpu.memoryUsed); break;
+        case TelemetryMetric::GPU_POWER:              value = gpu.powerUsage; break;
+        case TelemetryMetric::GPU_TEMPERATURE:        value = gpu.temperature; break;
+        case TelemetryMetric::GPU_CLOCK:              value = static_cast<float>(gpu.clockSpeed); break;
+        case TelemetryMetric::GPU_PCIE_RX:            value = gpu.pcieRxThroughput; break;
+        case TelemetryMetric::GPU_PCIE_TX:            value = gpu.pcieTxThroughput; break;
+        default:                                      return false;
+    }
+    return true;
+}
+}
+
 HardwareMonitor::HardwareMonitor()
     : m_initialized(false)
     , m_gpuCount(0)
     , m_nvmlDevices(nullptr)
     , m_monitoring(false)
     , m_monitorThread(nullptr)
+    , m_procStatFd(-1)
+    , m_procStatBuffer(PROC_STAT_BUFFER_SIZE)
+    , m_history(nullptr)
+    , m_epoch(std::chrono::steady_clock::now())
 {
+    allocateHistory();
+
     Logger::getInstance().log(Logger::LogLevel::INFO, "HardwareMonitor",
                               "Hardware monitor created");
 }
@@ -91,6 +211,20 @@ bool HardwareMonitor::initialize() {
         }
     }
 
+    {
+        std::lock_guard<std::mutex> lock(m_healthMutex);
+        m_health.assign(m_gpuCount, GPUHealth());
+        for (unsigned int i = 0; i < m_gpuCount; i++) {
+            m_health[i].deviceId = i;
+        }
+    }
+
+#ifndef _WIN32
+    m_procStatFd = open("/proc/stat", O_RDONLY | O_CLOEXEC);
+#endif
+
+    detectTopology();
+
     m_initialized = true;
     Logger::getInstance().log(Logger::LogLevel::INFO, "HardwareMonitor",
                               "Hardware monitor initialized successfully");
@@ -110,6 +244,13 @@ void HardwareMonitor::shutdown() {
         m_nvmlDevices = nullptr;
     }
 
+#ifndef _WIN32
+    if (m_procStatFd >= 0) {
+        close(m_procStatFd);
+        m_procStatFd = -1;
+    }
+#endif
+
     // Shutdown NVML
     // In production: nvmlShutdown();
 
@@ -129,29 +270,145 @@ GPUMetrics HardwareMonitor::collectGPUMetrics(unsigned int deviceIndex) {
     metrics.deviceId = deviceIndex;
     metrics.name = devices[deviceIndex].name;
 
+    GPUSample sample;
+    sampleSlowGPUMetrics(deviceIndex, sample);
+    sampleFastGPUMetrics(deviceIndex, sample);
+
+    metrics.gpuUtilization = sample.gpuUtilization;
+    metrics.memoryUtilization = sample.memoryUtilization;
+    metrics.memoryUsed = static_cast<size_t>(sample.memoryUsed);
+    metrics.memoryTotal = static_cast<size_t>(sample.memoryTotal);
+    metrics.temperature = sample.temperature;
+    metrics.powerUsage = sample.powerUsage;
+    metrics.clockSpeed = sample.clockSpeed;
+    metrics.memoryClock = sample.memoryClock;
+    metrics.fanSpeed = sample.fanSpeed;
+    metrics.pcieRxThroughput = sample.pcieRxThroughput;
+    metrics.pcieTxThroughput = sample.pcieTxThroughput;
+    metrics.nvlinkRxBytes = sample.nvlinkRxBytes;
+    metrics.nvlinkTxBytes = sample.nvlinkTxBytes;
+    if (deviceIndex < m_topology.size()) {
+        metrics.pcieGeneration = m_topology[deviceIndex].pcieGeneration;
+        metrics.pcieWidth = m_topology[deviceIndex].pcieWidth;
+        metrics.numaNode = m_topology[deviceIndex].numaNode;
+        metrics.nvlinkActiveLinks = m_topology[deviceIndex].nvlinkActiveLinks;
+    } else {
+        metrics.numaNode = -1;
+    }
+
+    return metrics;
+}
+
+void HardwareMonitor::detectTopology() {
+    m_numaNodeIds.clear();
+    m_numaNodeCPUs.clear();
+
+#ifndef _WIN32
+    std::string line;
+    if (readSysfsLine("/sys/devices/system/node/online", line)) {
+        m_numaNodeIds = parseCPUList(line);
+    }
+    for (int node : m_numaNodeIds) {
+        std::string cpus;
+        readSysfsLine("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist", cpus);
+        m_numaNodeCPUs.push_back(parseCPUList(cpus));
+    }
+#endif
+    // In production on Windows: GetNumaHighestNodeNumber / GetNumaNodeProcessorMaskEx
+
+    m_topology.assign(m_gpuCount, GPUTopology());
+    for (unsigned int i = 0; i < m_gpuCount; i++) {
+        GPUTopology& topology = m_topology[i];
+        topology.deviceId = i;
+
+        // In production:
+        // nvmlDeviceGetPciInfo(device, &pci);                  // pci.busId
+        // nvmlDeviceGetCurrPcieLinkGeneration(device, &gen);
+        // nvmlDeviceGetCurrPcieLinkWidth(device, &width);
+        // for each link: nvmlDeviceGetNvLinkState(device, link, &active);
+        char busId[32];
+        std::snprintf(busId, sizeof(busId), "0000:%02x:00.0", i + 1);
+        topology.pciBusId = busId;
+        topology.pcieGeneration = 5;
+        topology.pcieWidth = 16;
+        topology.nvlinkActiveLinks = 0; // GeForce boards have no NVLink
+
+        // The kernel reports the node of the root port the GPU hangs off;
+        // -1 there means the platform does not expose it
+        std::string node;
+        if (readSysfsLine("/sys/bus/pci/devices/" + topology.pciBusId + "/numa_node", node)) {
+            topology.numaNode = std::atoi(node.c_str());
+        }
+        if (topology.numaNode < 0 && m_numaNodeIds.size() == 1) {
+            topology.numaNode = m_numaNodeIds[0];
+        }
+
+        for (size_t n = 0; n < m_numaNodeIds.size(); n++) {
+            if (m_numaNodeIds[n] == topology.numaNode) {
+                topology.cpus = m_numaNodeCPUs[n];
+            }
+        }
+
+        Logger::getInstance().log(Logger::LogLevel::INFO, "HardwareMonitor",
+                                  "GPU " + std::to_string(i) + ": PCIe " + topology.pciBusId +
+                                  " Gen" + std::to_string(topology.pcieGeneration) +
+                                  " x" + std::to_string(topology.pcieWidth) +
+                                  ", NUMA node " + std::to_string(topology.numaNode) +
+                                  " (" + std::to_string(topology.cpus.size()) + " CPUs)");
+    }
+}
+
+void HardwareMonitor::sampleFastGPUMetrics(unsigned int deviceIndex, GPUSample& sample) {
+    (void)deviceIndex;
+
     // In production, use actual NVML calls:
     // nvmlDeviceGetUtilizationRates(device, &utilization);
     // nvmlDeviceGetMemoryInfo(device, &memInfo);
-    // nvmlDeviceGetTemperature(device, NVML_TEMPERATURE_GPU, &temp);
     // nvmlDeviceGetPowerUsage(device, &power);
-    // nvmlDeviceGetClockInfo(device, NVML_CLOCK_GRAPHICS, &clock);
-    // nvmlDeviceGetFanSpeed(device, &fanSpeed);
 
     // Simulate realistic metrics for RTX 50-Series
-    metrics.gpuUtilization = 45.0f + (rand() % 30);
-    metrics.memoryUtilization = 60.0f + (rand() % 20);
-    metrics.memoryUsed = 8192 + (rand() % 4096);
-    metrics.memoryTotal = 24576; // 24GB for RTX 5090
-    metrics.temperature = 55.0f + (rand() % 20);
-    metrics.powerUsage = 350.0f + (rand() % 100);
-    metrics.clockSpeed = 2400 + (rand() % 300);
-    metrics.memoryClock = 10500 + (rand() % 500);
-    metrics.fanSpeed = 40 + (rand() % 30);
+    sample.gpuUtilization = 45.0f + (rand() % 30);
+    sample.memoryUtilization = 60.0f + (rand() % 20);
+    sample.memoryUsed = 8192 + (rand() % 4096);
+    sample.powerUsage = 350.0f + (rand() % 100);
+
+    // In production: nvmlDeviceGetCurrentClocksThrottleReasons(device, &reasons);
+    // a register read, cheap enough for every fast sample
+    uint32_t reasons = THROTTLE_NONE;
+    if (sample.temperature >= SIMULATED_THERMAL_LIMIT_C) {
+        reasons |= THROTTLE_SW_THERMAL;
+    }
+    if (sample.powerUsage >= SIMULATED_POWER_LIMIT_W) {
+        reasons |= THROTTLE_SW_POWER_CAP;
+    }
+    sample.throttleReasons = reasons;
+}
 
-    return metrics;
+void HardwareMonitor::sampleSlowGPUMetrics(unsigned int deviceIndex, GPUSample& sample) {
+    (void)deviceIndex;
+
+    // In production, use actual NVML calls (these change slowly and some
+    // cost a driver round trip each):
+    // nvmlDeviceGetTemperature(device, NVML_TEMPERATURE_GPU, &temp);
+    // nvmlDeviceGetClockInfo(device, NVML_CLOCK_GRAPHICS, &clock);
+    // nvmlDeviceGetClockInfo(device, NVML_CLOCK_MEM, &memClock);
+    // nvmlDeviceGetFanSpeed(device, &fanSpeed);
+
+    sample.memoryTotal = 24576; // 24GB for RTX 5090
+    sample.temperature = 55.0f + (rand() % 20);
+    sample.clockSpeed = 2400 + (rand() % 300);
+    sample.memoryClock = 10500 + (rand() % 500);
+    sample.fanSpeed = 40 + (rand() % 30);
+
+    // In production (NVML averages the PCIe counters over 20 ms and reports KB/s):
+    // nvmlDeviceGetPcieThroughput(device, NVML_PCIE_UTIL_RX_BYTES, &rx);
+    // nvmlDeviceGetPcieThroughput(device, NVML_PCIE_UTIL_TX_BYTES, &tx);
+    // for each active link: nvmlDeviceGetNvLinkUtilizationCounter(device, link, 0, &rx, &tx);
+    sample.pcieRxThroughput = 2000.0f + (rand() % 6000);
+    sample.pcieTxThroughput = 500.0f + (rand() % 2000);
 }
 
-float HardwareMonitor::collectCPUMetrics() {
+float HardwareMonitor::collectCPUMetrics(std::vector<float>* coreUtilization) {
     // Platform-specific CPU utilization collection
     float cpuUsage = 0.0f;
 
@@ -159,41 +416,108 @@ float HardwareMonitor::collectCPUMetrics() {
     // Windows implementation using PDH (Performance Data Helper)
     // For simplicity, simulate
     cpuUsage = 30.0f + (rand() % 40);
+    if (coreUtilization) {
+        coreUtilization->assign(std::max(1u, std::thread::hardware_concurrency()), cpuUsage);
+    }
 #else
-    // Linux implementation reading /proc/stat
-    static unsigned long long lastTotalUser = 0, lastTotalUserLow = 0;
-    static unsigned long long lastTotalSys = 0, lastTotalIdle = 0;
-
-    std::ifstream procStat("/proc/stat");
-    if (procStat.is_open()) {
-        std::string cpu;
-        unsigned long long totalUser, totalUserLow, totalSys, totalIdle;
-
-        procStat >> cpu >> totalUser >> totalUserLow >> totalSys >> totalIdle;
-        procStat.close();
-
-        if (lastTotalUser != 0) {
-            unsigned long long total = (totalUser - lastTotalUser) +
-                                      (totalUserLow - lastTotalUserLow) +
-                                      (totalSys - lastTotalSys);
-            unsigned long long idle = totalIdle - lastTotalIdle;
-
-            cpuUsage = (total > 0) ? (100.0f * total / (total + idle)) : 0.0f;
+    // Linux implementation reading /proc/stat through the descriptor opened
+    // in initialize(): one pread, no open/close or stream setup per sample.
+    // The aggregate line comes first, so without per-core output only the
+    // head of the file is read.
+    auto usage = [](const CPUTimes& now, const CPUTimes& last) {
+        unsigned long long busy = now.busy - last.busy;
+        unsigned long long idle = now.idle - last.idle;
+        return (busy + idle > 0) ? (100.0f * busy / (busy + idle)) : 0.0f;
+    };
+
+    char* buffer = m_procStatBuffer.data();
+    const size_t readSize = coreUtilization ? m_procStatBuffer.size() - 1 : 255;
+    ssize_t bytes = m_procStatFd >= 0 ? pread(m_procStatFd, buffer, readSize, 0) : -1;
+
+    unsigned long long user = 0, nice = 0, sys = 0, idle = 0;
+    if (bytes > 0) {
+        buffer[bytes] = '\0';
+    }
+    if (bytes > 0 && std::sscanf(buffer, "cpu %llu %llu %llu %llu", &user, &nice, &sys, &idle) == 4) {
+        CPUTimes times{user + nice + sys, idle};
+        if (m_lastCPUTimes.busy + m_lastCPUTimes.idle != 0) {
+            cpuUsage = usage(times, m_lastCPUTimes);
+        }
+        m_lastCPUTimes = times;
+
+        if (coreUtilization) {
+            coreUtilization->clear();
+            const char* line = std::strchr(buffer, '\n');
+            int core = 0;
+            while (line && std::sscanf(line + 1, "cpu%d %llu %llu %llu %llu",
+                                       &core, &user, &nice, &sys, &idle) == 5) {
+                if (core >= 0 && static_cast<size_t>(core) < 4096) {
+                    if (static_cast<size_t>(core) >= m_lastCoreTimes.size()) {
+                        m_lastCoreTimes.resize(core + 1);
+                    }
+                    if (static_cast<size_t>(core) >= coreUtilization->size()) {
+                        coreUtilization->resize(core + 1, 0.0f);
+                    }
+                    CPUTimes coreTimes{user + nice + sys, idle};
+                    CPUTimes& lastCore = m_lastCoreTimes[core];
+                    (*coreUtilization)[core] = (lastCore.busy + lastCore.idle != 0) ?
+                        usage(coreTimes, lastCore) : 0.0f;
+                    lastCore = coreTimes;
+                }
+                line = std::strchr(line + 1, '\n');
+            }
         }
-
-        lastTotalUser = totalUser;
-        lastTotalUserLow = totalUserLow;
-        lastTotalSys = totalSys;
-        lastTotalIdle = totalIdle;
     } else {
         // Fallback simulation
         cpuUsage = 30.0f + (rand() % 40);
+        if (coreUtilization) {
+            coreUtilization->assign(std::max(1u, std::thread::hardware_concurrency()), cpuUsage);
+        }
     }
 #endif
 
     return cpuUsage;
 }
 
+void HardwareMonitor::collectNUMAMetrics(const std::vector<float>& coreUtilization,
+                                         std::vector<NUMANodeMetrics>& nodes) {
+    nodes.resize(m_numaNodeIds.size());
+
+    for (size_t n = 0; n < m_numaNodeIds.size(); n++) {
+        NUMANodeMetrics& node = nodes[n];
+        node.nodeId = m_numaNodeIds[n];
+
+        double sum = 0.0;
+        size_t count = 0;
+        for (int cpu : m_numaNodeCPUs[n]) {
+            if (cpu >= 0 && static_cast<size_t>(cpu) < coreUtilization.size()) {
+                sum += coreUtilization[cpu];
+                count++;
+            }
+        }
+        node.cpuUtilization = count > 0 ? static_cast<float>(sum / count) : 0.0f;
+
+#ifndef _WIN32
+        // Lines look like "Node 0 MemTotal:  65536000 kB"
+        std::ifstream meminfo("/sys/devices/system/node/node" + std::to_string(node.nodeId) + "/meminfo");
+        std::string line;
+        while (std::getline(meminfo, line)) {
+            int id = 0;
+            char key[32];
+            unsigned long long kb = 0;
+            if (std::sscanf(line.c_str(), "Node %d %31[^:]: %llu", &id, key, &kb) != 3) {
+                continue;
+            }
+            if (std::strcmp(key, "MemTotal") == 0) {
+                node.memoryTotal = static_cast<size_t>(kb / 1024);
+            } else if (std::strcmp(key, "MemFree") == 0) {
+                node.memoryFree = static_cast<size_t>(kb / 1024);
+            }
+        }
+#endif
+    }
+}
+
 void HardwareMonitor::collectRAMMetrics(size_t& used, size_t& total) {
 #ifdef _WIN32
     MEMORYSTATUSEX memInfo;
@@ -222,10 +546,11 @@ SystemMetrics HardwareMonitor::collectMetrics() {
     }
 
     // Collect CPU metrics
-    metrics.cpuUtilization = collectCPUMetrics();
+    metrics.cpuUtilization = collectCPUMetrics(&metrics.coreUtilization);
 
     // Collect RAM metrics
     collectRAMMetrics(metrics.ramUsed, metrics.ramTotal);
+    collectNUMAMetrics(metrics.coreUtilization, metrics.numaNodes);
 
     // Collect GPU metrics for all devices
     metrics.gpus.reserve(m_gpuCount);
@@ -236,6 +561,36 @@ SystemMetrics HardwareMonitor::collectMetrics() {
     return metrics;
 }
 
+bool HardwareMonitor::setTelemetryConfig(const TelemetryConfig& config) {
+    if (m_monitoring) {
+        Logger::getInstance().log(Logger::LogLevel::WARNING, "HardwareMonitor",
+                                  "Telemetry configuration cannot change while monitoring");
+        return false;
+    }
+
+    m_telemetryConfig = config;
+    m_telemetryConfig.fastIntervalMs = std::max(1u, config.fastIntervalMs);
+    m_telemetryConfig.slowIntervalMs = std::max(m_telemetryConfig.fastIntervalMs, config.slowIntervalMs);
+    allocateHistory();
+    return true;
+}
+
+void HardwareMonitor::allocateHistory() {
+    size_t size = 2;
+    while (size < m_telemetryConfig.historySize) {
+        size <<= 1;
+    }
+    TelemetryRing* current = m_history.load(std::memory_order_relaxed);
+    if (current && current->mask + 1 == size) {
+        return;
+    }
+
+    // The old ring is not freed: a concurrent reader may still be copying
+    // from it, and resizes are rare enough that keeping it costs little
+    m_historyRings.push_back(std::make_unique<TelemetryRing>(size));
+    m_history.store(m_historyRings.back().get(), std::memory_order_release);
+}
+
 void HardwareMonitor::startMonitoring(std::function<void(const SystemMetrics&)> callback,
                                      unsigned int intervalMs) {
     if (m_monitoring) {
@@ -246,19 +601,372 @@ void HardwareMonitor::startMonitoring(std::function<void(const SystemMetrics&)>
 
     m_monitoring = true;
 
-    m_monitorThread = std::make_unique<std::thread>([this, callback, intervalMs]() {
-        Logger::getInstance().log(Logger::LogLevel::INFO, "HardwareMonitor",
-                                  "Monitoring thread started");
+    m_monitorThread = std::make_unique<std::thread>(&HardwareMonitor::monitorLoop, this,
+                                                    std::move(callback), intervalMs);
+    m_eventThread = std::make_unique<std::thread>(&HardwareMonitor::eventLoop, this);
+}
+
+bool HardwareMonitor::setEventCallback(std::function<void(const GPUEvent&)> callback) {
+    if (m_monitoring) {
+        Logger::getInstance().log(Logger::LogLevel::WARNING, "HardwareMonitor",
+                                  "Event callback cannot change while monitoring");
+        return false;
+    }
+    m_eventCallback = std::move(callback);
+    return true;
+}
+
+std::vector<GPUHealth> HardwareMonitor::getGPUHealth() const {
+    std::lock_guard<std::mutex> lock(m_healthMutex);
+    return m_health;
+}
 
-        while (m_monitoring) {
-            SystemMetrics metrics = collectMetrics();
-            callback(metrics);
-            std::this_thread::sleep_for(std::chrono::milliseconds(intervalMs));
+void HardwareMonitor::updateHealth(unsigned int deviceIndex, const GPUSample& sample,
+                                   uint64_t timestampNs) {
+    GPUEvent events[3];
+    size_t eventCount = 0;
+
+    const float memoryUsage = sample.memoryTotal > 0 ?
+        static_cast<float>(sample.memoryUsed) / static_cast<float>(sample.memoryTotal) : 0.0f;
+    const bool thermal = (sample.throttleReasons & THROTTLE_THERMAL_MASK) != 0;
+    const bool power = (sample.throttleReasons & THROTTLE_POWER_MASK) != 0;
+
+    {
+        std::lock_guard<std::mutex> lock(m_healthMutex);
+        if (deviceIndex >= m_health.size()) {
+            return;
         }
+        GPUHealth& health = m_health[deviceIndex];
+        const bool wasThrottled = health.thermalThrottled || health.powerThrottled;
 
-        Logger::getInstance().log(Logger::LogLevel::INFO, "HardwareMonitor",
-                                  "Monitoring thread stopped");
-    });
+        if (thermal && !health.thermalThrottled) {
+            events[eventCount++].type = GPUEventType::THERMAL_THROTTLE;
+        }
+        if (power && !health.powerThrottled) {
+            events[eventCount++].type = GPUEventType::POWER_THROTTLE;
+        }
+        if (wasThrottled && !thermal && !power) {
+            events[eventCount++].type = GPUEventType::THROTTLE_CLEARED;
+        }
+        if (!wasThrottled && (thermal || power)) {
+            health.throttleEvents++;
+        }
+        health.throttleReasons = sample.throttleReasons;
+        health.thermalThrottled = thermal;
+        health.powerThrottled = power;
+
+        // Two watermarks, so usage hovering at one does not flap
+        if (!health.memoryPressure && memoryUsage >= m_telemetryConfig.memoryPressureHigh) {
+            health.memoryPressure = true;
+            events[eventCount++].type = GPUEventType::MEMORY_PRESSURE;
+        } else if (health.memoryPressure && memoryUsage <= m_telemetryConfig.memoryPressureLow) {
+            health.memoryPressure = false;
+            events[eventCount++].type = GPUEventType::MEMORY_PRESSURE_CLEARED;
+        }
+    }
+
+    for (size_t i = 0; i < eventCount; i++) {
+        events[i].deviceId = deviceIndex;
+        events[i].throttleReasons = sample.throttleReasons;
+        events[i].memoryUsage = memoryUsage;
+        events[i].timestampNs = timestampNs;
+        raiseEvent(events[i]);
+    }
+}
+
+void HardwareMonitor::raiseEvent(const GPUEvent& event) {
+    const bool cleared = event.type == GPUEventType::THROTTLE_CLEARED ||
+                         event.type == GPUEventType::MEMORY_PRESSURE_CLEARED;
+    std::string message = "GPU " + std::to_string(event.deviceId) + ": " +
+                          gpuEventTypeToString(event.type);
+    if (event.type == GPUEventType::XID_ERROR) {
+        message += " " + std::to_string(event.xid);
+    } else if (event.type == GPUEventType::MEMORY_PRESSURE) {
+        message += " (" + std::to_string(static_cast<int>(event.memoryUsage * 100.0f)) + "% VRAM)";
+    }
+    Logger::getInstance().log(event.type == GPUEventType::XID_ERROR ? Logger::LogLevel::ERROR :
+                              cleared ? Logger::LogLevel::INFO : Logger::LogLevel::WARNING,
+                              "HardwareMonitor", message);
+
+    if (m_eventCallback) {
+        m_eventCallback(event);
+    }
+}
+
+void HardwareMonitor::eventLoop() {
+    // In production: one NVML event set for all devices
+    // nvmlEventSetCreate(&eventSet);
+    // for each device: nvmlDeviceRegisterEvents(device,
+    //     nvmlEventTypeXidCriticalError | nvmlEventTypeClock, eventSet);
+    // (devices without event support return NVML_ERROR_NOT_SUPPORTED and
+    // are left to polling)
+
+    const auto waitTime = std::chrono::milliseconds(m_telemetryConfig.eventWaitMs);
+    while (m_monitoring) {
+        // In production: nvmlEventSetWait_v2(eventSet, &data, eventWaitMs) blocks
+        // in the driver until an event arrives or the timeout expires
+        bool gotEvent = false;
+        unsigned int deviceIndex = 0;
+        unsigned long long xid = 0;
+        std::this_thread::sleep_for(waitTime);
+
+        if (!gotEvent) {
+            continue;
+        }
+
+        // nvmlEventTypeClock changes show up in the next fast sample through
+        // the throttle reasons; only Xid errors are handled here
+        GPUEvent event;
+        event.type = GPUEventType::XID_ERROR;
+        event.deviceId = deviceIndex;
+        event.xid = xid;
+        event.timestampNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - m_epoch).count());
+        {
+            std::lock_guard<std::mutex> lock(m_healthMutex);
+            if (deviceIndex >= m_health.size()) {
+                continue;
+            }
+            m_health[deviceIndex].xidErrors++;
+            m_health[deviceIndex].lastXid = xid;
+            event.throttleReasons = m_health[deviceIndex].throttleReasons;
+        }
+        raiseEvent(event);
+    }
+
+    // In production: nvmlEventSetFree(eventSet);
+}
+
+void HardwareMonitor::monitorLoop(std::function<void(const SystemMetrics&)> callback,
+                                  unsigned int intervalMs) {
+    Logger::getInstance().log(Logger::LogLevel::INFO, "HardwareMonitor",
+                              "Monitoring thread started");
+
+    using Clock = std::chrono::steady_clock;
+    const auto fastInterval = std::chrono::milliseconds(m_telemetryConfig.fastIntervalMs);
+    const auto slowInterval = std::chrono::milliseconds(m_telemetryConfig.slowIntervalMs);
+    const auto callbackInterval = std::chrono::milliseconds(intervalMs);
+
+    TelemetrySample sample;
+    sample.gpuCount = std::min(m_gpuCount, MAX_TELEMETRY_GPUS);
+    sample.sequence = m_history.load(std::memory_order_relaxed)->head.load(std::memory_order_relaxed);
+
+    NVMLDevice* devices = static_cast<NVMLDevice*>(m_nvmlDevices);
+    m_callbackMetrics.gpus.resize(sample.gpuCount);
+    for (unsigned int i = 0; i < sample.gpuCount; i++) {
+        GPUMetrics& metrics = m_callbackMetrics.gpus[i];
+        metrics.deviceId = i;
+        metrics.name = devices[i].name;
+        metrics.numaNode = -1;
+        if (i < m_topology.size()) {
+            metrics.pcieGeneration = m_topology[i].pcieGeneration;
+            metrics.pcieWidth = m_topology[i].pcieWidth;
+            metrics.numaNode = m_topology[i].numaNode;
+            metrics.nvlinkActiveLinks = m_topology[i].nvlinkActiveLinks;
+        }
+    }
+
+    auto now = Clock::now();
+    auto nextSample = now;
+    auto nextSlow = now;
+    auto nextCallback = now;
+
+    while (m_monitoring) {
+        now = Clock::now();
+        const bool slowDue = now >= nextSlow;
+        if (slowDue) {
+            nextSlow = now + slowInterval;
+        }
+
+        sample.timestampNs = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(now - m_epoch).count());
+        sample.sequence++;
+        const bool callbackDue = callback && now >= nextCallback;
+
+        // Per-core load is only read for the callback; the history keeps the aggregate
+        sample.cpuUtilization = collectCPUMetrics(callbackDue ? &m_callbackMetrics.coreUtilization : nullptr);
+        if (slowDue) {
+            size_t used = 0, total = 0;
+            collectRAMMetrics(used, total);
+            sample.ramUsed = used;
+            sample.ramTotal = total;
+        }
+        for (unsigned int i = 0; i < sample.gpuCount; i++) {
+            if (slowDue) {
+                sampleSlowGPUMetrics(i, sample.gpus[i]);
+            }
+            sampleFastGPUMetrics(i, sample.gpus[i]);
+            updateHealth(i, sample.gpus[i], sample.timestampNs);
+        }
+        pushSample(sample);
+
+        if (callbackDue) {
+            nextCallback = now + callbackInterval;
+            collectNUMAMetrics(m_callbackMetrics.coreUtilization, m_callbackMetrics.numaNodes);
+
+            m_callbackMetrics.cpuUtilization = sample.cpuUtilization;
+            m_callbackMetrics.ramUsed = static_cast<size_t>(sample.ramUsed);
+            m_callbackMetrics.ramTotal = static_cast<size_t>(sample.ramTotal);
+            m_callbackMetrics.timestamp = std::chrono::system_clock::now();
+            for (unsigned int i = 0; i < sample.gpuCount; i++) {
+                const GPUSample& gpu = sample.gpus[i];
+                GPUMetrics& metrics = m_callbackMetrics.gpus[i];
+                metrics.gpuUtilization = gpu.gpuUtilization;
+                metrics.memoryUtilization = gpu.memoryUtilization;
+                metrics.memoryUsed = static_cast<size_t>(gpu.memoryUsed);
+                metrics.memoryTotal = static_cast<size_t>(gpu.memoryTotal);
+                metrics.temperature = gpu.temperature;
+                metrics.powerUsage = gpu.powerUsage;
+                metrics.clockSpeed = gpu.clockSpeed;
+                metrics.memoryClock = gpu.memoryClock;
+                metrics.fanSpeed = gpu.fanSpeed;
+                metrics.pcieRxThroughput = gpu.pcieRxThroughput;
+                metrics.pcieTxThroughput = gpu.pcieTxThroughput;
+                metrics.nvlinkRxBytes = gpu.nvlinkRxBytes;
+                metrics.nvlinkTxBytes = gpu.nvlinkTxBytes;
+            }
+            callback(m_callbackMetrics);
+        }
+
+        // Fixed cadence; after a stall, skip the missed ticks instead of bursting
+        nextSample += fastInterval;
+        now = Clock::now();
+        if (nextSample <= now) {
+            nextSample = now + fastInterval;
+        }
+        std::this_thread::sleep_until(nextSample);
+    }
+
+    Logger::getInstance().log(Logger::LogLevel::INFO, "HardwareMonitor",
+                              "Monitoring thread stopped");
+}
+
+void HardwareMonitor::pushSample(const TelemetrySample& sample) {
+    TelemetryRing& ring = *m_history.load(std::memory_order_relaxed);
+    const uint64_t position = ring.head.load(std::memory_order_relaxed);
+    TelemetrySlot& slot = ring.slots[position & ring.mask];
+
+    uint64_t words[TelemetrySlot::WORDS] = {};
+    std::memcpy(words, &sample, sizeof(sample));
+
+    slot.sequence.store(2 * position + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < TelemetrySlot::WORDS; i++) {
+        slot.words[i].store(words[i], std::memory_order_relaxed);
+    }
+    slot.sequence.store(2 * position + 2, std::memory_order_release);
+    ring.head.store(position + 1, std::memory_order_release);
+}
+
+bool HardwareMonitor::readSample(const TelemetryRing& ring, uint64_t position,
+                                 TelemetrySample& sample) {
+    const TelemetrySlot& slot = ring.slots[position & ring.mask];
+    const uint64_t expected = 2 * position + 2;
+
+    if (slot.sequence.load(std::memory_order_acquire) != expected) {
+        return false;
+    }
+
+    uint64_t words[TelemetrySlot::WORDS];
+    for (size_t i = 0; i < TelemetrySlot::WORDS; i++) {
+        words[i] = slot.words[i].load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    // Overwritten while copying: the copy may be torn
+    if (slot.sequence.load(std::memory_order_relaxed) != expected) {
+        return false;
+    }
+
+    std::memcpy(&sample, words, sizeof(sample));
+    return true;
+}
+
+bool HardwareMonitor::getLatestSample(TelemetrySample& sample) const {
+    // Only fails if the writer laps the whole ring during the copy
+    const TelemetryRing& ring = *m_history.load(std::memory_order_acquire);
+    for (int attempt = 0; attempt < 4; attempt++) {
+        uint64_t head = ring.head.load(std::memory_order_acquire);
+        if (head == 0) {
+            return false;
+        }
+        if (readSample(ring, head - 1, sample)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t HardwareMonitor::getTelemetryHistory(TelemetrySample* out, size_t maxSamples) const {
+    const TelemetryRing& ring = *m_history.load(std::memory_order_acquire);
+    const uint64_t head = ring.head.load(std::memory_order_acquire);
+    const uint64_t available = std::min<uint64_t>(head, ring.mask + 1);
+    const uint64_t count = std::min<uint64_t>(available, maxSamples);
+
+    size_t copied = 0;
+    for (uint64_t position = head - count; position < head; position++) {
+        // The oldest slots may be overwritten meanwhile; they are skipped
+        if (readSample(ring, position, out[copied])) {
+            copied++;
+        }
+    }
+    return copied;
+}
+
+TelemetryAggregate HardwareMonitor::getTelemetryAggregate(TelemetryMetric metric,
+                                                          unsigned int deviceIndex,
+                                                          unsigned int windowMs) const {
+    TelemetryAggregate aggregate;
+
+    const TelemetryRing& ring = *m_history.load(std::memory_order_acquire);
+    const uint64_t head = ring.head.load(std::memory_order_acquire);
+    const uint64_t available = std::min<uint64_t>(head, ring.mask + 1);
+    const uint64_t windowNs = static_cast<uint64_t>(windowMs) * 1000000ULL;
+
+    std::vector<float> values;
+    values.reserve(static_cast<size_t>(available));
+
+    // Newest first, until the window or the surviving history ends
+    TelemetrySample sample;
+    uint64_t newestNs = 0;
+    for (uint64_t i = 0; i < available; i++) {
+        if (!readSample(ring, head - 1 - i, sample)) {
+            break;
+        }
+        if (i == 0) {
+            newestNs = sample.timestampNs;
+        } else if (newestNs - sample.timestampNs > windowNs) {
+            break;
+        }
+
+        float value = 0.0f;
+        if (telemetryValue(sample, metric, deviceIndex, value)) {
+            values.push_back(value);
+        }
+    }
+
+    if (values.empty()) {
+        return aggregate;
+    }
+
+    double sum = 0.0;
+    aggregate.min = values[0];
+    aggregate.max = values[0];
+    for (float value : values) {
+        aggregate.min = std::min(aggregate.min, value);
+        aggregate.max = std::max(aggregate.max, value);
+        sum += value;
+    }
+    aggregate.avg = static_cast<float>(sum / values.size());
+    aggregate.samples = values.size();
+
+    // Nearest-rank 95th percentile
+    size_t rank = (values.size() * 95 + 99) / 100;
+    auto p95 = values.begin() + static_cast<std::ptrdiff_t>(rank - 1);
+    std::nth_element(values.begin(), p95, values.end());
+    aggregate.p95 = *p95;
+
+    return aggregate;
 }
 
 void HardwareMonitor::stopMonitoring() {
@@ -271,8 +979,12 @@ void HardwareMonitor::stopMonitoring() {
     if (m_monitorThread && m_monitorThread->joinable()) {
         m_monitorThread->join();
     }
+    if (m_eventThread && m_eventThread->joinable()) {
+        m_eventThread->join();
+    }
 
     m_monitorThread.reset();
+    m_eventThread.reset();
 }
 
 } // namespace AIForge
@@ -10,6 +10,13 @@
  * - Temperature and power consumption monitoring
  * - Multi-GPU support
  * - Real-time data collection with configurable intervals
+ * - Telemetry stream: fast and slow per-metric sampling rates into a
+ *   preallocated history ring that readers poll without locks, with
+ *   rolling min/max/avg/p95 aggregates
+ * - GPU events: clock-throttle reasons, memory pressure and Xid errors,
+ *   delivered to a callback and kept as queryable per-GPU health
+ * - Per-core CPU load, NUMA node memory, PCIe throughput, NVLink counters
+ *   and the GPU-to-NUMA-node topology used for worker placement
  */
 
 #ifndef HARDWARE_MONITOR_H
@@ -20,6 +27,10 @@
 #include <memory>
 #include <chrono>
 #include <functional>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <cstdint>
 
 namespace AIForge {
 
@@ -39,6 +50,39 @@ struct GPUMetrics {
     unsigned int clockSpeed;   // In MHz
     unsigned int memoryClock;  // In MHz
     unsigned int fanSpeed;     // Percentage (0-100)
+    float pcieRxThroughput;    // Host-to-device, MB/s
+    float pcieTxThroughput;    // Device-to-host, MB/s
+    unsigned int pcieGeneration;
+    unsigned int pcieWidth;    // Lanes
+    int numaNode;              // Closest NUMA node (-1 = unknown)
+    unsigned int nvlinkActiveLinks;
+    unsigned long long nvlinkRxBytes;  // Cumulative over all links
+    unsigned long long nvlinkTxBytes;
+};
+
+/**
+ * @struct NUMANodeMetrics
+ * @brief Memory and CPU load of one NUMA node
+ */
+struct NUMANodeMetrics {
+    int nodeId = 0;
+    size_t memoryTotal = 0;    // In MB
+    size_t memoryFree = 0;     // In MB
+    float cpuUtilization = 0.0f; // Average over the node's cores (0-100)
+};
+
+/**
+ * @struct GPUTopology
+ * @brief Where a GPU sits relative to the host
+ */
+struct GPUTopology {
+    unsigned int deviceId = 0;
+    std::string pciBusId;          // e.g. "0000:01:00.0"
+    int numaNode = -1;             // -1 = unknown or not NUMA
+    std::vector<int> cpus;         // CPUs of that node (empty = no affinity)
+    unsigned int pcieGeneration = 0;
+    unsigned int pcieWidth = 0;
+    unsigned int nvlinkActiveLinks = 0;
 };
 
 /**
@@ -49,10 +93,159 @@ struct SystemMetrics {
     float cpuUtilization;      // Percentage (0-100)
     size_t ramUsed;            // In MB
     size_t ramTotal;           // In MB
+    std::vector<float> coreUtilization;     // Per logical CPU (0-100)
+    std::vector<NUMANodeMetrics> numaNodes;
     std::vector<GPUMetrics> gpus;
     std::chrono::system_clock::time_point timestamp;
 };
 
+/**
+ * @brief Clock throttle reasons (bit values of nvmlClocksThrottleReasons)
+ */
+enum GPUThrottleReason : uint32_t {
+    THROTTLE_NONE           = 0,
+    THROTTLE_GPU_IDLE       = 0x1,
+    THROTTLE_APP_CLOCKS     = 0x2,
+    THROTTLE_SW_POWER_CAP   = 0x4,
+    THROTTLE_HW_SLOWDOWN    = 0x8,
+    THROTTLE_SYNC_BOOST     = 0x10,
+    THROTTLE_SW_THERMAL     = 0x20,
+    THROTTLE_HW_THERMAL     = 0x40,
+    THROTTLE_HW_POWER_BRAKE = 0x80
+};
+
+constexpr uint32_t THROTTLE_THERMAL_MASK = THROTTLE_SW_THERMAL | THROTTLE_HW_THERMAL | THROTTLE_HW_SLOWDOWN;
+constexpr uint32_t THROTTLE_POWER_MASK = THROTTLE_SW_POWER_CAP | THROTTLE_HW_POWER_BRAKE;
+
+/**
+ * @enum GPUEventType
+ * @brief Health transitions reported by the monitor
+ */
+enum class GPUEventType {
+    THERMAL_THROTTLE,           // Thermal throttling started
+    POWER_THROTTLE,             // Power throttling started
+    THROTTLE_CLEARED,           // Neither thermal nor power throttling any more
+    MEMORY_PRESSURE,            // VRAM use crossed the high watermark
+    MEMORY_PRESSURE_CLEARED,    // VRAM use fell below the low watermark
+    XID_ERROR                   // Critical driver error
+};
+
+/**
+ * @struct GPUEvent
+ * @brief One health transition of a GPU
+ */
+struct GPUEvent {
+    GPUEventType type = GPUEventType::THROTTLE_CLEARED;
+    unsigned int deviceId = 0;
+    uint32_t throttleReasons = 0;   // GPUThrottleReason bits active after the event
+    float memoryUsage = 0.0f;       // Fraction of VRAM in use
+    unsigned long long xid = 0;     // XID_ERROR only
+    uint64_t timestampNs = 0;       // Same clock as TelemetrySample
+};
+
+/**
+ * @struct GPUHealth
+ * @brief Current health of a GPU, as of its last event
+ */
+struct GPUHealth {
+    unsigned int deviceId = 0;
+    uint32_t throttleReasons = 0;
+    bool thermalThrottled = false;
+    bool powerThrottled = false;
+    bool memoryPressure = false;
+    size_t throttleEvents = 0;      // Thermal or power throttling episodes
+    size_t xidErrors = 0;
+    unsigned long long lastXid = 0;
+};
+
+/**
+ * @brief Convert GPU event type to string
+ */
+std::string gpuEventTypeToString(GPUEventType type);
+
+/**
+ * @brief Most GPUs a telemetry sample holds
+ */
+constexpr unsigned int MAX_TELEMETRY_GPUS = 8;
+
+/**
+ * @struct GPUSample
+ * @brief Fixed-size GPU reading inside a telemetry sample
+ */
+struct GPUSample {
+    float gpuUtilization = 0.0f;       // Fast
+    float memoryUtilization = 0.0f;    // Fast
+    float powerUsage = 0.0f;           // Fast
+    float temperature = 0.0f;          // Slow
+    uint64_t memoryUsed = 0;           // Fast, MB
+    uint64_t memoryTotal = 0;          // Slow, MB
+    uint32_t clockSpeed = 0;           // Slow, MHz
+    uint32_t memoryClock = 0;          // Slow, MHz
+    uint32_t fanSpeed = 0;             // Slow, percentage
+    uint32_t throttleReasons = 0;      // Fast, GPUThrottleReason bits
+    float pcieRxThroughput = 0.0f;     // Slow (NVML averages it over 20 ms), MB/s
+    float pcieTxThroughput = 0.0f;     // Slow, MB/s
+    uint64_t nvlinkRxBytes = 0;        // Slow, cumulative
+    uint64_t nvlinkTxBytes = 0;        // Slow, cumulative
+};
+
+/**
+ * @struct TelemetrySample
+ * @brief One point of the telemetry time series (trivially copyable, no heap)
+ *
+ * Slow metrics carry their last reading between slow samples.
+ */
+struct TelemetrySample {
+    uint64_t timestampNs = 0;          // steady_clock time since monitor creation
+    uint64_t sequence = 0;             // Sample number, increasing
+    float cpuUtilization = 0.0f;       // Fast
+    uint32_t gpuCount = 0;
+    uint64_t ramUsed = 0;              // Slow, MB
+    uint64_t ramTotal = 0;             // Slow, MB
+    GPUSample gpus[MAX_TELEMETRY_GPUS];
+};
+
+/**
+ * @struct TelemetryConfig
+ * @brief Sampling rates and history size of the telemetry stream
+ */
+struct TelemetryConfig {
+    unsigned int fastIntervalMs = 20;      // Utilization, power, memory used, CPU
+    unsigned int slowIntervalMs = 1000;    // Temperature, clocks, fan, RAM
+    size_t historySize = 2048;             // Samples kept (rounded up to a power of two)
+    float memoryPressureHigh = 0.92f;      // VRAM fraction raising MEMORY_PRESSURE
+    float memoryPressureLow = 0.85f;       // VRAM fraction clearing it
+    unsigned int eventWaitMs = 100;        // NVML event wait timeout (bounds stop latency)
+};
+
+/**
+ * @enum TelemetryMetric
+ * @brief Metric selector for rolling aggregates
+ */
+enum class TelemetryMetric {
+    CPU_UTILIZATION,
+    GPU_UTILIZATION,
+    GPU_MEMORY_UTILIZATION,
+    GPU_MEMORY_USED,
+    GPU_POWER,
+    GPU_TEMPERATURE,
+    GPU_CLOCK,
+    GPU_PCIE_RX,
+    GPU_PCIE_TX
+};
+
+/**
+ * @struct TelemetryAggregate
+ * @brief Rolling statistics of one metric over a time window
+ */
+struct TelemetryAggregate {
+    float min = 0.0f;
+    float max = 0.0f;
+    float avg = 0.0f;
+    float p95 = 0.0f;
+    size_t samples = 0;
+};
+
 /**
  * @class HardwareMonitor
  * @brief Main hardware monitoring class with NVML integration
@@ -100,10 +293,32 @@ public:
      */
     bool isInitialized() const { return m_initialized; }
 
+    /**
+     * @brief Configure telemetry sampling (only while not monitoring)
+     *
+     * Not safe against concurrent telemetry readers: the history ring is
+     * reallocated when its size changes.
+     *
+     * @param config Telemetry configuration
+     * @return false if monitoring is running
+     */
+    bool setTelemetryConfig(const TelemetryConfig& config);
+
+    /**
+     * @brief Get telemetry configuration
+     * @return Current TelemetryConfig
+     */
+    TelemetryConfig getTelemetryConfig() const { return m_telemetryConfig; }
+
     /**
      * @brief Start asynchronous monitoring with callback
-     * @param callback Function to call with new metrics
-     * @param intervalMs Update interval in milliseconds
+     *
+     * The monitor thread samples at the telemetry rates into the history
+     * ring, and calls the callback (on the monitor thread) every intervalMs
+     * with metrics built from the latest sample.
+     *
+     * @param callback Function to call with new metrics (may be empty)
+     * @param intervalMs Callback interval in milliseconds
      */
     void startMonitoring(std::function<void(const SystemMetrics&)> callback,
                         unsigned int intervalMs = 1000);
@@ -113,13 +328,95 @@ public:
      */
     void stopMonitoring();
 
+    /**
+     * @brief Get the PCIe and NUMA placement of every GPU
+     * @return One GPUTopology per detected GPU (read once at initialize)
+     */
+    std::vector<GPUTopology> getGPUTopology() const { return m_topology; }
+
+    /**
+     * @brief Set the GPU event callback (only while not monitoring)
+     *
+     * Called on the monitor threads as soon as a transition is seen (within
+     * one fast telemetry interval for throttling and memory pressure); keep
+     * it short.
+     *
+     * @param callback Function to call with each event (empty to disable)
+     * @return false if monitoring is running
+     */
+    bool setEventCallback(std::function<void(const GPUEvent&)> callback);
+
+    /**
+     * @brief Get the health of every GPU
+     * @return One GPUHealth per detected GPU
+     */
+    std::vector<GPUHealth> getGPUHealth() const;
+
+    /**
+     * @brief Read the newest telemetry sample (lock-free, any thread)
+     * @param sample Receives the sample
+     * @return false if nothing has been sampled yet
+     */
+    bool getLatestSample(TelemetrySample& sample) const;
+
+    /**
+     * @brief Copy recent telemetry samples, oldest first (lock-free, any thread)
+     * @param out Destination array
+     * @param maxSamples Capacity of out
+     * @return Number of samples copied
+     */
+    size_t getTelemetryHistory(TelemetrySample* out, size_t maxSamples) const;
+
+    /**
+     * @brief Compute min/max/avg/p95 of a metric over a recent window
+     * @param metric Metric to aggregate
+     * @param deviceIndex GPU index (ignored for CPU metrics)
+     * @param windowMs Window ending at the newest sample
+     * @return TelemetryAggregate (samples == 0 if no data)
+     */
+    TelemetryAggregate getTelemetryAggregate(TelemetryMetric metric, unsigned int deviceIndex,
+                                             unsigned int windowMs) const;
+
 private:
     bool m_initialized;
     unsigned int m_gpuCount;
     void* m_nvmlDevices;  // Opaque pointer to NVML device handles
-    bool m_monitoring;
+    std::atomic<bool> m_monitoring;
     std::unique_ptr<class std::thread> m_monitorThread;
 
+    // /proc/stat stays open; each CPU sample is one pread
+    int m_procStatFd;
+    struct CPUTimes {
+        unsigned long long busy = 0;    // user + nice + system jiffies
+        unsigned long long idle = 0;
+    };
+    CPUTimes m_lastCPUTimes;
+    std::vector<CPUTimes> m_lastCoreTimes;
+    std::vector<char> m_procStatBuffer;
+
+    // NUMA nodes and GPU placement, read at initialize
+    std::vector<int> m_numaNodeIds;
+    std::vector<std::vector<int>> m_numaNodeCPUs;
+    std::vector<GPUTopology> m_topology;
+
+    // Telemetry history: single writer (monitor thread), seqlock per slot
+    struct TelemetrySlot;
+    struct TelemetryRing;
+    TelemetryConfig m_telemetryConfig;
+    std::atomic<TelemetryRing*> m_history;  // Current ring
+    // Every ring allocated; replaced rings stay valid for readers still in them
+    std::vector<std::unique_ptr<TelemetryRing>> m_historyRings;
+    std::chrono::steady_clock::time_point m_epoch;
+
+    // Reused for every callback so the monitor loop does not allocate
+    SystemMetrics m_callbackMetrics;
+
+    // GPU events
+    std::function<void(const GPUEvent&)> m_eventCallback;
+    std::vector<GPUHealth> m_health;
+    mutable std::mutex m_healthMutex;
+    std::unique_ptr<class std::thread> m_eventThread;
+
     /**
      * @brief Collect metrics for a specific GPU
      * @param deviceIndex Index of the GPU to query
@@ -129,9 +426,24 @@ private:
 
     /**
      * @brief Collect CPU utilization
+     * @param coreUtilization Optional, receives per-core usage
      * @return CPU usage percentage
      */
-    float collectCPUMetrics();
+    float collectCPUMetrics(std::vector<float>* coreUtilization = nullptr);
+
+    /**
+     * @brief Collect per-node memory and CPU load
+     * @param coreUtilization Per-core usage from collectCPUMetrics
+     * @param nodes Receives one entry per NUMA node (resized in place)
+     */
+    void collectNUMAMetrics(const std::vector<float>& coreUtilization,
+                            std::vector<NUMANodeMetrics>& nodes);
+
+    /**
+     * @brief Discover NUMA nodes and the node and PCIe link of each GPU
+     */
+    void detectTopology();
+
 
     /**
      * @brief Collect RAM usage
@@ -139,6 +451,55 @@ private:
      * @param total Reference to store total RAM in MB
      */
     void collectRAMMetrics(size_t& used, size_t& total);
+
+    /**
+     * @brief Read fast GPU metrics (utilization, power, memory used)
+     */
+    void sampleFastGPUMetrics(unsigned int deviceIndex, GPUSample& sample);
+
+    /**
+     * @brief Read slow GPU metrics (temperature, clocks, fan, memory total)
+     */
+    void sampleSlowGPUMetrics(unsigned int deviceIndex, GPUSample& sample);
+
+    /**
+     * @brief Append a sample to the history ring (monitor thread only)
+     */
+    void pushSample(const TelemetrySample& sample);
+
+    /**
+     * @brief Read the sample at a history position
+     * @return false if the slot was overwritten or is being written
+     */
+    static bool readSample(const TelemetryRing& ring, uint64_t position, TelemetrySample& sample);
+
+    /**
+     * @brief Allocate the history ring for the configured size
+     */
+    void allocateHistory();
+
+    /**
+     * @brief Raise events for throttle and memory pressure transitions
+     * @param deviceIndex GPU index
+     * @param sample Latest fast sample of the GPU
+     * @param timestampNs Sample timestamp
+     */
+    void updateHealth(unsigned int deviceIndex, const GPUSample& sample, uint64_t timestampNs);
+
+    /**
+     * @brief Log an event and pass it to the event callback (no locks held)
+     */
+    void raiseEvent(const GPUEvent& event);
+
+    /**
+     * @brief Body of the NVML event thread (Xid errors)
+     */
+    void eventLoop();
+
+    /**
+     * @brief Body of the monitor thread
+     */
+    void monitorLoop(std::function<void(const SystemMetrics&)> callback, unsigned int intervalMs);
 };
 
 } // namespace AIForge
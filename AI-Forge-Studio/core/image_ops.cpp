@@ -0,0 +1,1072 @@
+/**
+ * @file image_ops.cpp
+ * @brief Implementation of the image kernels
+ *
+ * Each SIMD kernel handles the whole blocks it can and returns how many
+ * pixels it did; the scalar kernel finishes the rest. x86 variants are
+ * compiled with per-function target attributes, so they build regardless
+ * of -march and only run after detectSimdLevel has seen the CPU support
+ * them.
+ */
+
+#include "image_ops.h"
+#include "logger.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #define IMAGE_OPS_X86 1
+    #include <immintrin.h>
+    #if defined(_MSC_VER) && !defined(__clang__)
+        #include <intrin.h>
+        #define TARGET_AVX2
+        #define TARGET_AVX512
+    #else
+        #define TARGET_AVX2 __attribute__((target("avx2,fma")))
+        #define TARGET_AVX512 __attribute__((target("avx512f,avx2,fma")))
+    #endif
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+    #define IMAGE_OPS_NEON 1
+    #include <arm_neon.h>
+#endif
+
+namespace AIForge {
+
+namespace {
+
+constexpr float PI = 3.14159265358979323846f;
+
+// Floats past the end of resize rows, so a pixel of 1-3 channels can be
+// loaded and stored as a whole 4-lane vector
+constexpr size_t RESAMPLE_PADDING = 4;
+
+// Active level; -1 until first use
+std::atomic<int> g_simdLevel{-1};
+
+/**
+ * @struct ImageDims
+ * @brief Height, width and channels of an HWC image
+ */
+struct ImageDims {
+    int height = 0;
+    int width = 0;
+    int channels = 0;
+
+    size_t pixels() const { return static_cast<size_t>(height) * width; }
+};
+
+bool hwcDims(const TensorShape& shape, DataType dtype, ImageDims& dims) {
+    if (shape.ndim != 3 || dtype != DataType::UINT8 ||
+        shape.dims[0] <= 0 || shape.dims[1] <= 0 ||
+        shape.dims[2] < 1 || shape.dims[2] > 4) {
+        return false;
+    }
+    dims.height = static_cast<int>(shape.dims[0]);
+    dims.width = static_cast<int>(shape.dims[1]);
+    dims.channels = static_cast<int>(shape.dims[2]);
+    return true;
+}
+
+bool chwMatches(const TensorShape& shape, DataType dtype, const ImageDims& dims) {
+    // C x H x W, or a batch of one
+    const int offset = shape.ndim == 4 ? 1 : 0;
+    if (dtype != DataType::FLOAT32 || shape.ndim != 3 + offset ||
+        (offset && shape.dims[0] != 1)) {
+        return false;
+    }
+    return shape.dims[offset] == dims.channels &&
+           shape.dims[offset + 1] == dims.height &&
+           shape.dims[offset + 2] == dims.width;
+}
+
+bool fail(const std::string& message) {
+    LOG_ERROR("ImageOps", message);
+    return false;
+}
+
+uint8_t clampToByte(float value) {
+    // Written so NaN maps to 0
+    value = value > 0.0f ? (value < 255.0f ? value : 255.0f) : 0.0f;
+    return static_cast<uint8_t>(std::nearbyint(value));
+}
+
+// Scalar kernels, also the tails of the SIMD ones
+
+void imageToTensorScalar(const uint8_t* src, float* dst, size_t pixels, int channels,
+                         const float* scale, const float* bias, size_t begin) {
+    for (int c = 0; c < channels; c++) {
+        float* plane = dst + c * pixels;
+        for (size_t p = begin; p < pixels; p++) {
+            plane[p] = src[p * channels + c] * scale[c] + bias[c];
+        }
+    }
+}
+
+void tensorToImageScalar(const float* src, uint8_t* dst, size_t pixels, int channels,
+                         const float* scale, const float* bias, size_t begin) {
+    for (size_t p = begin; p < pixels; p++) {
+        for (int c = 0; c < channels; c++) {
+            dst[p * channels + c] = clampToByte(src[c * pixels + p] * scale[c] + bias[c]);
+        }
+    }
+}
+
+void convertColorScalar(const uint8_t* src, uint8_t* dst, size_t pixels, int channels,
+                        ColorConversion conversion, size_t begin) {
+    for (size_t p = begin; p < pixels; p++) {
+        const uint8_t* in = src + p * channels;
+        switch (conversion) {
+            case ColorConversion::SWAP_RED_BLUE: {
+                uint8_t* out = dst + p * channels;
+                const uint8_t red = in[0];
+                out[0] = in[2];
+                out[1] = in[1];
+                out[2] = red;
+                if (channels == 4) {
+                    out[3] = in[3];
+                }
+                break;
+            }
+            case ColorConversion::ADD_ALPHA: {
+                uint8_t* out = dst + p * 4;
+                out[0] = in[0];
+                out[1] = in[1];
+                out[2] = in[2];
+                out[3] = 255;
+                break;
+            }
+            case ColorConversion::DROP_ALPHA: {
+                uint8_t* out = dst + p * 3;
+                out[0] = in[0];
+                out[1] = in[1];
+                out[2] = in[2];
+                break;
+            }
+            case ColorConversion::TO_GRAY:
+                // BT.601 weights in 8.8 fixed point (they sum to 256)
+                dst[p] = static_cast<uint8_t>((77 * in[0] + 150 * in[1] + 29 * in[2] + 128) >> 8);
+                break;
+        }
+    }
+}
+
+void resampleRowScalar(const float* src, const int* index, const float* weights, int taps,
+                       int channels, float* dst, size_t count, size_t begin) {
+    for (size_t x = begin; x < count; x++) {
+        const int* pixelIndex = index + x * taps;
+        const float* pixelWeight = weights + x * taps;
+        float sum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        for (int t = 0; t < taps; t++) {
+            const float* pixel = src + static_cast<size_t>(pixelIndex[t]) * channels;
+            for (int c = 0; c < channels; c++) {
+                sum[c] += pixelWeight[t] * pixel[c];
+            }
+        }
+        for (int c = 0; c < channels; c++) {
+            dst[x * channels + c] = sum[c];
+        }
+    }
+}
+
+void packRowScalar(const float* const* rows, const float* weights, int taps,
+                   uint8_t* dst, size_t count, size_t begin) {
+    for (size_t i = begin; i < count; i++) {
+        float sum = 0.0f;
+        for (int t = 0; t < taps; t++) {
+            sum += weights[t] * rows[t][i];
+        }
+        dst[i] = clampToByte(sum);
+    }
+}
+
+#if IMAGE_OPS_X86
+
+/**
+ * @struct Deinterleave8
+ * @brief Shuffle masks picking one channel of 8 pixels out of 16-byte loads
+ *
+ * 8 pixels of C channels span 8C bytes, covered by (C + 1) / 2 loads from
+ * the block start.
+ */
+struct Deinterleave8 {
+    __m128i mask[4][2];
+    int loads;
+};
+
+TARGET_AVX2 void buildDeinterleave8(int channels, Deinterleave8& table) {
+    table.loads = (channels + 1) / 2;
+    for (int c = 0; c < channels; c++) {
+        for (int j = 0; j < table.loads; j++) {
+            alignas(16) int8_t bytes[16];
+            for (int k = 0; k < 16; k++) {
+                const int offset = c + channels * k - 16 * j;
+                bytes[k] = k < 8 && offset >= 0 && offset < 16 ? static_cast<int8_t>(offset) : -128;
+            }
+            table.mask[c][j] = _mm_load_si128(reinterpret_cast<const __m128i*>(bytes));
+        }
+    }
+}
+
+TARGET_AVX2 inline __m128i gatherChannel8(const __m128i* in, const Deinterleave8& table, int c) {
+    __m128i bytes = _mm_shuffle_epi8(in[0], table.mask[c][0]);
+    if (table.loads > 1) {
+        bytes = _mm_or_si128(bytes, _mm_shuffle_epi8(in[1], table.mask[c][1]));
+    }
+    return bytes;
+}
+
+TARGET_AVX2 inline __m128i packToBytes8(__m256 values) {
+    // Round to nearest, saturate to 0..255 in the low 8 bytes (NaN gives 0)
+    __m256i ints = _mm256_cvtps_epi32(values);
+    __m128i words = _mm_packus_epi32(_mm256_castsi256_si128(ints), _mm256_extracti128_si256(ints, 1));
+    return _mm_packus_epi16(words, words);
+}
+
+TARGET_AVX2 size_t imageToTensorAvx2(const uint8_t* src, float* dst, size_t pixels, int channels,
+                                     const float* scale, const float* bias) {
+    Deinterleave8 table;
+    buildDeinterleave8(channels, table);
+    __m256 scales[4];
+    __m256 biases[4];
+    for (int c = 0; c < channels; c++) {
+        scales[c] = _mm256_set1_ps(scale[c]);
+        biases[c] = _mm256_set1_ps(bias[c]);
+    }
+
+    const size_t totalBytes = pixels * channels;
+    const size_t readBytes = 16 * static_cast<size_t>(table.loads);
+    size_t p = 0;
+    for (; p + 8 <= pixels && p * channels + readBytes <= totalBytes; p += 8) {
+        const uint8_t* block = src + p * channels;
+        __m128i in[2];
+        in[0] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block));
+        if (table.loads > 1) {
+            in[1] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 16));
+        }
+        for (int c = 0; c < channels; c++) {
+            __m256 values = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(gatherChannel8(in, table, c)));
+            _mm256_storeu_ps(dst + c * pixels + p, _mm256_fmadd_ps(values, scales[c], biases[c]));
+        }
+    }
+    return p;
+}
+
+TARGET_AVX2 size_t tensorToImageAvx2(const float* src, uint8_t* dst, size_t pixels, int channels,
+                                     const float* scale, const float* bias) {
+    // Channel bytes of 8 pixels sit in two registers, channels 0-1 and 2-3,
+    // 8 bytes each; these masks interleave them into the 8C output bytes
+    __m128i fromLow[2];
+    __m128i fromHigh[2];
+    for (int o = 0; o < 2; o++) {
+        alignas(16) int8_t low[16];
+        alignas(16) int8_t high[16];
+        for (int k = 0; k < 16; k++) {
+            const int i = 16 * o + k;
+            const int pixel = i / channels;
+            const int c = i % channels;
+            const bool used = i < 8 * channels;
+            low[k] = used && c < 2 ? static_cast<int8_t>(c * 8 + pixel) : -128;
+            high[k] = used && c >= 2 ? static_cast<int8_t>((c - 2) * 8 + pixel) : -128;
+        }
+        fromLow[o] = _mm_load_si128(reinterpret_cast<const __m128i*>(low));
+        fromHigh[o] = _mm_load_si128(reinterpret_cast<const __m128i*>(high));
+    }
+    __m256 scales[4];
+    __m256 biases[4];
+    for (int c = 0; c < channels; c++) {
+        scales[c] = _mm256_set1_ps(scale[c]);
+        biases[c] = _mm256_set1_ps(bias[c]);
+    }
+
+    size_t p = 0;
+    for (; p + 8 <= pixels; p += 8) {
+        __m128i bytes[4] = {_mm_setzero_si128(), _mm_setzero_si128(),
+                            _mm_setzero_si128(), _mm_setzero_si128()};
+        for (int c = 0; c < channels; c++) {
+            __m256 values = _mm256_fmadd_ps(_mm256_loadu_ps(src + c * pixels + p), scales[c], biases[c]);
+            bytes[c] = packToBytes8(values);
+        }
+        const __m128i low = _mm_unpacklo_epi64(bytes[0], bytes[1]);
+        const __m128i high = _mm_unpacklo_epi64(bytes[2], bytes[3]);
+        const __m128i out0 = _mm_or_si128(_mm_shuffle_epi8(low, fromLow[0]),
+                                          _mm_shuffle_epi8(high, fromHigh[0]));
+        uint8_t* block = dst + p * channels;
+        if (channels == 1) {
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(block), out0);
+            continue;
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(block), out0);
+        if (channels > 2) {
+            const __m128i out1 = _mm_or_si128(_mm_shuffle_epi8(low, fromLow[1]),
+                                              _mm_shuffle_epi8(high, fromHigh[1]));
+            if (channels == 3) {
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(block + 16), out1);
+            } else {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(block + 16), out1);
+            }
+        }
+    }
+    return p;
+}
+
+TARGET_AVX2 size_t convertColorAvx2(const uint8_t* src, uint8_t* dst, size_t pixels, int channels,
+                                    ColorConversion conversion) {
+    const size_t totalBytes = pixels * channels;
+    size_t p = 0;
+    switch (conversion) {
+        case ColorConversion::SWAP_RED_BLUE:
+            if (channels == 4) {
+                const __m256i mask = _mm256_setr_epi8(
+                    2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+                    2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+                for (; p + 8 <= pixels; p += 8) {
+                    __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + p * 4));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + p * 4), _mm256_shuffle_epi8(in, mask));
+                }
+            } else {
+                // 5 pixels per 16 bytes; byte 15 (the next pixel's red) is
+                // written back unchanged, which keeps in-place use correct
+                const __m128i mask = _mm_setr_epi8(2, 1, 0, 5, 4, 3, 8, 7, 6, 11, 10, 9, 14, 13, 12, 15);
+                for (; p + 5 <= pixels && p * 3 + 16 <= totalBytes; p += 5) {
+                    __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + p * 3));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + p * 3), _mm_shuffle_epi8(in, mask));
+                }
+            }
+            break;
+
+        case ColorConversion::ADD_ALPHA: {
+            const __m128i mask = _mm_setr_epi8(0, 1, 2, -128, 3, 4, 5, -128, 6, 7, 8, -128, 9, 10, 11, -128);
+            const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+            for (; p + 4 <= pixels && p * 3 + 16 <= totalBytes; p += 4) {
+                __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + p * 3));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + p * 4),
+                                 _mm_or_si128(_mm_shuffle_epi8(in, mask), alpha));
+            }
+            break;
+        }
+
+        case ColorConversion::DROP_ALPHA: {
+            const __m128i mask = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -128, -128, -128, -128);
+            for (; p + 4 <= pixels; p += 4) {
+                __m128i out = _mm_shuffle_epi8(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + p * 4)), mask);
+                uint8_t* block = dst + p * 3;
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(block), out);
+                const int tail = _mm_cvtsi128_si32(_mm_srli_si128(out, 8));
+                std::memcpy(block + 8, &tail, 4);
+            }
+            break;
+        }
+
+        case ColorConversion::TO_GRAY: {
+            Deinterleave8 table;
+            buildDeinterleave8(channels, table);
+            const size_t readBytes = 16 * static_cast<size_t>(table.loads);
+            const __m128i red = _mm_set1_epi16(77);
+            const __m128i green = _mm_set1_epi16(150);
+            const __m128i blue = _mm_set1_epi16(29);
+            const __m128i half = _mm_set1_epi16(128);
+            for (; p + 8 <= pixels && p * channels + readBytes <= totalBytes; p += 8) {
+                const uint8_t* block = src + p * channels;
+                __m128i in[2];
+                in[0] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block));
+                in[1] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 16));
+                // Unsigned 16-bit sums stay below 65536 since the weights sum to 256
+                __m128i sum = _mm_mullo_epi16(_mm_cvtepu8_epi16(gatherChannel8(in, table, 0)), red);
+                sum = _mm_add_epi16(sum, _mm_mullo_epi16(_mm_cvtepu8_epi16(gatherChannel8(in, table, 1)), green));
+                sum = _mm_add_epi16(sum, _mm_mullo_epi16(_mm_cvtepu8_epi16(gatherChannel8(in, table, 2)), blue));
+                sum = _mm_srli_epi16(_mm_add_epi16(sum, half), 8);
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + p), _mm_packus_epi16(sum, sum));
+            }
+            break;
+        }
+    }
+    return p;
+}
+
+TARGET_AVX2 size_t resampleRowAvx2(const float* src, const int* index, const float* weights,
+                                   int taps, int channels, float* dst, size_t count) {
+    // One pixel's channels per vector; the store spills into the next
+    // pixel, which is written after it, or into the row padding
+    for (size_t x = 0; x < count; x++) {
+        const int* pixelIndex = index + x * taps;
+        const float* pixelWeight = weights + x * taps;
+        __m128 sum = _mm_setzero_ps();
+        for (int t = 0; t < taps; t++) {
+            const __m128 pixel = _mm_loadu_ps(src + static_cast<size_t>(pixelIndex[t]) * channels);
+            sum = _mm_fmadd_ps(_mm_set1_ps(pixelWeight[t]), pixel, sum);
+        }
+        _mm_storeu_ps(dst + x * channels, sum);
+    }
+    return count;
+}
+
+TARGET_AVX2 size_t packRowAvx2(const float* const* rows, const float* weights, int taps,
+                               uint8_t* dst, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 sum = _mm256_setzero_ps();
+        for (int t = 0; t < taps; t++) {
+            sum = _mm256_fmadd_ps(_mm256_set1_ps(weights[t]), _mm256_loadu_ps(rows[t] + i), sum);
+        }
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + i), packToBytes8(sum));
+    }
+    return i;
+}
+
+TARGET_AVX512 size_t imageToTensorAvx512(const uint8_t* src, float* dst, size_t pixels, int channels,
+                                         const float* scale, const float* bias) {
+    // 16 pixels of C channels are exactly C 16-byte loads
+    __m128i masks[4][4];
+    for (int c = 0; c < channels; c++) {
+        for (int j = 0; j < channels; j++) {
+            alignas(16) int8_t bytes[16];
+            for (int k = 0; k < 16; k++) {
+                const int offset = c + channels * k - 16 * j;
+                bytes[k] = offset >= 0 && offset < 16 ? static_cast<int8_t>(offset) : -128;
+            }
+            masks[c][j] = _mm_load_si128(reinterpret_cast<const __m128i*>(bytes));
+        }
+    }
+    __m512 scales[4];
+    __m512 biases[4];
+    for (int c = 0; c < channels; c++) {
+        scales[c] = _mm512_set1_ps(scale[c]);
+        biases[c] = _mm512_set1_ps(bias[c]);
+    }
+
+    size_t p = 0;
+    for (; p + 16 <= pixels; p += 16) {
+        const uint8_t* block = src + p * channels;
+        __m128i in[4];
+        for (int j = 0; j < channels; j++) {
+            in[j] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 16 * j));
+        }
+        for (int c = 0; c < channels; c++) {
+            __m128i bytes = _mm_shuffle_epi8(in[0], masks[c][0]);
+            for (int j = 1; j < channels; j++) {
+                bytes = _mm_or_si128(bytes, _mm_shuffle_epi8(in[j], masks[c][j]));
+            }
+            __m512 values = _mm512_cvtepi32_ps(_mm512_cvtepu8_epi32(bytes));
+            _mm512_storeu_ps(dst + c * pixels + p, _mm512_fmadd_ps(values, scales[c], biases[c]));
+        }
+    }
+    return p;
+}
+
+TARGET_AVX512 size_t packRowAvx512(const float* const* rows, const float* weights, int taps,
+                                   uint8_t* dst, size_t count) {
+    const __m512i zero = _mm512_setzero_si512();
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m512 sum = _mm512_setzero_ps();
+        for (int t = 0; t < taps; t++) {
+            sum = _mm512_fmadd_ps(_mm512_set1_ps(weights[t]), _mm512_loadu_ps(rows[t] + i), sum);
+        }
+        // Clamp negatives first: the narrowing saturates as unsigned
+        __m512i ints = _mm512_max_epi32(_mm512_cvtps_epi32(sum), zero);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm512_cvtusepi32_epi8(ints));
+    }
+    return i;
+}
+
+#endif // IMAGE_OPS_X86
+
+#if IMAGE_OPS_NEON
+
+inline void storeChannelNeon(uint8x16_t bytes, float* dst, float32x4_t scale, float32x4_t bias) {
+    const uint16x8_t low = vmovl_u8(vget_low_u8(bytes));
+    const uint16x8_t high = vmovl_u8(vget_high_u8(bytes));
+    vst1q_f32(dst, vfmaq_f32(bias, vcvtq_f32_u32(vmovl_u16(vget_low_u16(low))), scale));
+    vst1q_f32(dst + 4, vfmaq_f32(bias, vcvtq_f32_u32(vmovl_u16(vget_high_u16(low))), scale));
+    vst1q_f32(dst + 8, vfmaq_f32(bias, vcvtq_f32_u32(vmovl_u16(vget_low_u16(high))), scale));
+    vst1q_f32(dst + 12, vfmaq_f32(bias, vcvtq_f32_u32(vmovl_u16(vget_high_u16(high))), scale));
+}
+
+inline uint8x16_t packBytesNeon(float32x4_t v0, float32x4_t v1, float32x4_t v2, float32x4_t v3) {
+    // Round to nearest, saturate to 0..255 (NaN gives 0)
+    const uint16x8_t low = vcombine_u16(vqmovun_s32(vcvtnq_s32_f32(v0)), vqmovun_s32(vcvtnq_s32_f32(v1)));
+    const uint16x8_t high = vcombine_u16(vqmovun_s32(vcvtnq_s32_f32(v2)), vqmovun_s32(vcvtnq_s32_f32(v3)));
+    return vcombine_u8(vqmovn_u16(low), vqmovn_u16(high));
+}
+
+inline uint8x16_t loadChannelNeon(const float* src, float32x4_t scale, float32x4_t bias) {
+    return packBytesNeon(vfmaq_f32(bias, vld1q_f32(src), scale),
+                         vfmaq_f32(bias, vld1q_f32(src + 4), scale),
+                         vfmaq_f32(bias, vld1q_f32(src + 8), scale),
+                         vfmaq_f32(bias, vld1q_f32(src + 12), scale));
+}
+
+size_t imageToTensorNeon(const uint8_t* src, float* dst, size_t pixels, int channels,
+                         const float* scale, const float* bias) {
+    float32x4_t scales[4];
+    float32x4_t biases[4];
+    for (int c = 0; c < channels; c++) {
+        scales[c] = vdupq_n_f32(scale[c]);
+        biases[c] = vdupq_n_f32(bias[c]);
+    }
+
+    size_t p = 0;
+    for (; p + 16 <= pixels; p += 16) {
+        const uint8_t* block = src + p * channels;
+        uint8x16_t planes[4];
+        switch (channels) {
+            case 1:
+                planes[0] = vld1q_u8(block);
+                break;
+            case 2: {
+                uint8x16x2_t in = vld2q_u8(block);
+                planes[0] = in.val[0];
+                planes[1] = in.val[1];
+                break;
+            }
+            case 3: {
+                uint8x16x3_t in = vld3q_u8(block);
+                planes[0] = in.val[0];
+                planes[1] = in.val[1];
+                planes[2] = in.val[2];
+                break;
+            }
+            default: {
+                uint8x16x4_t in = vld4q_u8(block);
+                planes[0] = in.val[0];
+                planes[1] = in.val[1];
+                planes[2] = in.val[2];
+                planes[3] = in.val[3];
+                break;
+            }
+        }
+        for (int c = 0; c < channels; c++) {
+            storeChannelNeon(planes[c], dst + c * pixels + p, scales[c], biases[c]);
+        }
+    }
+    return p;
+}
+
+size_t tensorToImageNeon(const float* src, uint8_t* dst, size_t pixels, int channels,
+                         const float* scale, const float* bias) {
+    float32x4_t scales[4];
+    float32x4_t biases[4];
+    for (int c = 0; c < channels; c++) {
+        scales[c] = vdupq_n_f32(scale[c]);
+        biases[c] = vdupq_n_f32(bias[c]);
+    }
+
+    size_t p = 0;
+    for (; p + 16 <= pixels; p += 16) {
+        uint8_t* block = dst + p * channels;
+        switch (channels) {
+            case 1:
+                vst1q_u8(block, loadChannelNeon(src + p, scales[0], biases[0]));
+                break;
+            case 2: {
+                uint8x16x2_t out;
+                out.val[0] = loadChannelNeon(src + p, scales[0], biases[0]);
+                out.val[1] = loadChannelNeon(src + pixels + p, scales[1], biases[1]);
+                vst2q_u8(block, out);
+                break;
+            }
+            case 3: {
+                uint8x16x3_t out;
+                for (int c = 0; c < 3; c++) {
+                    out.val[c] = loadChannelNeon(src + c * pixels + p, scales[c], biases[c]);
+                }
+                vst3q_u8(block, out);
+                break;
+            }
+            default: {
+                uint8x16x4_t out;
+                for (int c = 0; c < 4; c++) {
+                    out.val[c] = loadChannelNeon(src + c * pixels + p, scales[c], biases[c]);
+                }
+                vst4q_u8(block, out);
+                break;
+            }
+        }
+    }
+    return p;
+}
+
+size_t convertColorNeon(const uint8_t* src, uint8_t* dst, size_t pixels, int channels,
+                        ColorConversion conversion) {
+    size_t p = 0;
+    for (; p + 16 <= pixels; p += 16) {
+        const uint8_t* in = src + p * channels;
+        switch (conversion) {
+            case ColorConversion::SWAP_RED_BLUE:
+                if (channels == 4) {
+                    uint8x16x4_t pixels4 = vld4q_u8(in);
+                    std::swap(pixels4.val[0], pixels4.val[2]);
+                    vst4q_u8(dst + p * 4, pixels4);
+                } else {
+                    uint8x16x3_t pixels3 = vld3q_u8(in);
+                    std::swap(pixels3.val[0], pixels3.val[2]);
+                    vst3q_u8(dst + p * 3, pixels3);
+                }
+                break;
+            case ColorConversion::ADD_ALPHA: {
+                uint8x16x3_t rgb = vld3q_u8(in);
+                uint8x16x4_t rgba;
+                rgba.val[0] = rgb.val[0];
+                rgba.val[1] = rgb.val[1];
+                rgba.val[2] = rgb.val[2];
+                rgba.val[3] = vdupq_n_u8(255);
+                vst4q_u8(dst + p * 4, rgba);
+                break;
+            }
+            case ColorConversion::DROP_ALPHA: {
+                uint8x16x4_t rgba = vld4q_u8(in);
+                uint8x16x3_t rgb;
+                rgb.val[0] = rgba.val[0];
+                rgb.val[1] = rgba.val[1];
+                rgb.val[2] = rgba.val[2];
+                vst3q_u8(dst + p * 3, rgb);
+                break;
+            }
+            case ColorConversion::TO_GRAY: {
+                uint8x16_t r, g, b;
+                if (channels == 4) {
+                    uint8x16x4_t rgba = vld4q_u8(in);
+                    r = rgba.val[0];
+                    g = rgba.val[1];
+                    b = rgba.val[2];
+                } else {
+                    uint8x16x3_t rgb = vld3q_u8(in);
+                    r = rgb.val[0];
+                    g = rgb.val[1];
+                    b = rgb.val[2];
+                }
+                uint16x8_t low = vmull_u8(vget_low_u8(r), vdup_n_u8(77));
+                low = vmlal_u8(low, vget_low_u8(g), vdup_n_u8(150));
+                low = vmlal_u8(low, vget_low_u8(b), vdup_n_u8(29));
+                uint16x8_t high = vmull_u8(vget_high_u8(r), vdup_n_u8(77));
+                high = vmlal_u8(high, vget_high_u8(g), vdup_n_u8(150));
+                high = vmlal_u8(high, vget_high_u8(b), vdup_n_u8(29));
+                vst1q_u8(dst + p, vcombine_u8(vrshrn_n_u16(low, 8), vrshrn_n_u16(high, 8)));
+                break;
+            }
+        }
+    }
+    return p;
+}
+
+size_t resampleRowNeon(const float* src, const int* index, const float* weights, int taps,
+                       int channels, float* dst, size_t count) {
+    // As resampleRowAvx2: one pixel per vector, spilling into padding
+    for (size_t x = 0; x < count; x++) {
+        const int* pixelIndex = index + x * taps;
+        const float* pixelWeight = weights + x * taps;
+        float32x4_t sum = vdupq_n_f32(0.0f);
+        for (int t = 0; t < taps; t++) {
+            const float32x4_t pixel = vld1q_f32(src + static_cast<size_t>(pixelIndex[t]) * channels);
+            sum = vfmaq_f32(sum, pixel, vdupq_n_f32(pixelWeight[t]));
+        }
+        vst1q_f32(dst + x * channels, sum);
+    }
+    return count;
+}
+
+size_t packRowNeon(const float* const* rows, const float* weights, int taps,
+                   uint8_t* dst, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        float32x4_t sum[4] = {vdupq_n_f32(0.0f), vdupq_n_f32(0.0f), vdupq_n_f32(0.0f), vdupq_n_f32(0.0f)};
+        for (int t = 0; t < taps; t++) {
+            const float32x4_t weight = vdupq_n_f32(weights[t]);
+            for (int q = 0; q < 4; q++) {
+                sum[q] = vfmaq_f32(sum[q], vld1q_f32(rows[t] + i + 4 * q), weight);
+            }
+        }
+        vst1q_u8(dst + i, packBytesNeon(sum[0], sum[1], sum[2], sum[3]));
+    }
+    return i;
+}
+
+#endif // IMAGE_OPS_NEON
+
+/**
+ * @struct FilterTaps
+ * @brief Source indices and weights of every output pixel along one axis
+ */
+struct FilterTaps {
+    int taps = 0;
+    std::vector<int> index;     // taps per output, clamped to the source
+    std::vector<float> weight;  // taps per output, summing to 1
+};
+
+float filterKernel(ResizeFilter filter, float x) {
+    x = std::fabs(x);
+    if (filter == ResizeFilter::BILINEAR) {
+        return x < 1.0f ? 1.0f - x : 0.0f;
+    }
+    if (x < 1e-6f) {
+        return 1.0f;
+    }
+    if (x >= 3.0f) {
+        return 0.0f;
+    }
+    const float px = PI * x;
+    return 3.0f * std::sin(px) * std::sin(px / 3.0f) / (px * px);
+}
+
+void buildTaps(int srcSize, int dstSize, ResizeFilter filter, FilterTaps& taps) {
+    const float scale = static_cast<float>(srcSize) / static_cast<float>(dstSize);
+    // Widen the filter when shrinking so it covers every source pixel
+    const float stretch = std::max(scale, 1.0f);
+    const float support = (filter == ResizeFilter::BILINEAR ? 1.0f : 3.0f) * stretch;
+    taps.taps = static_cast<int>(std::ceil(support * 2.0f)) + 1;
+    taps.index.resize(static_cast<size_t>(dstSize) * taps.taps);
+    taps.weight.resize(static_cast<size_t>(dstSize) * taps.taps);
+
+    for (int i = 0; i < dstSize; i++) {
+        // Pixel centers line up at the image edges
+        const float center = (i + 0.5f) * scale - 0.5f;
+        const int first = static_cast<int>(std::floor(center - support)) + 1;
+        int* index = &taps.index[static_cast<size_t>(i) * taps.taps];
+        float* weight = &taps.weight[static_cast<size_t>(i) * taps.taps];
+        float total = 0.0f;
+        for (int t = 0; t < taps.taps; t++) {
+            const int source = first + t;
+            index[t] = std::min(std::max(source, 0), srcSize - 1);
+            weight[t] = filterKernel(filter, (source - center) / stretch);
+            total += weight[t];
+        }
+        for (int t = 0; t < taps.taps; t++) {
+            weight[t] = total != 0.0f ? weight[t] / total : (t == 0 ? 1.0f : 0.0f);
+        }
+    }
+}
+
+/**
+ * @brief Resample one float row horizontally
+ *
+ * src holds the source row's pixels and dst receives taps.index.size() /
+ * taps.taps pixels; both need RESAMPLE_PADDING floats beyond their end.
+ */
+void resampleRow(SimdLevel level, const float* src, const FilterTaps& taps, int channels,
+                 float* dst) {
+    const size_t count = taps.index.size() / taps.taps;
+    const int* index = taps.index.data();
+    const float* weights = taps.weight.data();
+    size_t done = 0;
+    switch (level) {
+#if IMAGE_OPS_X86
+        case SimdLevel::AVX512:
+        case SimdLevel::AVX2:
+            done = resampleRowAvx2(src, index, weights, taps.taps, channels, dst, count);
+            break;
+#endif
+#if IMAGE_OPS_NEON
+        case SimdLevel::NEON:
+            done = resampleRowNeon(src, index, weights, taps.taps, channels, dst, count);
+            break;
+#endif
+        default:
+            break;
+    }
+    resampleRowScalar(src, index, weights, taps.taps, channels, dst, count, done);
+}
+
+size_t packRow(SimdLevel level, const float* const* rows, const float* weights, int taps,
+               uint8_t* dst, size_t count) {
+    size_t done = 0;
+    switch (level) {
+#if IMAGE_OPS_X86
+        case SimdLevel::AVX512:
+            done = packRowAvx512(rows, weights, taps, dst, count);
+            break;
+        case SimdLevel::AVX2:
+            done = packRowAvx2(rows, weights, taps, dst, count);
+            break;
+#endif
+#if IMAGE_OPS_NEON
+        case SimdLevel::NEON:
+            done = packRowNeon(rows, weights, taps, dst, count);
+            break;
+#endif
+        default:
+            break;
+    }
+    packRowScalar(rows, weights, taps, dst, count, done);
+    return count;
+}
+
+} // namespace
+
+SimdLevel detectSimdLevel() {
+    static const SimdLevel detected = [] {
+#if IMAGE_OPS_X86
+    #if defined(_MSC_VER) && !defined(__clang__)
+        int info[4];
+        __cpuid(info, 0);
+        const int maxLeaf = info[0];
+        __cpuid(info, 1);
+        const bool osxsave = (info[2] & (1 << 27)) != 0;
+        const bool fma = (info[2] & (1 << 12)) != 0;
+        if (maxLeaf < 7 || !osxsave) {
+            return SimdLevel::SCALAR;
+        }
+        const unsigned long long xcr0 = _xgetbv(0);
+        __cpuidex(info, 7, 0);
+        const bool avx2 = (info[1] & (1 << 5)) != 0 && fma && (xcr0 & 0x6) == 0x6;
+        const bool avx512 = (info[1] & (1 << 16)) != 0 && (xcr0 & 0xE6) == 0xE6;
+        if (avx2 && avx512) {
+            return SimdLevel::AVX512;
+        }
+        return avx2 ? SimdLevel::AVX2 : SimdLevel::SCALAR;
+    #else
+        __builtin_cpu_init();
+        const bool avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+        if (avx2 && __builtin_cpu_supports("avx512f")) {
+            return SimdLevel::AVX512;
+        }
+        return avx2 ? SimdLevel::AVX2 : SimdLevel::SCALAR;
+    #endif
+#elif IMAGE_OPS_NEON
+        return SimdLevel::NEON;
+#else
+        return SimdLevel::SCALAR;
+#endif
+    }();
+    return detected;
+}
+
+SimdLevel getSimdLevel() {
+    int level = g_simdLevel.load(std::memory_order_relaxed);
+    if (level < 0) {
+        level = static_cast<int>(detectSimdLevel());
+        g_simdLevel.store(level, std::memory_order_relaxed);
+    }
+    return static_cast<SimdLevel>(level);
+}
+
+void setSimdLevel(SimdLevel level) {
+    const SimdLevel detected = detectSimdLevel();
+    // NEON and the x86 levels are exclusive; anything unsupported is scalar
+    bool supported = level == SimdLevel::SCALAR || level == detected ||
+                     (level == SimdLevel::AVX2 && detected == SimdLevel::AVX512);
+    g_simdLevel.store(static_cast<int>(supported ? level : SimdLevel::SCALAR),
+                      std::memory_order_relaxed);
+}
+
+const char* simdLevelToString(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::SCALAR: return "Scalar";
+        case SimdLevel::NEON:   return "NEON";
+        case SimdLevel::AVX2:   return "AVX2";
+        case SimdLevel::AVX512: return "AVX-512";
+        default:                return "Unknown";
+    }
+}
+
+bool imageToTensor(const ConstTensorView& image, const TensorView& tensor,
+                   const NormalizeParams& params) {
+    ImageDims dims;
+    if (!image.data || !hwcDims(image.shape, image.dtype, dims)) {
+        return fail("Image must be a uint8 H x W x C view with 1-4 channels");
+    }
+    if (!tensor.data || !chwMatches(tensor.shape, tensor.dtype, dims)) {
+        return fail("Tensor must be a float32 " + std::to_string(dims.channels) + " x " +
+                    std::to_string(dims.height) + " x " + std::to_string(dims.width) + " view");
+    }
+
+    float scale[4];
+    float bias[4];
+    for (int c = 0; c < dims.channels; c++) {
+        if (params.stddev[c] == 0.0f) {
+            return fail("Normalization stddev must be non-zero");
+        }
+        scale[c] = params.scale / params.stddev[c];
+        bias[c] = -params.mean[c] / params.stddev[c];
+    }
+
+    // In production: DEVICE views go to launchImageToTensor (image_ops.cu)
+    // on the caller's stream; device buffers are host allocations here
+    const uint8_t* src = static_cast<const uint8_t*>(image.data);
+    float* dst = static_cast<float*>(tensor.data);
+    const size_t pixels = dims.pixels();
+    size_t done = 0;
+    switch (getSimdLevel()) {
+#if IMAGE_OPS_X86
+        case SimdLevel::AVX512:
+            done = imageToTensorAvx512(src, dst, pixels, dims.channels, scale, bias);
+            break;
+        case SimdLevel::AVX2:
+            done = imageToTensorAvx2(src, dst, pixels, dims.channels, scale, bias);
+            break;
+#endif
+#if IMAGE_OPS_NEON
+        case SimdLevel::NEON:
+            done = imageToTensorNeon(src, dst, pixels, dims.channels, scale, bias);
+            break;
+#endif
+        default:
+            break;
+    }
+    imageToTensorScalar(src, dst, pixels, dims.channels, scale, bias, done);
+    return true;
+}
+
+bool tensorToImage(const ConstTensorView& tensor, const TensorView& image,
+                   const NormalizeParams& params) {
+    ImageDims dims;
+    if (!image.data || !hwcDims(image.shape, image.dtype, dims)) {
+        return fail("Image must be a uint8 H x W x C view with 1-4 channels");
+    }
+    if (!tensor.data || !chwMatches(tensor.shape, tensor.dtype, dims)) {
+        return fail("Tensor must be a float32 " + std::to_string(dims.channels) + " x " +
+                    std::to_string(dims.height) + " x " + std::to_string(dims.width) + " view");
+    }
+    if (params.scale == 0.0f) {
+        return fail("Normalization scale must be non-zero");
+    }
+
+    float scale[4];
+    float bias[4];
+    for (int c = 0; c < dims.channels; c++) {
+        scale[c] = params.stddev[c] / params.scale;
+        bias[c] = params.mean[c] / params.scale;
+    }
+
+    // In production: DEVICE views go to launchTensorToImage (image_ops.cu)
+    const float* src = static_cast<const float*>(tensor.data);
+    uint8_t* dst = static_cast<uint8_t*>(image.data);
+    const size_t pixels = dims.pixels();
+    size_t done = 0;
+    switch (getSimdLevel()) {
+#if IMAGE_OPS_X86
+        case SimdLevel::AVX512:
+        case SimdLevel::AVX2:
+            done = tensorToImageAvx2(src, dst, pixels, dims.channels, scale, bias);
+            break;
+#endif
+#if IMAGE_OPS_NEON
+        case SimdLevel::NEON:
+            done = tensorToImageNeon(src, dst, pixels, dims.channels, scale, bias);
+            break;
+#endif
+        default:
+            break;
+    }
+    tensorToImageScalar(src, dst, pixels, dims.channels, scale, bias, done);
+    return true;
+}
+
+bool convertColor(const ConstTensorView& image, const TensorView& output,
+                  ColorConversion conversion) {
+    ImageDims in;
+    ImageDims out;
+    if (!image.data || !hwcDims(image.shape, image.dtype, in)) {
+        return fail("Image must be a uint8 H x W x C view with 1-4 channels");
+    }
+    if (!output.data || !hwcDims(output.shape, output.dtype, out) ||
+        out.height != in.height || out.width != in.width) {
+        return fail("Output must be a uint8 view of the image's size");
+    }
+
+    int expected = 0;
+    switch (conversion) {
+        case ColorConversion::SWAP_RED_BLUE:
+            expected = in.channels >= 3 ? in.channels : 0;
+            break;
+        case ColorConversion::ADD_ALPHA:
+            expected = in.channels == 3 ? 4 : 0;
+            break;
+        case ColorConversion::DROP_ALPHA:
+            expected = in.channels == 4 ? 3 : 0;
+            break;
+        case ColorConversion::TO_GRAY:
+            expected = in.channels >= 3 ? 1 : 0;
+            break;
+    }
+    if (expected == 0 || out.channels != expected) {
+        return fail("Conversion does not apply to " + std::to_string(in.channels) + " to " +
+                    std::to_string(out.channels) + " channels");
+    }
+
+    // In production: DEVICE views go to launchConvertColor (image_ops.cu)
+    const uint8_t* src = static_cast<const uint8_t*>(image.data);
+    uint8_t* dst = static_cast<uint8_t*>(output.data);
+    const size_t pixels = in.pixels();
+    size_t done = 0;
+    switch (getSimdLevel()) {
+#if IMAGE_OPS_X86
+        case SimdLevel::AVX512:
+        case SimdLevel::AVX2:
+            done = convertColorAvx2(src, dst, pixels, in.channels, conversion);
+            break;
+#endif
+#if IMAGE_OPS_NEON
+        case SimdLevel::NEON:
+            done = convertColorNeon(src, dst, pixels, in.channels, conversion);
+            break;
+#endif
+        default:
+            break;
+    }
+    convertColorScalar(src, dst, pixels, in.channels, conversion, done);
+    return true;
+}
+
+bool resizeImage(const ConstTensorView& image, const TensorView& output, ResizeFilter filter) {
+    ImageDims in;
+    ImageDims out;
+    if (!image.data || !hwcDims(image.shape, image.dtype, in)) {
+        return fail("Image must be a uint8 H x W x C view with 1-4 channels");
+    }
+    if (!output.data || !hwcDims(output.shape, output.dtype, out) || out.channels != in.channels) {
+        return fail("Output must be a uint8 H x W x " + std::to_string(in.channels) + " view");
+    }
+
+    if (image.location == MemoryLocation::DEVICE || output.location == MemoryLocation::DEVICE) {
+        return fail("resizeImage takes host views; device images go to launchResizeImage");
+    }
+
+    const int channels = in.channels;
+    FilterTaps horizontal;
+    FilterTaps vertical;
+    buildTaps(in.width, out.width, filter, horizontal);
+    buildTaps(in.height, out.height, filter, vertical);
+
+    // Horizontally resampled source rows, in a ring of one row per vertical
+    // tap. The taps of successive output rows only move down the source, so
+    // each source row is resampled once and its slot reused once passed.
+    const SimdLevel level = getSimdLevel();
+    const size_t rowFloats = static_cast<size_t>(out.width) * channels;
+    const size_t rowStride = rowFloats + RESAMPLE_PADDING;
+    const int window = vertical.taps;
+    std::vector<float> rows(static_cast<size_t>(window) * rowStride);
+    std::vector<int> slotRow(window, -1);
+    std::vector<float> source(static_cast<size_t>(in.width) * channels + RESAMPLE_PADDING);
+
+    const uint8_t* src = static_cast<const uint8_t*>(image.data);
+    uint8_t* dst = static_cast<uint8_t*>(output.data);
+    std::vector<const float*> taps(vertical.taps);
+    for (int y = 0; y < out.height; y++) {
+        const int* index = &vertical.index[static_cast<size_t>(y) * vertical.taps];
+        for (int t = 0; t < vertical.taps; t++) {
+            const int slot = index[t] % window;
+            float* row = &rows[static_cast<size_t>(slot) * rowStride];
+            if (slotRow[slot] != index[t]) {
+                const uint8_t* srcRow = src + static_cast<size_t>(index[t]) * in.width * channels;
+                for (size_t i = 0; i < source.size() - RESAMPLE_PADDING; i++) {
+                    source[i] = srcRow[i];
+                }
+                resampleRow(level, source.data(), horizontal, channels, row);
+                slotRow[slot] = index[t];
+            }
+            taps[t] = row;
+        }
+
+        // Vertical pass: a weighted sum of whole contiguous rows, vectorized
+        packRow(level, taps.data(), &vertical.weight[static_cast<size_t>(y) * vertical.taps],
+                vertical.taps, dst + static_cast<size_t>(y) * rowFloats, rowFloats);
+    }
+    return true;
+}
+
+} // namespace AIForge
@@ -0,0 +1,307 @@
+/**
+ * @file image_ops.cu
+ * @brief CUDA kernels for image views in device memory
+ *
+ * Same conversions as image_ops.cpp, one thread per output pixel, enqueued
+ * on the caller's stream so they overlap with inference on other streams.
+ * Only compiled when CUDA is found.
+ */
+
+#include "image_ops.h"
+#include "logger.h"
+#include <cuda_runtime.h>
+#include <string>
+
+namespace AIForge {
+
+namespace {
+
+constexpr int BLOCK_SIZE = 256;
+
+struct ChannelAffine {
+    float scale[4];
+    float bias[4];
+};
+
+struct ImageDims {
+    int height = 0;
+    int width = 0;
+    int channels = 0;
+
+    int pixels() const { return height * width; }
+};
+
+bool hwcDims(const TensorShape& shape, DataType dtype, ImageDims& dims) {
+    if (shape.ndim != 3 || dtype != DataType::UINT8 ||
+        shape.dims[0] <= 0 || shape.dims[1] <= 0 ||
+        shape.dims[2] < 1 || shape.dims[2] > 4) {
+        return false;
+    }
+    dims.height = static_cast<int>(shape.dims[0]);
+    dims.width = static_cast<int>(shape.dims[1]);
+    dims.channels = static_cast<int>(shape.dims[2]);
+    return true;
+}
+
+bool chwMatches(const TensorShape& shape, DataType dtype, const ImageDims& dims) {
+    const int offset = shape.ndim == 4 ? 1 : 0;
+    if (dtype != DataType::FLOAT32 || shape.ndim != 3 + offset ||
+        (offset && shape.dims[0] != 1)) {
+        return false;
+    }
+    return shape.dims[offset] == dims.channels &&
+           shape.dims[offset + 1] == dims.height &&
+           shape.dims[offset + 2] == dims.width;
+}
+
+bool deviceViews(const void* a, MemoryLocation la, const void* b, MemoryLocation lb) {
+    return a && b && la == MemoryLocation::DEVICE && lb == MemoryLocation::DEVICE;
+}
+
+bool checkLaunch(const char* kernel) {
+    const cudaError_t error = cudaGetLastError();
+    if (error != cudaSuccess) {
+        LOG_ERROR("ImageOps", std::string(kernel) + " launch failed: " + cudaGetErrorString(error));
+        return false;
+    }
+    return true;
+}
+
+int gridFor(int count) {
+    return (count + BLOCK_SIZE - 1) / BLOCK_SIZE;
+}
+
+__device__ unsigned char clampToByte(float value) {
+    // NaN maps to 0
+    value = value > 0.0f ? (value < 255.0f ? value : 255.0f) : 0.0f;
+    return static_cast<unsigned char>(__float2int_rn(value));
+}
+
+__global__ void imageToTensorKernel(const unsigned char* src, float* dst, int pixels,
+                                    int channels, ChannelAffine affine) {
+    const int p = blockIdx.x * blockDim.x + threadIdx.x;
+    if (p >= pixels) {
+        return;
+    }
+    for (int c = 0; c < channels; c++) {
+        dst[c * pixels + p] = src[p * channels + c] * affine.scale[c] + affine.bias[c];
+    }
+}
+
+__global__ void tensorToImageKernel(const float* src, unsigned char* dst, int pixels,
+                                    int channels, ChannelAffine affine) {
+    const int p = blockIdx.x * blockDim.x + threadIdx.x;
+    if (p >= pixels) {
+        return;
+    }
+    for (int c = 0; c < channels; c++) {
+        dst[p * channels + c] = clampToByte(src[c * pixels + p] * affine.scale[c] + affine.bias[c]);
+    }
+}
+
+__global__ void convertColorKernel(const unsigned char* src, unsigned char* dst, int pixels,
+                                   int channels, ColorConversion conversion) {
+    const int p = blockIdx.x * blockDim.x + threadIdx.x;
+    if (p >= pixels) {
+        return;
+    }
+    const unsigned char* in = src + p * channels;
+    const unsigned char r = in[0];
+    const unsigned char g = in[1];
+    const unsigned char b = in[2];
+    switch (conversion) {
+        case ColorConversion::SWAP_RED_BLUE: {
+            // Each thread reads its pixel before writing it, so in place works
+            unsigned char* out = dst + p * channels;
+            const unsigned char a = channels == 4 ? in[3] : 0;
+            out[0] = b;
+            out[1] = g;
+            out[2] = r;
+            if (channels == 4) {
+                out[3] = a;
+            }
+            break;
+        }
+        case ColorConversion::ADD_ALPHA: {
+            unsigned char* out = dst + p * 4;
+            out[0] = r;
+            out[1] = g;
+            out[2] = b;
+            out[3] = 255;
+            break;
+        }
+        case ColorConversion::DROP_ALPHA: {
+            unsigned char* out = dst + p * 3;
+            out[0] = r;
+            out[1] = g;
+            out[2] = b;
+            break;
+        }
+        case ColorConversion::TO_GRAY:
+            dst[p] = static_cast<unsigned char>((77 * r + 150 * g + 29 * b + 128) >> 8);
+            break;
+    }
+}
+
+__device__ float filterKernel(ResizeFilter filter, float x) {
+    x = fabsf(x);
+    if (filter == ResizeFilter::BILINEAR) {
+        return x < 1.0f ? 1.0f - x : 0.0f;
+    }
+    if (x < 1e-6f) {
+        return 1.0f;
+    }
+    if (x >= 3.0f) {
+        return 0.0f;
+    }
+    const float px = 3.14159265358979323846f * x;
+    return 3.0f * __sinf(px) * __sinf(px / 3.0f) / (px * px);
+}
+
+__global__ void resizeKernel(const unsigned char* src, unsigned char* dst,
+                             int srcHeight, int srcWidth, int dstHeight, int dstWidth,
+                             int channels, ResizeFilter filter) {
+    const int x = blockIdx.x * blockDim.x + threadIdx.x;
+    const int y = blockIdx.y;
+    if (x >= dstWidth || y >= dstHeight) {
+        return;
+    }
+
+    // Same tap placement as the CPU resize: centers aligned, filters
+    // widened by the downscale factor
+    const float radius = filter == ResizeFilter::BILINEAR ? 1.0f : 3.0f;
+    const float scaleX = static_cast<float>(srcWidth) / dstWidth;
+    const float scaleY = static_cast<float>(srcHeight) / dstHeight;
+    const float stretchX = fmaxf(scaleX, 1.0f);
+    const float stretchY = fmaxf(scaleY, 1.0f);
+    const float centerX = (x + 0.5f) * scaleX - 0.5f;
+    const float centerY = (y + 0.5f) * scaleY - 0.5f;
+    const int firstX = static_cast<int>(floorf(centerX - radius * stretchX)) + 1;
+    const int firstY = static_cast<int>(floorf(centerY - radius * stretchY)) + 1;
+    const int tapsX = static_cast<int>(ceilf(radius * stretchX * 2.0f)) + 1;
+    const int tapsY = static_cast<int>(ceilf(radius * stretchY * 2.0f)) + 1;
+
+    float sum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    float total = 0.0f;
+    for (int ty = 0; ty < tapsY; ty++) {
+        const int sy = firstY + ty;
+        const float wy = filterKernel(filter, (sy - centerY) / stretchY);
+        if (wy == 0.0f) {
+            continue;
+        }
+        const unsigned char* row = src + min(max(sy, 0), srcHeight - 1) * srcWidth * channels;
+        for (int tx = 0; tx < tapsX; tx++) {
+            const int sx = firstX + tx;
+            const float weight = wy * filterKernel(filter, (sx - centerX) / stretchX);
+            const unsigned char* pixel = row + min(max(sx, 0), srcWidth - 1) * channels;
+            for (int c = 0; c < channels; c++) {
+                sum[c] += weight * pixel[c];
+            }
+            total += weight;
+        }
+    }
+
+    unsigned char* out = dst + (y * dstWidth + x) * channels;
+    for (int c = 0; c < channels; c++) {
+        out[c] = clampToByte(total != 0.0f ? sum[c] / total : 0.0f);
+    }
+}
+
+} // namespace
+
+bool launchImageToTensor(const ConstTensorView& image, const TensorView& tensor,
+                         const NormalizeParams& params, void* stream) {
+    ImageDims dims;
+    if (!deviceViews(image.data, image.location, tensor.data, tensor.location) ||
+        !hwcDims(image.shape, image.dtype, dims) || !chwMatches(tensor.shape, tensor.dtype, dims)) {
+        LOG_ERROR("ImageOps", "launchImageToTensor needs device uint8 HWC and float32 CHW views");
+        return false;
+    }
+
+    ChannelAffine affine;
+    for (int c = 0; c < dims.channels; c++) {
+        if (params.stddev[c] == 0.0f) {
+            LOG_ERROR("ImageOps", "Normalization stddev must be non-zero");
+            return false;
+        }
+        affine.scale[c] = params.scale / params.stddev[c];
+        affine.bias[c] = -params.mean[c] / params.stddev[c];
+    }
+
+    imageToTensorKernel<<<gridFor(dims.pixels()), BLOCK_SIZE, 0, static_cast<cudaStream_t>(stream)>>>(
+        static_cast<const unsigned char*>(image.data), static_cast<float*>(tensor.data),
+        dims.pixels(), dims.channels, affine);
+    return checkLaunch("imageToTensor");
+}
+
+bool launchTensorToImage(const ConstTensorView& tensor, const TensorView& image,
+                         const NormalizeParams& params, void* stream) {
+    ImageDims dims;
+    if (!deviceViews(tensor.data, tensor.location, image.data, image.location) ||
+        !hwcDims(image.shape, image.dtype, dims) || !chwMatches(tensor.shape, tensor.dtype, dims) ||
+        params.scale == 0.0f) {
+        LOG_ERROR("ImageOps", "launchTensorToImage needs device float32 CHW and uint8 HWC views");
+        return false;
+    }
+
+    ChannelAffine affine;
+    for (int c = 0; c < dims.channels; c++) {
+        affine.scale[c] = params.stddev[c] / params.scale;
+        affine.bias[c] = params.mean[c] / params.scale;
+    }
+
+    tensorToImageKernel<<<gridFor(dims.pixels()), BLOCK_SIZE, 0, static_cast<cudaStream_t>(stream)>>>(
+        static_cast<const float*>(tensor.data), static_cast<unsigned char*>(image.data),
+        dims.pixels(), dims.channels, affine);
+    return checkLaunch("tensorToImage");
+}
+
+bool launchConvertColor(const ConstTensorView& image, const TensorView& output,
+                        ColorConversion conversion, void* stream) {
+    ImageDims in;
+    ImageDims out;
+    if (!deviceViews(image.data, image.location, output.data, output.location) ||
+        !hwcDims(image.shape, image.dtype, in) || !hwcDims(output.shape, output.dtype, out) ||
+        in.height != out.height || in.width != out.width) {
+        LOG_ERROR("ImageOps", "launchConvertColor needs device uint8 HWC views of one size");
+        return false;
+    }
+
+    bool valid = false;
+    switch (conversion) {
+        case ColorConversion::SWAP_RED_BLUE: valid = in.channels >= 3 && out.channels == in.channels; break;
+        case ColorConversion::ADD_ALPHA:     valid = in.channels == 3 && out.channels == 4; break;
+        case ColorConversion::DROP_ALPHA:    valid = in.channels == 4 && out.channels == 3; break;
+        case ColorConversion::TO_GRAY:       valid = in.channels >= 3 && out.channels == 1; break;
+    }
+    if (!valid) {
+        LOG_ERROR("ImageOps", "Conversion does not apply to " + std::to_string(in.channels) +
+                  " to " + std::to_string(out.channels) + " channels");
+        return false;
+    }
+
+    convertColorKernel<<<gridFor(in.pixels()), BLOCK_SIZE, 0, static_cast<cudaStream_t>(stream)>>>(
+        static_cast<const unsigned char*>(image.data), static_cast<unsigned char*>(output.data),
+        in.pixels(), in.channels, conversion);
+    return checkLaunch("convertColor");
+}
+
+bool launchResizeImage(const ConstTensorView& image, const TensorView& output,
+                       ResizeFilter filter, void* stream) {
+    ImageDims in;
+    ImageDims out;
+    if (!deviceViews(image.data, image.location, output.data, output.location) ||
+        !hwcDims(image.shape, image.dtype, in) || !hwcDims(output.shape, output.dtype, out) ||
+        in.channels != out.channels) {
+        LOG_ERROR("ImageOps", "launchResizeImage needs device uint8 HWC views with equal channels");
+        return false;
+    }
+
+    const dim3 grid(gridFor(out.width), out.height);
+    resizeKernel<<<grid, BLOCK_SIZE, 0, static_cast<cudaStream_t>(stream)>>>(
+        static_cast<const unsigned char*>(image.data), static_cast<unsigned char*>(output.data),
+        in.height, in.width, out.height, out.width, in.channels, filter);
+    return checkLaunch("resizeImage");
+}
+
+} // namespace AIForge
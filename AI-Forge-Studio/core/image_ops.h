@@ -0,0 +1,165 @@
+/**
+ * @file image_ops.h
+ * @brief Vectorized image pre- and post-processing kernels
+ *
+ * Models take normalized float CHW tensors and produce them; the UI,
+ * renderer and files use uint8 HWC pixels. These kernels convert between
+ * the two, swap color layouts and resize, with AVX2, AVX-512 and NEON
+ * variants picked at runtime from what the CPU supports. Views in device
+ * memory have CUDA equivalents in image_ops.cu.
+ *
+ * Features:
+ * - uint8 HWC <-> float CHW with per-channel normalization in one pass
+ * - RGB/BGR swap, alpha add/drop and luma conversion
+ * - Separable bilinear and Lanczos-3 resize of uint8 HWC images
+ * - Runtime dispatch, overridable for benchmarks
+ *
+ * Thread-safe: the kernels keep no state.
+ */
+
+#ifndef IMAGE_OPS_H
+#define IMAGE_OPS_H
+
+#include "tensor.h"
+
+namespace AIForge {
+
+/**
+ * @enum SimdLevel
+ * @brief Instruction sets the CPU kernels can use
+ */
+enum class SimdLevel {
+    SCALAR,
+    NEON,       // AArch64 Advanced SIMD
+    AVX2,       // AVX2 + FMA
+    AVX512      // AVX-512 F
+};
+
+/**
+ * @enum ColorConversion
+ * @brief Conversions between uint8 HWC pixel layouts
+ */
+enum class ColorConversion {
+    SWAP_RED_BLUE,  // RGB <-> BGR, RGBA <-> BGRA
+    ADD_ALPHA,      // RGB -> RGBA (opaque)
+    DROP_ALPHA,     // RGBA -> RGB
+    TO_GRAY         // RGB or RGBA -> single-channel luma (BT.601)
+};
+
+/**
+ * @enum ResizeFilter
+ * @brief Resampling filters for resizeImage
+ */
+enum class ResizeFilter {
+    BILINEAR,
+    LANCZOS3
+};
+
+/**
+ * @struct NormalizeParams
+ * @brief Per-channel mapping between pixels and tensor values
+ *
+ * value = (pixel * scale - mean[c]) / stddev[c]. The defaults map
+ * 0..255 to 0..1; mean 0.5 and stddev 0.5 give the [-1, 1] range of
+ * diffusion VAEs.
+ */
+struct NormalizeParams {
+    float scale = 1.0f / 255.0f;
+    float mean[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    float stddev[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+};
+
+/**
+ * @brief Best instruction set this CPU supports
+ * @return Detected level (cached after the first call)
+ */
+SimdLevel detectSimdLevel();
+
+/**
+ * @brief Instruction set the kernels currently use
+ * @return Active level
+ */
+SimdLevel getSimdLevel();
+
+/**
+ * @brief Restrict the kernels to an instruction set
+ * @param level Requested level (capped at detectSimdLevel())
+ */
+void setSimdLevel(SimdLevel level);
+
+/**
+ * @brief Helper function to convert SimdLevel to string
+ */
+const char* simdLevelToString(SimdLevel level);
+
+/**
+ * @brief Convert a uint8 HWC image to a normalized float32 CHW tensor
+ * @param image Source view of H x W x C (C = 1-4)
+ * @param tensor Destination float32 view of C x H x W (or 1 x C x H x W)
+ * @param params Normalization
+ * @return true if converted
+ */
+bool imageToTensor(const ConstTensorView& image, const TensorView& tensor,
+                   const NormalizeParams& params = NormalizeParams());
+
+/**
+ * @brief Convert a float32 CHW tensor to a uint8 HWC image
+ *
+ * Inverse of imageToTensor with the same params; values are rounded and
+ * clamped to 0..255.
+ *
+ * @param tensor Source float32 view of C x H x W (or 1 x C x H x W)
+ * @param image Destination view of H x W x C
+ * @param params Normalization the tensor was produced with
+ * @return true if converted
+ */
+bool tensorToImage(const ConstTensorView& tensor, const TensorView& image,
+                   const NormalizeParams& params = NormalizeParams());
+
+/**
+ * @brief Convert between uint8 HWC pixel layouts
+ *
+ * SWAP_RED_BLUE may run in place (image and output the same buffer).
+ *
+ * @param image Source view of H x W x C
+ * @param output Destination view of H x W x C' for the conversion
+ * @param conversion Conversion to apply
+ * @return true if converted
+ */
+bool convertColor(const ConstTensorView& image, const TensorView& output,
+                  ColorConversion conversion);
+
+/**
+ * @brief Resize a uint8 HWC image
+ *
+ * Filters widen with the downscale factor, so shrinking averages every
+ * source pixel instead of skipping them.
+ *
+ * @param image Source view of H x W x C (C = 1-4)
+ * @param output Destination view of H' x W' x C (size taken from its shape)
+ * @param filter Resampling filter
+ * @return true if resized
+ */
+bool resizeImage(const ConstTensorView& image, const TensorView& output,
+                 ResizeFilter filter = ResizeFilter::LANCZOS3);
+
+#ifdef CUDA_AVAILABLE
+/**
+ * @brief Device-memory equivalents in image_ops.cu, enqueued on a stream
+ *
+ * Same views and semantics as the host functions; return false on invalid
+ * arguments or a launch error.
+ */
+bool launchImageToTensor(const ConstTensorView& image, const TensorView& tensor,
+                         const NormalizeParams& params, void* stream);
+bool launchTensorToImage(const ConstTensorView& tensor, const TensorView& image,
+                         const NormalizeParams& params, void* stream);
+bool launchConvertColor(const ConstTensorView& image, const TensorView& output,
+                        ColorConversion conversion, void* stream);
+bool launchResizeImage(const ConstTensorView& image, const TensorView& output,
+                       ResizeFilter filter, void* stream);
+#endif
+
+} // namespace AIForge
+
+#endif // IMAGE_OPS_H
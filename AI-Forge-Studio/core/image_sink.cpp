@@ -0,0 +1,86 @@
+/**
+ * @file image_sink.cpp
+ * @brief Implementation of the PNM file sink
+ */
+
+#include "image_sink.h"
+#include "logger.h"
+
+namespace AIForge {
+
+PnmFileSink::PnmFileSink(const std::string& path)
+    : m_path(path)
+    , m_rowBytes(0)
+    , m_height(0)
+    , m_nextRow(0)
+{
+}
+
+PnmFileSink::~PnmFileSink() {
+    if (m_file.is_open() && m_nextRow < m_height) {
+        LOG_WARNING("PnmFileSink", "Closing " + m_path + " after " + std::to_string(m_nextRow) +
+                    " of " + std::to_string(m_height) + " rows");
+    }
+}
+
+bool PnmFileSink::begin(int width, int height, int channels) {
+    if (width <= 0 || height <= 0 || channels < 1 || channels > 4) {
+        LOG_ERROR("PnmFileSink", "Unsupported image " + std::to_string(width) + "x" +
+                  std::to_string(height) + "x" + std::to_string(channels));
+        return false;
+    }
+
+    m_file.open(m_path, std::ios::binary | std::ios::trunc);
+    if (!m_file) {
+        LOG_ERROR("PnmFileSink", "Failed to open " + m_path);
+        return false;
+    }
+
+    if (channels == 1 || channels == 3) {
+        m_file << (channels == 1 ? "P5\n" : "P6\n") << width << " " << height << "\n255\n";
+    } else {
+        m_file << "P7\nWIDTH " << width << "\nHEIGHT " << height << "\nDEPTH " << channels
+               << "\nMAXVAL 255\nTUPLTYPE " << (channels == 2 ? "GRAYSCALE_ALPHA" : "RGB_ALPHA")
+               << "\nENDHDR\n";
+    }
+
+    m_rowBytes = static_cast<size_t>(width) * channels;
+    m_height = height;
+    m_nextRow = 0;
+    return static_cast<bool>(m_file);
+}
+
+bool PnmFileSink::writeRows(int firstRow, int rowCount, const unsigned char* rows) {
+    if (!m_file.is_open() || firstRow != m_nextRow || rowCount < 0 ||
+        firstRow + rowCount > m_height) {
+        LOG_ERROR("PnmFileSink", "Rows " + std::to_string(firstRow) + "+" +
+                  std::to_string(rowCount) + " out of order for " + m_path);
+        return false;
+    }
+
+    m_file.write(reinterpret_cast<const char*>(rows),
+                 static_cast<std::streamsize>(m_rowBytes * rowCount));
+    if (!m_file) {
+        LOG_ERROR("PnmFileSink", "Failed writing " + m_path);
+        return false;
+    }
+    m_nextRow += rowCount;
+    return true;
+}
+
+bool PnmFileSink::finish() {
+    if (!m_file.is_open() || m_nextRow != m_height) {
+        LOG_ERROR("PnmFileSink", "Image incomplete: " + m_path);
+        return false;
+    }
+
+    m_file.close();
+    if (m_file.fail()) {
+        LOG_ERROR("PnmFileSink", "Failed closing " + m_path);
+        return false;
+    }
+    LOG_INFO("PnmFileSink", "Wrote " + m_path);
+    return true;
+}
+
+} // namespace AIForge
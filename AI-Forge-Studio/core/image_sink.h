@@ -0,0 +1,92 @@
+/**
+ * @file image_sink.h
+ * @brief Destinations that receive an image a band of rows at a time
+ *
+ * Producers that never hold a whole image (the tiled upscaler) hand rows
+ * to a sink top to bottom as they are finished. A sink may write them to
+ * a file, a texture or anywhere else without buffering the full frame.
+ *
+ * Features:
+ * - begin / writeRows / finish protocol, rows strictly in order
+ * - Binary PNM file sink (PGM, PPM, PAM by channel count)
+ *
+ * Not thread-safe: a sink is fed from one thread.
+ */
+
+#ifndef IMAGE_SINK_H
+#define IMAGE_SINK_H
+
+#include <fstream>
+#include <string>
+#include <cstddef>
+
+namespace AIForge {
+
+/**
+ * @class ImageRowSink
+ * @brief Receiver of uint8 HWC rows in top-to-bottom order
+ */
+class ImageRowSink {
+public:
+    virtual ~ImageRowSink() = default;
+
+    /**
+     * @brief Start an image
+     * @param width Width in pixels
+     * @param height Height in pixels
+     * @param channels Bytes per pixel
+     * @return false to abort the producer
+     */
+    virtual bool begin(int width, int height, int channels) = 0;
+
+    /**
+     * @brief Take the next rows
+     * @param firstRow Index of the first row (continues from the last call)
+     * @param rowCount Number of rows
+     * @param rows rowCount * width * channels bytes; only valid during the call
+     * @return false to abort the producer
+     */
+    virtual bool writeRows(int firstRow, int rowCount, const unsigned char* rows) = 0;
+
+    /**
+     * @brief Complete the image after its last row
+     * @return false if the image could not be completed
+     */
+    virtual bool finish() = 0;
+};
+
+/**
+ * @class PnmFileSink
+ * @brief Streams rows into a binary PGM (1 channel), PPM (3) or PAM (2, 4) file
+ */
+class PnmFileSink : public ImageRowSink {
+public:
+    explicit PnmFileSink(const std::string& path);
+    ~PnmFileSink() override;
+
+    // Disable copy and move
+    PnmFileSink(const PnmFileSink&) = delete;
+    PnmFileSink& operator=(const PnmFileSink&) = delete;
+    PnmFileSink(PnmFileSink&&) = delete;
+    PnmFileSink& operator=(PnmFileSink&&) = delete;
+
+    bool begin(int width, int height, int channels) override;
+    bool writeRows(int firstRow, int rowCount, const unsigned char* rows) override;
+    bool finish() override;
+
+    /**
+     * @brief Get the file path
+     */
+    const std::string& getPath() const { return m_path; }
+
+private:
+    std::string m_path;
+    std::ofstream m_file;
+    size_t m_rowBytes;
+    int m_height;
+    int m_nextRow;
+};
+
+} // namespace AIForge
+
+#endif // IMAGE_SINK_H
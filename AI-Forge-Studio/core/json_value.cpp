@@ -0,0 +1,398 @@
+/**
+ * @file json_value.cpp
+ * @brief Implementation of the minimal JSON parser
+ */
+
+#include "json_value.h"
+#include <cstdlib>
+#include <cstdio>
+
+namespace AIForge {
+
+/**
+ * @class JsonParser
+ * @brief Recursive-descent parser over an in-memory string
+ */
+class JsonParser {
+public:
+    explicit JsonParser(const std::string& text) : m_text(text), m_pos(0), m_depth(0) {}
+
+    bool parseDocument(JsonValue& out, std::string* error) {
+        skipWhitespace();
+        bool ok = parseValue(out);
+        if (ok) {
+            skipWhitespace();
+            if (m_pos != m_text.size()) {
+                ok = fail("Trailing characters");
+            }
+        }
+        if (!ok && error) {
+            *error = m_error + " at offset " + std::to_string(m_pos);
+        }
+        return ok;
+    }
+
+private:
+    static constexpr int MAX_DEPTH = 256;
+
+    const std::string& m_text;
+    size_t m_pos;
+    int m_depth;
+    std::string m_error;
+
+    bool fail(const char* message) {
+        if (m_error.empty()) {
+            m_error = message;
+        }
+        return false;
+    }
+
+    void skipWhitespace() {
+        while (m_pos < m_text.size()) {
+            char c = m_text[m_pos];
+            if (c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+                break;
+            }
+            m_pos++;
+        }
+    }
+
+    bool consumeLiteral(const char* literal) {
+        size_t i = 0;
+        while (literal[i]) {
+            if (m_pos + i >= m_text.size() || m_text[m_pos + i] != literal[i]) {
+                return fail("Invalid literal");
+            }
+            i++;
+        }
+        m_pos += i;
+        return true;
+    }
+
+    bool parseValue(JsonValue& out) {
+        if (m_pos >= m_text.size()) {
+            return fail("Unexpected end of input");
+        }
+
+        char c = m_text[m_pos];
+        switch (c) {
+            case '{': return parseObject(out);
+            case '[': return parseArray(out);
+            case '"':
+                out.m_type = JsonValue::Type::STRING;
+                return parseString(out.m_string);
+            case 't':
+                out.m_type = JsonValue::Type::BOOL;
+                out.m_bool = true;
+                return consumeLiteral("true");
+            case 'f':
+                out.m_type = JsonValue::Type::BOOL;
+                out.m_bool = false;
+                return consumeLiteral("false");
+            case 'n':
+                out.m_type = JsonValue::Type::NUL;
+                return consumeLiteral("null");
+            default:
+                if (c == '-' || (c >= '0' && c <= '9')) {
+                    return parseNumber(out);
+                }
+                return fail("Unexpected character");
+        }
+    }
+
+    bool parseObject(JsonValue& out) {
+        if (++m_depth > MAX_DEPTH) {
+            return fail("Nesting too deep");
+        }
+        out.m_type = JsonValue::Type::OBJECT;
+        m_pos++; // '{'
+        skipWhitespace();
+
+        if (m_pos < m_text.size() && m_text[m_pos] == '}') {
+            m_pos++;
+            m_depth--;
+            return true;
+        }
+
+        while (true) {
+            skipWhitespace();
+            if (m_pos >= m_text.size() || m_text[m_pos] != '"') {
+                return fail("Expected member name");
+            }
+
+            std::string key;
+            if (!parseString(key)) {
+                return false;
+            }
+
+            skipWhitespace();
+            if (m_pos >= m_text.size() || m_text[m_pos] != ':') {
+                return fail("Expected ':'");
+            }
+            m_pos++;
+            skipWhitespace();
+
+            out.m_members.emplace_back(std::move(key), JsonValue());
+            if (!parseValue(out.m_members.back().second)) {
+                return false;
+            }
+
+            skipWhitespace();
+            if (m_pos >= m_text.size()) {
+                return fail("Unterminated object");
+            }
+            if (m_text[m_pos] == ',') {
+                m_pos++;
+                continue;
+            }
+            if (m_text[m_pos] == '}') {
+                m_pos++;
+                m_depth--;
+                return true;
+            }
+            return fail("Expected ',' or '}'");
+        }
+    }
+
+    bool parseArray(JsonValue& out) {
+        if (++m_depth > MAX_DEPTH) {
+            return fail("Nesting too deep");
+        }
+        out.m_type = JsonValue::Type::ARRAY;
+        m_pos++; // '['
+        skipWhitespace();
+
+        if (m_pos < m_text.size() && m_text[m_pos] == ']') {
+            m_pos++;
+            m_depth--;
+            return true;
+        }
+
+        while (true) {
+            skipWhitespace();
+            out.m_array.emplace_back();
+            if (!parseValue(out.m_array.back())) {
+                return false;
+            }
+
+            skipWhitespace();
+            if (m_pos >= m_text.size()) {
+                return fail("Unterminated array");
+            }
+            if (m_text[m_pos] == ',') {
+                m_pos++;
+                continue;
+            }
+            if (m_text[m_pos] == ']') {
+                m_pos++;
+                m_depth--;
+                return true;
+            }
+            return fail("Expected ',' or ']'");
+        }
+    }
+
+    static void appendUtf8(std::string& out, unsigned int codepoint) {
+        if (codepoint < 0x80) {
+            out += static_cast<char>(codepoint);
+        } else if (codepoint < 0x800) {
+            out += static_cast<char>(0xC0 | (codepoint >> 6));
+            out += static_cast<char>(0x80 | (codepoint & 0x3F));
+        } else if (codepoint < 0x10000) {
+            out += static_cast<char>(0xE0 | (codepoint >> 12));
+            out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (codepoint & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (codepoint >> 18));
+            out += static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (codepoint & 0x3F));
+        }
+    }
+
+    bool parseHex4(unsigned int& value) {
+        if (m_pos + 4 > m_text.size()) {
+            return fail("Truncated unicode escape");
+        }
+        value = 0;
+        for (int i = 0; i < 4; i++) {
+            char c = m_text[m_pos++];
+            value <<= 4;
+            if (c >= '0' && c <= '9') value |= c - '0';
+            else if (c >= 'a' && c <= 'f') value |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F') value |= c - 'A' + 10;
+            else return fail("Invalid unicode escape");
+        }
+        return true;
+    }
+
+    bool parseString(std::string& out) {
+        m_pos++; // opening quote
+        out.clear();
+
+        while (m_pos < m_text.size()) {
+            char c = m_text[m_pos++];
+            if (c == '"') {
+                return true;
+            }
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+
+            if (m_pos >= m_text.size()) {
+                break;
+            }
+            char escaped = m_text[m_pos++];
+            switch (escaped) {
+                case '"':  out += '"'; break;
+                case '\\': out += '\\'; break;
+                case '/':  out += '/'; break;
+                case 'b':  out += '\b'; break;
+                case 'f':  out += '\f'; break;
+                case 'n':  out += '\n'; break;
+                case 'r':  out += '\r'; break;
+                case 't':  out += '\t'; break;
+                case 'u': {
+                    unsigned int codepoint = 0;
+                    if (!parseHex4(codepoint)) {
+                        return false;
+                    }
+                    // Surrogate pair
+                    if (codepoint >= 0xD800 && codepoint <= 0xDBFF &&
+                        m_pos + 1 < m_text.size() && m_text[m_pos] == '\\' &&
+                        m_text[m_pos + 1] == 'u') {
+                        m_pos += 2;
+                        unsigned int low = 0;
+                        if (!parseHex4(low)) {
+                            return false;
+                        }
+                        codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    appendUtf8(out, codepoint);
+                    break;
+                }
+                default:
+                    return fail("Invalid escape sequence");
+            }
+        }
+
+        return fail("Unterminated string");
+    }
+
+    bool parseNumber(JsonValue& out) {
+        size_t start = m_pos;
+        bool isInteger = true;
+
+        if (m_text[m_pos] == '-') {
+            m_pos++;
+        }
+        while (m_pos < m_text.size()) {
+            char c = m_text[m_pos];
+            if (c >= '0' && c <= '9') {
+                m_pos++;
+            } else if (c == '.' || c == 'e' || c == 'E' || c == '+' || c == '-') {
+                isInteger = false;
+                m_pos++;
+            } else {
+                break;
+            }
+        }
+
+        std::string token = m_text.substr(start, m_pos - start);
+        char* end = nullptr;
+        out.m_type = JsonValue::Type::NUMBER;
+        out.m_number = std::strtod(token.c_str(), &end);
+        if (end == token.c_str() || *end != '\0') {
+            return fail("Invalid number");
+        }
+
+        out.m_isInteger = isInteger;
+        if (isInteger) {
+            out.m_integer = std::strtoll(token.c_str(), nullptr, 10);
+        }
+        return true;
+    }
+};
+
+bool JsonValue::parse(const std::string& text, JsonValue& out, std::string* error) {
+    out = JsonValue();
+    JsonParser parser(text);
+    return parser.parseDocument(out, error);
+}
+
+std::string JsonValue::escape(const std::string& text) {
+    std::string out;
+    out.reserve(text.size() + 8);
+
+    for (char c : text) {
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buffer[8];
+                    std::snprintf(buffer, sizeof(buffer), "\\u%04x", static_cast<unsigned char>(c));
+                    out += buffer;
+                } else {
+                    out += c;
+                }
+        }
+    }
+
+    return out;
+}
+
+bool JsonValue::asBool(bool defaultValue) const {
+    return m_type == Type::BOOL ? m_bool : defaultValue;
+}
+
+double JsonValue::asNumber(double defaultValue) const {
+    return m_type == Type::NUMBER ? m_number : defaultValue;
+}
+
+int64_t JsonValue::asInt(int64_t defaultValue) const {
+    if (m_type != Type::NUMBER) {
+        return defaultValue;
+    }
+    return m_isInteger ? m_integer : static_cast<int64_t>(m_number);
+}
+
+const JsonValue* JsonValue::find(const std::string& key) const {
+    if (m_type != Type::OBJECT) {
+        return nullptr;
+    }
+    for (const auto& member : m_members) {
+        if (member.first == key) {
+            return &member.second;
+        }
+    }
+    return nullptr;
+}
+
+std::string JsonValue::getString(const std::string& key, const std::string& defaultValue) const {
+    const JsonValue* value = find(key);
+    return (value && value->isString()) ? value->m_string : defaultValue;
+}
+
+double JsonValue::getNumber(const std::string& key, double defaultValue) const {
+    const JsonValue* value = find(key);
+    return value ? value->asNumber(defaultValue) : defaultValue;
+}
+
+int64_t JsonValue::getInt(const std::string& key, int64_t defaultValue) const {
+    const JsonValue* value = find(key);
+    return value ? value->asInt(defaultValue) : defaultValue;
+}
+
+bool JsonValue::getBool(const std::string& key, bool defaultValue) const {
+    const JsonValue* value = find(key);
+    return value ? value->asBool(defaultValue) : defaultValue;
+}
+
+} // namespace AIForge
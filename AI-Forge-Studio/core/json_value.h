@@ -0,0 +1,110 @@
+/**
+ * @file json_value.h
+ * @brief Minimal JSON document model and parser
+ *
+ * Small dependency-free JSON reader used for file headers (SafeTensors),
+ * manifests and bridge payloads. Objects keep their members in document
+ * order. Integers are kept exactly (64-bit) alongside their double value.
+ */
+
+#ifndef JSON_VALUE_H
+#define JSON_VALUE_H
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstdint>
+
+namespace AIForge {
+
+/**
+ * @class JsonValue
+ * @brief Immutable-after-parse JSON value
+ */
+class JsonValue {
+public:
+    enum class Type {
+        NUL,
+        BOOL,
+        NUMBER,
+        STRING,
+        ARRAY,
+        OBJECT
+    };
+
+    JsonValue() = default;
+
+    /**
+     * @brief Parse a JSON document
+     * @param text JSON text
+     * @param out Receives the parsed value
+     * @param error Optional, receives a description of the first error
+     * @return true if the whole text parsed as one JSON value
+     */
+    static bool parse(const std::string& text, JsonValue& out, std::string* error = nullptr);
+
+    /**
+     * @brief Escape a string for embedding in JSON output (without quotes)
+     * @param text Raw string
+     * @return Escaped string
+     */
+    static std::string escape(const std::string& text);
+
+    Type type() const { return m_type; }
+    bool isNull() const { return m_type == Type::NUL; }
+    bool isBool() const { return m_type == Type::BOOL; }
+    bool isNumber() const { return m_type == Type::NUMBER; }
+    bool isString() const { return m_type == Type::STRING; }
+    bool isArray() const { return m_type == Type::ARRAY; }
+    bool isObject() const { return m_type == Type::OBJECT; }
+
+    bool asBool(bool defaultValue = false) const;
+    double asNumber(double defaultValue = 0.0) const;
+    int64_t asInt(int64_t defaultValue = 0) const;
+    const std::string& asString() const { return m_string; }
+    const std::vector<JsonValue>& asArray() const { return m_array; }
+    const std::vector<std::pair<std::string, JsonValue>>& members() const { return m_members; }
+
+    /**
+     * @brief Look up an object member
+     * @param key Member name
+     * @return Pointer to the member, or nullptr if absent or not an object
+     */
+    const JsonValue* find(const std::string& key) const;
+
+    /**
+     * @brief Get a string member, or a default if missing or not a string
+     */
+    std::string getString(const std::string& key, const std::string& defaultValue = "") const;
+
+    /**
+     * @brief Get a numeric member, or a default if missing or not a number
+     */
+    double getNumber(const std::string& key, double defaultValue = 0.0) const;
+
+    /**
+     * @brief Get an integer member, or a default if missing or not a number
+     */
+    int64_t getInt(const std::string& key, int64_t defaultValue = 0) const;
+
+    /**
+     * @brief Get a boolean member, or a default if missing or not a bool
+     */
+    bool getBool(const std::string& key, bool defaultValue = false) const;
+
+private:
+    friend class JsonParser;
+
+    Type m_type = Type::NUL;
+    bool m_bool = false;
+    double m_number = 0.0;
+    int64_t m_integer = 0;
+    bool m_isInteger = false;
+    std::string m_string;
+    std::vector<JsonValue> m_array;
+    std::vector<std::pair<std::string, JsonValue>> m_members;
+};
+
+} // namespace AIForge
+
+#endif // JSON_VALUE_H
@@ -0,0 +1,111 @@
+/**
+ * @file kv_cache.cpp
+ * @brief Implementation of the paged KV cache
+ */
+
+#include "kv_cache.h"
+#include "logger.h"
+#include <string>
+
+namespace AIForge {
+
+PagedKVCache::PagedKVCache()
+    : m_blockTokens(0)
+    , m_blockBytes(0)
+    , m_totalBlocks(0)
+{
+}
+
+PagedKVCache::~PagedKVCache() {
+    shutdown();
+}
+
+bool PagedKVCache::initialize(size_t capacityBytes, int blockTokens, size_t bytesPerToken) {
+    shutdown();
+
+    if (blockTokens <= 0 || bytesPerToken == 0) {
+        LOG_ERROR("KVCache", "Invalid block size");
+        return false;
+    }
+    const size_t blockBytes = static_cast<size_t>(blockTokens) * bytesPerToken;
+    const size_t blocks = capacityBytes / blockBytes;
+    if (blocks == 0) {
+        LOG_ERROR("KVCache", std::to_string(capacityBytes / (1024 * 1024)) +
+                  " MB holds no " + std::to_string(blockTokens) + "-token block");
+        return false;
+    }
+
+    // In production: one cudaMalloc of blocks * blockBytes; block b of layer l
+    // holds keys at base + b * blockBytes + l * (blockBytes / layers) with
+    // the values after them, and the paged attention kernels index blocks
+    // through the tables. The blocks are bookkeeping only in this build.
+    m_blockTokens = blockTokens;
+    m_blockBytes = blockBytes;
+    m_totalBlocks = blocks;
+    m_freeBlocks.reserve(blocks);
+    for (size_t i = blocks; i > 0; i--) {
+        m_freeBlocks.push_back(static_cast<int>(i - 1));
+    }
+
+    LOG_INFO("KVCache", "KV cache: " + std::to_string(blocks) + " blocks of " +
+             std::to_string(blockTokens) + " tokens (" +
+             std::to_string(blocks * blockBytes / (1024 * 1024)) + " MB)");
+    return true;
+}
+
+void PagedKVCache::shutdown() {
+    if (m_totalBlocks == 0) {
+        return;
+    }
+
+    // In production: cudaFree the pool once no step is in flight
+    m_tables.clear();
+    m_freeBlocks.clear();
+    m_totalBlocks = 0;
+}
+
+bool PagedKVCache::reserve(uint64_t sequenceId, size_t tokens) {
+    std::vector<int>& table = m_tables[sequenceId];
+    const size_t needed = blocksFor(tokens);
+    if (needed <= table.size()) {
+        return true;
+    }
+    if (needed - table.size() > m_freeBlocks.size()) {
+        if (table.empty()) {
+            m_tables.erase(sequenceId);
+        }
+        return false;
+    }
+
+    while (table.size() < needed) {
+        table.push_back(m_freeBlocks.back());
+        m_freeBlocks.pop_back();
+    }
+    return true;
+}
+
+void PagedKVCache::release(uint64_t sequenceId) {
+    auto it = m_tables.find(sequenceId);
+    if (it == m_tables.end()) {
+        return;
+    }
+    // Reverse order so the next sequence gets them in the same order
+    for (auto block = it->second.rbegin(); block != it->second.rend(); ++block) {
+        m_freeBlocks.push_back(*block);
+    }
+    m_tables.erase(it);
+}
+
+const std::vector<int>* PagedKVCache::getBlockTable(uint64_t sequenceId) const {
+    auto it = m_tables.find(sequenceId);
+    return it != m_tables.end() ? &it->second : nullptr;
+}
+
+size_t PagedKVCache::blocksFor(size_t tokens) const {
+    if (m_blockTokens <= 0) {
+        return 0;
+    }
+    return (tokens + m_blockTokens - 1) / m_blockTokens;
+}
+
+} // namespace AIForge
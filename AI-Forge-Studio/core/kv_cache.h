@@ -0,0 +1,105 @@
+/**
+ * @file kv_cache.h
+ * @brief Paged key/value cache for LLM sequences
+ *
+ * A contiguous KV buffer per sequence must be sized for its longest
+ * possible output up front, so most of it sits empty and only a few
+ * sequences fit. The paged cache splits one device allocation into
+ * fixed-size blocks of tokens; each sequence owns a block table and grows
+ * a block at a time, so memory follows what was actually generated and a
+ * finished sequence's blocks go straight to the next one.
+ *
+ * Features:
+ * - Fixed-size blocks from a single pool, no fragmentation
+ * - Per-sequence block tables handed to the attention kernels
+ * - All-or-nothing growth so a failed reservation changes nothing
+ *
+ * Not thread-safe: owned by one TextGenerator loop.
+ */
+
+#ifndef KV_CACHE_H
+#define KV_CACHE_H
+
+#include <unordered_map>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace AIForge {
+
+/**
+ * @class PagedKVCache
+ * @brief Block allocator and block tables for sequence KV state
+ */
+class PagedKVCache {
+public:
+    PagedKVCache();
+    ~PagedKVCache();
+
+    // Disable copy and move
+    PagedKVCache(const PagedKVCache&) = delete;
+    PagedKVCache& operator=(const PagedKVCache&) = delete;
+    PagedKVCache(PagedKVCache&&) = delete;
+    PagedKVCache& operator=(PagedKVCache&&) = delete;
+
+    /**
+     * @brief Create the block pool
+     * @param capacityBytes Memory for the cache
+     * @param blockTokens Tokens per block
+     * @param bytesPerToken KV bytes of one token across all layers
+     * @return false if not even one block fits
+     */
+    bool initialize(size_t capacityBytes, int blockTokens, size_t bytesPerToken);
+
+    /**
+     * @brief Release the pool (every sequence loses its blocks)
+     */
+    void shutdown();
+
+    /**
+     * @brief Grow a sequence's block table to hold a number of tokens
+     *
+     * Adds a table for a new sequence. Nothing changes if the free blocks
+     * do not cover the growth.
+     *
+     * @param sequenceId Sequence
+     * @param tokens Tokens the sequence must be able to hold
+     * @return true if the sequence now holds enough blocks
+     */
+    bool reserve(uint64_t sequenceId, size_t tokens);
+
+    /**
+     * @brief Return a sequence's blocks to the pool
+     * @param sequenceId Sequence
+     */
+    void release(uint64_t sequenceId);
+
+    /**
+     * @brief Get a sequence's block table
+     * @param sequenceId Sequence
+     * @return Block indices in token order, or nullptr if it holds none
+     */
+    const std::vector<int>* getBlockTable(uint64_t sequenceId) const;
+
+    /**
+     * @brief Blocks needed for a number of tokens
+     */
+    size_t blocksFor(size_t tokens) const;
+
+    int getBlockTokens() const { return m_blockTokens; }
+    size_t getTotalBlocks() const { return m_totalBlocks; }
+    size_t getFreeBlocks() const { return m_freeBlocks.size(); }
+    size_t getUsedBlocks() const { return m_totalBlocks - m_freeBlocks.size(); }
+    size_t getBlockBytes() const { return m_blockBytes; }
+
+private:
+    int m_blockTokens;
+    size_t m_blockBytes;
+    size_t m_totalBlocks;
+    std::vector<int> m_freeBlocks;  // Stack, so recently freed blocks are reused first
+    std::unordered_map<uint64_t, std::vector<int>> m_tables;
+};
+
+} // namespace AIForge
+
+#endif // KV_CACHE_H
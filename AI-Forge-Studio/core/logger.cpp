@@ -1,12 +1,20 @@
 /**
  * @file logger.cpp
  * @brief Implementation of the logging system
+ *
+ * The async queue is a bounded multi-producer ring in the style of Vyukov's
+ * queue: every slot carries a sequence number, producers claim a position
+ * with one compare-exchange, and the single writer thread consumes slots in
+ * order. Producers never take a lock unless the writer is asleep and needs
+ * waking.
  */
 
 #include "logger.h"
 #include <iostream>
 #include <iomanip>
 #include <ctime>
+#include <cstdio>
+#include <cstdarg>
 
 #ifdef _WIN32
     #include <windows.h>
@@ -14,11 +22,28 @@
 
 namespace AIForge {
 
+namespace {
+constexpr size_t WRITER_BATCH = 256;
+constexpr auto WRITER_IDLE_TIMEOUT = std::chrono::milliseconds(100);
+}
+
 Logger::Logger()
     : m_logFilePath("ai_forge_studio.log")
     , m_minLevel(LogLevel::INFO)
     , m_consoleOutput(true)
     , m_fileOutput(true)
+    , m_cachedSecond(-1)
+    , m_ringMask(0)
+    , m_enqueuePos(0)
+    , m_dequeuePos(0)
+    , m_overflowPolicy(OverflowPolicy::BLOCK)
+    , m_async(false)
+    , m_activeProducers(0)
+    , m_dropped(0)
+    , m_writerRunning(false)
+    , m_writerSleeping(false)
+    , m_pushed(0)
+    , m_written(0)
 {
     // Open log file
     if (m_fileOutput) {
@@ -31,6 +56,7 @@ Logger::Logger()
 }
 
 Logger::~Logger() {
+    disableAsync();
     flush();
     if (m_logFile.is_open()) {
         m_logFile.close();
@@ -66,52 +92,118 @@ std::string Logger::levelToString(LogLevel level) {
     }
 }
 
-std::string Logger::formatLogEntry(LogLevel level, const std::string& module,
-                                   const std::string& message) {
-    std::stringstream ss;
-    ss << "[" << getCurrentTimestamp() << "] "
-       << "[" << std::setw(8) << std::left << levelToString(level) << "] "
-       << "[" << std::setw(20) << std::left << module << "] "
-       << message;
-    return ss.str();
+std::string Logger::formatMessage(const char* format, ...) {
+    // Most messages fit the stack buffer: one vsnprintf, one allocation
+    char buffer[256];
+    va_list args;
+    va_start(args, format);
+    int length = std::vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+
+    if (length < 0) {
+        return format;
+    }
+    if (static_cast<size_t>(length) < sizeof(buffer)) {
+        return std::string(buffer, static_cast<size_t>(length));
+    }
+
+    std::string message(static_cast<size_t>(length), '\0');
+    va_start(args, format);
+    std::vsnprintf(&message[0], message.size() + 1, format, args);
+    va_end(args);
+    return message;
 }
 
-void Logger::writeLog(const std::string& formattedLog) {
-    // Console output
-    if (m_consoleOutput) {
+/**
+ * @brief Append text padded with spaces to a minimum width
+ */
+static void appendPadded(std::string& out, const std::string& text, size_t width) {
+    out += text;
+    if (text.size() < width) {
+        out.append(width - text.size(), ' ');
+    }
+}
+
+void Logger::formatLogEntry(LogLevel level, std::chrono::system_clock::time_point timestamp,
+                            const std::string& module, const std::string& message,
+                            std::string& out) {
+    auto sinceEpoch = timestamp.time_since_epoch();
+    int64_t second = std::chrono::duration_cast<std::chrono::seconds>(sinceEpoch).count();
+    int ms = static_cast<int>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(sinceEpoch).count() % 1000);
+
+    // localtime and strftime only run once per second of log output
+    if (second != m_cachedSecond) {
+        std::time_t seconds = static_cast<std::time_t>(second);
+        char buffer[32];
+        std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", std::localtime(&seconds));
+        m_cachedTimestamp = buffer;
+        m_cachedSecond = second;
+    }
+
+    char millis[8];
+    std::snprintf(millis, sizeof(millis), ".%03d", ms);
+
+    out += '[';
+    out += m_cachedTimestamp;
+    out += millis;
+    out += "] [";
+    appendPadded(out, levelToString(level), 8);
+    out += "] [";
+    appendPadded(out, module, 20);
+    out += "] ";
+    out += message;
+}
+
+void Logger::writeConsole(LogLevel level, const std::string& line) {
+    const bool isError = level == LogLevel::ERROR || level == LogLevel::CRITICAL;
+    const bool isWarning = level == LogLevel::WARNING;
+
 #ifdef _WIN32
-        // On Windows, use colored output
-        HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
-        CONSOLE_SCREEN_BUFFER_INFO consoleInfo;
-        GetConsoleScreenBufferInfo(hConsole, &consoleInfo);
-        WORD saved_attributes = consoleInfo.wAttributes;
-
-        // Set color based on log level (extract from formatted log)
-        if (formattedLog.find("[ERROR") != std::string::npos ||
-            formattedLog.find("[CRITICAL") != std::string::npos) {
-            SetConsoleTextAttribute(hConsole, FOREGROUND_RED | FOREGROUND_INTENSITY);
-        } else if (formattedLog.find("[WARNING") != std::string::npos) {
-            SetConsoleTextAttribute(hConsole, FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_INTENSITY);
-        }
+    // On Windows, use colored output
+    HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
+    CONSOLE_SCREEN_BUFFER_INFO consoleInfo;
+    GetConsoleScreenBufferInfo(hConsole, &consoleInfo);
+    WORD saved_attributes = consoleInfo.wAttributes;
+
+    if (isError) {
+        SetConsoleTextAttribute(hConsole, FOREGROUND_RED | FOREGROUND_INTENSITY);
+    } else if (isWarning) {
+        SetConsoleTextAttribute(hConsole, FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_INTENSITY);
+    }
 
-        std::cout << formattedLog << std::endl;
+    std::cout << line << '\n';
+    if (isError || isWarning) {
+        // The color applies to what has been written, so push it out first
+        std::cout.flush();
         SetConsoleTextAttribute(hConsole, saved_attributes);
+    }
 #else
-        // On Linux/Unix, use ANSI color codes
-        if (formattedLog.find("[ERROR") != std::string::npos ||
-            formattedLog.find("[CRITICAL") != std::string::npos) {
-            std::cout << "\033[1;31m" << formattedLog << "\033[0m" << std::endl;
-        } else if (formattedLog.find("[WARNING") != std::string::npos) {
-            std::cout << "\033[1;33m" << formattedLog << "\033[0m" << std::endl;
-        } else {
-            std::cout << formattedLog << std::endl;
-        }
+    // On Linux/Unix, use ANSI color codes
+    if (isError) {
+        std::cout << "\033[1;31m" << line << "\033[0m\n";
+    } else if (isWarning) {
+        std::cout << "\033[1;33m" << line << "\033[0m\n";
+    } else {
+        std::cout << line << '\n';
+    }
 #endif
+}
+
+void Logger::logSync(LogLevel level, const std::string& module, const std::string& message) {
+    auto timestamp = std::chrono::system_clock::now();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::string line;
+    formatLogEntry(level, timestamp, module, message, line);
+
+    if (m_consoleOutput) {
+        writeConsole(level, line);
+        std::cout.flush();
     }
 
-    // File output
     if (m_fileOutput && m_logFile.is_open()) {
-        m_logFile << formattedLog << std::endl;
+        m_logFile << line << std::endl;
     }
 }
 
@@ -121,9 +213,222 @@ void Logger::log(LogLevel level, const std::string& module, const std::string& m
         return;
     }
 
+    if (m_async && pushAsync(level, module, std::string(message))) {
+        return;
+    }
+    logSync(level, module, message);
+}
+
+void Logger::log(LogLevel level, const std::string& module, std::string&& message) {
+    if (level < m_minLevel) {
+        return;
+    }
+
+    if (m_async && pushAsync(level, module, std::move(message))) {
+        return;
+    }
+    logSync(level, module, message);
+}
+
+bool Logger::pushAsync(LogLevel level, const std::string& module, std::string&& message) {
+    // Announce the push before checking the mode, so disableAsync can wait
+    // for pushes already past the check
+    m_activeProducers++;
+    if (!m_async) {
+        m_activeProducers--;
+        return false;
+    }
+
+    auto timestamp = std::chrono::system_clock::now();
+    uint64_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+    Slot* slot = nullptr;
+
+    while (true) {
+        slot = &m_ring[pos & m_ringMask];
+        uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+        int64_t diff = static_cast<int64_t>(sequence) - static_cast<int64_t>(pos);
+
+        if (diff == 0) {
+            // Slot is free for this position; claim it
+            if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // Full: the writer has not consumed this slot's previous record yet
+            if (m_overflowPolicy == OverflowPolicy::DROP) {
+                m_dropped++;
+                m_activeProducers--;
+                return true;
+            }
+            // Sleep until the writer hands this slot back
+            {
+                std::unique_lock<std::mutex> lock(m_writerMutex);
+                m_writerCondition.notify_one();
+                m_spaceCondition.wait(lock, [this, slot, pos] {
+                    int64_t lap = static_cast<int64_t>(slot->sequence.load(std::memory_order_acquire)) -
+                                  static_cast<int64_t>(pos);
+                    return lap >= 0;
+                });
+            }
+            pos = m_enqueuePos.load(std::memory_order_relaxed);
+        } else {
+            // Another producer took this position
+            pos = m_enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->level = level;
+    slot->timestamp = timestamp;
+    slot->module = module;
+    slot->message = std::move(message);
+    slot->sequence.store(pos + 1, std::memory_order_release);
+
+    m_pushed++;
+    m_activeProducers--;
+
+    // Errors are usually followed by a crash or exit; do not let them wait
+    // for the idle timeout
+    if (m_writerSleeping || level >= LogLevel::ERROR) {
+        wakeWriter();
+    }
+    return true;
+}
+
+void Logger::wakeWriter() {
+    std::lock_guard<std::mutex> lock(m_writerMutex);
+    m_writerCondition.notify_one();
+}
+
+size_t Logger::drainBatch() {
+    std::string fileBatch;
+    size_t count = 0;
+
     std::lock_guard<std::mutex> lock(m_mutex);
-    std::string formattedLog = formatLogEntry(level, module, message);
-    writeLog(formattedLog);
+    const bool console = m_consoleOutput;
+    const bool file = m_fileOutput && m_logFile.is_open();
+
+    while (count < WRITER_BATCH) {
+        Slot& slot = m_ring[m_dequeuePos & m_ringMask];
+        if (slot.sequence.load(std::memory_order_acquire) != m_dequeuePos + 1) {
+            break; // Empty, or the producer is still filling the slot
+        }
+
+        std::string line;
+        formatLogEntry(slot.level, slot.timestamp, slot.module, slot.message, line);
+        if (console) {
+            writeConsole(slot.level, line);
+        }
+        if (file) {
+            fileBatch += line;
+            fileBatch += '\n';
+        }
+
+        // Hand the slot back to producers one lap ahead
+        slot.sequence.store(m_dequeuePos + m_ring.size(), std::memory_order_release);
+        m_dequeuePos++;
+        count++;
+    }
+
+    if (count > 0) {
+        // One write and one flush per batch instead of per line
+        if (file) {
+            m_logFile.write(fileBatch.data(), static_cast<std::streamsize>(fileBatch.size()));
+            m_logFile.flush();
+        }
+        if (console) {
+            std::cout.flush();
+        }
+    }
+    return count;
+}
+
+void Logger::writerLoop() {
+    uint64_t reportedDrops = 0;
+
+    while (true) {
+        size_t written = drainBatch();
+
+        uint64_t dropped = m_dropped;
+        if (dropped != reportedDrops) {
+            logSync(LogLevel::WARNING, "Logger", "Log queue full, dropped " +
+                    std::to_string(dropped - reportedDrops) + " messages");
+            reportedDrops = dropped;
+        }
+
+        if (written > 0) {
+            m_written += written;
+            std::lock_guard<std::mutex> lock(m_writerMutex);
+            m_flushCondition.notify_all();
+            m_spaceCondition.notify_all();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_writerMutex);
+        if (!m_writerRunning && m_written == m_pushed) {
+            break;
+        }
+        m_writerSleeping = true;
+        m_writerCondition.wait_for(lock, WRITER_IDLE_TIMEOUT, [this] {
+            return !m_writerRunning || m_written != m_pushed;
+        });
+        m_writerSleeping = false;
+    }
+}
+
+void Logger::enableAsync(const AsyncConfig& config) {
+    std::lock_guard<std::mutex> configLock(m_configMutex);
+    if (m_async) {
+        stopWriter();
+    }
+
+    size_t capacity = 2;
+    while (capacity < config.queueCapacity) {
+        capacity <<= 1;
+    }
+
+    m_ring = std::vector<Slot>(capacity);
+    for (size_t i = 0; i < capacity; i++) {
+        m_ring[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    m_ringMask = capacity - 1;
+    m_enqueuePos = 0;
+    m_dequeuePos = 0;
+    m_pushed = 0;
+    m_written = 0;
+    m_overflowPolicy = config.overflowPolicy;
+
+    m_writerRunning = true;
+    m_writerThread = std::thread(&Logger::writerLoop, this);
+    m_async = true;
+}
+
+void Logger::enableAsync() {
+    enableAsync(AsyncConfig());
+}
+
+void Logger::disableAsync() {
+    std::lock_guard<std::mutex> configLock(m_configMutex);
+    if (m_async) {
+        stopWriter();
+    }
+}
+
+void Logger::stopWriter() {
+    // New records go the synchronous path; wait out pushes in progress so
+    // the writer sees everything before it exits
+    m_async = false;
+    while (m_activeProducers > 0) {
+        std::this_thread::yield();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_writerMutex);
+        m_writerRunning = false;
+        m_writerCondition.notify_one();
+    }
+    if (m_writerThread.joinable()) {
+        m_writerThread.join();
+    }
 }
 
 void Logger::setFileOutput(bool enable) {
@@ -161,6 +466,16 @@ void Logger::setLogFilePath(const std::string& filepath) {
 }
 
 void Logger::flush() {
+    if (m_async) {
+        // Wait for the writer to get past every record pushed so far
+        uint64_t target = m_pushed;
+        std::unique_lock<std::mutex> lock(m_writerMutex);
+        m_writerCondition.notify_one();
+        m_flushCondition.wait(lock, [this, target] {
+            return m_written >= target || !m_writerRunning;
+        });
+    }
+
     std::lock_guard<std::mutex> lock(m_mutex);
     if (m_logFile.is_open()) {
         m_logFile.flush();
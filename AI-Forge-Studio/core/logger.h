@@ -12,6 +12,10 @@
  * - Console and file output
  * - Automatic log file rotation
  * - Performance monitoring integration
+ * - Optional asynchronous mode: producers push records into a lock-free
+ *   ring and a background thread formats and writes them in batches
+ * - Compile-time level floor (AIFORGE_LOG_MIN_LEVEL) and lazy macros that
+ *   only build the message once the level check passes
  */
 
 #ifndef LOGGER_H
@@ -20,9 +24,35 @@
 #include <string>
 #include <fstream>
 #include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <vector>
 #include <memory>
 #include <chrono>
 #include <sstream>
+#include <cstdint>
+
+// Numeric log levels for the preprocessor (match Logger::LogLevel)
+#define AIFORGE_LOG_LEVEL_DEBUG    0
+#define AIFORGE_LOG_LEVEL_INFO     1
+#define AIFORGE_LOG_LEVEL_WARNING  2
+#define AIFORGE_LOG_LEVEL_ERROR    3
+#define AIFORGE_LOG_LEVEL_CRITICAL 4
+
+// LOG_* macros below this level compile to nothing: the message expression
+// is never evaluated and the call is not emitted. Set by the build (e.g.
+// -DAIFORGE_LOG_MIN_LEVEL=1 strips LOG_DEBUG from release builds).
+#ifndef AIFORGE_LOG_MIN_LEVEL
+#define AIFORGE_LOG_MIN_LEVEL AIFORGE_LOG_LEVEL_DEBUG
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define AIFORGE_PRINTF_FORMAT(formatIndex, firstArg) \
+    __attribute__((format(printf, formatIndex, firstArg)))
+#else
+#define AIFORGE_PRINTF_FORMAT(formatIndex, firstArg)
+#endif
 
 namespace AIForge {
 
@@ -43,6 +73,23 @@ public:
         CRITICAL
     };
 
+    /**
+     * @brief What producers do when the async queue is full
+     */
+    enum class OverflowPolicy {
+        BLOCK,          // Wait for the writer to make room (nothing is lost)
+        DROP            // Discard the record and count it
+    };
+
+    /**
+     * @struct AsyncConfig
+     * @brief Configuration for asynchronous logging
+     */
+    struct AsyncConfig {
+        size_t queueCapacity = 8192;    // Records; rounded up to a power of two
+        OverflowPolicy overflowPolicy = OverflowPolicy::BLOCK;
+    };
+
     /**
      * @brief Get singleton instance
      * @return Reference to the logger instance
@@ -63,18 +110,77 @@ public:
      */
     void log(LogLevel level, const std::string& module, const std::string& message);
 
+    /**
+     * @brief Log a message with specified level, taking ownership of the text
+     * @param level Severity level of the message
+     * @param module Name of the module generating the log
+     * @param message The log message (moved into the queue in async mode)
+     */
+    void log(LogLevel level, const std::string& module, std::string&& message);
+
     /**
      * @brief Set minimum log level to display/record
      * @param level Minimum level (messages below this are ignored)
      */
     void setMinLogLevel(LogLevel level) { m_minLevel = level; }
 
+    /**
+     * @brief Check whether a level passes the runtime filter
+     *
+     * The LOG_* macros call this before building their message.
+     *
+     * @param level Severity level
+     * @return true if messages at this level are recorded
+     */
+    bool isEnabled(LogLevel level) const { return level >= m_minLevel.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Build a message from a printf-style format
+     * @param format printf format string
+     * @return Formatted message
+     */
+    static std::string formatMessage(const char* format, ...) AIFORGE_PRINTF_FORMAT(1, 2);
+
     /**
      * @brief Enable or disable console output
      * @param enable true to enable console output, false to disable
      */
     void setConsoleOutput(bool enable) { m_consoleOutput = enable; }
 
+    /**
+     * @brief Switch to asynchronous logging
+     *
+     * log() then only timestamps the record and pushes it into a lock-free
+     * queue; a background thread formats, colors and writes records in
+     * batches. Calling again with a new configuration drains the queue
+     * first.
+     *
+     * @param config Queue capacity and overflow policy
+     */
+    void enableAsync(const AsyncConfig& config);
+
+    /**
+     * @brief Switch to asynchronous logging with the default AsyncConfig
+     */
+    void enableAsync();
+
+    /**
+     * @brief Write everything still queued and return to synchronous logging
+     */
+    void disableAsync();
+
+    /**
+     * @brief Check if asynchronous logging is active
+     * @return true if records go through the queue
+     */
+    bool isAsync() const { return m_async; }
+
+    /**
+     * @brief Get the number of records discarded by OverflowPolicy::DROP
+     * @return Dropped record count since the logger was created
+     */
+    uint64_t getDroppedCount() const { return m_dropped; }
+
     /**
      * @brief Enable or disable file output
      * @param enable true to enable file output, false to disable
@@ -89,6 +195,9 @@ public:
 
     /**
      * @brief Flush all pending log entries to file
+     *
+     * In async mode, blocks until every record logged before the call has
+     * been written.
      */
     void flush();
 
@@ -109,47 +218,167 @@ private:
     Logger();
     ~Logger();
 
-    std::mutex m_mutex;
+    /**
+     * @struct Slot
+     * @brief One queued record; sequence tells producers and the writer whose turn it is
+     */
+    struct Slot {
+        std::atomic<uint64_t> sequence{0};
+        LogLevel level = LogLevel::INFO;
+        std::chrono::system_clock::time_point timestamp;
+        std::string module;     // Assigned in place, so capacity is reused
+        std::string message;
+    };
+
+    std::mutex m_mutex;         // Guards the outputs
     std::ofstream m_logFile;
     std::string m_logFilePath;
-    LogLevel m_minLevel;
-    bool m_consoleOutput;
+    std::atomic<LogLevel> m_minLevel;
+    std::atomic<bool> m_consoleOutput;
     bool m_fileOutput;
 
+    // Timestamp formatting cache (m_mutex): "YYYY-MM-DD HH:MM:SS" of m_cachedSecond
+    int64_t m_cachedSecond;
+    std::string m_cachedTimestamp;
+
+    // Async queue (bounded MPSC ring)
+    std::vector<Slot> m_ring;
+    uint64_t m_ringMask;
+    std::atomic<uint64_t> m_enqueuePos;
+    uint64_t m_dequeuePos;              // Writer thread only
+    OverflowPolicy m_overflowPolicy;
+    std::atomic<bool> m_async;
+    std::atomic<int> m_activeProducers; // Inside an async push
+    std::atomic<uint64_t> m_dropped;
+
+    std::thread m_writerThread;
+    std::atomic<bool> m_writerRunning;
+    std::atomic<bool> m_writerSleeping;
+    std::atomic<uint64_t> m_pushed;     // Records accepted into the ring
+    std::atomic<uint64_t> m_written;    // Records written by the writer
+    std::mutex m_writerMutex;
+    std::condition_variable m_writerCondition;
+    std::condition_variable m_flushCondition;
+    std::condition_variable m_spaceCondition;   // Writer freed slots (BLOCK policy)
+    std::mutex m_configMutex;           // Serializes enableAsync/disableAsync
+
+    /**
+     * @brief Queue a record, honoring the overflow policy
+     * @return false if async mode is off (caller logs synchronously)
+     */
+    bool pushAsync(LogLevel level, const std::string& module, std::string&& message);
+
+    /**
+     * @brief Format and write one record synchronously
+     */
+    void logSync(LogLevel level, const std::string& module, const std::string& message);
+
     /**
-     * @brief Format a log entry
+     * @brief Format a log entry (m_mutex must be held)
      * @param level Log level
+     * @param timestamp When the record was logged
      * @param module Module name
      * @param message Log message
-     * @return Formatted log string
+     * @param out Receives the formatted line (appended, without newline)
+     */
+    void formatLogEntry(LogLevel level, std::chrono::system_clock::time_point timestamp,
+                        const std::string& module, const std::string& message,
+                        std::string& out);
+
+    /**
+     * @brief Write one formatted line to the console with the level's color
+     *        (m_mutex must be held)
+     */
+    void writeConsole(LogLevel level, const std::string& line);
+
+    /**
+     * @brief Wake the writer thread if it is waiting for records
+     */
+    void wakeWriter();
+
+    /**
+     * @brief Stop the writer after it has drained the queue
      */
-    std::string formatLogEntry(LogLevel level, const std::string& module,
-                               const std::string& message);
+    void stopWriter();
 
     /**
-     * @brief Write formatted log to outputs
-     * @param formattedLog The formatted log string
+     * @brief Writer thread main loop
      */
-    void writeLog(const std::string& formattedLog);
+    void writerLoop();
+
+    /**
+     * @brief Write up to a batch of queued records (writer thread only)
+     * @return Number of records written
+     */
+    size_t drainBatch();
 };
 
 /**
- * @brief Helper macro for debug logging
+ * @brief Log only if the runtime level allows it; message is evaluated lazily
+ */
+#define AIFORGE_LOG(level, module, message) \
+    do { \
+        Logger& aiforgeLogger_ = Logger::getInstance(); \
+        if (aiforgeLogger_.isEnabled(level)) { \
+            aiforgeLogger_.log(level, module, message); \
+        } \
+    } while (0)
+
+/**
+ * @brief printf-style variant: one allocation for the whole message, and
+ *        none at all when the level is filtered out
+ */
+#define AIFORGE_LOGF(level, module, ...) \
+    AIFORGE_LOG(level, module, Logger::formatMessage(__VA_ARGS__))
+
+/**
+ * @brief Stand-in for macros stripped at compile time; the arguments are
+ *        type-checked but never evaluated
+ */
+#define AIFORGE_LOG_DISCARD(module, ...) \
+    do { (void)sizeof(module); (void)sizeof((__VA_ARGS__)); } while (0)
+
+/**
+ * @brief Helper macros for logging at each level
+ *
+ * LOG_INFO("Module", "Loaded " + name);
+ * LOG_INFOF("Module", "Inference completed in %.2f ms", timeMs);
  */
-#define LOG_DEBUG(module, message) \
-    Logger::getInstance().log(Logger::LogLevel::DEBUG, module, message)
+#if AIFORGE_LOG_MIN_LEVEL <= AIFORGE_LOG_LEVEL_DEBUG
+#define LOG_DEBUG(module, message) AIFORGE_LOG(Logger::LogLevel::DEBUG, module, message)
+#define LOG_DEBUGF(module, ...) AIFORGE_LOGF(Logger::LogLevel::DEBUG, module, __VA_ARGS__)
+#else
+#define LOG_DEBUG(module, message) AIFORGE_LOG_DISCARD(module, message)
+#define LOG_DEBUGF(module, ...) AIFORGE_LOG_DISCARD(module, __VA_ARGS__)
+#endif
 
-#define LOG_INFO(module, message) \
-    Logger::getInstance().log(Logger::LogLevel::INFO, module, message)
+#if AIFORGE_LOG_MIN_LEVEL <= AIFORGE_LOG_LEVEL_INFO
+#define LOG_INFO(module, message) AIFORGE_LOG(Logger::LogLevel::INFO, module, message)
+#define LOG_INFOF(module, ...) AIFORGE_LOGF(Logger::LogLevel::INFO, module, __VA_ARGS__)
+#else
+#define LOG_INFO(module, message) AIFORGE_LOG_DISCARD(module, message)
+#define LOG_INFOF(module, ...) AIFORGE_LOG_DISCARD(module, __VA_ARGS__)
+#endif
 
-#define LOG_WARNING(module, message) \
-    Logger::getInstance().log(Logger::LogLevel::WARNING, module, message)
+#if AIFORGE_LOG_MIN_LEVEL <= AIFORGE_LOG_LEVEL_WARNING
+#define LOG_WARNING(module, message) AIFORGE_LOG(Logger::LogLevel::WARNING, module, message)
+#define LOG_WARNINGF(module, ...) AIFORGE_LOGF(Logger::LogLevel::WARNING, module, __VA_ARGS__)
+#else
+#define LOG_WARNING(module, message) AIFORGE_LOG_DISCARD(module, message)
+#define LOG_WARNINGF(module, ...) AIFORGE_LOG_DISCARD(module, __VA_ARGS__)
+#endif
 
-#define LOG_ERROR(module, message) \
-    Logger::getInstance().log(Logger::LogLevel::ERROR, module, message)
+#if AIFORGE_LOG_MIN_LEVEL <= AIFORGE_LOG_LEVEL_ERROR
+#define LOG_ERROR(module, message) AIFORGE_LOG(Logger::LogLevel::ERROR, module, message)
+#define LOG_ERRORF(module, ...) AIFORGE_LOGF(Logger::LogLevel::ERROR, module, __VA_ARGS__)
+#else
+#define LOG_ERROR(module, message) AIFORGE_LOG_DISCARD(module, message)
+#define LOG_ERRORF(module, ...) AIFORGE_LOG_DISCARD(module, __VA_ARGS__)
+#endif
 
-#define LOG_CRITICAL(module, message) \
-    Logger::getInstance().log(Logger::LogLevel::CRITICAL, module, message)
+// CRITICAL is never stripped
+#define LOG_CRITICAL(module, message) AIFORGE_LOG(Logger::LogLevel::CRITICAL, module, message)
+#define LOG_CRITICALF(module, ...) AIFORGE_LOGF(Logger::LogLevel::CRITICAL, module, __VA_ARGS__)
 
 } // namespace AIForge
 
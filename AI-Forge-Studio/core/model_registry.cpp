@@ -0,0 +1,96 @@
+/**
+ * @file model_registry.cpp
+ * @brief Implementation of the model registry
+ */
+
+#include "model_registry.h"
+
+namespace AIForge {
+
+ModelRegistry::ModelRegistry()
+    : m_snapshot(std::make_shared<const Snapshot>())
+{
+}
+
+ModelRegistry::~ModelRegistry() = default;
+
+ModelHandle ModelRegistry::find(const std::string& modelId) const {
+    std::shared_lock<std::shared_mutex> lock(m_snapshotMutex);
+    auto it = m_snapshot->find(modelId);
+    return it == m_snapshot->end() ? nullptr : it->second;
+}
+
+std::shared_ptr<const ModelRegistry::Snapshot> ModelRegistry::snapshot() const {
+    std::shared_lock<std::shared_mutex> lock(m_snapshotMutex);
+    return m_snapshot;
+}
+
+size_t ModelRegistry::size() const {
+    std::shared_lock<std::shared_mutex> lock(m_snapshotMutex);
+    return m_snapshot->size();
+}
+
+bool ModelRegistry::insert(const std::string& modelId, ModelHandle model) {
+    std::shared_ptr<const Snapshot> previous;
+    std::lock_guard<std::mutex> lock(m_writeMutex);
+
+    // Writers are serialized, so the current snapshot is stable here
+    if (m_snapshot->count(modelId)) {
+        return false;
+    }
+    auto next = std::make_shared<Snapshot>(*m_snapshot);
+    (*next)[modelId] = std::move(model);
+
+    std::unique_lock<std::shared_mutex> swap(m_snapshotMutex);
+    previous = std::move(m_snapshot);
+    m_snapshot = std::move(next);
+    return true;
+}
+
+ModelHandle ModelRegistry::remove(const std::string& modelId) {
+    // Declared first so the old snapshot is released after both locks: it
+    // may hold the last handle of another model being torn down, whose
+    // deleter calls forget
+    std::shared_ptr<const Snapshot> previous;
+    ModelHandle removed;
+    {
+        std::lock_guard<std::mutex> lock(m_writeMutex);
+        auto it = m_snapshot->find(modelId);
+        if (it == m_snapshot->end()) {
+            return nullptr;
+        }
+        removed = it->second;
+        m_retired[modelId] = removed.get();
+
+        auto next = std::make_shared<Snapshot>(*m_snapshot);
+        next->erase(modelId);
+
+        std::unique_lock<std::shared_mutex> swap(m_snapshotMutex);
+        previous = std::move(m_snapshot);
+        m_snapshot = std::move(next);
+    }
+    return removed;
+}
+
+AIModel* ModelRegistry::findRetained(const std::string& modelId) const {
+    {
+        // Look inside the snapshot instead of copying it, so no reference
+        // is taken or dropped
+        std::shared_lock<std::shared_mutex> lock(m_snapshotMutex);
+        auto it = m_snapshot->find(modelId);
+        if (it != m_snapshot->end()) {
+            return it->second.get();
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_writeMutex);
+    auto it = m_retired.find(modelId);
+    return it == m_retired.end() ? nullptr : it->second;
+}
+
+void ModelRegistry::forget(const std::string& modelId) {
+    std::lock_guard<std::mutex> lock(m_writeMutex);
+    m_retired.erase(modelId);
+}
+
+} // namespace AIForge
@@ -0,0 +1,129 @@
+/**
+ * @file model_registry.h
+ * @brief Concurrent registry of loaded models
+ *
+ * Every request resolves its model ID from a worker thread while the UI
+ * thread loads and unloads models. The registry publishes the ID map as an
+ * immutable snapshot: readers hold a shared lock only while they look up
+ * and copy one handle, and writers build the next snapshot beside the
+ * current one and swap it in.
+ *
+ * Handles are reference counted, so a request that resolved a model keeps
+ * it alive across unloadModel. The handle's deleter releases the model's
+ * resources once the last request lets go.
+ *
+ * Features:
+ * - Readers never take an exclusive lock and never wait for each other
+ * - Copy-on-write snapshots for iteration without holding any lock
+ * - Unloaded models stay reachable by ID, without a reference, until destroyed
+ *
+ * Thread-safe.
+ */
+
+#ifndef MODEL_REGISTRY_H
+#define MODEL_REGISTRY_H
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <cstddef>
+
+namespace AIForge {
+
+class AIModel;
+
+// Keeps a model alive; the engine's deleter tears it down
+using ModelHandle = std::shared_ptr<AIModel>;
+
+/**
+ * @class ModelRegistry
+ * @brief Model ID to handle map read through published snapshots
+ */
+class ModelRegistry {
+public:
+    using Snapshot = std::map<std::string, ModelHandle>;
+
+    ModelRegistry();
+    ~ModelRegistry();
+
+    // Disable copy and move
+    ModelRegistry(const ModelRegistry&) = delete;
+    ModelRegistry& operator=(const ModelRegistry&) = delete;
+    ModelRegistry(ModelRegistry&&) = delete;
+    ModelRegistry& operator=(ModelRegistry&&) = delete;
+
+    /**
+     * @brief Look up a loaded model
+     * @param modelId Model identifier
+     * @return Handle keeping the model alive, or nullptr if not loaded
+     */
+    ModelHandle find(const std::string& modelId) const;
+
+    /**
+     * @brief Get the current set of loaded models
+     *
+     * The snapshot does not change; later loads and unloads publish new ones.
+     *
+     * @return Immutable ID to handle map
+     */
+    std::shared_ptr<const Snapshot> snapshot() const;
+
+    /**
+     * @brief Get number of loaded models
+     * @return Model count
+     */
+    size_t size() const;
+
+    /**
+     * @brief Publish a model
+     * @param modelId Model identifier
+     * @param model Model handle
+     * @return false if the ID is already loaded
+     */
+    bool insert(const std::string& modelId, ModelHandle model);
+
+    /**
+     * @brief Unpublish a model
+     *
+     * Requests that already hold the handle keep using the model. It stays
+     * reachable through findRetained until forget is called.
+     *
+     * @param modelId Model identifier
+     * @return The removed handle, or nullptr if not loaded
+     */
+    ModelHandle remove(const std::string& modelId);
+
+    /**
+     * @brief Look up a loaded or unloaded-but-alive model without a reference
+     *
+     * Taking no reference means the caller can never be the one to destroy
+     * the model. The pointer is only valid while the caller otherwise holds
+     * off the model's destruction (e.g. during a residency transfer, which
+     * the teardown waits for).
+     *
+     * @param modelId Model identifier
+     * @return Model, or nullptr if destroyed or unknown
+     */
+    AIModel* findRetained(const std::string& modelId) const;
+
+    /**
+     * @brief Drop an unloaded model from findRetained (from its deleter)
+     * @param modelId Model identifier
+     */
+    void forget(const std::string& modelId);
+
+private:
+    // Writers only swap the pointer under the exclusive lock
+    mutable std::shared_mutex m_snapshotMutex;
+    std::shared_ptr<const Snapshot> m_snapshot;
+
+    // Serializes writers and guards m_retired
+    mutable std::mutex m_writeMutex;
+    std::map<std::string, AIModel*> m_retired;
+};
+
+} // namespace AIForge
+
+#endif // MODEL_REGISTRY_H
@@ -0,0 +1,378 @@
+/**
+ * @file model_residency.cpp
+ * @brief Implementation of the model residency manager
+ *
+ * A model being moved is marked busy and already carries its target state,
+ * so concurrent acquires see the VRAM it is about to occupy (or free) and
+ * never over-commit the budget while transfers run outside the lock.
+ */
+
+#include "model_residency.h"
+#include "logger.h"
+#include <algorithm>
+#include <vector>
+#include <limits>
+
+namespace AIForge {
+
+ResidencyManager::ResidencyManager(TransitionHandler handler)
+    : m_handler(std::move(handler))
+    , m_clock(0)
+    , m_running(false)
+{
+}
+
+ResidencyManager::~ResidencyManager() {
+    stop();
+}
+
+void ResidencyManager::start(const ResidencyConfig& config) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_config = config;
+    if (m_running) {
+        return;
+    }
+    m_running = true;
+    m_prefetchThread = std::thread(&ResidencyManager::prefetchLoop, this);
+}
+
+void ResidencyManager::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_running) {
+            return;
+        }
+        m_running = false;
+        m_prefetchQueue.clear();
+    }
+    m_condition.notify_all();
+
+    if (m_prefetchThread.joinable()) {
+        m_prefetchThread.join();
+    }
+}
+
+void ResidencyManager::setConfig(const ResidencyConfig& config) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_config = config;
+}
+
+void ResidencyManager::setDeviceBudget(int deviceId, size_t budgetMB) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_deviceBudgets[deviceId] = budgetMB;
+    }
+    LOG_INFO("Residency", "Device " + std::to_string(deviceId) + " model budget: " +
+             std::to_string(budgetMB) + " MB");
+    m_condition.notify_all();
+}
+
+void ResidencyManager::registerModel(const std::string& modelId, int deviceId, size_t sizeMB) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Entry entry;
+    entry.deviceId = deviceId;
+    entry.sizeMB = sizeMB;
+    entry.lastUsed = ++m_clock;
+    m_entries[modelId] = entry;
+}
+
+void ResidencyManager::unregisterModel(const std::string& modelId) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_condition.wait(lock, [this, &modelId] {
+        auto it = m_entries.find(modelId);
+        return it == m_entries.end() || !it->second.busy;
+    });
+    m_entries.erase(modelId);
+    m_prefetchQueue.erase(std::remove(m_prefetchQueue.begin(), m_prefetchQueue.end(), modelId),
+                          m_prefetchQueue.end());
+    lock.unlock();
+    m_condition.notify_all();
+}
+
+void ResidencyManager::updateModelSize(const std::string& modelId, size_t sizeMB) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_entries.find(modelId);
+    if (it != m_entries.end()) {
+        it->second.sizeMB = sizeMB;
+    }
+}
+
+bool ResidencyManager::acquire(const std::string& modelId, bool allowOffload, std::string* error) {
+    return makeResident(modelId, true, true, allowOffload, error);
+}
+
+void ResidencyManager::release(const std::string& modelId) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_entries.find(modelId);
+        if (it == m_entries.end() || it->second.pins == 0) {
+            return;
+        }
+        it->second.pins--;
+        it->second.lastUsed = ++m_clock;
+    }
+    m_condition.notify_all();
+}
+
+void ResidencyManager::prefetch(const std::string& modelId) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_running || !m_config.prefetch) {
+            return;
+        }
+        auto it = m_entries.find(modelId);
+        if (it == m_entries.end() || it->second.state == ResidencyState::RESIDENT ||
+            std::find(m_prefetchQueue.begin(), m_prefetchQueue.end(), modelId) != m_prefetchQueue.end()) {
+            return;
+        }
+        m_prefetchQueue.push_back(modelId);
+    }
+    m_condition.notify_all();
+}
+
+bool ResidencyManager::makeResident(const std::string& modelId, bool pin, bool wait,
+                                    bool allowOffload, std::string* error) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (true) {
+        auto it = m_entries.find(modelId);
+        if (it == m_entries.end()) {
+            if (error) *error = "Model not registered: " + modelId;
+            return false;
+        }
+        Entry& entry = it->second;
+
+        if (entry.busy) {
+            if (!wait) return false;
+            m_condition.wait(lock);
+            continue;
+        }
+
+        if (entry.state == ResidencyState::RESIDENT) {
+            if (pin) {
+                entry.pins++;
+                entry.allowOffload = allowOffload;
+            }
+            entry.lastUsed = ++m_clock;
+            return true;
+        }
+
+        const size_t budget = budgetLocked(entry.deviceId);
+        if (entry.sizeMB > budget) {
+            if (error) {
+                *error = "Model needs " + std::to_string(entry.sizeMB) + " MB, device " +
+                         std::to_string(entry.deviceId) + " budget is " + std::to_string(budget) + " MB";
+            }
+            return false;
+        }
+
+        // Pick least-recently-used idle models until the new one fits
+        std::vector<std::pair<uint64_t, std::string>> candidates;
+        for (const auto& pair : m_entries) {
+            const Entry& other = pair.second;
+            if (pair.first != modelId && other.deviceId == entry.deviceId &&
+                other.state == ResidencyState::RESIDENT && other.pins == 0 && !other.busy) {
+                candidates.emplace_back(other.lastUsed, pair.first);
+            }
+        }
+        std::sort(candidates.begin(), candidates.end());
+
+        size_t used = residentLocked(entry.deviceId);
+        size_t freed = 0;
+        std::vector<std::string> victims;
+        for (const auto& candidate : candidates) {
+            if (used - freed + entry.sizeMB <= budget) {
+                break;
+            }
+            victims.push_back(candidate.second);
+            freed += m_entries[candidate.second].sizeMB;
+        }
+
+        if (used - freed + entry.sizeMB > budget) {
+            // Everything left is in use; wait for a release
+            if (!wait) return false;
+            m_condition.wait(lock);
+            continue;
+        }
+
+        // Reserve: victims and target take their new states now
+        size_t hostUsed = offloadedLocked();
+        std::vector<Move> moves;
+        for (const auto& victimId : victims) {
+            Entry& victim = m_entries[victimId];
+            ResidencyState to = ResidencyState::EVICTED;
+            if (victim.allowOffload && hostUsed + victim.sizeMB <= m_config.hostOffloadBudgetMB) {
+                to = ResidencyState::OFFLOADED;
+                hostUsed += victim.sizeMB;
+            }
+            moves.push_back({victimId, ResidencyState::RESIDENT, to});
+            victim.busy = true;
+            victim.state = to;
+        }
+
+        const ResidencyState from = entry.state;
+        entry.busy = true;
+        entry.state = ResidencyState::RESIDENT;
+        if (pin) {
+            entry.pins++;
+            entry.allowOffload = allowOffload;
+        }
+
+        lock.unlock();
+
+        // Free VRAM first; the model comes in only once every victim is out
+        std::vector<bool> moved;
+        for (const auto& move : moves) {
+            LOG_INFO("Residency", (move.to == ResidencyState::OFFLOADED ? "Offloading " : "Evicting ") +
+                     move.modelId + " to make room for " + modelId);
+            moved.push_back(m_handler(move.modelId, move.from, move.to));
+        }
+
+        lock.lock();
+
+        bool allMoved = true;
+        for (size_t i = 0; i < moves.size(); i++) {
+            auto victimIt = m_entries.find(moves[i].modelId);
+            if (victimIt == m_entries.end()) {
+                continue;
+            }
+            victimIt->second.busy = false;
+            if (!moved[i]) {
+                LOG_WARNING("Residency", "Failed to evict " + moves[i].modelId);
+                victimIt->second.state = ResidencyState::RESIDENT;
+                allMoved = false;
+            } else if (moves[i].to == ResidencyState::OFFLOADED) {
+                m_stats.offloads++;
+            } else {
+                m_stats.evictions++;
+            }
+        }
+
+        bool loaded = false;
+        if (allMoved) {
+            lock.unlock();
+            loaded = m_handler(modelId, from, ResidencyState::RESIDENT);
+            lock.lock();
+        }
+
+        it = m_entries.find(modelId);
+        if (it != m_entries.end()) {
+            Entry& self = it->second;
+            self.busy = false;
+            if (loaded) {
+                self.lastUsed = ++m_clock;
+                if (from == ResidencyState::OFFLOADED) {
+                    m_stats.hostReloads++;
+                } else {
+                    m_stats.loads++;
+                }
+            } else {
+                // Release the reservation; a victim still holds the VRAM it needed
+                self.state = from;
+                if (pin && self.pins > 0) {
+                    self.pins--;
+                }
+            }
+        }
+
+        lock.unlock();
+        m_condition.notify_all();
+
+        if (!loaded && error) {
+            *error = allMoved ? "Failed to make model resident: " + modelId
+                              : "Failed to evict models to make room for " + modelId;
+        }
+        return loaded;
+    }
+}
+
+size_t ResidencyManager::residentLocked(int deviceId) const {
+    size_t total = 0;
+    for (const auto& pair : m_entries) {
+        if (pair.second.deviceId == deviceId && pair.second.state == ResidencyState::RESIDENT) {
+            total += pair.second.sizeMB;
+        }
+    }
+    return total;
+}
+
+size_t ResidencyManager::offloadedLocked() const {
+    size_t total = 0;
+    for (const auto& pair : m_entries) {
+        if (pair.second.state == ResidencyState::OFFLOADED) {
+            total += pair.second.sizeMB;
+        }
+    }
+    return total;
+}
+
+size_t ResidencyManager::budgetLocked(int deviceId) const {
+    auto it = m_deviceBudgets.find(deviceId);
+    if (it == m_deviceBudgets.end()) {
+        return std::numeric_limits<size_t>::max();
+    }
+    return it->second;
+}
+
+ResidencyState ResidencyManager::getState(const std::string& modelId) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_entries.find(modelId);
+    return it == m_entries.end() ? ResidencyState::EVICTED : it->second.state;
+}
+
+size_t ResidencyManager::getResidentMB(int deviceId) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return residentLocked(deviceId);
+}
+
+ResidencyStats ResidencyManager::getStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ResidencyStats stats = m_stats;
+
+    for (const auto& pair : m_entries) {
+        switch (pair.second.state) {
+            case ResidencyState::RESIDENT:
+                stats.residentModels++;
+                stats.residentMB += pair.second.sizeMB;
+                break;
+            case ResidencyState::OFFLOADED:
+                stats.offloadedModels++;
+                stats.offloadedMB += pair.second.sizeMB;
+                break;
+            case ResidencyState::EVICTED:
+                stats.evictedModels++;
+                break;
+        }
+    }
+    for (const auto& pair : m_deviceBudgets) {
+        stats.budgetMB += pair.second;
+    }
+
+    return stats;
+}
+
+void ResidencyManager::prefetchLoop() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (m_running) {
+        m_condition.wait(lock, [this] { return !m_running || !m_prefetchQueue.empty(); });
+        if (!m_running) {
+            break;
+        }
+
+        std::string modelId = m_prefetchQueue.front();
+        m_prefetchQueue.pop_front();
+        lock.unlock();
+
+        // Never waits for running models: a prefetch that does not fit
+        // right now is simply skipped and the request loads on demand
+        if (makeResident(modelId, false, false, false, nullptr)) {
+            lock.lock();
+            m_stats.prefetches++;
+        } else {
+            lock.lock();
+        }
+    }
+}
+
+} // namespace AIForge
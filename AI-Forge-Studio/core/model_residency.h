@@ -0,0 +1,264 @@
+/**
+ * @file model_residency.h
+ * @brief VRAM-budgeted model residency with LRU eviction and host offload
+ *
+ * Tracks which loaded models currently hold VRAM on each device and keeps
+ * the total under a per-device budget. Before a model is used it is made
+ * resident, evicting the least-recently-used idle models first. Evicted
+ * models are either offloaded to pinned host memory (fast to bring back)
+ * or dropped and reloaded from their source file.
+ *
+ * The manager only makes decisions; moving the data is delegated to a
+ * transition callback supplied by the engine.
+ *
+ * Features:
+ * - Per-device VRAM budgets
+ * - LRU eviction of models that are not in use
+ * - Bounded pinned-host offload pool
+ * - Background prefetch for models with queued requests
+ */
+
+#ifndef MODEL_RESIDENCY_H
+#define MODEL_RESIDENCY_H
+
+#include "ai_engine.h"
+#include <string>
+#include <map>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <functional>
+#include <cstdint>
+
+namespace AIForge {
+
+/**
+ * @class ResidencyManager
+ * @brief Keeps per-device model VRAM usage within budget
+ */
+class ResidencyManager {
+public:
+    /**
+     * @brief Function moving a model's weights between states
+     *
+     * Called without the manager's lock held. Returns false if the move
+     * failed, in which case the model keeps its previous state.
+     */
+    using TransitionHandler = std::function<bool(const std::string& modelId,
+                                                 ResidencyState from, ResidencyState to)>;
+
+    explicit ResidencyManager(TransitionHandler handler);
+    ~ResidencyManager();
+
+    // Disable copy and move
+    ResidencyManager(const ResidencyManager&) = delete;
+    ResidencyManager& operator=(const ResidencyManager&) = delete;
+    ResidencyManager(ResidencyManager&&) = delete;
+    ResidencyManager& operator=(ResidencyManager&&) = delete;
+
+    /**
+     * @brief Start the prefetch thread
+     * @param config Residency configuration
+     */
+    void start(const ResidencyConfig& config);
+
+    /**
+     * @brief Stop the prefetch thread (pending prefetches are dropped)
+     */
+    void stop();
+
+    /**
+     * @brief Apply a new configuration (budgets take effect on the next acquire)
+     * @param config Residency configuration
+     */
+    void setConfig(const ResidencyConfig& config);
+
+    /**
+     * @brief Set the VRAM budget of a device
+     * @param deviceId GPU device ID
+     * @param budgetMB Budget in MB for model weights
+     */
+    void setDeviceBudget(int deviceId, size_t budgetMB);
+
+    /**
+     * @brief Start tracking a model (initially EVICTED)
+     * @param modelId Model ID
+     * @param deviceId Device the model runs on
+     * @param sizeMB VRAM needed when resident
+     */
+    void registerModel(const std::string& modelId, int deviceId, size_t sizeMB);
+
+    /**
+     * @brief Stop tracking a model, waiting for any transition in progress
+     * @param modelId Model ID
+     */
+    void unregisterModel(const std::string& modelId);
+
+    /**
+     * @brief Update a model's resident size (e.g. after precision optimization)
+     * @param modelId Model ID
+     * @param sizeMB New VRAM size
+     */
+    void updateModelSize(const std::string& modelId, size_t sizeMB);
+
+    /**
+     * @brief Make a model resident and pin it until release()
+     *
+     * Evicts least-recently-used idle models on the same device as needed,
+     * waiting for running models to be released if nothing idle is left.
+     *
+     * @param modelId Model ID
+     * @param allowOffload Whether this model may be offloaded to host memory
+     *                     when it is evicted later (InferenceConfig::useVRAMOffload)
+     * @param error Optional, receives the failure reason
+     * @return true if the model is resident and pinned
+     */
+    bool acquire(const std::string& modelId, bool allowOffload, std::string* error = nullptr);
+
+    /**
+     * @brief Unpin a model acquired with acquire()
+     * @param modelId Model ID
+     */
+    void release(const std::string& modelId);
+
+    /**
+     * @brief Bring a model in ahead of use, in the background
+     *
+     * Only evicts idle models; never waits for running ones.
+     *
+     * @param modelId Model ID
+     */
+    void prefetch(const std::string& modelId);
+
+    /**
+     * @brief Get a model's residency state
+     * @param modelId Model ID
+     * @return Current state (EVICTED if unknown)
+     */
+    ResidencyState getState(const std::string& modelId) const;
+
+    /**
+     * @brief Get VRAM held by resident models on a device
+     * @param deviceId GPU device ID
+     * @return Usage in MB
+     */
+    size_t getResidentMB(int deviceId) const;
+
+    /**
+     * @brief Get residency statistics across all devices
+     * @return ResidencyStats structure
+     */
+    ResidencyStats getStats() const;
+
+private:
+    struct Entry {
+        int deviceId = 0;
+        size_t sizeMB = 0;
+        ResidencyState state = ResidencyState::EVICTED;
+        int pins = 0;               // Active users
+        bool busy = false;          // Transition in progress
+        bool allowOffload = false;
+        uint64_t lastUsed = 0;      // Logical clock for LRU
+    };
+
+    struct Move {
+        std::string modelId;
+        ResidencyState from;
+        ResidencyState to;
+    };
+
+    TransitionHandler m_handler;
+    ResidencyConfig m_config;
+    std::map<std::string, Entry> m_entries;
+    std::map<int, size_t> m_deviceBudgets;
+    uint64_t m_clock;
+    ResidencyStats m_stats;
+
+    std::deque<std::string> m_prefetchQueue;
+    std::thread m_prefetchThread;
+    bool m_running;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_condition;
+
+    /**
+     * @brief Make a model resident
+     * @param modelId Model ID
+     * @param pin Pin the model on success
+     * @param wait Wait for pinned models to be released if VRAM is short
+     * @param allowOffload Offload setting to record (ignored if pin is false)
+     * @param error Optional failure reason
+     * @return true if resident
+     */
+    bool makeResident(const std::string& modelId, bool pin, bool wait,
+                      bool allowOffload, std::string* error);
+
+    /**
+     * @brief Usage of resident models on a device (lock must be held)
+     */
+    size_t residentLocked(int deviceId) const;
+
+    /**
+     * @brief Usage of offloaded models across devices (lock must be held)
+     */
+    size_t offloadedLocked() const;
+
+    /**
+     * @brief Budget of a device (lock must be held)
+     */
+    size_t budgetLocked(int deviceId) const;
+
+    /**
+     * @brief Prefetch thread main loop
+     */
+    void prefetchLoop();
+};
+
+/**
+ * @class ResidencyLease
+ * @brief Keeps a model resident for the lifetime of the lease
+ */
+class ResidencyLease {
+public:
+    ResidencyLease() : m_manager(nullptr) {}
+    ResidencyLease(ResidencyManager* manager, const std::string& modelId)
+        : m_manager(manager), m_modelId(modelId) {}
+    ~ResidencyLease() { reset(); }
+
+    ResidencyLease(const ResidencyLease&) = delete;
+    ResidencyLease& operator=(const ResidencyLease&) = delete;
+    ResidencyLease(ResidencyLease&& other) noexcept
+        : m_manager(other.m_manager), m_modelId(std::move(other.m_modelId)) {
+        other.m_manager = nullptr;
+    }
+    ResidencyLease& operator=(ResidencyLease&& other) noexcept {
+        if (this != &other) {
+            reset();
+            m_manager = other.m_manager;
+            m_modelId = std::move(other.m_modelId);
+            other.m_manager = nullptr;
+        }
+        return *this;
+    }
+
+    bool isHeld() const { return m_manager != nullptr; }
+
+    /**
+     * @brief Release the model early
+     */
+    void reset() {
+        if (m_manager) {
+            m_manager->release(m_modelId);
+            m_manager = nullptr;
+        }
+    }
+
+private:
+    ResidencyManager* m_manager;
+    std::string m_modelId;
+};
+
+} // namespace AIForge
+
+#endif // MODEL_RESIDENCY_H
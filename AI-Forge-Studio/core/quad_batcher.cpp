@@ -0,0 +1,73 @@
+/**
+ * @file quad_batcher.cpp
+ * @brief Implementation of the quad batcher
+ */
+
+#include "quad_batcher.h"
+#include <algorithm>
+
+namespace AIForge {
+
+QuadBatcher::QuadBatcher()
+    : m_bindless(true)
+    , m_maxInstancesPerBatch(4096)
+{
+}
+
+void QuadBatcher::configure(bool bindless, uint32_t maxInstancesPerBatch) {
+    m_bindless = bindless;
+    m_maxInstancesPerBatch = std::max(1u, maxInstancesPerBatch);
+}
+
+void QuadBatcher::clear() {
+    m_instances.clear();
+    m_batches.clear();
+}
+
+const std::vector<DrawBatch>& QuadBatcher::buildBatches(uint32_t splitInto) {
+    m_batches.clear();
+
+    const uint32_t count = static_cast<uint32_t>(m_instances.size());
+    uint32_t limit = m_maxInstancesPerBatch;
+    if (splitInto > 1 && count > 0) {
+        limit = std::min(limit, std::max(1u, (count + splitInto - 1) / splitInto));
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        const uint32_t texture = m_instances[i].textureIndex;
+        if (m_batches.empty() || m_batches.back().instanceCount >= limit ||
+            (!m_bindless && m_batches.back().textureIndex != texture)) {
+            DrawBatch batch;
+            batch.firstInstance = i;
+            batch.textureIndex = texture;
+            m_batches.push_back(batch);
+        }
+        m_batches.back().instanceCount++;
+    }
+    return m_batches;
+}
+
+std::vector<size_t> QuadBatcher::partition(size_t ranges) const {
+    std::vector<size_t> bounds;
+    bounds.push_back(0);
+    if (m_batches.empty()) {
+        return bounds;
+    }
+
+    ranges = std::max<size_t>(1, std::min(ranges, m_batches.size()));
+    const size_t total = m_instances.size();
+    size_t accumulated = 0;
+    for (size_t i = 0; i < m_batches.size(); i++) {
+        accumulated += m_batches[i].instanceCount;
+        // Close a range once it holds its share of the instances
+        const size_t closed = bounds.size() - 1;
+        if (closed + 1 < ranges && accumulated * ranges >= total * (closed + 1) &&
+            i + 1 < m_batches.size()) {
+            bounds.push_back(i + 1);
+        }
+    }
+    bounds.push_back(m_batches.size());
+    return bounds;
+}
+
+} // namespace AIForge
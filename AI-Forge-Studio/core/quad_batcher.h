@@ -0,0 +1,111 @@
+/**
+ * @file quad_batcher.h
+ * @brief Instanced batching of textured screen quads
+ *
+ * The gallery wall draws hundreds of thumbnails per frame. One draw call
+ * (and one descriptor bind) per image makes CPU-side recording the frame
+ * limiter, so images are collected as quad instances and drawn with a few
+ * instanced draws. With bindless textures an instance carries its texture
+ * index and every quad of the frame fits one pipeline; without, batches
+ * break where the texture changes.
+ *
+ * Features:
+ * - Submission (painter's) order preserved, so blending stays correct
+ * - Batches capped at the instance buffer's per-draw range
+ * - Contiguous batch ranges for parallel secondary command buffer recording
+ *
+ * Not thread-safe: filled by the render thread.
+ */
+
+#ifndef QUAD_BATCHER_H
+#define QUAD_BATCHER_H
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace AIForge {
+
+/**
+ * @struct QuadInstance
+ * @brief Per-instance vertex data of one screen quad (matches the shader layout)
+ */
+struct QuadInstance {
+    float x = 0.0f;                 // Top-left corner, pixels
+    float y = 0.0f;
+    float width = 0.0f;             // Size on screen, pixels
+    float height = 0.0f;
+    float u0 = 0.0f;                // Texture rectangle
+    float v0 = 0.0f;
+    float u1 = 1.0f;
+    float v1 = 1.0f;
+    uint32_t textureIndex = 0;      // Bindless descriptor index
+    uint32_t padding = 0;
+};
+
+/**
+ * @struct DrawBatch
+ * @brief One instanced draw
+ */
+struct DrawBatch {
+    uint32_t firstInstance = 0;
+    uint32_t instanceCount = 0;
+    uint32_t textureIndex = 0;      // Bound texture when not bindless
+};
+
+/**
+ * @class QuadBatcher
+ * @brief Collects quads for a frame and groups them into instanced draws
+ */
+class QuadBatcher {
+public:
+    QuadBatcher();
+
+    /**
+     * @brief Set batching rules
+     * @param bindless Quads may use different textures within one draw
+     * @param maxInstancesPerBatch Cap per draw (at least 1)
+     */
+    void configure(bool bindless, uint32_t maxInstancesPerBatch);
+
+    /**
+     * @brief Queue a quad
+     * @param quad Instance data
+     */
+    void add(const QuadInstance& quad) { m_instances.push_back(quad); }
+
+    /**
+     * @brief Drop the queued quads (capacity is kept for the next frame)
+     */
+    void clear();
+
+    /**
+     * @brief Group the queued quads into draws
+     * @param splitInto Produce at least this many batches when there are
+     *                  enough quads, so they can be recorded in parallel
+     * @return Batches in submission order
+     */
+    const std::vector<DrawBatch>& buildBatches(uint32_t splitInto = 1);
+
+    /**
+     * @brief Split batches into contiguous ranges of similar instance count
+     * @param ranges Number of ranges wanted
+     * @return Batch index where each range starts, plus the end index
+     */
+    std::vector<size_t> partition(size_t ranges) const;
+
+    const std::vector<QuadInstance>& getInstances() const { return m_instances; }
+    const std::vector<DrawBatch>& getBatches() const { return m_batches; }
+    size_t getQuadCount() const { return m_instances.size(); }
+    bool isBindless() const { return m_bindless; }
+
+private:
+    bool m_bindless;
+    uint32_t m_maxInstancesPerBatch;
+    std::vector<QuadInstance> m_instances;
+    std::vector<DrawBatch> m_batches;
+};
+
+} // namespace AIForge
+
+#endif // QUAD_BATCHER_H
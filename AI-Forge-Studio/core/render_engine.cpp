@@ -8,8 +8,13 @@
 
 #include "render_engine.h"
 #include "logger.h"
+#include "tracer.h"
 #include <chrono>
 #include <algorithm>
+#include <cstring>
+#include <new>
+#include <mutex>
+#include <condition_variable>
 
 // Vulkan headers (include in production)
 // #include <vulkan/vulkan.h>
@@ -24,11 +29,32 @@
 
 namespace AIForge {
 
+namespace {
+// Covers Vulkan's texel-size/4-byte copy offset rule and
+// D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT
+constexpr size_t STAGING_ALIGNMENT = 512;
+
+// Optimal-tiling images are placed at 64 KB granularity
+constexpr size_t TEXTURE_ALLOCATION_ALIGNMENT = 64 * 1024;
+
+// Size of the bindless sampled-image array (well inside
+// maxDescriptorSetUpdateAfterBindSampledImages on RTX hardware)
+constexpr uint32_t MAX_BINDLESS_TEXTURES = 16384;
+
+// Below this many quads, handing ranges to other threads costs more than
+// recording them on the render thread
+constexpr size_t PARALLEL_RECORD_MIN_QUADS = 512;
+}
+
 RenderEngine::RenderEngine()
     : m_initialized(false)
+    , m_stats()
     , m_instance(nullptr)
     , m_device(nullptr)
     , m_queue(nullptr)
+    , m_transferQueue(nullptr)
+    , m_transferSemaphore(nullptr)
+    , m_graphicsSemaphore(nullptr)
     , m_swapchain(nullptr)
     , m_commandBuffer(nullptr)
     , m_renderPass(nullptr)
@@ -38,6 +64,10 @@ RenderEngine::RenderEngine()
     , m_rayTracingEnabled(false)
     , m_currentFrame(0)
     , m_imageIndex(0)
+    , m_completedFrame(0)
+    , m_frameActive(false)
+    , m_frameTraceStart(0)
+    , m_nextDescriptorIndex(0)
 {
     LOG_INFO("RenderEngine", "Render engine created");
 }
@@ -93,6 +123,11 @@ bool RenderEngine::initialize(const RenderConfig& config, void* windowHandle) {
         return false;
     }
 
+    if (!createFrameResources()) {
+        LOG_ERROR("RenderEngine", "Failed to create frame resources");
+        return false;
+    }
+
     // Initialize DLSS if enabled
     if (config.enableDLSS) {
         m_dlssAvailable = initializeDLSS();
@@ -128,11 +163,15 @@ bool RenderEngine::initializeVulkan(void* windowHandle) {
     // 3. Create logical device with graphics queue
     // 4. Create surface for window
     // 5. Set up memory allocator (VMA recommended)
+    // 6. If useTransferQueue: also request a queue from a family with
+    //    VK_QUEUE_TRANSFER_BIT but not GRAPHICS/COMPUTE (the copy engine),
+    //    and enable timelineSemaphore and synchronization2
 
     // Simulate successful initialization
     m_instance = reinterpret_cast<void*>(0x1000);
     m_device = reinterpret_cast<void*>(0x2000);
     m_queue = reinterpret_cast<void*>(0x3000);
+    m_transferQueue = m_config.useTransferQueue ? reinterpret_cast<void*>(0x3100) : m_queue;
 
     LOG_INFO("RenderEngine", "Vulkan instance created");
     LOG_INFO("RenderEngine", "Using device: NVIDIA GeForce RTX 5090 (simulated)");
@@ -147,10 +186,12 @@ bool RenderEngine::initializeDirectX12(void* windowHandle) {
     // 2. Create command queue
     // 3. Create command allocators
     // 4. Create fence for synchronization
+    // 5. If useTransferQueue: a D3D12_COMMAND_LIST_TYPE_COPY queue for uploads
 
     // Simulate successful initialization
     m_device = reinterpret_cast<void*>(0x1000);
     m_queue = reinterpret_cast<void*>(0x2000);
+    m_transferQueue = m_config.useTransferQueue ? reinterpret_cast<void*>(0x2100) : m_queue;
 
     LOG_INFO("RenderEngine", "DirectX 12 device created");
     LOG_INFO("RenderEngine", "Feature level: D3D_FEATURE_LEVEL_12_2 (simulated)");
@@ -191,6 +232,148 @@ bool RenderEngine::createRenderPass() {
     return true;
 }
 
+bool RenderEngine::createFrameResources() {
+    const int framesInFlight = std::max(1, m_config.maxFramesInFlight);
+
+    // In production, per frame in flight:
+    // Vulkan: vkCreateFence (created signalled), a graphics command buffer
+    //         and a command buffer from a pool on the transfer queue family
+    // DX12: an ID3D12Fence value, a direct and a copy command allocator
+    // plus, once: two timeline semaphores (VkSemaphoreTypeCreateInfo /
+    // ID3D12Fence) ordering transfer copies before the frames that read them
+    m_frames.assign(framesInFlight, FrameContext());
+    for (int i = 0; i < framesInFlight; i++) {
+        m_frames[i].fence = reinterpret_cast<void*>(0x9000 + i);
+        m_frames[i].commandBuffer = reinterpret_cast<void*>(0x7000 + i);
+        m_frames[i].transferCommandBuffer = reinterpret_cast<void*>(0x7100 + i);
+    }
+    m_commandBuffer = m_frames[0].commandBuffer;
+    m_transferSemaphore = reinterpret_cast<void*>(0x9100);
+    m_graphicsSemaphore = reinterpret_cast<void*>(0x9200);
+
+    if (!m_stagingRing.initialize(m_config.stagingBufferMB * 1024 * 1024, STAGING_ALIGNMENT)) {
+        return false;
+    }
+
+    m_quadBatcher.configure(m_config.bindlessTextures, m_config.maxInstancesPerBatch);
+    m_quadBatcher.clear();
+    m_nextDescriptorIndex = 0;
+    m_freeDescriptorIndices.clear();
+
+    // In production (bindless): a descriptor set with a
+    // MAX_BINDLESS_TEXTURES-sized sampled image array, created with
+    // PARTIALLY_BOUND | UPDATE_AFTER_BIND binding flags so slots can be
+    // written while older frames still use the set
+    m_texturePool = std::make_unique<TexturePool>(
+        [this](PooledTexture& texture) {
+            if (m_freeDescriptorIndices.empty() && m_nextDescriptorIndex >= MAX_BINDLESS_TEXTURES) {
+                LOG_ERROR("RenderEngine", "Bindless texture array full (" +
+                          std::to_string(MAX_BINDLESS_TEXTURES) + " textures)");
+                return false;
+            }
+
+            // In production:
+            // Vulkan: vkCreateImage (OPTIMAL tiling, SAMPLED | TRANSFER_DST usage,
+            //         exclusive to the graphics family), vmaAllocateMemoryForImage,
+            //         vkBindImageMemory, vkCreateImageView; allocationBytes from
+            //         vkGetImageMemoryRequirements
+            // DX12: CreateCommittedResource in a DEFAULT heap + SRV;
+            //       allocationBytes from GetResourceAllocationInfo
+            texture.image = reinterpret_cast<void*>(0x8000 + (rand() % 1000));
+            texture.view = texture.image;
+            texture.allocationBytes = (texture.bytes + TEXTURE_ALLOCATION_ALIGNMENT - 1) &
+                                      ~(TEXTURE_ALLOCATION_ALIGNMENT - 1);
+
+            // In production: vkUpdateDescriptorSets writing the view into
+            // the array slot (DX12: CopyDescriptorsSimple into the heap)
+            if (!m_freeDescriptorIndices.empty()) {
+                texture.descriptorIndex = m_freeDescriptorIndices.back();
+                m_freeDescriptorIndices.pop_back();
+            } else {
+                texture.descriptorIndex = m_nextDescriptorIndex++;
+            }
+            return true;
+        },
+        [this](PooledTexture& texture) {
+            // In production:
+            // Vulkan: vkDestroyImageView, vkDestroyImage, vmaFreeMemory
+            // DX12: Release() on texture resource
+            // Only textures no frame samples are destroyed, so the slot is free
+            texture.image = nullptr;
+            texture.view = nullptr;
+            m_freeDescriptorIndices.push_back(texture.descriptorIndex);
+        });
+    m_texturePool->setBudget(m_config.textureBudgetMB * 1024 * 1024);
+
+    if (m_config.recordingThreads > 0) {
+        WorkerPoolConfig poolConfig;
+        poolConfig.name = "RenderRecording";
+        poolConfig.numThreads = static_cast<unsigned int>(m_config.recordingThreads);
+        poolConfig.maxQueuedJobs = static_cast<size_t>(m_config.recordingThreads) * 2;
+        poolConfig.submitTimeoutMs = 0;     // Record on the render thread rather than wait
+        m_recordingPool = std::make_unique<WorkerPool>();
+        m_recordingPool->start(poolConfig);
+    }
+
+    LOG_INFO("RenderEngine", std::to_string(framesInFlight) + " frames in flight, " +
+             (m_transferQueue != m_queue ? "dedicated transfer queue" : "uploads on the graphics queue"));
+    return true;
+}
+
+void RenderEngine::destroyFrameResources() {
+    // In production: vkDestroyFence / vkDestroySemaphore, free the command
+    // buffers and the per-range secondary command pools
+    if (m_recordingPool) {
+        m_recordingPool->stop();
+        m_recordingPool.reset();
+    }
+    m_quadBatcher.clear();
+    if (m_texturePool) {
+        m_texturePool->clear();
+        m_texturePool.reset();
+    }
+    m_frames.clear();
+    m_stagingRing.shutdown();
+    m_transferSemaphore = nullptr;
+    m_graphicsSemaphore = nullptr;
+}
+
+RenderEngine::FrameContext& RenderEngine::recordingFrame() {
+    return m_frames[(m_currentFrame + 1) % m_frames.size()];
+}
+
+void RenderEngine::waitForFrame(uint64_t serial) {
+    if (serial <= m_completedFrame) {
+        return;
+    }
+
+    TRACE_SCOPE("RenderEngine", "waitForFrame");
+    // In production: vkWaitForFences(device, 1, &m_frames[serial % size].fence, VK_TRUE, UINT64_MAX)
+    // Frames complete in submission order, so every older serial is done too.
+    // Simulated: GPU work finishes by the time it is waited on.
+    m_completedFrame = serial;
+    retireCompletedFrames();
+}
+
+void RenderEngine::retireCompletedFrames() {
+    // In production: poll without blocking first, vkGetFenceStatus /
+    // vkGetSemaphoreCounterValue(m_graphicsSemaphore) -> m_completedFrame
+    m_stagingRing.retire(m_completedFrame);
+
+    while (!m_deferredReleases.empty() && m_deferredReleases.front().serial <= m_completedFrame) {
+        DeferredRelease& release = m_deferredReleases.front();
+        if (release.texture) {
+            m_texturePool->release(release.texture);
+        }
+        if (release.sharedImage) {
+            // In production: vkDestroySemaphore, vkDestroyBuffer, vkFreeMemory
+            // (the CUDA side has released its imports by now)
+            m_texturePool->release(release.sharedImage->texture);
+        }
+        m_deferredReleases.pop_front();
+    }
+}
+
 bool RenderEngine::initializeDLSS() {
     // In production, initialize NVIDIA NGX DLSS:
     // 1. Create NGX context
@@ -241,11 +424,17 @@ void RenderEngine::shutdown() {
     // Cleanup resources in reverse order
     // In production: Destroy all Vulkan/DX12 objects
 
+    // Textures the caller never freed go with the pool
+    m_deferredReleases.clear();
+    m_sharedImages.clear();
+    destroyFrameResources();
+
     m_framebuffers.clear();
     m_commandBuffer = nullptr;
     m_renderPass = nullptr;
     m_swapchain = nullptr;
     m_queue = nullptr;
+    m_transferQueue = nullptr;
     m_device = nullptr;
     m_instance = nullptr;
 
@@ -258,11 +447,21 @@ bool RenderEngine::beginFrame() {
         return false;
     }
 
+    TRACE_SCOPE("RenderEngine", "beginFrame");
+    m_frameTraceStart = Tracer::getInstance().now();
+
+    // Only the frame that last used this slot has to be done, so up to
+    // maxFramesInFlight frames stay queued on the GPU
+    FrameContext& frame = recordingFrame();
+    waitForFrame(frame.serial);
+    retireCompletedFrames();
+    m_commandBuffer = frame.commandBuffer;
+
     // In production:
-    // 1. Acquire next swapchain image
-    // 2. Wait for previous frame fence
-    // 3. Reset command buffer
-    // 4. Begin command buffer recording
+    // 1. Acquire next swapchain image (signals this slot's image-available semaphore)
+    // 2. Reset the fence and command buffer of this slot
+    // 3. Begin command buffer recording, starting with the queue family
+    //    acquire barriers for textures the transfer queue filled
 
     auto currentTime = std::chrono::high_resolution_clock::now();
     auto deltaTime = std::chrono::duration<float, std::milli>(
@@ -273,7 +472,8 @@ bool RenderEngine::beginFrame() {
     m_stats.fps = 1000.0f / std::max(deltaTime, 0.001f);
 
     // Simulate image acquisition
-    m_imageIndex = m_currentFrame % m_config.maxFramesInFlight;
+    m_imageIndex = static_cast<uint32_t>((m_currentFrame + 1) % m_frames.size());
+    m_frameActive = true;
 
     return true;
 }
@@ -283,15 +483,51 @@ bool RenderEngine::endFrame() {
         return false;
     }
 
+    TRACE_SCOPE("RenderEngine", "endFrame");
+
+    FrameContext& frame = recordingFrame();
+    const uint64_t serial = m_currentFrame + 1;
+
+    recordDraws(frame);
+    m_quadBatcher.clear();
+
+    if (frame.uploads > 0) {
+        // In production: end frame.transferCommandBuffer (after its release
+        // barriers) and submit it on m_transferQueue, waiting on
+        // m_graphicsSemaphore >= transferWaitSerial when it rewrites textures
+        // older frames still sample, and signalling m_transferSemaphore = serial
+    }
+
     // In production:
-    // 1. End command buffer recording
-    // 2. Submit command buffer to queue
+    // 1. End command buffer recording (vkCmdEndRenderPass after the
+    //    secondary command buffers were executed)
+    // 2. Submit to m_queue, waiting on image-available, (if uploads)
+    //    m_transferSemaphore >= serial at the fragment shader stage and
+    //    each frame.semaphoreWaits value at the transfer stage; signal
+    //    render-finished, m_graphicsSemaphore = serial, frame.fence and
+    //    each frame.semaphoreSignals value
     // 3. Present swapchain image
-    // 4. Signal frame fence
+    // The CPU does not wait here; beginFrame waits when the slot comes round
+
+    frame.serial = serial;
+    m_stats.uploadBytes = frame.uploadBytes;
+    m_stats.sharedImageCopies = static_cast<int>(frame.semaphoreWaits.size());
+    frame.semaphoreWaits.clear();
+    frame.semaphoreSignals.clear();
+    frame.uploads = 0;
+    frame.uploadBytes = 0;
+    frame.transferWaitSerial = 0;
+    m_frameActive = false;
 
     m_currentFrame++;
     updateStats();
 
+    // One span per frame, from beginFrame() to present
+    Tracer& tracer = Tracer::getInstance();
+    if (tracer.isEnabled() && m_frameTraceStart > 0) {
+        tracer.record("RenderEngine", "frame", m_frameTraceStart, tracer.now());
+    }
+
     return true;
 }
 
@@ -308,59 +544,365 @@ void RenderEngine::clearScreen(float r, float g, float b, float a) {
 
 void RenderEngine::renderImage(const ImageRenderData& imageData,
                                float x, float y, float scale) {
-    if (!m_initialized || !imageData.data) {
+    if (!m_initialized) {
+        return;
+    }
+    if (!imageData.gpuTexture) {
+        LOG_WARNING("RenderEngine", "renderImage needs an uploaded texture");
         return;
     }
 
-    // In production:
-    // 1. Upload image to GPU if needed
-    // 2. Bind texture and sampler
-    // 3. Render full-screen quad or viewport-sized quad
-    // 4. Apply DLSS if enabled
-    // 5. Apply post-processing effects
+    // Drawn in endFrame with the frame's other quads. DLSS and
+    // post-processing run on the composed frame, not per image.
+    PooledTexture* texture = static_cast<PooledTexture*>(imageData.gpuTexture);
+    texture->lastUsedSerial = m_currentFrame + 1;
+
+    QuadInstance quad;
+    quad.x = x;
+    quad.y = y;
+    quad.width = texture->width * scale;
+    quad.height = texture->height * scale;
+    quad.textureIndex = texture->descriptorIndex;
+    m_quadBatcher.add(quad);
+}
+
+void RenderEngine::recordDraws(FrameContext& frame) {
+    const size_t quads = m_quadBatcher.getQuadCount();
+    m_stats.quads = static_cast<int>(quads);
+    m_stats.triangles = static_cast<int>(quads * 2);
+    m_stats.drawCalls = 0;
+    m_stats.recordingThreads = 0;
+    if (quads == 0) {
+        return;
+    }
+
+    TRACE_SCOPE("RenderEngine", "recordDraws");
+
+    // Split large frames so every recorder, the render thread included,
+    // gets a range of similar size
+    const bool parallel = m_recordingPool && quads >= PARALLEL_RECORD_MIN_QUADS;
+    const uint32_t wanted = parallel ? static_cast<uint32_t>(m_config.recordingThreads) + 1 : 1;
+    const std::vector<DrawBatch>& batches = m_quadBatcher.buildBatches(wanted);
+    const std::vector<size_t> bounds = m_quadBatcher.partition(wanted);
+    const size_t ranges = bounds.size() - 1;
+
+    // In production: grow the persistently mapped instance buffer (recreated
+    // only when a frame needs more room) and allocate SECONDARY command
+    // buffers from one command pool per range and frame slot; a pool is only
+    // ever used by the thread recording its range, as Vulkan requires
+    if (frame.instanceBuffer.size() < quads) {
+        frame.instanceBuffer.resize(quads);
+    }
+    while (frame.secondaryCommandBuffers.size() < ranges) {
+        frame.secondaryCommandBuffers.push_back(
+            reinterpret_cast<void*>(0x7200 + frame.secondaryCommandBuffers.size()));
+    }
+
+    std::mutex mutex;
+    std::condition_variable recorded;
+    size_t pending = ranges - 1;
+    for (size_t range = 1; range < ranges; range++) {
+        auto record = [this, &frame, &bounds, &mutex, &recorded, &pending, range] {
+            recordBatchRange(frame, range, bounds[range], bounds[range + 1]);
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--pending == 0) {
+                recorded.notify_one();
+            }
+        };
+        const WorkerPool::JobId id = (static_cast<uint64_t>(m_currentFrame + 1) << 8) | range;
+        if (!m_recordingPool->submit(id, JobPriority::INTERACTIVE, record, record)) {
+            record();
+        }
+    }
+    recordBatchRange(frame, 0, bounds[0], bounds[1]);
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        recorded.wait(lock, [&pending] { return pending == 0; });
+    }
+
+    // In production, on the primary command buffer:
+    // vkCmdBeginRenderPass(..., VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS)
+    // then vkCmdExecuteCommands(ranges, secondaryCommandBuffers), which keeps
+    // the ranges (and so the quads) in submission order
+    // DX12: ExecuteBundle per range, or command lists recorded in parallel
+    // and submitted in order with one ExecuteCommandLists
+    m_stats.drawCalls = static_cast<int>(batches.size());
+    m_stats.recordingThreads = static_cast<int>(ranges);
+}
 
-    m_stats.drawCalls++;
-    m_stats.triangles += 2; // Two triangles for quad
+void RenderEngine::recordBatchRange(FrameContext& frame, size_t range,
+                                    size_t firstBatch, size_t endBatch) {
+    if (firstBatch >= endBatch) {
+        return;
+    }
+
+    const std::vector<QuadInstance>& instances = m_quadBatcher.getInstances();
+    const std::vector<DrawBatch>& batches = m_quadBatcher.getBatches();
+    const uint32_t firstInstance = batches[firstBatch].firstInstance;
+    const uint32_t endInstance = batches[endBatch - 1].firstInstance + batches[endBatch - 1].instanceCount;
+
+    // Ranges cover disjoint instances, so recorders write the mapped buffer
+    // without locking
+    std::memcpy(frame.instanceBuffer.data() + firstInstance, instances.data() + firstInstance,
+                (endInstance - firstInstance) * sizeof(QuadInstance));
+
+    // In production, on frame.secondaryCommandBuffers[range], begun with
+    // RENDER_PASS_CONTINUE and the render pass / framebuffer inherited:
+    // 1. Bind the quad pipeline, viewport, scissor and the instance buffer
+    //    as a per-instance vertex stream
+    // 2. Bindless: bind the texture array set once; the fragment shader
+    //    samples textures[nonuniformEXT(textureIndex)]
+    // 3. Per batch: (not bindless) bind the batch texture's set, then
+    //    vkCmdDraw(6, instanceCount, 0, firstInstance)
+    // 4. vkEndCommandBuffer
+    (void)range;
 }
 
 void* RenderEngine::uploadImageToGPU(const unsigned char* data, int width,
                                      int height, int channels) {
-    if (!m_initialized || !data) {
+    if (!m_initialized || !data || width <= 0 || height <= 0 || channels <= 0) {
         return nullptr;
     }
 
-    LOG_INFO("RenderEngine", "Uploading image to GPU: " +
-             std::to_string(width) + "x" + std::to_string(height));
+    TRACE_SCOPE("RenderEngine", "uploadImageToGPU");
+    LOG_DEBUG("RenderEngine", "Uploading image to GPU: " +
+              std::to_string(width) + "x" + std::to_string(height));
 
-    // In production:
-    // 1. Create staging buffer
-    // 2. Copy data to staging buffer
-    // 3. Create GPU-only image/texture
-    // 4. Record copy command from staging to GPU
-    // 5. Submit and wait
-    // 6. Cleanup staging buffer
-    // 7. Create image view and sampler
+    // A recycled texture's old contents are discarded by the upload
+    PooledTexture* texture = m_texturePool->acquire(width, height, channels);
+    if (!texture) {
+        return nullptr;
+    }
 
-    // Simulate GPU texture
-    void* texture = reinterpret_cast<void*>(0x8000 + (rand() % 1000));
+    if (!streamToTexture(*texture, data, 0, height)) {
+        m_texturePool->release(texture);
+        return nullptr;
+    }
 
-    size_t sizeInBytes = width * height * channels;
-    m_stats.vramUsed += sizeInBytes / (1024 * 1024); // Convert to MB
+    updateStats();
+    return texture;
+}
+
+bool RenderEngine::updateGPUTexture(void* texture, const unsigned char* data) {
+    if (!m_initialized || !texture || !data) {
+        return false;
+    }
 
+    TRACE_SCOPE("RenderEngine", "updateGPUTexture");
+    PooledTexture* pooled = static_cast<PooledTexture*>(texture);
+    return streamToTexture(*pooled, data, 0, pooled->height);
+}
+
+void* RenderEngine::createGPUTexture(int width, int height, int channels) {
+    if (!m_initialized || width <= 0 || height <= 0 || channels <= 0) {
+        return nullptr;
+    }
+
+    // Contents stay undefined until rows are streamed in
+    PooledTexture* texture = m_texturePool->acquire(width, height, channels);
+    updateStats();
     return texture;
 }
 
+bool RenderEngine::updateGPUTextureRows(void* texture, int firstRow, int rowCount,
+                                        const unsigned char* rows) {
+    PooledTexture* pooled = static_cast<PooledTexture*>(texture);
+    if (!m_initialized || !pooled || !rows || firstRow < 0 || rowCount <= 0 ||
+        firstRow + rowCount > pooled->height) {
+        return false;
+    }
+
+    TRACE_SCOPE("RenderEngine", "updateGPUTextureRows");
+    return streamToTexture(*pooled, rows, firstRow, rowCount);
+}
+
+bool RenderEngine::streamToTexture(PooledTexture& texture, const unsigned char* data,
+                                   int firstRow, int rowCount) {
+    // The slot's transfer command buffer is reused, so its last frame must be done
+    FrameContext& frame = recordingFrame();
+    waitForFrame(frame.serial);
+
+    const uint64_t serial = m_currentFrame + 1;
+    const size_t bytes = static_cast<size_t>(texture.width) * texture.channels * rowCount;
+    StagingAllocation allocation;
+    bool staged = false;
+    if (bytes <= m_stagingRing.getCapacity()) {
+        while (!(staged = m_stagingRing.allocate(bytes, serial, allocation))) {
+            // Full: the oldest submitted frame gives its span back. Space held
+            // by the frame being built cannot be waited for.
+            uint64_t oldest = m_stagingRing.oldestSerial();
+            if (oldest == 0 || oldest > m_currentFrame) {
+                break;
+            }
+            m_stats.uploadStalls++;
+            waitForFrame(oldest);
+        }
+    }
+
+    unsigned char* destination = allocation.data;
+    if (!staged) {
+        // Larger than the ring, or the ring is full with this frame's own
+        // uploads: a one-off staging buffer released with the frame
+        DeferredRelease release;
+        release.serial = serial;
+        release.stagingBuffer.reset(new (std::nothrow) unsigned char[bytes]);
+        if (!release.stagingBuffer) {
+            LOG_ERROR("RenderEngine", "Out of host memory staging a " + std::to_string(texture.width) +
+                      "x" + std::to_string(rowCount) + " upload at row " + std::to_string(firstRow));
+            return false;
+        }
+        destination = release.stagingBuffer.get();
+        m_deferredReleases.push_back(std::move(release));
+        LOG_DEBUG("RenderEngine", "Staging ring full, using a one-off buffer for " +
+                  std::to_string(bytes / (1024 * 1024)) + " MB");
+    }
+
+    std::memcpy(destination, data, bytes);
+
+    // In production, on frame.transferCommandBuffer (begun on first use):
+    // 1. Barrier UNDEFINED -> TRANSFER_DST_OPTIMAL (previous contents discarded),
+    //    or SHADER_READ_ONLY_OPTIMAL -> TRANSFER_DST_OPTIMAL when only some
+    //    rows are replaced and the rest must survive
+    // 2. vkCmdCopyBufferToImage from the ring buffer at allocation.offset,
+    //    imageOffset.y = firstRow and imageExtent.height = rowCount
+    // 3. Release barrier to the graphics queue family, SHADER_READ_ONLY_OPTIMAL
+    // DX12: CopyTextureRegion on the copy command list from a placed
+    //       footprint at allocation.offset (rows then need a 256-byte pitch)
+    frame.uploads++;
+    frame.uploadBytes += bytes;
+    if (texture.lastUsedSerial > m_completedFrame) {
+        // Rewriting a texture a queued frame still samples (live preview)
+        frame.transferWaitSerial = std::max(frame.transferWaitSerial, texture.lastUsedSerial);
+    }
+    return true;
+}
+
 void RenderEngine::freeGPUTexture(void* texture) {
     if (!m_initialized || !texture) {
         return;
     }
 
-    // In production:
-    // Destroy image view, sampler, and image
-    // Vulkan: vkDestroyImageView, vkDestroyImage, vkFreeMemory
-    // DX12: Release() on texture resource
+    // Submitted frames and the one being built may still sample or fill it
+    DeferredRelease release;
+    release.serial = m_currentFrame + 1;
+    release.texture = static_cast<PooledTexture*>(texture);
+    m_deferredReleases.push_back(std::move(release));
+    retireCompletedFrames();
+    updateStats();
+
+    LOG_DEBUG("RenderEngine", "Freed GPU texture");
+}
+
+void* RenderEngine::createSharedImage(int width, int height, int channels, InteropHandles& handles) {
+    if (!m_initialized || width <= 0 || height <= 0 || channels <= 0) {
+        return nullptr;
+    }
+
+    auto shared = std::make_unique<SharedImage>();
+    const size_t bytes = static_cast<size_t>(width) * height * channels;
+    const size_t allocationBytes = (bytes + TEXTURE_ALLOCATION_ALIGNMENT - 1) &
+                                   ~(TEXTURE_ALLOCATION_ALIGNMENT - 1);
+
+    // In production (Vulkan; DX12 uses CreateCommittedResource with
+    // D3D12_HEAP_FLAG_SHARED, CreateSharedHandle and a shared ID3D12Fence):
+    // 1. vkCreateBuffer with VkExternalMemoryBufferCreateInfo{OPAQUE_FD} and
+    //    TRANSFER_SRC usage; CUDA maps it as a plain linear device pointer,
+    //    which optimal-tiled images cannot offer
+    // 2. vkAllocateMemory DEVICE_LOCAL with VkExportMemoryAllocateInfo and
+    //    VkMemoryDedicatedAllocateInfo, then vkBindBufferMemory
+    // 3. vkGetMemoryFdKHR -> handles.memoryHandle
+    // 4. vkCreateSemaphore with VkSemaphoreTypeCreateInfo{TIMELINE, 0} and
+    //    VkExportSemaphoreCreateInfo{OPAQUE_FD}; vkGetSemaphoreFdKHR
+    // 5. VkPhysicalDeviceIDProperties::deviceUUID -> handles.deviceUUID
+    shared->storage.reset(new (std::nothrow) unsigned char[allocationBytes]);
+    if (!shared->storage) {
+        LOG_ERROR("RenderEngine", "Failed to allocate shared image memory");
+        return nullptr;
+    }
+    shared->buffer = shared->storage.get();
+    shared->memory = shared->storage.get();
+    shared->semaphore = reinterpret_cast<void*>(0xa000 + m_sharedImages.size());
+
+    shared->texture = m_texturePool->acquire(width, height, channels);
+    if (!shared->texture) {
+        return nullptr;
+    }
+
+    handles = InteropHandles();
+#ifdef _WIN32
+    handles.handleType = ExternalHandleType::OPAQUE_WIN32;
+#endif
+    handles.memoryHandle = reinterpret_cast<intptr_t>(shared->storage.get()); // Simulated
+    handles.memoryBytes = allocationBytes;
+    handles.semaphoreHandle = reinterpret_cast<intptr_t>(shared->semaphore);
+    handles.width = width;
+    handles.height = height;
+    handles.channels = channels;
+    shared->handles = handles;
+
+    void* handle = shared.get();
+    m_sharedImages[handle] = std::move(shared);
+    updateStats();
+
+    LOG_INFO("RenderEngine", "Created " + std::to_string(width) + "x" + std::to_string(height) +
+             " CUDA-shared image");
+    return handle;
+}
+
+void* RenderEngine::consumeSharedImage(void* sharedImage, uint64_t generation) {
+    if (!m_initialized) {
+        return nullptr;
+    }
+    auto it = m_sharedImages.find(sharedImage);
+    if (it == m_sharedImages.end()) {
+        LOG_WARNING("RenderEngine", "Unknown shared image");
+        return nullptr;
+    }
+    SharedImage& shared = *it->second;
+
+    FrameContext& frame = recordingFrame();
+    waitForFrame(frame.serial);
+
+    // In production, on the frame's graphics command buffer (a VRAM-to-VRAM
+    // copy, so the graphics queue is fine and no ownership transfer is needed):
+    // 1. Barrier on the texture: SHADER_READ_ONLY -> TRANSFER_DST_OPTIMAL
+    //    (srcStage FRAGMENT_SHADER, so frames still sampling it finish first)
+    // 2. vkCmdCopyBufferToImage(shared.buffer -> shared.texture->image)
+    // 3. Barrier TRANSFER_DST -> SHADER_READ_ONLY_OPTIMAL
+    // The submit waits for the written value and signals the next write's
+    frame.semaphoreWaits.emplace_back(shared.semaphore, interopWrittenValue(generation));
+    frame.semaphoreSignals.emplace_back(shared.semaphore, interopWriteWaitValue(generation + 1));
+
+    shared.texture->lastUsedSerial = m_currentFrame + 1;
+    return shared.texture;
+}
+
+void RenderEngine::destroySharedImage(void* sharedImage) {
+    if (!m_initialized) {
+        return;
+    }
+    auto it = m_sharedImages.find(sharedImage);
+    if (it == m_sharedImages.end()) {
+        return;
+    }
 
-    LOG_INFO("RenderEngine", "Freed GPU texture");
+    DeferredRelease release;
+    release.serial = m_currentFrame + 1;
+    release.sharedImage = std::move(it->second);
+    m_sharedImages.erase(it);
+    m_deferredReleases.push_back(std::move(release));
+    retireCompletedFrames();
+    updateStats();
+}
+
+void RenderEngine::trimTexturePool() {
+    if (!m_initialized) {
+        return;
+    }
+
+    m_texturePool->trim();
+    updateStats();
+    LOG_INFO("RenderEngine", "Texture pool trimmed");
 }
 
 void RenderEngine::renderText(const std::string& text, float x, float y) {
@@ -429,6 +971,7 @@ void RenderEngine::waitIdle() {
     // In production:
     // Vulkan: vkDeviceWaitIdle
     // DX12: Fence synchronization
+    waitForFrame(m_currentFrame);
 }
 
 bool RenderEngine::captureScreenshot(const std::string& filepath) {
@@ -451,9 +994,61 @@ bool RenderEngine::captureScreenshot(const std::string& filepath) {
 void RenderEngine::updateStats() {
     m_stats.dlssActive = m_dlssEnabled;
     m_stats.rayTracingActive = m_rayTracingEnabled;
+    m_stats.stagingUsedMB = m_stagingRing.getUsedBytes() / (1024 * 1024);
+
+    if (m_texturePool) {
+        TexturePoolStats pool = m_texturePool->getStats();
+        m_stats.vramUsed = (pool.liveBytes + pool.idleBytes) / (1024 * 1024);
+        m_stats.textureCount = pool.liveTextures;
+        m_stats.texturePoolMB = pool.idleBytes / (1024 * 1024);
+        m_stats.texturePoolHitRate = pool.hitRate;
+    }
+}
 
-    // Reset per-frame counters
-    // (drawCalls and triangles are accumulated during frame)
+TextureRowSink::TextureRowSink(RenderEngine& renderer)
+    : m_renderer(renderer)
+    , m_texture(nullptr)
+    , m_finished(false)
+{
+}
+
+TextureRowSink::~TextureRowSink() {
+    if (m_texture) {
+        m_renderer.freeGPUTexture(m_texture);
+    }
+}
+
+bool TextureRowSink::begin(int width, int height, int channels) {
+    if (m_texture) {
+        m_renderer.freeGPUTexture(m_texture);
+    }
+    m_finished = false;
+    m_texture = m_renderer.createGPUTexture(width, height, channels);
+    if (!m_texture) {
+        LOG_ERROR("RenderEngine", "Failed to create a " + std::to_string(width) + "x" +
+                  std::to_string(height) + " texture for streamed rows");
+        return false;
+    }
+    return true;
+}
+
+bool TextureRowSink::writeRows(int firstRow, int rowCount, const unsigned char* rows) {
+    return m_renderer.updateGPUTextureRows(m_texture, firstRow, rowCount, rows);
+}
+
+bool TextureRowSink::finish() {
+    m_finished = m_texture != nullptr;
+    return m_finished;
+}
+
+void* TextureRowSink::releaseTexture() {
+    if (!m_finished) {
+        return nullptr;
+    }
+    void* texture = m_texture;
+    m_texture = nullptr;
+    m_finished = false;
+    return texture;
 }
 
 } // namespace AIForge
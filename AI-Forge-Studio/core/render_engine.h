@@ -8,6 +8,12 @@
  * - Ray tracing effects
  * - HDR rendering
  * - Multi-threaded command buffer generation
+ * - Multiple frames in flight with per-frame fences
+ * - Asynchronous texture streaming through a persistent staging ring
+ *   on a dedicated transfer queue
+ * - Texture recycling under a VRAM budget
+ * - CUDA-shared images presented after a GPU-side semaphore wait
+ * - Instanced quad batching over a bindless texture array
  *
  * Designed specifically for NVIDIA RTX 50-Series GPUs to showcase
  * AI-generated imagery with maximum visual fidelity.
@@ -18,8 +24,18 @@
 
 #include <string>
 #include <vector>
+#include <deque>
+#include <map>
 #include <memory>
 #include <functional>
+#include <chrono>
+#include <cstdint>
+#include "staging_ring.h"
+#include "texture_pool.h"
+#include "gpu_interop.h"
+#include "image_sink.h"
+#include "quad_batcher.h"
+#include "worker_pool.h"
 
 namespace AIForge {
 
@@ -59,6 +75,12 @@ struct RenderConfig {
     RenderQuality quality = RenderQuality::HIGH;
     int maxFramesInFlight = 2;
     bool fullscreen = false;
+    size_t stagingBufferMB = 256;       // Upload ring; a 4K RGBA8 image takes 32 MB
+    bool useTransferQueue = true;       // Copy on the DMA queue when the device has one
+    size_t textureBudgetMB = 4096;      // Live plus recycled textures (0 = unlimited)
+    int recordingThreads = 4;           // Secondary command buffer recorders (0 = render thread only)
+    uint32_t maxInstancesPerBatch = 4096; // Quads per instanced draw
+    bool bindlessTextures = true;       // Descriptor indexing; one draw spans many textures
 };
 
 /**
@@ -68,11 +90,20 @@ struct RenderConfig {
 struct RenderStats {
     float frameTime;        // ms
     float fps;
-    int drawCalls;
+    int drawCalls;          // Instanced draws in the last frame
     int triangles;
-    size_t vramUsed;        // MB
+    int quads;              // Images drawn in the last frame
+    int recordingThreads;   // Threads that recorded the last frame's draws
+    size_t vramUsed;        // MB, textures (live and pooled)
     bool dlssActive;
     bool rayTracingActive;
+    size_t uploadBytes;     // Staged for the last frame
+    size_t stagingUsedMB;   // Ring memory held by frames in flight
+    int uploadStalls;       // Uploads that waited for a frame fence (cumulative)
+    int sharedImageCopies;  // GPU-side copies from CUDA-shared images in the last frame
+    size_t textureCount;    // Live textures
+    size_t texturePoolMB;   // Idle textures kept for reuse
+    float texturePoolHitRate;
 };
 
 /**
@@ -134,7 +165,12 @@ public:
 
     /**
      * @brief Render an image to the display
-     * @param imageData Image data to render
+     *
+     * Queues a quad for the frame; endFrame draws the queued quads in
+     * submission order with as few instanced draws as the batching mode
+     * allows.
+     *
+     * @param imageData Image data to render (gpuTexture must be set)
      * @param x X position on screen
      * @param y Y position on screen
      * @param scale Scaling factor
@@ -144,18 +180,102 @@ public:
 
     /**
      * @brief Upload image data to GPU
-     * @param imageData Image data to upload
+     *
+     * The pixels are copied into the staging ring and the GPU copy runs on
+     * the transfer queue ahead of the next submitted frame, so the call
+     * returns without waiting on the GPU. Draws recorded in that frame see
+     * the finished texture.
+     *
+     * @param data Pixel data (copied before returning)
+     * @param width Width in pixels
+     * @param height Height in pixels
+     * @param channels Bytes per pixel
      * @return GPU texture handle
      */
     void* uploadImageToGPU(const unsigned char* data, int width,
                           int height, int channels);
 
+    /**
+     * @brief Stream new pixels into an existing texture (e.g. a live preview)
+     * @param texture Handle from uploadImageToGPU
+     * @param data Pixel data with the texture's size and channel count
+     * @return true if the upload was queued
+     */
+    bool updateGPUTexture(void* texture, const unsigned char* data);
+
+    /**
+     * @brief Create a texture whose pixels are streamed in later
+     * @param width Width in pixels
+     * @param height Height in pixels
+     * @param channels Bytes per pixel
+     * @return GPU texture handle (contents undefined until written)
+     */
+    void* createGPUTexture(int width, int height, int channels);
+
+    /**
+     * @brief Stream new pixels into a band of rows, keeping the others
+     * @param texture Handle from uploadImageToGPU or createGPUTexture
+     * @param firstRow First row replaced
+     * @param rowCount Number of rows
+     * @param rows rowCount rows of the texture's width and channel count
+     * @return true if the upload was queued
+     */
+    bool updateGPUTextureRows(void* texture, int firstRow, int rowCount,
+                              const unsigned char* rows);
+
     /**
      * @brief Free GPU texture
+     *
+     * The texture returns to the pool once every frame that may still
+     * sample it has finished, and is reused for the next upload of the
+     * same size and format.
+     *
      * @param texture GPU texture handle to free
      */
     void freeGPUTexture(void* texture);
 
+    /**
+     * @brief Create an image CUDA can write into directly
+     *
+     * Allocates an exportable device buffer, a matching texture and an
+     * exportable timeline semaphore. Import the handles with
+     * AIEngine::importInteropImage.
+     *
+     * @param width Width in pixels
+     * @param height Height in pixels
+     * @param channels Bytes per pixel (4 for RGBA8 render targets)
+     * @param handles Receives the exported handles
+     * @return Shared image handle, or nullptr on failure
+     */
+    void* createSharedImage(int width, int height, int channels, InteropHandles& handles);
+
+    /**
+     * @brief Show a generation of a shared image in the frame being built
+     *
+     * The frame waits on the GPU for the engine's write of the generation,
+     * copies the buffer into the texture in VRAM, and signals the engine
+     * that the buffer may be written again. The CPU never waits.
+     *
+     * @param sharedImage Handle from createSharedImage
+     * @param generation Generation the engine wrote (see gpu_interop.h)
+     * @return Texture handle for renderImage, or nullptr
+     */
+    void* consumeSharedImage(void* sharedImage, uint64_t generation);
+
+    /**
+     * @brief Destroy a shared image once frames using it have finished
+     *
+     * Release the CUDA import first.
+     *
+     * @param sharedImage Handle from createSharedImage
+     */
+    void destroySharedImage(void* sharedImage);
+
+    /**
+     * @brief Destroy the pooled idle textures (e.g. under VRAM pressure)
+     */
+    void trimTexturePool();
+
     /**
      * @brief Clear the screen with color
      * @param r Red component (0-1)
@@ -231,6 +351,48 @@ public:
     bool captureScreenshot(const std::string& filepath);
 
 private:
+    /**
+     * @struct FrameContext
+     * @brief Per-frame-in-flight submission resources
+     */
+    struct FrameContext {
+        void* fence = nullptr;                  // Signalled when the frame's GPU work is done
+        void* commandBuffer = nullptr;          // Graphics commands
+        void* transferCommandBuffer = nullptr;  // Staging copies consumed by the frame
+        uint64_t serial = 0;                    // Frame last submitted from this slot
+        size_t uploads = 0;                     // Copies recorded for the frame being built
+        size_t uploadBytes = 0;
+        uint64_t transferWaitSerial = 0;        // Frame that must finish before the copies run
+        std::vector<std::pair<void*, uint64_t>> semaphoreWaits;   // Shared images to wait for
+        std::vector<std::pair<void*, uint64_t>> semaphoreSignals; // and release after the frame
+        std::vector<void*> secondaryCommandBuffers; // One per recording range, from per-thread pools
+        std::vector<QuadInstance> instanceBuffer;   // Host-visible instance data (mapped, simulated)
+    };
+
+    /**
+     * @struct SharedImage
+     * @brief Exported buffer, semaphore and texture behind a shared image handle
+     */
+    struct SharedImage {
+        void* buffer = nullptr;         // VkBuffer / ID3D12Resource, exportable
+        void* memory = nullptr;         // VkDeviceMemory with VkExportMemoryAllocateInfo
+        void* semaphore = nullptr;      // Exportable timeline semaphore / ID3D12Fence
+        std::unique_ptr<unsigned char[]> storage;   // Backing memory (simulated)
+        PooledTexture* texture = nullptr;
+        InteropHandles handles;
+    };
+
+    /**
+     * @struct DeferredRelease
+     * @brief Resource destroyed once a frame has retired
+     */
+    struct DeferredRelease {
+        uint64_t serial = 0;
+        PooledTexture* texture = nullptr;                // Texture to return to the pool, or
+        std::unique_ptr<unsigned char[]> stagingBuffer;  // one-off staging for an upload larger than the ring, or
+        std::unique_ptr<SharedImage> sharedImage;        // shared image to destroy
+    };
+
     bool m_initialized;
     RenderConfig m_config;
     RenderStats m_stats;
@@ -239,6 +401,9 @@ private:
     void* m_instance;           // VkInstance or ID3D12Device
     void* m_device;             // VkDevice or ID3D12Device
     void* m_queue;              // VkQueue or ID3D12CommandQueue
+    void* m_transferQueue;      // Dedicated copy queue, or m_queue if the device has none
+    void* m_transferSemaphore;  // Timeline semaphore: transfer copies -> graphics frame
+    void* m_graphicsSemaphore;  // Timeline semaphore signalled with each frame's serial
     void* m_swapchain;          // VkSwapchainKHR or IDXGISwapChain
     void* m_commandBuffer;      // VkCommandBuffer or ID3D12CommandList
     void* m_renderPass;         // VkRenderPass or render target
@@ -251,9 +416,21 @@ private:
     bool m_rayTracingEnabled;
 
     // Frame tracking
-    uint32_t m_currentFrame;
+    uint32_t m_currentFrame;    // Frames submitted; the frame being built has serial m_currentFrame + 1
     uint32_t m_imageIndex;
+    uint64_t m_completedFrame;  // Newest serial whose fence has signalled
+    bool m_frameActive;         // Between beginFrame and endFrame
+    std::vector<FrameContext> m_frames;
+    StagingRing m_stagingRing;
+    std::deque<DeferredRelease> m_deferredReleases;
+    std::unique_ptr<TexturePool> m_texturePool;
+    std::map<void*, std::unique_ptr<SharedImage>> m_sharedImages;
     std::chrono::high_resolution_clock::time_point m_lastFrameTime;
+    uint64_t m_frameTraceStart;     // Tracer timestamp of beginFrame()
+    QuadBatcher m_quadBatcher;
+    std::unique_ptr<WorkerPool> m_recordingPool;
+    uint32_t m_nextDescriptorIndex;                 // Bindless texture array slots
+    std::vector<uint32_t> m_freeDescriptorIndices;
 
     /**
      * @brief Initialize Vulkan
@@ -293,12 +470,103 @@ private:
      */
     bool checkRayTracingSupport();
 
+    /**
+     * @brief Create the per-frame fences, command buffers and staging ring
+     * @return true if successful
+     */
+    bool createFrameResources();
+
+    /**
+     * @brief Destroy the per-frame resources (the GPU must be idle)
+     */
+    void destroyFrameResources();
+
+    /**
+     * @brief Frame context recording the next submission
+     */
+    FrameContext& recordingFrame();
+
+    /**
+     * @brief Block until a submitted frame's fence signals, then retire it
+     * @param serial Frame serial
+     */
+    void waitForFrame(uint64_t serial);
+
+    /**
+     * @brief Release staging memory and resources of completed frames
+     */
+    void retireCompletedFrames();
+
+    /**
+     * @brief Stage pixels and record the copy into rows of a texture
+     * @param texture Destination
+     * @param data rowCount rows of the texture's width and channel count
+     * @param firstRow First row written
+     * @param rowCount Number of rows (the texture's height replaces it all)
+     * @return true if the copy was recorded
+     */
+    bool streamToTexture(PooledTexture& texture, const unsigned char* data,
+                         int firstRow, int rowCount);
+
+    /**
+     * @brief Batch the queued quads and record their draws
+     *
+     * Large frames are split into contiguous batch ranges recorded into
+     * secondary command buffers on the recording pool, then executed from
+     * the primary command buffer in order.
+     */
+    void recordDraws(FrameContext& frame);
+
+    /**
+     * @brief Write instance data and draw commands for a range of batches
+     * @param frame Frame being recorded
+     * @param range Secondary command buffer index
+     * @param firstBatch First batch of the range
+     * @param endBatch One past the last batch
+     */
+    void recordBatchRange(FrameContext& frame, size_t range, size_t firstBatch, size_t endBatch);
+
     /**
      * @brief Update render statistics
      */
     void updateStats();
 };
 
+/**
+ * @class TextureRowSink
+ * @brief Streams rows into a texture as a producer finishes them
+ *
+ * Each band goes through the staging ring like any other upload, so a
+ * tiled upscale fills a preview texture progressively. Used on the render
+ * thread, like the renderer itself.
+ */
+class TextureRowSink : public ImageRowSink {
+public:
+    explicit TextureRowSink(RenderEngine& renderer);
+    ~TextureRowSink() override;
+
+    // Disable copy and move
+    TextureRowSink(const TextureRowSink&) = delete;
+    TextureRowSink& operator=(const TextureRowSink&) = delete;
+    TextureRowSink(TextureRowSink&&) = delete;
+    TextureRowSink& operator=(TextureRowSink&&) = delete;
+
+    bool begin(int width, int height, int channels) override;
+    bool writeRows(int firstRow, int rowCount, const unsigned char* rows) override;
+    bool finish() override;
+
+    /**
+     * @brief Take the finished texture (the caller frees it)
+     * @return GPU texture handle, or nullptr before finish
+     */
+    void* releaseTexture();
+
+private:
+    RenderEngine& m_renderer;
+    void* m_texture;
+    bool m_finished;
+};
+
 } // namespace AIForge
 
 #endif // RENDER_ENGINE_H
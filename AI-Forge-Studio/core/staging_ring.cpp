@@ -0,0 +1,136 @@
+/**
+ * @file staging_ring.cpp
+ * @brief Implementation of the staging ring
+ */
+
+#include "staging_ring.h"
+#include "logger.h"
+#include <new>
+
+namespace AIForge {
+
+StagingRing::StagingRing()
+    : m_buffer(nullptr)
+    , m_capacity(0)
+    , m_alignment(1)
+    , m_head(0)
+    , m_tail(0)
+    , m_used(0)
+{
+}
+
+StagingRing::~StagingRing() {
+    shutdown();
+}
+
+bool StagingRing::initialize(size_t capacity, size_t alignment) {
+    shutdown();
+
+    // In production (Vulkan, with VMA):
+    // vmaCreateBuffer with VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+    // VMA_MEMORY_USAGE_AUTO_PREFER_HOST and
+    // VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT |
+    // VMA_ALLOCATION_CREATE_MAPPED_BIT; HOST_COHERENT memory so writes need
+    // no flush. DX12: an UPLOAD heap buffer mapped once.
+    m_memory.reset(new (std::nothrow) unsigned char[capacity]);
+    if (!m_memory) {
+        LOG_ERROR("StagingRing", "Failed to allocate " + std::to_string(capacity / (1024 * 1024)) +
+                  " MB staging buffer");
+        return false;
+    }
+    m_buffer = m_memory.get();
+
+    m_capacity = capacity;
+    m_alignment = alignment > 0 ? alignment : 1;
+    m_head = 0;
+    m_tail = 0;
+    m_used = 0;
+
+    LOG_INFO("StagingRing", "Staging ring created: " +
+             std::to_string(capacity / (1024 * 1024)) + " MB");
+    return true;
+}
+
+void StagingRing::shutdown() {
+    if (!m_memory) {
+        return;
+    }
+
+    // In production: vmaDestroyBuffer (the mapping goes with it)
+    m_memory.reset();
+    m_buffer = nullptr;
+    m_spans.clear();
+    m_capacity = 0;
+    m_head = 0;
+    m_tail = 0;
+    m_used = 0;
+}
+
+bool StagingRing::allocate(size_t size, uint64_t serial, StagingAllocation& allocation) {
+    if (!m_memory || size == 0) {
+        return false;
+    }
+
+    // Rounding the size keeps every head offset aligned
+    const size_t aligned = (size + m_alignment - 1) & ~(m_alignment - 1);
+    if (m_used + aligned > m_capacity) {
+        return false;
+    }
+
+    if (m_used == 0) {
+        m_head = 0;
+        m_tail = 0;
+    }
+
+    size_t offset = m_head;
+    size_t padding = 0;
+    if (m_head >= m_tail) {
+        // Free space is [head, capacity) and [0, tail); a span never wraps,
+        // so the end of the buffer is skipped when it is too short
+        if (m_capacity - m_head < aligned) {
+            if (m_tail < aligned) {
+                return false;
+            }
+            padding = m_capacity - m_head;
+            offset = 0;
+        }
+    } else if (m_tail - m_head < aligned) {
+        return false;
+    }
+
+    m_head = offset + aligned;
+    if (m_head == m_capacity) {
+        m_head = 0;
+    }
+    m_used += padding + aligned;
+
+    if (!m_spans.empty() && m_spans.back().serial == serial) {
+        m_spans.back().end = m_head;
+        m_spans.back().bytes += padding + aligned;
+    } else {
+        Span span;
+        span.serial = serial;
+        span.end = m_head;
+        span.bytes = padding + aligned;
+        m_spans.push_back(span);
+    }
+
+    allocation.data = m_memory.get() + offset;
+    allocation.offset = offset;
+    allocation.size = size;
+    return true;
+}
+
+void StagingRing::retire(uint64_t completedSerial) {
+    while (!m_spans.empty() && m_spans.front().serial <= completedSerial) {
+        m_tail = m_spans.front().end;
+        m_used -= m_spans.front().bytes;
+        m_spans.pop_front();
+    }
+    if (m_used == 0) {
+        m_head = 0;
+        m_tail = 0;
+    }
+}
+
+} // namespace AIForge
@@ -0,0 +1,119 @@
+/**
+ * @file staging_ring.h
+ * @brief Persistent host-visible upload ring for texture streaming
+ *
+ * Creating a staging buffer per upload and waiting for the copy to finish
+ * stalls the frame, which at 4K (32 MB per RGBA8 image) drops frames on
+ * every diffusion preview. The ring is one persistently mapped buffer;
+ * each upload takes the next span of it and gives it back once the GPU has
+ * finished the frame that consumed it, so uploads never wait on the GPU
+ * unless every frame in flight still holds staging memory.
+ *
+ * Features:
+ * - One allocation, mapped for the lifetime of the renderer
+ * - Spans tagged with the frame serial that consumes them
+ * - Retirement in frame order when that frame's fence signals
+ * - Aligned offsets for buffer-to-image copies
+ *
+ * Not thread-safe: owned and used by the render thread.
+ */
+
+#ifndef STAGING_RING_H
+#define STAGING_RING_H
+
+#include <deque>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+namespace AIForge {
+
+/**
+ * @struct StagingAllocation
+ * @brief A span of the staging ring
+ */
+struct StagingAllocation {
+    unsigned char* data = nullptr;  // Mapped pointer to write the upload to
+    size_t offset = 0;              // Offset in the ring buffer, for the copy command
+    size_t size = 0;
+};
+
+/**
+ * @class StagingRing
+ * @brief Frame-retired ring allocator over a mapped upload buffer
+ */
+class StagingRing {
+public:
+    StagingRing();
+    ~StagingRing();
+
+    // Disable copy and move
+    StagingRing(const StagingRing&) = delete;
+    StagingRing& operator=(const StagingRing&) = delete;
+    StagingRing(StagingRing&&) = delete;
+    StagingRing& operator=(StagingRing&&) = delete;
+
+    /**
+     * @brief Create and map the ring buffer
+     * @param capacity Size in bytes
+     * @param alignment Offset alignment (power of two)
+     * @return true if the buffer was created
+     */
+    bool initialize(size_t capacity, size_t alignment = 256);
+
+    /**
+     * @brief Unmap and destroy the buffer (the GPU must be idle)
+     */
+    void shutdown();
+
+    /**
+     * @brief Take a span for an upload consumed by a frame
+     * @param size Bytes needed
+     * @param serial Frame serial that reads the span (non-decreasing across calls)
+     * @param allocation Receives the span
+     * @return false if the ring has no room until older frames retire
+     */
+    bool allocate(size_t size, uint64_t serial, StagingAllocation& allocation);
+
+    /**
+     * @brief Release the spans of every frame up to a completed serial
+     * @param completedSerial Newest frame whose fence has signalled
+     */
+    void retire(uint64_t completedSerial);
+
+    /**
+     * @brief Frame serial holding the oldest live span
+     * @return Serial, or 0 if the ring is empty
+     */
+    uint64_t oldestSerial() const { return m_spans.empty() ? 0 : m_spans.front().serial; }
+
+    /**
+     * @brief Get the buffer handle for copy commands
+     * @return VkBuffer / ID3D12Resource (opaque)
+     */
+    void* getBuffer() const { return m_buffer; }
+
+    size_t getCapacity() const { return m_capacity; }
+    size_t getUsedBytes() const { return m_used; }
+    bool isInitialized() const { return m_memory != nullptr; }
+
+private:
+    struct Span {
+        uint64_t serial = 0;
+        size_t end = 0;                 // Ring offset just past the span
+        size_t bytes = 0;               // Including padding skipped at the wrap
+    };
+
+    void* m_buffer;                     // VkBuffer (opaque)
+    std::unique_ptr<unsigned char[]> m_memory; // Mapped memory (simulated)
+    size_t m_capacity;
+    size_t m_alignment;
+    size_t m_head;                      // Next free offset
+    size_t m_tail;                      // Start of the oldest live span
+    size_t m_used;
+    std::deque<Span> m_spans;           // Live spans, oldest first
+};
+
+} // namespace AIForge
+
+#endif // STAGING_RING_H
@@ -0,0 +1,148 @@
+/**
+ * @file tensor.h
+ * @brief Non-owning tensor views over host, pinned-host and device memory
+ *
+ * Lets callers hand buffers they already own to the AI engine instead of
+ * copying them into std::vector. A view carries the pointer, element type,
+ * shape and memory location; it never allocates or frees.
+ */
+
+#ifndef TENSOR_H
+#define TENSOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+
+namespace AIForge {
+
+/**
+ * @enum DataType
+ * @brief Tensor element types
+ */
+enum class DataType {
+    FLOAT32,
+    FLOAT16,
+    UINT8,
+    INT32
+};
+
+/**
+ * @enum MemoryLocation
+ * @brief Where a tensor's memory lives
+ */
+enum class MemoryLocation {
+    HOST,               // Pageable host memory
+    PINNED_HOST,        // Page-locked host memory (async DMA capable)
+    DEVICE              // GPU memory
+};
+
+/**
+ * @brief Size in bytes of one element of the given type
+ */
+inline size_t dataTypeSize(DataType type) {
+    switch (type) {
+        case DataType::FLOAT32: return 4;
+        case DataType::FLOAT16: return 2;
+        case DataType::UINT8:   return 1;
+        case DataType::INT32:   return 4;
+        default:                return 0;
+    }
+}
+
+/**
+ * @struct TensorShape
+ * @brief Fixed-capacity tensor shape (no heap allocation)
+ */
+struct TensorShape {
+    static constexpr int MAX_DIMS = 8;
+
+    int ndim = 0;
+    int64_t dims[MAX_DIMS] = {};
+
+    TensorShape() = default;
+    TensorShape(std::initializer_list<int64_t> values) {
+        for (int64_t value : values) {
+            if (ndim == MAX_DIMS) {
+                break;
+            }
+            dims[ndim++] = value;
+        }
+    }
+
+    /**
+     * @brief Total number of elements (0 for an empty shape)
+     */
+    size_t numElements() const {
+        if (ndim == 0) {
+            return 0;
+        }
+        size_t count = 1;
+        for (int i = 0; i < ndim; i++) {
+            count *= static_cast<size_t>(dims[i] > 0 ? dims[i] : 0);
+        }
+        return count;
+    }
+};
+
+/**
+ * @struct TensorView
+ * @brief Mutable view of a caller-owned tensor buffer
+ */
+struct TensorView {
+    void* data = nullptr;
+    DataType dtype = DataType::FLOAT32;
+    MemoryLocation location = MemoryLocation::HOST;
+    int deviceId = 0;           // Owning GPU for DEVICE memory
+    TensorShape shape;
+
+    TensorView() = default;
+    TensorView(void* ptr, DataType type, TensorShape tensorShape,
+               MemoryLocation where = MemoryLocation::HOST, int device = 0)
+        : data(ptr), dtype(type), location(where), deviceId(device), shape(tensorShape) {}
+
+    size_t numElements() const { return shape.numElements(); }
+    size_t sizeBytes() const { return numElements() * dataTypeSize(dtype); }
+    bool isValid() const { return data != nullptr && numElements() > 0; }
+};
+
+/**
+ * @struct ConstTensorView
+ * @brief Read-only view of a caller-owned tensor buffer
+ */
+struct ConstTensorView {
+    const void* data = nullptr;
+    DataType dtype = DataType::FLOAT32;
+    MemoryLocation location = MemoryLocation::HOST;
+    int deviceId = 0;
+    TensorShape shape;
+
+    ConstTensorView() = default;
+    ConstTensorView(const void* ptr, DataType type, TensorShape tensorShape,
+                    MemoryLocation where = MemoryLocation::HOST, int device = 0)
+        : data(ptr), dtype(type), location(where), deviceId(device), shape(tensorShape) {}
+    ConstTensorView(const TensorView& view)
+        : data(view.data), dtype(view.dtype), location(view.location),
+          deviceId(view.deviceId), shape(view.shape) {}
+
+    size_t numElements() const { return shape.numElements(); }
+    size_t sizeBytes() const { return numElements() * dataTypeSize(dtype); }
+    bool isValid() const { return data != nullptr && numElements() > 0; }
+};
+
+/**
+ * @brief Helper function to convert DataType to string
+ */
+inline const char* dataTypeToString(DataType type) {
+    switch (type) {
+        case DataType::FLOAT32: return "float32";
+        case DataType::FLOAT16: return "float16";
+        case DataType::UINT8:   return "uint8";
+        case DataType::INT32:   return "int32";
+        default:                return "unknown";
+    }
+}
+
+} // namespace AIForge
+
+#endif // TENSOR_H
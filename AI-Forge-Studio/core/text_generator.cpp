@@ -0,0 +1,467 @@
+/**
+ * @file text_generator.cpp
+ * @brief Implementation of the continuous-batching text generator
+ */
+
+#include "text_generator.h"
+#include "logger.h"
+#include <algorithm>
+#include <cmath>
+#include <exception>
+
+namespace AIForge {
+
+TextGenerator::TextGenerator(StepExecutor executor, Detokenizer detokenizer, int32_t eosToken)
+    : m_executor(std::move(executor))
+    , m_detokenizer(std::move(detokenizer))
+    , m_eosToken(eosToken)
+    , m_stepSeconds(0.0)
+    , m_stepSequences(0)
+    , m_running(false)
+{
+}
+
+TextGenerator::~TextGenerator() {
+    stop();
+}
+
+bool TextGenerator::start(const TextGeneratorConfig& config, size_t kvBytesPerToken) {
+    stop();
+
+    m_config = config;
+    m_config.maxBatchSize = std::max(1, config.maxBatchSize);
+    m_config.maxStepTokens = std::max(1, config.maxStepTokens);
+    if (!m_cache.initialize(config.kvCacheMB * 1024 * 1024, config.kvBlockTokens, kvBytesPerToken)) {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats = TextGenerationStats();
+        m_stats.kvBlocksTotal = m_cache.getTotalBlocks();
+        m_stepSeconds = 0.0;
+        m_stepSequences = 0;
+        m_running = true;
+    }
+    m_thread = std::thread(&TextGenerator::stepLoop, this);
+    return true;
+}
+
+void TextGenerator::stop(const std::string& reason) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running = false;
+    }
+    m_condition.notify_all();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+
+    // The loop has exited, so what it left behind is finished from here
+    std::deque<SequencePtr> waiting;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        waiting.swap(m_waiting);
+        m_cancelRequests.clear();
+    }
+    std::vector<SequencePtr> batch;
+    batch.swap(m_batch);
+    for (SequencePtr& sequence : batch) {
+        finish(std::move(sequence), FinishReason::FAILED, reason);
+    }
+    for (SequencePtr& sequence : waiting) {
+        finish(std::move(sequence), FinishReason::FAILED, reason);
+    }
+    m_cache.shutdown();
+}
+
+bool TextGenerator::isRunning() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_running;
+}
+
+bool TextGenerator::submit(uint64_t requestId, std::vector<int32_t> promptTokens,
+                           const SamplingParams& params, TextGenerationCallbacks callbacks) {
+    const int promptLength = static_cast<int>(promptTokens.size());
+    if (promptTokens.empty() || params.maxTokens <= 0) {
+        reject(callbacks, promptLength, "Empty prompt or no tokens to generate");
+        return false;
+    }
+
+    auto sequence = std::make_unique<Sequence>();
+    sequence->id = requestId;
+    sequence->tokens = std::move(promptTokens);
+    sequence->params = params;
+    sequence->rng.seed(params.seed != 0 ? params.seed : std::random_device{}());
+    sequence->callbacks = std::move(callbacks);
+    sequence->result.promptTokens = promptLength;
+    sequence->submitTime = Clock::now();
+
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        const size_t blockTokens = static_cast<size_t>(std::max(1, m_config.kvBlockTokens));
+        const size_t promptBlocks = (static_cast<size_t>(promptLength) + blockTokens) / blockTokens;
+        std::string error;
+        if (!m_running) {
+            error = "Generator not running";
+        } else if (promptBlocks > m_stats.kvBlocksTotal) {
+            error = "Prompt of " + std::to_string(promptLength) + " tokens exceeds the KV cache";
+        } else if (!m_live.insert(requestId).second) {
+            error = "Duplicate request ID";
+        }
+        if (!error.empty()) {
+            lock.unlock();
+            reject(sequence->callbacks, promptLength, error);
+            return false;
+        }
+
+        m_waiting.push_back(std::move(sequence));
+        m_stats.requestsSubmitted++;
+        m_stats.promptTokens += promptLength;
+        m_stats.waitingSequences = m_waiting.size();
+    }
+    m_condition.notify_all();
+    return true;
+}
+
+bool TextGenerator::cancel(uint64_t requestId) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_live.count(requestId)) {
+            return false;
+        }
+        m_cancelRequests.insert(requestId);
+    }
+    m_condition.notify_all();
+    return true;
+}
+
+TextGenerationStats TextGenerator::getStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    TextGenerationStats stats = m_stats;
+    if (stats.steps > 0) {
+        stats.averageBatchSize = static_cast<float>(m_stepSequences) / stats.steps;
+    }
+    if (m_stepSeconds > 0.0) {
+        stats.tokensPerSecond = static_cast<float>(stats.generatedTokens / m_stepSeconds);
+    }
+    return stats;
+}
+
+void TextGenerator::stepLoop() {
+    while (true) {
+        std::vector<SequencePtr> cancelled;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this] {
+                return !m_running || !m_waiting.empty() || !m_batch.empty();
+            });
+            if (!m_running) {
+                return;
+            }
+
+            if (!m_cancelRequests.empty()) {
+                for (auto it = m_waiting.begin(); it != m_waiting.end();) {
+                    if (m_cancelRequests.count((*it)->id)) {
+                        cancelled.push_back(std::move(*it));
+                        it = m_waiting.erase(it);
+                    } else {
+                        ++it;
+                    }
+                }
+                for (SequencePtr& sequence : m_batch) {
+                    if (m_cancelRequests.count(sequence->id)) {
+                        cancelled.push_back(std::move(sequence));
+                    }
+                }
+                m_batch.erase(std::remove(m_batch.begin(), m_batch.end(), nullptr), m_batch.end());
+                m_cancelRequests.clear();
+            }
+        }
+
+        for (SequencePtr& sequence : cancelled) {
+            finish(std::move(sequence), FinishReason::CANCELLED, "Cancelled");
+        }
+
+        admitWaiting();
+        if (!m_batch.empty()) {
+            runStep();
+        }
+    }
+}
+
+void TextGenerator::admitWaiting() {
+    std::vector<SequencePtr> unfit;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        // First come, first served: a request that does not fit yet holds
+        // back the ones behind it rather than being overtaken forever
+        while (!m_waiting.empty() && m_batch.size() < static_cast<size_t>(m_config.maxBatchSize)) {
+            Sequence& next = *m_waiting.front();
+            if (!m_cache.reserve(next.id, next.tokens.size() + 1)) {
+                if (m_batch.empty()) {
+                    // Nothing left to free: it has outgrown the whole cache
+                    unfit.push_back(std::move(m_waiting.front()));
+                    m_waiting.pop_front();
+                    continue;
+                }
+                break;
+            }
+            m_batch.push_back(std::move(m_waiting.front()));
+            m_waiting.pop_front();
+        }
+        m_stats.waitingSequences = m_waiting.size();
+        m_stats.runningSequences = m_batch.size();
+        m_stats.kvBlocksUsed = m_cache.getUsedBlocks();
+    }
+
+    for (SequencePtr& sequence : unfit) {
+        finish(std::move(sequence), FinishReason::FAILED, "Sequence exceeds the KV cache");
+    }
+}
+
+void TextGenerator::runStep() {
+    // Plan: every sequence feeds its uncached tokens (one when decoding, a
+    // chunk of the prompt when prefilling) within the step's token budget
+    std::vector<StepSlot> slots;
+    std::vector<Sequence*> members;
+    int budget = m_config.maxStepTokens;
+    for (size_t i = 0; i < m_batch.size() && budget > 0; i++) {
+        Sequence& sequence = *m_batch[i];
+        const int pending = static_cast<int>(sequence.tokens.size()) - sequence.computed;
+        const int chunk = std::min(pending, budget);
+
+        // Out of blocks: preempt the newest sequences until this one fits
+        bool reserved = m_cache.reserve(sequence.id, static_cast<size_t>(sequence.computed) + chunk);
+        while (!reserved && m_batch.size() > i + 1) {
+            SequencePtr victim = std::move(m_batch.back());
+            m_batch.pop_back();
+            preempt(std::move(victim));
+            reserved = m_cache.reserve(sequence.id, static_cast<size_t>(sequence.computed) + chunk);
+        }
+        if (!reserved) {
+            // It is the newest left; older sequences keep their progress
+            SequencePtr self = std::move(m_batch.back());
+            m_batch.pop_back();
+            if (i == 0) {
+                finish(std::move(self), FinishReason::FAILED, "Sequence exceeds the KV cache");
+            } else {
+                preempt(std::move(self));
+            }
+            break;
+        }
+
+        StepSlot slot;
+        slot.sequenceId = sequence.id;
+        slot.tokens = sequence.tokens.data() + sequence.computed;
+        slot.tokenCount = chunk;
+        slot.position = sequence.computed;
+        slot.blockTable = m_cache.getBlockTable(sequence.id);
+        slot.sample = chunk == pending;
+        slots.push_back(slot);
+        members.push_back(&sequence);
+        budget -= chunk;
+    }
+    if (slots.empty()) {
+        return;
+    }
+
+    std::vector<std::vector<float>> logits;
+    std::string error;
+    const size_t sampling = static_cast<size_t>(
+        std::count_if(slots.begin(), slots.end(), [](const StepSlot& slot) { return slot.sample; }));
+    const auto stepStart = Clock::now();
+    bool ok = false;
+    try {
+        ok = m_executor(slots, logits, error);
+    } catch (const std::exception& e) {
+        error = e.what();
+    }
+    if (ok && logits.size() != sampling) {
+        ok = false;
+        error = "Step returned " + std::to_string(logits.size()) + " logit rows for " +
+                std::to_string(sampling) + " sequences";
+    }
+    const double stepSeconds = std::chrono::duration<double>(Clock::now() - stepStart).count();
+
+    size_t generated = 0;
+    std::vector<std::pair<Sequence*, FinishReason>> done;
+    if (!ok) {
+        LOG_ERROR("TextGenerator", "Step failed: " + error);
+        for (Sequence* sequence : members) {
+            done.emplace_back(sequence, FinishReason::FAILED);
+        }
+    } else {
+        size_t row = 0;
+        for (size_t k = 0; k < slots.size(); k++) {
+            Sequence& sequence = *members[k];
+            sequence.computed += slots[k].tokenCount;
+            if (!slots[k].sample) {
+                continue;
+            }
+
+            const int32_t token = sample(sequence, logits[row++]);
+            if (sequence.result.tokens.empty()) {
+                sequence.result.timeToFirstToken = std::chrono::duration<float, std::milli>(
+                    Clock::now() - sequence.submitTime).count();
+            }
+            if (token == m_eosToken) {
+                done.emplace_back(&sequence, FinishReason::STOP_TOKEN);
+                continue;
+            }
+
+            sequence.tokens.push_back(token);
+            generated++;
+            TokenEvent event;
+            event.requestId = sequence.id;
+            event.token = token;
+            event.text = m_detokenizer ? m_detokenizer(token) : std::string();
+            event.index = static_cast<int>(sequence.result.tokens.size());
+            sequence.result.tokens.push_back(token);
+            sequence.result.text += event.text;
+
+            if (sequence.callbacks.token && !sequence.callbacks.token(event)) {
+                done.emplace_back(&sequence, FinishReason::STOPPED);
+            } else if (static_cast<int>(sequence.result.tokens.size()) >= sequence.params.maxTokens) {
+                done.emplace_back(&sequence, FinishReason::LENGTH);
+            }
+        }
+    }
+
+    // Finished sequences leave the batch now; the rest run again next step
+    for (const auto& entry : done) {
+        auto it = std::find_if(m_batch.begin(), m_batch.end(),
+                               [&entry](const SequencePtr& s) { return s.get() == entry.first; });
+        SequencePtr sequence = std::move(*it);
+        m_batch.erase(it);
+        finish(std::move(sequence), entry.second, entry.second == FinishReason::FAILED ? error : "");
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.steps++;
+    m_stats.generatedTokens += generated;
+    m_stats.runningSequences = m_batch.size();
+    m_stats.waitingSequences = m_waiting.size();
+    m_stats.kvBlocksUsed = m_cache.getUsedBlocks();
+    m_stepSequences += slots.size();
+    m_stepSeconds += stepSeconds;
+}
+
+void TextGenerator::preempt(SequencePtr sequence) {
+    // Recompute: the prompt and the tokens so far are prefilled again later
+    m_cache.release(sequence->id);
+    sequence->computed = 0;
+    sequence->result.preemptions++;
+    LOG_DEBUG("TextGenerator", "Preempted request " + std::to_string(sequence->id) + " at " +
+              std::to_string(sequence->tokens.size()) + " tokens");
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.preemptions++;
+    m_waiting.push_front(std::move(sequence));
+}
+
+void TextGenerator::finish(SequencePtr sequence, FinishReason reason, const std::string& error) {
+    m_cache.release(sequence->id);
+
+    TextGenerationResult& result = sequence->result;
+    result.finishReason = reason;
+    result.success = reason != FinishReason::FAILED && reason != FinishReason::CANCELLED;
+    result.errorMessage = error;
+    result.totalTime = std::chrono::duration<float, std::milli>(
+        Clock::now() - sequence->submitTime).count();
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_live.erase(sequence->id);
+        m_stats.requestsFinished++;
+    }
+
+    if (sequence->callbacks.finished) {
+        sequence->callbacks.finished(std::move(result));
+    }
+}
+
+void TextGenerator::reject(TextGenerationCallbacks& callbacks, int promptTokens,
+                           const std::string& error) {
+    LOG_ERROR("TextGenerator", error);
+    TextGenerationResult result;
+    result.success = false;
+    result.errorMessage = error;
+    result.promptTokens = promptTokens;
+    result.finishReason = FinishReason::FAILED;
+    if (callbacks.finished) {
+        callbacks.finished(std::move(result));
+    }
+}
+
+int32_t TextGenerator::sample(Sequence& sequence, const std::vector<float>& logits) {
+    if (logits.empty()) {
+        return m_eosToken;
+    }
+    const auto best = std::max_element(logits.begin(), logits.end());
+    if (sequence.params.temperature <= 0.0f) {
+        return static_cast<int32_t>(best - logits.begin());
+    }
+
+    // Softmax at the request's temperature, shifted by the max for range
+    std::vector<float> weights(logits.size());
+    double total = 0.0;
+    for (size_t i = 0; i < logits.size(); i++) {
+        weights[i] = std::exp((logits[i] - *best) / sequence.params.temperature);
+        total += weights[i];
+    }
+    double target = std::uniform_real_distribution<double>(0.0, total)(sequence.rng);
+    for (size_t i = 0; i < weights.size(); i++) {
+        target -= weights[i];
+        if (target <= 0.0) {
+            return static_cast<int32_t>(i);
+        }
+    }
+    return static_cast<int32_t>(best - logits.begin());
+}
+
+TokenStream::TokenStream()
+    : m_state(std::make_shared<State>())
+{
+}
+
+TextGenerationCallbacks TokenStream::callbacks() const {
+    TextGenerationCallbacks callbacks;
+    std::shared_ptr<State> state = m_state;
+    callbacks.token = [state](const TokenEvent& token) {
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->tokens.push_back(token);
+        }
+        state->condition.notify_all();
+        return true;
+    };
+    callbacks.finished = [state](TextGenerationResult&& result) {
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->result = std::move(result);
+            state->finished = true;
+        }
+        state->condition.notify_all();
+    };
+    return callbacks;
+}
+
+bool TokenStream::next(TokenEvent& token) {
+    std::unique_lock<std::mutex> lock(m_state->mutex);
+    m_state->condition.wait(lock, [this] { return !m_state->tokens.empty() || m_state->finished; });
+    if (m_state->tokens.empty()) {
+        return false;
+    }
+    token = std::move(m_state->tokens.front());
+    m_state->tokens.pop_front();
+    return true;
+}
+
+TextGenerationResult TokenStream::result() {
+    std::unique_lock<std::mutex> lock(m_state->mutex);
+    m_state->condition.wait(lock, [this] { return m_state->finished; });
+    return m_state->result;
+}
+
+} // namespace AIForge
@@ -0,0 +1,322 @@
+/**
+ * @file text_generator.h
+ * @brief Token-streaming LLM generation with continuous batching
+ *
+ * Running a text request as one monolithic inference holds the model for
+ * the whole output and makes every other user wait behind it; batching
+ * whole requests together stalls the batch on its longest member. The
+ * generator instead runs one decode step at a time over every active
+ * sequence: new requests join the running batch at the next step, and
+ * finished ones leave it at once, so the GPU always works on a full batch
+ * and each token reaches its caller as soon as it is sampled.
+ *
+ * Each model gets one generator with its own step loop and a paged KV
+ * cache. Prompts are prefilled in chunks alongside the decodes, and when
+ * the cache runs out the most recently admitted sequence is preempted and
+ * later recomputed from its tokens.
+ *
+ * Features:
+ * - Per-token callbacks (or the blocking TokenStream) as tokens are sampled
+ * - Continuous batching with chunked prefill under a per-step token budget
+ * - Paged KV cache with preemption and recompute
+ * - Temperature sampling with per-request seeds
+ *
+ * Thread-safe: submit, cancel and getStats may be called from any thread.
+ * Callbacks run on the generator's thread.
+ */
+
+#ifndef TEXT_GENERATOR_H
+#define TEXT_GENERATOR_H
+
+#include "kv_cache.h"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+#include <cstdint>
+
+namespace AIForge {
+
+/**
+ * @enum FinishReason
+ * @brief Why a sequence stopped generating
+ */
+enum class FinishReason {
+    NONE,
+    STOP_TOKEN,         // Model produced end-of-sequence
+    LENGTH,             // Reached maxTokens
+    STOPPED,            // Token callback returned false
+    CANCELLED,
+    FAILED
+};
+
+/**
+ * @struct TextGeneratorConfig
+ * @brief Batching and KV cache limits of a generator
+ */
+struct TextGeneratorConfig {
+    int maxBatchSize = 32;          // Sequences in the running batch
+    int maxStepTokens = 2048;       // Tokens per step (decodes + prefill chunks)
+    int kvBlockTokens = 16;         // Tokens per KV cache block
+    size_t kvCacheMB = 2048;        // KV cache memory per model
+};
+
+/**
+ * @struct SamplingParams
+ * @brief Per-request generation settings
+ */
+struct SamplingParams {
+    int maxTokens = 512;
+    float temperature = 1.0f;       // 0 = greedy
+    unsigned int seed = 0;          // 0 = random
+};
+
+/**
+ * @struct TokenEvent
+ * @brief One sampled token
+ */
+struct TokenEvent {
+    uint64_t requestId = 0;
+    int32_t token = 0;
+    std::string text;               // Detokenized piece
+    int index = 0;                  // Position among the generated tokens
+};
+
+/**
+ * @struct TextGenerationResult
+ * @brief Outcome of one text generation request
+ */
+struct TextGenerationResult {
+    bool success = false;
+    std::string errorMessage;
+    std::string text;                   // All generated pieces
+    std::vector<int32_t> tokens;        // Generated tokens
+    int promptTokens = 0;
+    FinishReason finishReason = FinishReason::NONE;
+    float timeToFirstToken = 0.0f;      // In milliseconds from submission
+    float totalTime = 0.0f;             // In milliseconds from submission
+    int preemptions = 0;                // Times evicted from the KV cache and recomputed
+};
+
+/**
+ * @struct TextGenerationCallbacks
+ * @brief Notifications for one text generation request
+ */
+struct TextGenerationCallbacks {
+    std::function<bool(const TokenEvent&)> token;            // Return false to stop
+    std::function<void(TextGenerationResult&&)> finished;   // Exactly once, also on cancel or rejection
+};
+
+/**
+ * @struct TextGenerationStats
+ * @brief Generator counters
+ */
+struct TextGenerationStats {
+    size_t requestsSubmitted = 0;
+    size_t requestsFinished = 0;
+    size_t promptTokens = 0;
+    size_t generatedTokens = 0;
+    size_t steps = 0;
+    size_t preemptions = 0;
+    size_t runningSequences = 0;
+    size_t waitingSequences = 0;
+    size_t kvBlocksUsed = 0;
+    size_t kvBlocksTotal = 0;
+    float averageBatchSize = 0.0f;      // Sequences per step
+    float tokensPerSecond = 0.0f;       // Generated tokens per second of step time
+};
+
+/**
+ * @class TextGenerator
+ * @brief Continuous-batching decode loop for one model
+ */
+class TextGenerator {
+public:
+    /**
+     * @struct StepSlot
+     * @brief One sequence's share of a decode step
+     */
+    struct StepSlot {
+        uint64_t sequenceId = 0;
+        const int32_t* tokens = nullptr;    // Tokens to feed (a prefill chunk or one decode token)
+        int tokenCount = 0;
+        int position = 0;                   // Position of the first fed token
+        const std::vector<int>* blockTable = nullptr;
+        bool sample = false;                // Logits wanted for the last fed token
+    };
+
+    /**
+     * @brief Function running one forward pass over every slot
+     *
+     * Must fill one vocabulary-sized logit vector per sampling slot, in slot
+     * order. Returns false (with a reason) to fail the step's sequences.
+     */
+    using StepExecutor = std::function<bool(const std::vector<StepSlot>&,
+                                            std::vector<std::vector<float>>&, std::string&)>;
+
+    /**
+     * @brief Function turning a token into its text piece
+     */
+    using Detokenizer = std::function<std::string(int32_t)>;
+
+    /**
+     * @brief Construct a generator
+     * @param executor Runs the model
+     * @param detokenizer Maps tokens to text
+     * @param eosToken End-of-sequence token
+     */
+    TextGenerator(StepExecutor executor, Detokenizer detokenizer, int32_t eosToken);
+    ~TextGenerator();
+
+    // Disable copy and move
+    TextGenerator(const TextGenerator&) = delete;
+    TextGenerator& operator=(const TextGenerator&) = delete;
+    TextGenerator(TextGenerator&&) = delete;
+    TextGenerator& operator=(TextGenerator&&) = delete;
+
+    /**
+     * @brief Create the KV cache and start the step loop
+     * @param config Batching and cache limits
+     * @param kvBytesPerToken KV bytes of one token across all layers
+     * @return false if the cache could not be created
+     */
+    bool start(const TextGeneratorConfig& config, size_t kvBytesPerToken);
+
+    /**
+     * @brief Stop the loop and fail every unfinished request
+     *
+     * Must not be called from a callback of this generator.
+     *
+     * @param reason Error message the requests finish with
+     */
+    void stop(const std::string& reason = "Generator stopped");
+
+    /**
+     * @brief Check if the loop is running
+     */
+    bool isRunning() const;
+
+    /**
+     * @brief Queue a request; it joins the running batch at a coming step
+     * @param requestId Caller-assigned ID used for cancellation
+     * @param promptTokens Tokenized prompt (not empty)
+     * @param params Sampling settings
+     * @param callbacks Token and completion notifications
+     * @return false if rejected (finished has then been called)
+     */
+    bool submit(uint64_t requestId, std::vector<int32_t> promptTokens,
+                const SamplingParams& params, TextGenerationCallbacks callbacks);
+
+    /**
+     * @brief Cancel a waiting or running request
+     * @param requestId ID passed to submit()
+     * @return true if found; it finishes with CANCELLED at the next step
+     */
+    bool cancel(uint64_t requestId);
+
+    /**
+     * @brief Get generator counters
+     */
+    TextGenerationStats getStats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Sequence {
+        uint64_t id = 0;
+        std::vector<int32_t> tokens;    // Prompt followed by the generated tokens
+        int computed = 0;               // Leading tokens whose KV is in the cache
+        SamplingParams params;
+        std::mt19937 rng;
+        TextGenerationCallbacks callbacks;
+        TextGenerationResult result;
+        Clock::time_point submitTime;
+    };
+    using SequencePtr = std::unique_ptr<Sequence>;
+
+    void stepLoop();
+
+    // Move waiting sequences into the batch while slots and blocks allow
+    void admitWaiting();
+
+    // Plan, execute and sample one step over the batch
+    void runStep();
+
+    // Give a sequence's blocks back and requeue it for recompute
+    void preempt(SequencePtr sequence);
+
+    void finish(SequencePtr sequence, FinishReason reason, const std::string& error = std::string());
+    int32_t sample(Sequence& sequence, const std::vector<float>& logits);
+    static void reject(TextGenerationCallbacks& callbacks, int promptTokens, const std::string& error);
+
+    StepExecutor m_executor;
+    Detokenizer m_detokenizer;
+    int32_t m_eosToken;
+    TextGeneratorConfig m_config;
+
+    // Loop thread only (and stop() once the loop has exited)
+    PagedKVCache m_cache;
+    std::vector<SequencePtr> m_batch;       // Running sequences in admission order
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::deque<SequencePtr> m_waiting;
+    std::unordered_set<uint64_t> m_live;            // Submitted and not yet finished
+    std::unordered_set<uint64_t> m_cancelRequests;  // Taken by the loop before each step
+    TextGenerationStats m_stats;
+    double m_stepSeconds;
+    size_t m_stepSequences;
+    bool m_running;
+    std::thread m_thread;
+};
+
+/**
+ * @class TokenStream
+ * @brief Blocking iterator over a request's tokens
+ *
+ * Pass callbacks() to a submission, then pull tokens with next() from any
+ * one thread.
+ */
+class TokenStream {
+public:
+    TokenStream();
+
+    /**
+     * @brief Callbacks feeding this stream
+     */
+    TextGenerationCallbacks callbacks() const;
+
+    /**
+     * @brief Wait for the next token
+     * @param token Receives it
+     * @return false once the request has finished and every token was read
+     */
+    bool next(TokenEvent& token);
+
+    /**
+     * @brief Wait for the request to finish
+     * @return Its result (text and tokens included)
+     */
+    TextGenerationResult result();
+
+private:
+    struct State {
+        std::mutex mutex;
+        std::condition_variable condition;
+        std::deque<TokenEvent> tokens;
+        TextGenerationResult result;
+        bool finished = false;
+    };
+    std::shared_ptr<State> m_state;
+};
+
+} // namespace AIForge
+
+#endif // TEXT_GENERATOR_H
@@ -0,0 +1,173 @@
+/**
+ * @file texture_pool.cpp
+ * @brief Implementation of the texture pool
+ */
+
+#include "texture_pool.h"
+#include "logger.h"
+#include <tuple>
+
+namespace AIForge {
+
+TextureFormat textureFormatFromChannels(int channels) {
+    switch (channels) {
+        case 1:  return TextureFormat::R8;
+        case 2:  return TextureFormat::RG8;
+        case 3:  return TextureFormat::RGB8;
+        default: return TextureFormat::RGBA8;
+    }
+}
+
+bool TexturePool::Key::operator<(const Key& other) const {
+    return std::tie(width, height, format) < std::tie(other.width, other.height, other.format);
+}
+
+TexturePool::TexturePool(CreateFunction create, DestroyFunction destroy)
+    : m_create(std::move(create))
+    , m_destroy(std::move(destroy))
+    , m_budget(0)
+{
+}
+
+TexturePool::~TexturePool() {
+    clear();
+}
+
+void TexturePool::setBudget(size_t budgetBytes) {
+    m_budget = budgetBytes;
+    evictForBudget(0);
+}
+
+PooledTexture* TexturePool::acquire(int width, int height, int channels) {
+    Key key;
+    key.width = width;
+    key.height = height;
+    key.format = textureFormatFromChannels(channels);
+
+    auto idle = m_idle.find(key);
+    if (idle != m_idle.end()) {
+        PooledTexture* texture = *idle->second;
+        m_idleOrder.erase(idle->second);
+        m_idle.erase(idle);
+
+        m_stats.idleTextures--;
+        m_stats.idleBytes -= texture->allocationBytes;
+        m_stats.liveTextures++;
+        m_stats.liveBytes += texture->allocationBytes;
+        m_stats.reused++;
+        texture->lastUsedSerial = 0;
+        return texture;
+    }
+
+    auto texture = std::make_unique<PooledTexture>();
+    texture->width = width;
+    texture->height = height;
+    texture->channels = channels;
+    texture->format = key.format;
+    texture->bytes = static_cast<size_t>(width) * height * channels;
+
+    evictForBudget(texture->bytes);
+    if (m_budget > 0 && m_stats.liveBytes + texture->bytes > m_budget) {
+        m_stats.overBudget++;
+        LOG_WARNING("TexturePool", "Live textures exceed the " + std::to_string(m_budget / (1024 * 1024)) +
+                    " MB budget");
+    }
+
+    if (!m_create(*texture)) {
+        LOG_ERROR("TexturePool", "Failed to create " + std::to_string(width) + "x" +
+                  std::to_string(height) + " texture");
+        return nullptr;
+    }
+    if (texture->allocationBytes == 0) {
+        texture->allocationBytes = texture->bytes;
+    }
+
+    m_stats.created++;
+    m_stats.liveTextures++;
+    m_stats.liveBytes += texture->allocationBytes;
+
+    PooledTexture* raw = texture.get();
+    m_textures[raw] = std::move(texture);
+    return raw;
+}
+
+void TexturePool::release(PooledTexture* texture) {
+    if (!texture || !m_textures.count(texture)) {
+        return;
+    }
+
+    Key key;
+    key.width = texture->width;
+    key.height = texture->height;
+    key.format = texture->format;
+
+    m_stats.liveTextures--;
+    m_stats.liveBytes -= texture->allocationBytes;
+    m_stats.idleTextures++;
+    m_stats.idleBytes += texture->allocationBytes;
+
+    m_idleOrder.push_back(texture);
+    m_idle.emplace(key, std::prev(m_idleOrder.end()));
+    evictForBudget(0);
+}
+
+void TexturePool::evictForBudget(size_t reserve) {
+    if (m_budget == 0) {
+        return;
+    }
+    while (!m_idleOrder.empty() && m_stats.liveBytes + m_stats.idleBytes + reserve > m_budget) {
+        evictOldest();
+    }
+}
+
+void TexturePool::evictOldest() {
+    PooledTexture* texture = m_idleOrder.front();
+
+    Key key;
+    key.width = texture->width;
+    key.height = texture->height;
+    key.format = texture->format;
+    auto range = m_idle.equal_range(key);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (*it->second == texture) {
+            m_idle.erase(it);
+            break;
+        }
+    }
+    m_idleOrder.pop_front();
+
+    m_stats.idleTextures--;
+    m_stats.idleBytes -= texture->allocationBytes;
+    m_stats.evictions++;
+
+    m_destroy(*texture);
+    m_textures.erase(texture);
+}
+
+void TexturePool::trim() {
+    while (!m_idleOrder.empty()) {
+        evictOldest();
+    }
+}
+
+void TexturePool::clear() {
+    for (auto& pair : m_textures) {
+        m_destroy(*pair.second);
+    }
+    m_textures.clear();
+    m_idleOrder.clear();
+    m_idle.clear();
+    m_stats.liveTextures = 0;
+    m_stats.idleTextures = 0;
+    m_stats.liveBytes = 0;
+    m_stats.idleBytes = 0;
+}
+
+TexturePoolStats TexturePool::getStats() const {
+    TexturePoolStats stats = m_stats;
+    size_t requests = stats.reused + stats.created;
+    stats.hitRate = requests > 0 ? static_cast<float>(stats.reused) / requests : 0.0f;
+    return stats;
+}
+
+} // namespace AIForge
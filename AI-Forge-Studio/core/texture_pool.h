@@ -0,0 +1,183 @@
+/**
+ * @file texture_pool.h
+ * @brief Recycling pool of sampled GPU textures
+ *
+ * The gallery and preview views replace same-sized 512, 1024 and 4K
+ * images all the time. Creating an image and binding fresh memory for each
+ * one goes through the driver allocator and shows up as frame-time spikes,
+ * so freed textures are kept idle and handed out again for the next image
+ * of the same size and format.
+ *
+ * Features:
+ * - Reuse keyed by width, height and format
+ * - VRAM budget over live and idle textures
+ * - Least-recently-released eviction of idle textures
+ * - Byte accounting from the driver's allocation size
+ *
+ * Not thread-safe: owned and used by the render thread.
+ */
+
+#ifndef TEXTURE_POOL_H
+#define TEXTURE_POOL_H
+
+#include <map>
+#include <list>
+#include <unordered_map>
+#include <memory>
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+
+namespace AIForge {
+
+/**
+ * @enum TextureFormat
+ * @brief Pixel formats of uploaded images
+ */
+enum class TextureFormat {
+    R8,         // VK_FORMAT_R8_UNORM
+    RG8,        // VK_FORMAT_R8G8_UNORM
+    RGB8,       // VK_FORMAT_R8G8B8_UNORM (where supported for sampling)
+    RGBA8       // VK_FORMAT_R8G8B8A8_UNORM
+};
+
+/**
+ * @brief Format for an image with the given channel count
+ * @param channels Bytes per pixel (1-4)
+ * @return Texture format (RGBA8 for unknown counts)
+ */
+TextureFormat textureFormatFromChannels(int channels);
+
+/**
+ * @struct PooledTexture
+ * @brief A texture owned by the pool
+ */
+struct PooledTexture {
+    void* image = nullptr;          // VkImage / ID3D12Resource
+    void* view = nullptr;           // VkImageView / SRV
+    void* memory = nullptr;         // VkDeviceMemory / VmaAllocation
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    TextureFormat format = TextureFormat::RGBA8;
+    size_t bytes = 0;               // Pixel data size (width * height * channels)
+    size_t allocationBytes = 0;     // Device memory actually bound, set by the create function
+    uint64_t lastUsedSerial = 0;    // Newest frame that samples it (renderer)
+    uint32_t descriptorIndex = 0;   // Slot in the bindless texture array, set by the create function
+};
+
+/**
+ * @struct TexturePoolStats
+ * @brief Texture pool counters
+ */
+struct TexturePoolStats {
+    size_t liveTextures = 0;
+    size_t idleTextures = 0;
+    size_t liveBytes = 0;
+    size_t idleBytes = 0;
+    size_t created = 0;
+    size_t reused = 0;
+    size_t evictions = 0;
+    size_t overBudget = 0;          // Created although live textures alone exceed the budget
+    float hitRate = 0.0f;           // reused / (reused + created)
+};
+
+/**
+ * @class TexturePool
+ * @brief Size- and format-keyed texture recycler
+ */
+class TexturePool {
+public:
+    /**
+     * @brief Creates the device objects of a texture (size and format are set)
+     */
+    using CreateFunction = std::function<bool(PooledTexture& texture)>;
+
+    /**
+     * @brief Destroys the device objects of a texture
+     */
+    using DestroyFunction = std::function<void(PooledTexture& texture)>;
+
+    /**
+     * @brief Construct pool
+     * @param create Called when no idle texture fits
+     * @param destroy Called for evicted textures and on clear()
+     */
+    TexturePool(CreateFunction create, DestroyFunction destroy);
+    ~TexturePool();
+
+    // Disable copy and move
+    TexturePool(const TexturePool&) = delete;
+    TexturePool& operator=(const TexturePool&) = delete;
+    TexturePool(TexturePool&&) = delete;
+    TexturePool& operator=(TexturePool&&) = delete;
+
+    /**
+     * @brief Set the VRAM budget (a lower budget evicts idle textures at once)
+     * @param budgetBytes Budget over live and idle textures (0 = unlimited)
+     */
+    void setBudget(size_t budgetBytes);
+
+    /**
+     * @brief Get an idle texture of this size and format, or create one
+     * @param width Width in pixels
+     * @param height Height in pixels
+     * @param channels Bytes per pixel
+     * @return Texture, or nullptr if creation failed
+     */
+    PooledTexture* acquire(int width, int height, int channels);
+
+    /**
+     * @brief Return a texture the GPU no longer uses
+     * @param texture Texture from acquire
+     */
+    void release(PooledTexture* texture);
+
+    /**
+     * @brief Destroy every idle texture
+     */
+    void trim();
+
+    /**
+     * @brief Destroy every texture, live ones included (the GPU must be idle)
+     */
+    void clear();
+
+    /**
+     * @brief Get pool statistics
+     * @return TexturePoolStats structure
+     */
+    TexturePoolStats getStats() const;
+
+private:
+    struct Key {
+        int width = 0;
+        int height = 0;
+        TextureFormat format = TextureFormat::RGBA8;
+
+        bool operator<(const Key& other) const;
+    };
+
+    CreateFunction m_create;
+    DestroyFunction m_destroy;
+    size_t m_budget;
+
+    std::unordered_map<PooledTexture*, std::unique_ptr<PooledTexture>> m_textures;
+    std::list<PooledTexture*> m_idleOrder;  // Oldest release first
+    std::multimap<Key, std::list<PooledTexture*>::iterator> m_idle;
+    TexturePoolStats m_stats;
+
+    /**
+     * @brief Evict idle textures until reserve more bytes fit in the budget
+     */
+    void evictForBudget(size_t reserve);
+
+    /**
+     * @brief Destroy the oldest idle texture
+     */
+    void evictOldest();
+};
+
+} // namespace AIForge
+
+#endif // TEXTURE_POOL_H
@@ -0,0 +1,194 @@
+/**
+ * @file tile_blender.cpp
+ * @brief Implementation of the tile layout and blender
+ */
+
+#include "tile_blender.h"
+#include "image_sink.h"
+#include "logger.h"
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <string>
+
+namespace AIForge {
+
+namespace {
+
+std::vector<int> tileStarts(int size, int tile, int overlap) {
+    // Stops at the first tile that reaches the edge; with overlap at most
+    // half a tile, no pixel is covered by more than two tiles per axis
+    std::vector<int> starts;
+    for (int start = 0;; start += tile - overlap) {
+        starts.push_back(start);
+        if (start + tile >= size) {
+            break;
+        }
+    }
+    return starts;
+}
+
+unsigned char crossFade(unsigned char older, unsigned char newer, float weight) {
+    return static_cast<unsigned char>(older + (newer - older) * weight + 0.5f);
+}
+
+} // namespace
+
+bool TileGrid::build(int width, int height, const TileConfig& config) {
+    if (width <= 0 || height <= 0 || config.tileSize <= 0 ||
+        config.overlap < 0 || config.overlap * 2 > config.tileSize) {
+        LOG_ERROR("TileBlender", "Invalid tiling: " + std::to_string(config.tileSize) +
+                  " px tiles with " + std::to_string(config.overlap) + " px overlap over " +
+                  std::to_string(width) + "x" + std::to_string(height));
+        return false;
+    }
+
+    imageWidth = width;
+    imageHeight = height;
+    tileSize = config.tileSize;
+    columnStarts = tileStarts(width, config.tileSize, config.overlap);
+    rowStarts = tileStarts(height, config.tileSize, config.overlap);
+    return true;
+}
+
+TileRect TileGrid::tile(int row, int column) const {
+    TileRect rect;
+    rect.x = columnStarts[column];
+    rect.y = rowStarts[row];
+    rect.width = std::min(tileSize, imageWidth - rect.x);
+    rect.height = std::min(tileSize, imageHeight - rect.y);
+    return rect;
+}
+
+TileBlender::TileBlender()
+    : m_sink(nullptr)
+    , m_scale(1)
+    , m_channels(0)
+    , m_rowBytes(0)
+    , m_carryRows(0)
+    , m_nextTile(0)
+{
+}
+
+TileBlender::~TileBlender() = default;
+
+bool TileBlender::begin(const TileGrid& grid, int scaleFactor, int channels, ImageRowSink& sink) {
+    m_grid = grid;
+    m_sink = &sink;
+    m_scale = scaleFactor;
+    m_channels = channels;
+    m_rowBytes = static_cast<size_t>(grid.imageWidth) * scaleFactor * channels;
+    m_carryRows = 0;
+    m_nextTile = 0;
+
+    const size_t bandRows = static_cast<size_t>(grid.tile(0, 0).height) * scaleFactor;
+    const size_t overlapRows = grid.rows() > 1 ?
+        static_cast<size_t>(grid.tile(0, 0).height - grid.rowStarts[1]) * scaleFactor : 0;
+    try {
+        m_band.assign(bandRows * m_rowBytes, 0);
+        m_carry.assign(overlapRows * m_rowBytes, 0);
+    } catch (const std::bad_alloc&) {
+        LOG_ERROR("TileBlender", "Out of memory for a " + std::to_string(bandRows) + " row band");
+        return false;
+    }
+
+    LOG_DEBUG("TileBlender", std::to_string(grid.count()) + " tiles, " +
+              std::to_string(getBufferBytes() / (1024 * 1024)) + " MB blend buffers");
+    return sink.begin(grid.imageWidth * scaleFactor, grid.imageHeight * scaleFactor, channels);
+}
+
+bool TileBlender::addTile(int row, int column, const unsigned char* pixels) {
+    if (!m_sink || !pixels || row * m_grid.columns() + column != m_nextTile) {
+        LOG_ERROR("TileBlender", "Tile " + std::to_string(row) + "," + std::to_string(column) +
+                  " out of order");
+        return false;
+    }
+
+    const TileRect rect = m_grid.tile(row, column);
+    const size_t x0 = static_cast<size_t>(rect.x) * m_scale;
+    const int width = rect.width * m_scale;
+    const int height = rect.height * m_scale;
+    int overlap = 0;
+    if (column > 0) {
+        const TileRect left = m_grid.tile(row, column - 1);
+        overlap = (left.x + left.width - rect.x) * m_scale;
+    }
+    buildRamp(overlap);
+
+    // Cross-fade from the left neighbour over the shared columns, copy the rest
+    const size_t tileRowBytes = static_cast<size_t>(width) * m_channels;
+    const size_t blendBytes = static_cast<size_t>(overlap) * m_channels;
+    for (int y = 0; y < height; y++) {
+        unsigned char* destination = &m_band[y * m_rowBytes + x0 * m_channels];
+        const unsigned char* source = pixels + y * tileRowBytes;
+        for (int x = 0; x < overlap; x++) {
+            for (int c = 0; c < m_channels; c++) {
+                const size_t i = static_cast<size_t>(x) * m_channels + c;
+                destination[i] = crossFade(destination[i], source[i], m_ramp[x]);
+            }
+        }
+        std::memcpy(destination + blendBytes, source + blendBytes, tileRowBytes - blendBytes);
+    }
+
+    m_nextTile++;
+    if (column == m_grid.columns() - 1) {
+        return flushBand();
+    }
+    return true;
+}
+
+bool TileBlender::flushBand() {
+    const int row = m_nextTile / m_grid.columns() - 1;
+    const int y0 = m_grid.rowStarts[row] * m_scale;
+    const int bandRows = m_grid.tile(row, 0).height * m_scale;
+
+    // Cross-fade from the band above over the shared rows
+    buildRamp(m_carryRows);
+    for (int y = 0; y < m_carryRows; y++) {
+        unsigned char* destination = &m_band[y * m_rowBytes];
+        const unsigned char* older = &m_carry[y * m_rowBytes];
+        for (size_t i = 0; i < m_rowBytes; i++) {
+            destination[i] = crossFade(older[i], destination[i], m_ramp[y]);
+        }
+    }
+
+    // Rows the next band overlaps are held back for it
+    int finishedRows = bandRows;
+    m_carryRows = 0;
+    if (row + 1 < m_grid.rows()) {
+        finishedRows = m_grid.rowStarts[row + 1] * m_scale - y0;
+        m_carryRows = bandRows - finishedRows;
+        if (m_carryRows > 0) {
+            std::memcpy(m_carry.data(), &m_band[finishedRows * m_rowBytes], m_carryRows * m_rowBytes);
+        }
+    }
+
+    if (!m_sink->writeRows(y0, finishedRows, m_band.data())) {
+        LOG_ERROR("TileBlender", "Sink rejected rows " + std::to_string(y0) + "+" +
+                  std::to_string(finishedRows));
+        return false;
+    }
+    return true;
+}
+
+bool TileBlender::finish() {
+    if (!m_sink || m_nextTile != m_grid.count()) {
+        LOG_ERROR("TileBlender", "Finished after " + std::to_string(m_nextTile) + " of " +
+                  std::to_string(m_grid.count()) + " tiles");
+        return false;
+    }
+    return m_sink->finish();
+}
+
+size_t TileBlender::getBufferBytes() const {
+    return m_band.size() + m_carry.size();
+}
+
+void TileBlender::buildRamp(int n) {
+    m_ramp.resize(n);
+    for (int i = 0; i < n; i++) {
+        m_ramp[i] = (i + 0.5f) / n;
+    }
+}
+
+} // namespace AIForge
@@ -0,0 +1,159 @@
+/**
+ * @file tile_blender.h
+ * @brief Overlapping tile layout and seam blending for tiled upscaling
+ *
+ * Upscaling a large image in one pass needs the whole input and output in
+ * memory at once, which at 8K and 4x is several GB of VRAM and host RAM.
+ * The tiled path runs the model on overlapping input tiles and the
+ * blender stitches their outputs back together: neighbours cross-fade
+ * linearly over the shared pixels so no seam shows, and every finished
+ * band of rows goes straight to an ImageRowSink.
+ *
+ * Memory is bounded by one band of full-width output rows plus the
+ * overlap carried into the next band, whatever the image height.
+ *
+ * Features:
+ * - Tiles of at most tileSize with at least overlap shared pixels
+ * - Separable linear feathering (bilinear weights at tile corners)
+ * - Rows emitted to the sink in order as soon as no later tile touches them
+ *
+ * Not thread-safe: tiles are added from one thread.
+ */
+
+#ifndef TILE_BLENDER_H
+#define TILE_BLENDER_H
+
+#include <vector>
+#include <cstddef>
+
+namespace AIForge {
+
+class ImageRowSink;
+
+/**
+ * @struct TileConfig
+ * @brief Tiling parameters, in input pixels
+ */
+struct TileConfig {
+    int tileSize = 256;     // Largest tile side
+    int overlap = 16;       // Pixels shared by neighbouring tiles (at most tileSize / 2)
+    int maxInFlight = 0;    // Tiles queued or running at once (0 = two per worker)
+};
+
+/**
+ * @struct TileRect
+ * @brief A tile's input region
+ */
+struct TileRect {
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+};
+
+/**
+ * @struct TileGrid
+ * @brief Tile layout over an image
+ *
+ * Tiles step by tileSize - overlap; the last tile in a row or column is
+ * cut short at the image edge.
+ */
+struct TileGrid {
+    int imageWidth = 0;
+    int imageHeight = 0;
+    std::vector<int> columnStarts;
+    std::vector<int> rowStarts;
+    int tileSize = 0;
+
+    /**
+     * @brief Lay tiles out over an image
+     * @param width Image width
+     * @param height Image height
+     * @param config Tiling parameters
+     * @return false if the parameters are invalid
+     */
+    bool build(int width, int height, const TileConfig& config);
+
+    int columns() const { return static_cast<int>(columnStarts.size()); }
+    int rows() const { return static_cast<int>(rowStarts.size()); }
+    int count() const { return columns() * rows(); }
+
+    /**
+     * @brief Get a tile's region
+     * @param row Tile row
+     * @param column Tile column
+     */
+    TileRect tile(int row, int column) const;
+};
+
+/**
+ * @class TileBlender
+ * @brief Stitches upscaled tiles and streams the rows to a sink
+ */
+class TileBlender {
+public:
+    TileBlender();
+    ~TileBlender();
+
+    // Disable copy and move
+    TileBlender(const TileBlender&) = delete;
+    TileBlender& operator=(const TileBlender&) = delete;
+    TileBlender(TileBlender&&) = delete;
+    TileBlender& operator=(TileBlender&&) = delete;
+
+    /**
+     * @brief Start an image and call sink.begin
+     * @param grid Tile layout over the input
+     * @param scaleFactor Output pixels per input pixel
+     * @param channels Bytes per pixel
+     * @param sink Receives the output rows
+     * @return false if the sink refused the image or memory ran out
+     */
+    bool begin(const TileGrid& grid, int scaleFactor, int channels, ImageRowSink& sink);
+
+    /**
+     * @brief Add the upscaled output of the next tile
+     *
+     * Tiles must come in raster order (left to right, then top to bottom).
+     * Completing a row of tiles flushes its finished rows to the sink.
+     *
+     * @param row Tile row
+     * @param column Tile column
+     * @param pixels Tile output: (width * scale) x (height * scale) x channels
+     * @return false if out of order or the sink failed
+     */
+    bool addTile(int row, int column, const unsigned char* pixels);
+
+    /**
+     * @brief Call sink.finish after the last tile
+     * @return false if tiles are missing or the sink failed
+     */
+    bool finish();
+
+    /**
+     * @brief Get host memory held for blending
+     * @return Bytes
+     */
+    size_t getBufferBytes() const;
+
+private:
+    // Cross-fade weights over an overlap of n output pixels
+    void buildRamp(int n);
+    bool flushBand();
+
+    TileGrid m_grid;
+    ImageRowSink* m_sink;
+    int m_scale;
+    int m_channels;
+    size_t m_rowBytes;          // One output row
+
+    std::vector<unsigned char> m_band;   // Output rows of the current tile row
+    std::vector<unsigned char> m_carry;  // Bottom rows of the previous band, blended into this one
+    int m_carryRows;
+    std::vector<float> m_ramp;           // Weight of the newer tile across an overlap
+    int m_nextTile;
+};
+
+} // namespace AIForge
+
+#endif // TILE_BLENDER_H
@@ -0,0 +1,217 @@
+/**
+ * @file tracer.cpp
+ * @brief Implementation of the span tracer
+ */
+
+#include "tracer.h"
+#include "json_value.h"
+#include "logger.h"
+#include <fstream>
+#include <cstring>
+#include <cstdio>
+#include <set>
+
+namespace AIForge {
+
+namespace {
+constexpr size_t DEFAULT_BUFFER_CAPACITY = 16384;
+
+// Chrome trace process IDs for the CPU threads and the GPU tracks
+constexpr int CPU_PROCESS_ID = 1;
+constexpr int GPU_PROCESS_ID = 2;
+
+/**
+ * @brief Append a nanosecond value as fractional microseconds (the format's unit)
+ */
+void appendMicroseconds(std::string& out, uint64_t ns) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%llu.%03u",
+                  static_cast<unsigned long long>(ns / 1000),
+                  static_cast<unsigned>(ns % 1000));
+    out += buffer;
+}
+
+/**
+ * @brief Append a metadata event naming a process or thread
+ */
+void appendMetadata(std::string& out, const char* kind, int pid, uint32_t tid,
+                    const std::string& name) {
+    out += "{\"name\":\"";
+    out += kind;
+    out += "\",\"ph\":\"M\",\"pid\":" + std::to_string(pid) +
+           ",\"tid\":" + std::to_string(tid) +
+           ",\"args\":{\"name\":\"" + JsonValue::escape(name) + "\"}},\n";
+}
+}
+
+thread_local Tracer::ThreadBuffer* Tracer::t_buffer = nullptr;
+
+Tracer& Tracer::getInstance() {
+    static Tracer instance;
+    return instance;
+}
+
+Tracer::Tracer()
+    : m_epoch(std::chrono::steady_clock::now())
+    , m_enabled(false)
+    , m_capacity(DEFAULT_BUFFER_CAPACITY)
+    , m_nextThreadId(1)
+{
+}
+
+void Tracer::setEnabled(bool enabled) {
+    // In production: record the reference CUDA event per device here, so GPU
+    // spans can be placed on the host timeline at export
+    m_enabled.store(enabled, std::memory_order_relaxed);
+    LOG_INFO("Tracer", enabled ? "Tracing enabled" : "Tracing disabled");
+}
+
+void Tracer::setBufferCapacity(size_t events) {
+    m_capacity.store(events > 0 ? events : 1, std::memory_order_relaxed);
+}
+
+void Tracer::setThreadName(const std::string& name) {
+    ThreadBuffer& buffer = threadBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    buffer.threadName = name;
+}
+
+uint64_t Tracer::now() const {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - m_epoch).count());
+}
+
+Tracer::ThreadBuffer& Tracer::threadBuffer() {
+    if (!t_buffer) {
+        auto buffer = std::make_shared<ThreadBuffer>();
+        std::lock_guard<std::mutex> lock(m_registryMutex);
+        buffer->threadId = m_nextThreadId++;
+        buffer->threadName = "Thread " + std::to_string(buffer->threadId);
+        m_buffers.push_back(buffer);
+        t_buffer = buffer.get();
+    }
+    return *t_buffer;
+}
+
+void Tracer::append(const TraceEvent& event) {
+    ThreadBuffer& buffer = threadBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    if (buffer.events.empty()) {
+        // Sized on first span, so threads that never trace cost nothing
+        buffer.events.resize(m_capacity.load(std::memory_order_relaxed));
+    }
+    buffer.events[buffer.written % buffer.events.size()] = event;
+    buffer.written++;
+}
+
+void Tracer::record(const char* category, const char* name, uint64_t startNs, uint64_t endNs,
+                    const char* detail) {
+    TraceEvent event;
+    event.category = category;
+    event.name = name;
+    event.startNs = startNs;
+    event.durationNs = endNs > startNs ? endNs - startNs : 0;
+    if (detail) {
+        std::strncpy(event.detail, detail, sizeof(event.detail) - 1);
+    }
+    append(event);
+}
+
+void Tracer::recordGpu(const char* category, const char* name, int deviceId,
+                       uint64_t startNs, uint64_t endNs, const char* detail) {
+    TraceEvent event;
+    event.category = category;
+    event.name = name;
+    event.startNs = startNs;
+    event.durationNs = endNs > startNs ? endNs - startNs : 0;
+    event.deviceId = deviceId < 0 ? 0 : deviceId;
+    if (detail) {
+        std::strncpy(event.detail, detail, sizeof(event.detail) - 1);
+    }
+    append(event);
+}
+
+void Tracer::clear() {
+    std::lock_guard<std::mutex> lock(m_registryMutex);
+    for (auto& buffer : m_buffers) {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        buffer->events.clear();
+        buffer->events.shrink_to_fit();
+        buffer->written = 0;
+    }
+}
+
+std::string Tracer::exportChromeTrace() const {
+    std::string out = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    appendMetadata(out, "process_name", CPU_PROCESS_ID, 0, "AI Forge Studio");
+    appendMetadata(out, "process_name", GPU_PROCESS_ID, 0, "GPU");
+
+    std::set<int> devices;
+    size_t overwritten = 0;
+
+    std::lock_guard<std::mutex> lock(m_registryMutex);
+    for (const auto& buffer : m_buffers) {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        appendMetadata(out, "thread_name", CPU_PROCESS_ID, buffer->threadId, buffer->threadName);
+
+        // Oldest surviving event first
+        const size_t size = buffer->events.size();
+        if (size == 0) {
+            continue;
+        }
+        const uint64_t count = buffer->written < size ? buffer->written : size;
+        overwritten += static_cast<size_t>(buffer->written - count);
+
+        for (uint64_t i = buffer->written - count; i < buffer->written; i++) {
+            const TraceEvent& event = buffer->events[i % size];
+            const bool gpu = event.deviceId >= 0;
+            if (gpu) {
+                devices.insert(event.deviceId);
+            }
+
+            out += "{\"name\":\"" + JsonValue::escape(event.name ? event.name : "") +
+                   "\",\"cat\":\"" + JsonValue::escape(event.category ? event.category : "") +
+                   "\",\"ph\":\"X\",\"ts\":";
+            appendMicroseconds(out, event.startNs);
+            out += ",\"dur\":";
+            appendMicroseconds(out, event.durationNs);
+            out += ",\"pid\":" + std::to_string(gpu ? GPU_PROCESS_ID : CPU_PROCESS_ID) +
+                   ",\"tid\":" + std::to_string(gpu ? static_cast<uint32_t>(event.deviceId)
+                                                    : buffer->threadId);
+            if (event.detail[0] != '\0') {
+                out += ",\"args\":{\"detail\":\"" + JsonValue::escape(event.detail) + "\"}";
+            }
+            out += "},\n";
+        }
+    }
+
+    for (int device : devices) {
+        appendMetadata(out, "thread_name", GPU_PROCESS_ID, static_cast<uint32_t>(device),
+                       "Device " + std::to_string(device));
+    }
+
+    // The format allows no trailing comma, so the last entry carries the summary
+    out += "{\"name\":\"trace_stats\",\"ph\":\"M\",\"pid\":" + std::to_string(CPU_PROCESS_ID) +
+           ",\"tid\":0,\"args\":{\"overwritten\":" + std::to_string(overwritten) + "}}\n]}\n";
+    return out;
+}
+
+bool Tracer::writeChromeTrace(const std::string& filepath) const {
+    std::string json = exportChromeTrace();
+
+    std::ofstream file(filepath, std::ios::out | std::ios::trunc);
+    if (!file.is_open()) {
+        LOG_ERROR("Tracer", "Failed to open trace file: " + filepath);
+        return false;
+    }
+    file << json;
+    if (!file.good()) {
+        LOG_ERROR("Tracer", "Failed to write trace file: " + filepath);
+        return false;
+    }
+
+    LOG_INFO("Tracer", "Trace written to " + filepath);
+    return true;
+}
+
+} // namespace AIForge
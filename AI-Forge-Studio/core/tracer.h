@@ -0,0 +1,276 @@
+/**
+ * @file tracer.h
+ * @brief Scoped span tracing with Chrome trace (Perfetto) export
+ *
+ * InferenceResult::inferenceTime says how long a request took, not where
+ * the time went. The tracer records named spans (model load, optimize,
+ * every diffusion step, host/device copies, frames, Python calls) so a
+ * latency regression can be opened in chrome://tracing or ui.perfetto.dev
+ * and read off a timeline.
+ *
+ * Features:
+ * - Per-thread ring buffers: recording never contends with other threads
+ * - Nanosecond steady-clock timestamps
+ * - GPU spans on per-device tracks (CUDA events in production)
+ * - Disabled by default; a disabled span costs one relaxed atomic load
+ * - Compiled out entirely with AIFORGE_ENABLE_TRACING=0
+ */
+
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#ifndef AIFORGE_ENABLE_TRACING
+#define AIFORGE_ENABLE_TRACING 1
+#endif
+
+namespace AIForge {
+
+/**
+ * @struct TraceEvent
+ * @brief One completed span
+ */
+struct TraceEvent {
+    const char* category = nullptr;    // String literal
+    const char* name = nullptr;        // String literal
+    uint64_t startNs = 0;
+    uint64_t durationNs = 0;
+    int deviceId = -1;                 // GPU track, or -1 for the recording thread
+    char detail[48] = {};              // Truncated copy of the span's detail text
+};
+
+/**
+ * @class Tracer
+ * @brief Singleton span recorder
+ */
+class Tracer {
+public:
+    /**
+     * @brief Get singleton instance
+     * @return Reference to tracer instance
+     */
+    static Tracer& getInstance();
+
+    // Disable copy and move
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+    Tracer(Tracer&&) = delete;
+    Tracer& operator=(Tracer&&) = delete;
+
+    /**
+     * @brief Start or stop recording
+     * @param enabled true to record spans
+     */
+    void setEnabled(bool enabled);
+
+    /**
+     * @brief Check whether spans are being recorded
+     */
+    bool isEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Set the ring size of each thread (applies to new rings and after clear())
+     * @param events Events kept per thread; older ones are overwritten
+     */
+    void setBufferCapacity(size_t events);
+
+    /**
+     * @brief Name the calling thread in exported traces
+     * @param name Thread name
+     */
+    void setThreadName(const std::string& name);
+
+    /**
+     * @brief Current trace timestamp
+     * @return Nanoseconds since the tracer was created
+     */
+    uint64_t now() const;
+
+    /**
+     * @brief Record a CPU span on the calling thread
+     * @param category Category (string literal)
+     * @param name Span name (string literal)
+     * @param startNs Start timestamp from now()
+     * @param endNs End timestamp from now()
+     * @param detail Optional detail text (copied, truncated)
+     */
+    void record(const char* category, const char* name, uint64_t startNs, uint64_t endNs,
+                const char* detail = nullptr);
+
+    /**
+     * @brief Record a span on a GPU track
+     * @param deviceId GPU device ID
+     */
+    void recordGpu(const char* category, const char* name, int deviceId,
+                   uint64_t startNs, uint64_t endNs, const char* detail = nullptr);
+
+    /**
+     * @brief Drop all recorded events
+     */
+    void clear();
+
+    /**
+     * @brief Build a Chrome trace JSON document from the recorded events
+     * @return JSON text in the Trace Event Format
+     */
+    std::string exportChromeTrace() const;
+
+    /**
+     * @brief Write a Chrome trace JSON file
+     * @param filepath Output path
+     * @return true if written
+     */
+    bool writeChromeTrace(const std::string& filepath) const;
+
+private:
+    Tracer();
+    ~Tracer() = default;
+
+    struct ThreadBuffer {
+        std::mutex mutex;               // Owner thread vs. export; uncontended otherwise
+        std::vector<TraceEvent> events;
+        uint64_t written = 0;           // Total events recorded (ring index = written % size)
+        uint32_t threadId = 0;
+        std::string threadName;
+    };
+
+    std::chrono::steady_clock::time_point m_epoch;
+    std::atomic<bool> m_enabled;
+    std::atomic<size_t> m_capacity;
+
+    // Buffers outlive their threads so spans of finished workers still export
+    std::vector<std::shared_ptr<ThreadBuffer>> m_buffers;
+    uint32_t m_nextThreadId;
+    mutable std::mutex m_registryMutex;
+
+    static thread_local ThreadBuffer* t_buffer;
+
+    /**
+     * @brief Get the calling thread's buffer, registering it on first use
+     */
+    ThreadBuffer& threadBuffer();
+
+    /**
+     * @brief Append an event to the calling thread's ring
+     */
+    void append(const TraceEvent& event);
+};
+
+/**
+ * @class TraceScope
+ * @brief Records a CPU span from construction to destruction
+ */
+class TraceScope {
+public:
+    TraceScope(const char* category, const char* name, const char* detail = nullptr)
+        : m_category(category)
+        , m_name(name)
+        , m_detail(detail)
+        , m_startNs(0)
+        , m_active(Tracer::getInstance().isEnabled())
+    {
+        if (m_active) {
+            m_startNs = Tracer::getInstance().now();
+        }
+    }
+
+    TraceScope(const char* category, const char* name, const std::string& detail)
+        : TraceScope(category, name, detail.c_str()) {}
+
+    ~TraceScope() {
+        if (m_active) {
+            Tracer& tracer = Tracer::getInstance();
+            tracer.record(m_category, m_name, m_startNs, tracer.now(), m_detail);
+        }
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* m_category;
+    const char* m_name;
+    const char* m_detail;
+    uint64_t m_startNs;
+    bool m_active;
+};
+
+/**
+ * @class TraceGpuScope
+ * @brief Records the GPU time of the work enqueued on a stream within a scope
+ *
+ * In production the scope records a CUDA event pair on the stream
+ * (cudaEventRecord at both ends, events taken from a per-thread pool) and
+ * the tracer resolves them at export with cudaEventElapsedTime against a
+ * reference event recorded when tracing was enabled, so the span shows
+ * when the GPU actually ran the work. In simulation, enqueue is
+ * synchronous and host timestamps are used.
+ */
+class TraceGpuScope {
+public:
+    TraceGpuScope(const char* category, const char* name, int deviceId, void* stream = nullptr)
+        : m_category(category)
+        , m_name(name)
+        , m_deviceId(deviceId)
+        , m_startNs(0)
+        , m_active(Tracer::getInstance().isEnabled())
+    {
+        (void)stream;
+        if (m_active) {
+            // In production: cudaEventRecord(startEvent, stream)
+            m_startNs = Tracer::getInstance().now();
+        }
+    }
+
+    ~TraceGpuScope() {
+        if (m_active) {
+            // In production: cudaEventRecord(stopEvent, stream); resolved at export
+            Tracer& tracer = Tracer::getInstance();
+            tracer.recordGpu(m_category, m_name, m_deviceId, m_startNs, tracer.now());
+        }
+    }
+
+    TraceGpuScope(const TraceGpuScope&) = delete;
+    TraceGpuScope& operator=(const TraceGpuScope&) = delete;
+
+private:
+    const char* m_category;
+    const char* m_name;
+    int m_deviceId;
+    uint64_t m_startNs;
+    bool m_active;
+};
+
+} // namespace AIForge
+
+#define AIFORGE_TRACE_CONCAT_INNER(a, b) a##b
+#define AIFORGE_TRACE_CONCAT(a, b) AIFORGE_TRACE_CONCAT_INNER(a, b)
+
+/**
+ * @brief Helper macros for tracing the enclosing scope
+ *
+ * TRACE_SCOPE("AIEngine", "loadModel");
+ * TRACE_SCOPE_DETAIL("AIEngine", "runInference", config.modelId);
+ * TRACE_GPU_SCOPE("AIEngine", "H2D weights", deviceId, stream);
+ */
+#if AIFORGE_ENABLE_TRACING
+#define TRACE_SCOPE(category, name) \
+    ::AIForge::TraceScope AIFORGE_TRACE_CONCAT(traceScope_, __LINE__)(category, name)
+#define TRACE_SCOPE_DETAIL(category, name, detail) \
+    ::AIForge::TraceScope AIFORGE_TRACE_CONCAT(traceScope_, __LINE__)(category, name, detail)
+#define TRACE_GPU_SCOPE(category, name, deviceId, stream) \
+    ::AIForge::TraceGpuScope AIFORGE_TRACE_CONCAT(traceGpuScope_, __LINE__)(category, name, deviceId, stream)
+#else
+#define TRACE_SCOPE(category, name) ((void)0)
+#define TRACE_SCOPE_DETAIL(category, name, detail) ((void)0)
+#define TRACE_GPU_SCOPE(category, name, deviceId, stream) ((void)0)
+#endif
+
+#endif // TRACER_H
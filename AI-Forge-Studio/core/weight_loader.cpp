@@ -0,0 +1,661 @@
+/**
+ * @file weight_loader.cpp
+ * @brief Implementation of memory-mapped weight loading
+ *
+ * SafeTensors layout: u64 little-endian header length N, N bytes of JSON
+ * mapping tensor names to {dtype, shape, data_offsets}, then the payload.
+ * GGUF layout: magic, version, tensor and metadata counts, metadata KV
+ * pairs, tensor infos, then the payload starting at the next multiple of
+ * general.alignment.
+ */
+
+#include "weight_loader.h"
+#include "json_value.h"
+#include "logger.h"
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace AIForge {
+
+namespace {
+constexpr uint64_t SAFETENSORS_MAX_HEADER = 100 * 1024 * 1024;
+constexpr uint32_t GGUF_MAGIC = 0x46554747; // "GGUF" little-endian
+constexpr uint32_t GGUF_DEFAULT_ALIGNMENT = 32;
+constexpr int GGUF_MAX_DEPTH = 256;     // Nested arrays; deeper files are rejected
+
+/**
+ * @brief Bounds-checked little-endian reader over the mapping
+ */
+class ByteReader {
+public:
+    ByteReader(const uint8_t* data, uint64_t size) : m_data(data), m_size(size), m_pos(0), m_ok(true) {}
+
+    template <typename T>
+    T read() {
+        T value{};
+        if (!require(sizeof(T))) {
+            return value;
+        }
+        std::memcpy(&value, m_data + m_pos, sizeof(T));
+        m_pos += sizeof(T);
+        return value;
+    }
+
+    std::string readString() {
+        uint64_t length = read<uint64_t>();
+        if (!require(length)) {
+            return "";
+        }
+        std::string value(reinterpret_cast<const char*>(m_data + m_pos), static_cast<size_t>(length));
+        m_pos += length;
+        return value;
+    }
+
+    void skip(uint64_t bytes) {
+        if (require(bytes)) {
+            m_pos += bytes;
+        }
+    }
+
+    bool ok() const { return m_ok; }
+    uint64_t position() const { return m_pos; }
+
+private:
+    const uint8_t* m_data;
+    uint64_t m_size;
+    uint64_t m_pos;
+    bool m_ok;
+
+    bool require(uint64_t bytes) {
+        if (!m_ok || bytes > m_size - m_pos) {
+            m_ok = false;
+            return false;
+        }
+        return true;
+    }
+};
+
+enum GGUFValueType : uint32_t {
+    GGUF_UINT8 = 0, GGUF_INT8 = 1, GGUF_UINT16 = 2, GGUF_INT16 = 3,
+    GGUF_UINT32 = 4, GGUF_INT32 = 5, GGUF_FLOAT32 = 6, GGUF_BOOL = 7,
+    GGUF_STRING = 8, GGUF_ARRAY = 9, GGUF_UINT64 = 10, GGUF_INT64 = 11,
+    GGUF_FLOAT64 = 12
+};
+
+/**
+ * @brief Size of a fixed-width GGUF scalar (0 for strings and arrays)
+ */
+uint64_t ggufScalarSize(uint32_t type) {
+    switch (type) {
+        case GGUF_UINT8: case GGUF_INT8: case GGUF_BOOL:    return 1;
+        case GGUF_UINT16: case GGUF_INT16:                  return 2;
+        case GGUF_UINT32: case GGUF_INT32: case GGUF_FLOAT32: return 4;
+        case GGUF_UINT64: case GGUF_INT64: case GGUF_FLOAT64: return 8;
+        default:                                            return 0;
+    }
+}
+
+/**
+ * @brief Read one GGUF metadata value, rendering scalars as text
+ * @param depth Array nesting level, bounded so crafted files cannot exhaust the stack
+ * @return Value text (arrays are skipped and yield an empty string)
+ */
+std::string readGGUFValue(ByteReader& reader, uint32_t type, int depth = 0) {
+    switch (type) {
+        case GGUF_UINT8:   return std::to_string(reader.read<uint8_t>());
+        case GGUF_INT8:    return std::to_string(reader.read<int8_t>());
+        case GGUF_UINT16:  return std::to_string(reader.read<uint16_t>());
+        case GGUF_INT16:   return std::to_string(reader.read<int16_t>());
+        case GGUF_UINT32:  return std::to_string(reader.read<uint32_t>());
+        case GGUF_INT32:   return std::to_string(reader.read<int32_t>());
+        case GGUF_FLOAT32: return std::to_string(reader.read<float>());
+        case GGUF_BOOL:    return reader.read<uint8_t>() ? "true" : "false";
+        case GGUF_STRING:  return reader.readString();
+        case GGUF_UINT64:  return std::to_string(reader.read<uint64_t>());
+        case GGUF_INT64:   return std::to_string(reader.read<int64_t>());
+        case GGUF_FLOAT64: return std::to_string(reader.read<double>());
+        case GGUF_ARRAY: {
+            // Arrays (tokenizer vocabularies etc.) are skipped without copying
+            uint32_t elementType = reader.read<uint32_t>();
+            uint64_t count = reader.read<uint64_t>();
+            uint64_t elementSize = ggufScalarSize(elementType);
+            if (depth >= GGUF_MAX_DEPTH) {
+                reader.skip(UINT64_MAX);
+            } else if (elementSize > 0) {
+                if (count > UINT64_MAX / elementSize) {
+                    reader.skip(UINT64_MAX);
+                } else {
+                    reader.skip(count * elementSize);
+                }
+            } else {
+                for (uint64_t i = 0; i < count && reader.ok(); i++) {
+                    readGGUFValue(reader, elementType, depth + 1);
+                }
+            }
+            return "";
+        }
+        default:
+            reader.skip(UINT64_MAX); // Unknown type: fail the parse
+            return "";
+    }
+}
+
+/**
+ * @struct GGMLTypeInfo
+ * @brief Block layout of a ggml tensor type
+ */
+struct GGMLTypeInfo {
+    const char* name;
+    uint32_t blockSize;     // Elements per block
+    uint32_t typeSize;      // Bytes per block
+};
+
+/**
+ * @brief Look up a ggml tensor type
+ * @return Type info (typeSize 0 if unknown)
+ */
+GGMLTypeInfo ggmlTypeInfo(uint32_t type) {
+    switch (type) {
+        case 0:  return {"F32", 1, 4};
+        case 1:  return {"F16", 1, 2};
+        case 2:  return {"Q4_0", 32, 18};
+        case 3:  return {"Q4_1", 32, 20};
+        case 6:  return {"Q5_0", 32, 22};
+        case 7:  return {"Q5_1", 32, 24};
+        case 8:  return {"Q8_0", 32, 34};
+        case 9:  return {"Q8_1", 32, 36};
+        case 10: return {"Q2_K", 256, 84};
+        case 11: return {"Q3_K", 256, 110};
+        case 12: return {"Q4_K", 256, 144};
+        case 13: return {"Q5_K", 256, 176};
+        case 14: return {"Q6_K", 256, 210};
+        case 15: return {"Q8_K", 256, 292};
+        case 24: return {"I8", 1, 1};
+        case 25: return {"I16", 1, 2};
+        case 26: return {"I32", 1, 4};
+        case 27: return {"I64", 1, 8};
+        case 28: return {"F64", 1, 8};
+        case 30: return {"BF16", 1, 2};
+        default: return {"UNKNOWN", 1, 0};
+    }
+}
+
+/**
+ * @brief Derive the layer a tensor belongs to from its name
+ *
+ * "model.layers.12.mlp.up_proj.weight" -> "model.layers.12",
+ * "blk.3.attn_q.weight" -> "blk.3", "lm_head.weight" -> "lm_head".
+ */
+std::string layerNameOf(const std::string& tensorName) {
+    size_t start = 0;
+    while (start < tensorName.size()) {
+        size_t end = tensorName.find('.', start);
+        if (end == std::string::npos) {
+            end = tensorName.size();
+        }
+        bool numeric = end > start;
+        for (size_t i = start; i < end; i++) {
+            if (tensorName[i] < '0' || tensorName[i] > '9') {
+                numeric = false;
+                break;
+            }
+        }
+        if (numeric) {
+            return tensorName.substr(0, end);
+        }
+        start = end + 1;
+    }
+
+    size_t lastDot = tensorName.rfind('.');
+    return lastDot == std::string::npos ? tensorName : tensorName.substr(0, lastDot);
+}
+} // namespace
+
+// ============================================================================
+// MappedFile
+// ============================================================================
+
+MappedFile::MappedFile()
+    : m_data(nullptr)
+    , m_size(0)
+#ifdef _WIN32
+    , m_fileHandle(nullptr)
+    , m_mappingHandle(nullptr)
+#else
+    , m_fd(-1)
+#endif
+{
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::string& filepath) {
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        CloseHandle(file);
+        return false;
+    }
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    m_fileHandle = file;
+    m_mappingHandle = mapping;
+    m_data = static_cast<const uint8_t*>(view);
+    m_size = static_cast<uint64_t>(fileSize.QuadPart);
+#else
+    int fd = ::open(filepath.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+
+    // MAP_SHARED read-only: pages come straight from the page cache and are
+    // shared with every other process mapping the same file
+    void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    if (view == MAP_FAILED) {
+        ::close(fd);
+        return false;
+    }
+
+    m_fd = fd;
+    m_data = static_cast<const uint8_t*>(view);
+    m_size = static_cast<uint64_t>(st.st_size);
+#endif
+
+    return true;
+}
+
+void MappedFile::close() {
+    if (!m_data) {
+        return;
+    }
+
+#ifdef _WIN32
+    UnmapViewOfFile(m_data);
+    CloseHandle(m_mappingHandle);
+    CloseHandle(m_fileHandle);
+    m_mappingHandle = nullptr;
+    m_fileHandle = nullptr;
+#else
+    munmap(const_cast<uint8_t*>(m_data), static_cast<size_t>(m_size));
+    ::close(m_fd);
+    m_fd = -1;
+#endif
+
+    m_data = nullptr;
+    m_size = 0;
+}
+
+void MappedFile::advise(uint64_t offset, uint64_t length, Advice advice) const {
+    if (!m_data || offset >= m_size || length == 0) {
+        return;
+    }
+    length = std::min(length, m_size - offset);
+
+#ifdef _WIN32
+    if (advice == Advice::WILLNEED) {
+        WIN32_MEMORY_RANGE_ENTRY range;
+        range.VirtualAddress = const_cast<uint8_t*>(m_data + offset);
+        range.NumberOfBytes = static_cast<SIZE_T>(length);
+        PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+    }
+    // The Windows memory manager trims clean mapped pages on its own
+#else
+    // madvise needs a page-aligned start
+    static const uint64_t pageSize = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    uint64_t alignedOffset = offset - (offset % pageSize);
+    length += offset - alignedOffset;
+
+    int flag = MADV_NORMAL;
+    switch (advice) {
+        case Advice::NORMAL:     flag = MADV_NORMAL; break;
+        case Advice::SEQUENTIAL: flag = MADV_SEQUENTIAL; break;
+        case Advice::RANDOM:     flag = MADV_RANDOM; break;
+        case Advice::WILLNEED:   flag = MADV_WILLNEED; break;
+        case Advice::DONTNEED:   flag = MADV_DONTNEED; break;
+    }
+    madvise(const_cast<uint8_t*>(m_data + alignedOffset), static_cast<size_t>(length), flag);
+#endif
+}
+
+// ============================================================================
+// WeightLoader
+// ============================================================================
+
+WeightLoader::WeightLoader()
+    : m_totalTensorBytes(0)
+{
+}
+
+bool WeightLoader::open(const std::string& filepath, ModelFormat format) {
+    close();
+    m_lastError.clear();
+
+    if (format != ModelFormat::SAFETENSORS && format != ModelFormat::GGUF) {
+        m_lastError = "Unsupported weight format: " + modelFormatToString(format);
+        return false;
+    }
+
+    if (!m_file.open(filepath)) {
+        m_lastError = "Cannot map file: " + filepath;
+        return false;
+    }
+
+    // Only the header is touched here; the payload stays unread
+    bool parsed = (format == ModelFormat::SAFETENSORS) ? parseSafeTensors() : parseGGUF();
+    if (!parsed) {
+        m_file.close();
+        m_tensors.clear();
+        m_metadata.clear();
+        return false;
+    }
+
+    buildIndex();
+
+    LOG_INFO("WeightLoader", "Mapped " + filepath + ": " + std::to_string(m_tensors.size()) +
+             " tensors in " + std::to_string(m_layers.size()) + " layers, " +
+             std::to_string(m_totalTensorBytes / (1024 * 1024)) + " MB");
+    return true;
+}
+
+void WeightLoader::close() {
+    m_file.close();
+    m_tensors.clear();
+    m_layers.clear();
+    m_tensorIndex.clear();
+    m_metadata.clear();
+    m_totalTensorBytes = 0;
+}
+
+bool WeightLoader::parseSafeTensors() {
+    ByteReader reader(m_file.data(), m_file.size());
+    uint64_t headerLength = reader.read<uint64_t>();
+    if (!reader.ok() || headerLength == 0 || headerLength > SAFETENSORS_MAX_HEADER ||
+        headerLength > m_file.size() - sizeof(uint64_t)) {
+        m_lastError = "Invalid SafeTensors header length";
+        return false;
+    }
+
+    std::string headerText(reinterpret_cast<const char*>(m_file.data() + sizeof(uint64_t)),
+                           static_cast<size_t>(headerLength));
+    JsonValue header;
+    std::string parseError;
+    if (!JsonValue::parse(headerText, header, &parseError) || !header.isObject()) {
+        m_lastError = "Invalid SafeTensors header: " + parseError;
+        return false;
+    }
+
+    const uint64_t dataStart = sizeof(uint64_t) + headerLength;
+    const uint64_t dataSize = m_file.size() - dataStart;
+
+    for (const auto& member : header.members()) {
+        const JsonValue& entry = member.second;
+
+        if (member.first == "__metadata__") {
+            for (const auto& item : entry.members()) {
+                if (item.second.isString()) {
+                    m_metadata[item.first] = item.second.asString();
+                }
+            }
+            continue;
+        }
+
+        const JsonValue* shape = entry.find("shape");
+        const JsonValue* offsets = entry.find("data_offsets");
+        if (!entry.isObject() || !shape || !shape->isArray() ||
+            !offsets || !offsets->isArray() || offsets->asArray().size() != 2) {
+            m_lastError = "Malformed tensor entry: " + member.first;
+            return false;
+        }
+
+        int64_t begin = offsets->asArray()[0].asInt(-1);
+        int64_t end = offsets->asArray()[1].asInt(-1);
+        if (begin < 0 || end < begin || static_cast<uint64_t>(end) > dataSize) {
+            m_lastError = "Tensor data out of bounds: " + member.first;
+            return false;
+        }
+
+        WeightTensorInfo tensor;
+        tensor.name = member.first;
+        tensor.dtype = entry.getString("dtype");
+        for (const auto& dim : shape->asArray()) {
+            tensor.shape.push_back(dim.asInt());
+        }
+        tensor.offset = dataStart + static_cast<uint64_t>(begin);
+        tensor.sizeBytes = static_cast<uint64_t>(end - begin);
+        m_tensors.push_back(std::move(tensor));
+    }
+
+    return true;
+}
+
+bool WeightLoader::parseGGUF() {
+    ByteReader reader(m_file.data(), m_file.size());
+
+    uint32_t magic = reader.read<uint32_t>();
+    uint32_t version = reader.read<uint32_t>();
+    if (!reader.ok() || magic != GGUF_MAGIC) {
+        m_lastError = "Not a GGUF file";
+        return false;
+    }
+    if (version < 2) {
+        // v1 used 32-bit counts and string lengths
+        m_lastError = "Unsupported GGUF version " + std::to_string(version);
+        return false;
+    }
+
+    uint64_t tensorCount = reader.read<uint64_t>();
+    uint64_t kvCount = reader.read<uint64_t>();
+
+    uint32_t alignment = GGUF_DEFAULT_ALIGNMENT;
+    for (uint64_t i = 0; i < kvCount && reader.ok(); i++) {
+        std::string key = reader.readString();
+        uint32_t type = reader.read<uint32_t>();
+
+        if (key == "general.alignment" && type == GGUF_UINT32) {
+            alignment = reader.read<uint32_t>();
+            m_metadata[key] = std::to_string(alignment);
+            continue;
+        }
+
+        std::string value = readGGUFValue(reader, type);
+        if (type != GGUF_ARRAY) {
+            m_metadata[key] = value;
+        }
+    }
+
+    if (!reader.ok() || alignment == 0) {
+        m_lastError = "Truncated GGUF metadata";
+        return false;
+    }
+
+    struct RawTensor {
+        WeightTensorInfo info;
+        uint64_t relativeOffset;
+        uint64_t elements;
+        GGMLTypeInfo type;
+    };
+    std::vector<RawTensor> raw;
+
+    for (uint64_t i = 0; i < tensorCount && reader.ok(); i++) {
+        RawTensor tensor;
+        tensor.info.name = reader.readString();
+
+        uint32_t ndim = reader.read<uint32_t>();
+        if (ndim > 8) {
+            m_lastError = "Too many dimensions in tensor: " + tensor.info.name;
+            return false;
+        }
+        tensor.elements = 1;
+        for (uint32_t d = 0; d < ndim; d++) {
+            uint64_t dim = reader.read<uint64_t>();
+            if (dim > static_cast<uint64_t>(INT64_MAX) ||
+                (dim != 0 && tensor.elements > UINT64_MAX / dim)) {
+                m_lastError = "Tensor size overflows: " + tensor.info.name;
+                return false;
+            }
+            tensor.info.shape.push_back(static_cast<int64_t>(dim));
+            tensor.elements *= dim;
+        }
+
+        tensor.type = ggmlTypeInfo(reader.read<uint32_t>());
+        tensor.info.dtype = tensor.type.name;
+        tensor.relativeOffset = reader.read<uint64_t>();
+        raw.push_back(std::move(tensor));
+    }
+
+    if (!reader.ok()) {
+        m_lastError = "Truncated GGUF tensor index";
+        return false;
+    }
+
+    uint64_t dataStart = (reader.position() + alignment - 1) / alignment * alignment;
+    if (dataStart > m_file.size()) {
+        m_lastError = "GGUF data section out of bounds";
+        return false;
+    }
+    const uint64_t dataSize = m_file.size() - dataStart;
+
+    // Sizes of types this loader does not know are taken from the gap to the
+    // next tensor
+    std::vector<uint64_t> sortedOffsets;
+    for (const auto& tensor : raw) {
+        sortedOffsets.push_back(tensor.relativeOffset);
+    }
+    std::sort(sortedOffsets.begin(), sortedOffsets.end());
+
+    for (auto& tensor : raw) {
+        uint64_t size = 0;
+        if (tensor.type.typeSize > 0) {
+            uint64_t blocks = tensor.elements / tensor.type.blockSize;
+            if (blocks > UINT64_MAX / tensor.type.typeSize) {
+                m_lastError = "Tensor size overflows: " + tensor.info.name;
+                return false;
+            }
+            size = blocks * tensor.type.typeSize;
+        } else {
+            auto next = std::upper_bound(sortedOffsets.begin(), sortedOffsets.end(),
+                                         tensor.relativeOffset);
+            uint64_t limit = (next == sortedOffsets.end()) ? dataSize : *next;
+            size = limit > tensor.relativeOffset ? limit - tensor.relativeOffset : 0;
+        }
+
+        if (tensor.relativeOffset > dataSize || size > dataSize - tensor.relativeOffset) {
+            m_lastError = "Tensor data out of bounds: " + tensor.info.name;
+            return false;
+        }
+
+        tensor.info.offset = dataStart + tensor.relativeOffset;
+        tensor.info.sizeBytes = size;
+        m_tensors.push_back(std::move(tensor.info));
+    }
+
+    return true;
+}
+
+void WeightLoader::buildIndex() {
+    // File order, so layer-by-layer uploads read the file sequentially
+    std::sort(m_tensors.begin(), m_tensors.end(),
+              [](const WeightTensorInfo& a, const WeightTensorInfo& b) {
+                  return a.offset < b.offset;
+              });
+
+    std::unordered_map<std::string, size_t> layerIndex;
+    m_totalTensorBytes = 0;
+
+    for (size_t i = 0; i < m_tensors.size(); i++) {
+        const WeightTensorInfo& tensor = m_tensors[i];
+        m_tensorIndex[tensor.name] = i;
+        m_totalTensorBytes += tensor.sizeBytes;
+
+        std::string layerName = layerNameOf(tensor.name);
+        auto it = layerIndex.find(layerName);
+        if (it == layerIndex.end()) {
+            WeightLayer layer;
+            layer.name = layerName;
+            layer.offset = tensor.offset;
+            it = layerIndex.emplace(layerName, m_layers.size()).first;
+            m_layers.push_back(std::move(layer));
+        }
+
+        WeightLayer& layer = m_layers[it->second];
+        layer.tensors.push_back(i);
+        layer.sizeBytes += tensor.sizeBytes;
+    }
+}
+
+const WeightTensorInfo* WeightLoader::findTensor(const std::string& name) const {
+    auto it = m_tensorIndex.find(name);
+    if (it == m_tensorIndex.end()) {
+        return nullptr;
+    }
+    return &m_tensors[it->second];
+}
+
+const void* WeightLoader::getTensorData(const WeightTensorInfo& tensor) const {
+    if (!m_file.isOpen()) {
+        return nullptr;
+    }
+    return m_file.data() + tensor.offset;
+}
+
+std::string WeightLoader::getMetadata(const std::string& key) const {
+    auto it = m_metadata.find(key);
+    return it == m_metadata.end() ? "" : it->second;
+}
+
+void WeightLoader::prefetchLayer(size_t layerIndex) const {
+    adviseLayer(layerIndex, MappedFile::Advice::WILLNEED);
+}
+
+void WeightLoader::releaseLayer(size_t layerIndex) const {
+    adviseLayer(layerIndex, MappedFile::Advice::DONTNEED);
+}
+
+void WeightLoader::adviseLayer(size_t layerIndex, MappedFile::Advice advice) const {
+    if (layerIndex >= m_layers.size()) {
+        return;
+    }
+    for (size_t index : m_layers[layerIndex].tensors) {
+        const WeightTensorInfo& tensor = m_tensors[index];
+        m_file.advise(tensor.offset, tensor.sizeBytes, advice);
+    }
+}
+
+} // namespace AIForge
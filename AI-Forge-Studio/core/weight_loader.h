@@ -0,0 +1,230 @@
+/**
+ * @file weight_loader.h
+ * @brief Memory-mapped, lazy weight loading for SafeTensors and GGUF files
+ *
+ * Opening a checkpoint maps the file read-only and parses only its header
+ * and tensor index; no tensor payload is read. Payload pages are faulted in
+ * by the OS when a tensor is first touched (typically while uploading it to
+ * the GPU), and dropped from the process again once uploaded. Because the
+ * mapping is shared and read-only, several processes loading the same file
+ * on one node share a single copy in the page cache.
+ *
+ * Features:
+ * - SafeTensors (u64 header length + JSON index) and GGUF v2/v3
+ * - Tensor lookup by name and grouping into transformer layers
+ * - Layer-granular readahead and release hints (madvise / PrefetchVirtualMemory)
+ */
+
+#ifndef WEIGHT_LOADER_H
+#define WEIGHT_LOADER_H
+
+#include "ai_engine.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <cstdint>
+
+namespace AIForge {
+
+/**
+ * @class MappedFile
+ * @brief Read-only memory mapping of a whole file
+ */
+class MappedFile {
+public:
+    /**
+     * @enum Advice
+     * @brief Access pattern hints for a mapped range
+     */
+    enum class Advice {
+        NORMAL,
+        SEQUENTIAL,         // Aggressive readahead
+        RANDOM,             // No readahead
+        WILLNEED,           // Start reading the range in the background
+        DONTNEED            // Drop the range from this process (page cache is kept)
+    };
+
+    MappedFile();
+    ~MappedFile();
+
+    // Disable copy and move
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&&) = delete;
+    MappedFile& operator=(MappedFile&&) = delete;
+
+    /**
+     * @brief Map a file read-only
+     * @param filepath Path to file
+     * @return true if mapped
+     */
+    bool open(const std::string& filepath);
+
+    /**
+     * @brief Unmap the file
+     */
+    void close();
+
+    bool isOpen() const { return m_data != nullptr; }
+    const uint8_t* data() const { return m_data; }
+    uint64_t size() const { return m_size; }
+
+    /**
+     * @brief Give the OS a hint about how a range will be accessed
+     * @param offset Byte offset of the range
+     * @param length Length of the range in bytes
+     * @param advice Access pattern
+     */
+    void advise(uint64_t offset, uint64_t length, Advice advice) const;
+
+private:
+    const uint8_t* m_data;
+    uint64_t m_size;
+#ifdef _WIN32
+    void* m_fileHandle;
+    void* m_mappingHandle;
+#else
+    int m_fd;
+#endif
+};
+
+/**
+ * @struct WeightTensorInfo
+ * @brief Index entry for one tensor in a weight file
+ */
+struct WeightTensorInfo {
+    std::string name;
+    std::string dtype;              // As stored: "F16", "BF16", "Q4_K", ...
+    std::vector<int64_t> shape;     // GGUF lists the innermost dimension first
+    uint64_t offset = 0;            // Absolute byte offset in the file
+    uint64_t sizeBytes = 0;
+};
+
+/**
+ * @struct WeightLayer
+ * @brief Tensors that belong to one model layer, in file order
+ */
+struct WeightLayer {
+    std::string name;               // e.g. "model.layers.3", "blk.3", "token_embd"
+    std::vector<size_t> tensors;    // Indices into WeightLoader::getTensors()
+    uint64_t offset = 0;            // Lowest tensor offset in the layer
+    uint64_t sizeBytes = 0;
+};
+
+/**
+ * @class WeightLoader
+ * @brief Lazy tensor index over a memory-mapped SafeTensors or GGUF file
+ */
+class WeightLoader {
+public:
+    WeightLoader();
+    ~WeightLoader() = default;
+
+    // Disable copy and move
+    WeightLoader(const WeightLoader&) = delete;
+    WeightLoader& operator=(const WeightLoader&) = delete;
+    WeightLoader(WeightLoader&&) = delete;
+    WeightLoader& operator=(WeightLoader&&) = delete;
+
+    /**
+     * @brief Map a weight file and parse its tensor index
+     * @param filepath Path to .safetensors or .gguf file
+     * @param format ModelFormat::SAFETENSORS or ModelFormat::GGUF
+     * @return true if the header parsed and every tensor lies within the file
+     */
+    bool open(const std::string& filepath, ModelFormat format);
+
+    /**
+     * @brief Unmap the file and clear the index
+     */
+    void close();
+
+    bool isOpen() const { return m_file.isOpen(); }
+
+    /**
+     * @brief Get the reason the last open() failed
+     * @return Error description
+     */
+    const std::string& getLastError() const { return m_lastError; }
+
+    /**
+     * @brief Get all tensors in file order
+     * @return Tensor index
+     */
+    const std::vector<WeightTensorInfo>& getTensors() const { return m_tensors; }
+
+    /**
+     * @brief Get tensors grouped into layers, in file order
+     * @return Layer list
+     */
+    const std::vector<WeightLayer>& getLayers() const { return m_layers; }
+
+    /**
+     * @brief Look up a tensor by name
+     * @param name Tensor name
+     * @return Index entry, or nullptr if not present
+     */
+    const WeightTensorInfo* findTensor(const std::string& name) const;
+
+    /**
+     * @brief Get a pointer to a tensor's payload inside the mapping
+     *
+     * No data is read until the returned memory is touched.
+     *
+     * @param tensor Entry from getTensors()
+     * @return Read-only payload pointer
+     */
+    const void* getTensorData(const WeightTensorInfo& tensor) const;
+
+    /**
+     * @brief Get file metadata (SafeTensors __metadata__, GGUF scalar keys)
+     * @param key Metadata key
+     * @return Value as a string, or empty string if absent
+     */
+    std::string getMetadata(const std::string& key) const;
+
+    /**
+     * @brief Get the total payload size of all tensors
+     * @return Size in bytes
+     */
+    uint64_t getTotalTensorBytes() const { return m_totalTensorBytes; }
+
+    /**
+     * @brief Start reading a layer's payload in the background
+     * @param layerIndex Index into getLayers()
+     */
+    void prefetchLayer(size_t layerIndex) const;
+
+    /**
+     * @brief Drop a layer's payload pages from this process after upload
+     * @param layerIndex Index into getLayers()
+     */
+    void releaseLayer(size_t layerIndex) const;
+
+private:
+    MappedFile m_file;
+    std::vector<WeightTensorInfo> m_tensors;
+    std::vector<WeightLayer> m_layers;
+    std::unordered_map<std::string, size_t> m_tensorIndex;
+    std::map<std::string, std::string> m_metadata;
+    uint64_t m_totalTensorBytes;
+    std::string m_lastError;
+
+    bool parseSafeTensors();
+    bool parseGGUF();
+
+    /**
+     * @brief Build the name index and layer grouping after parsing
+     */
+    void buildIndex();
+
+    /**
+     * @brief Apply an access hint to every tensor of a layer
+     */
+    void adviseLayer(size_t layerIndex, MappedFile::Advice advice) const;
+};
+
+} // namespace AIForge
+
+#endif // WEIGHT_LOADER_H
@@ -0,0 +1,243 @@
+/**
+ * @file worker_pool.cpp
+ * @brief Implementation of the bounded priority worker pool
+ */
+
+#include "worker_pool.h"
+#include "logger.h"
+#include "tracer.h"
+#include <chrono>
+
+namespace AIForge {
+
+namespace {
+// Cancellation flag of the job currently running on this thread
+thread_local const std::atomic<bool>* t_currentJobCancelled = nullptr;
+}
+
+WorkerPool::WorkerPool()
+    : m_queuedCount(0)
+    , m_running(false)
+{
+}
+
+WorkerPool::~WorkerPool() {
+    stop();
+}
+
+bool WorkerPool::start(const WorkerPoolConfig& config) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_running) {
+        LOG_WARNING(config.name, "Worker pool already running");
+        return true;
+    }
+
+    m_config = config;
+    if (m_config.numThreads == 0) {
+        m_config.numThreads = 1;
+    }
+
+    m_running = true;
+    m_workers.reserve(m_config.numThreads);
+    for (unsigned int i = 0; i < m_config.numThreads; i++) {
+        m_workers.emplace_back(&WorkerPool::workerLoop, this, i);
+    }
+
+    LOG_INFO(m_config.name, "Started " + std::to_string(m_config.numThreads) +
+             " workers (queue capacity " + std::to_string(m_config.maxQueuedJobs) + ")");
+    return true;
+}
+
+void WorkerPool::stop() {
+    std::vector<QueuedJob> cancelled;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_running) {
+            return;
+        }
+        m_running = false;
+
+        for (auto& queue : m_queues) {
+            for (auto& job : queue) {
+                cancelled.push_back(std::move(job));
+            }
+            queue.clear();
+        }
+        m_queuedCount = 0;
+        m_stats.cancelledJobs += cancelled.size();
+
+        // Running jobs are asked to finish early
+        for (auto& pair : m_runningJobs) {
+            pair.second->store(true);
+        }
+    }
+
+    m_workAvailable.notify_all();
+    m_spaceAvailable.notify_all();
+
+    for (auto& job : cancelled) {
+        if (job.onCancel) {
+            job.onCancel();
+        }
+    }
+
+    for (auto& worker : m_workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    m_workers.clear();
+
+    LOG_INFO(m_config.name, "Worker pool stopped");
+}
+
+bool WorkerPool::submit(JobId id, JobPriority priority, std::function<void()> run,
+                        std::function<void()> onCancel) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    auto hasSpace = [this] {
+        return !m_running || m_queuedCount < m_config.maxQueuedJobs;
+    };
+
+    if (!hasSpace() && m_config.submitTimeoutMs > 0) {
+        m_spaceAvailable.wait_for(lock, std::chrono::milliseconds(m_config.submitTimeoutMs),
+                                  hasSpace);
+    }
+
+    if (!m_running || m_queuedCount >= m_config.maxQueuedJobs) {
+        m_stats.rejectedJobs++;
+        if (m_running) {
+            LOG_WARNING(m_config.name, "Queue full, rejecting job " + std::to_string(id));
+        }
+        return false;
+    }
+
+    int level = static_cast<int>(priority);
+    if (level < 0 || level >= PRIORITY_LEVELS) {
+        level = static_cast<int>(JobPriority::NORMAL);
+    }
+
+    m_queues[level].push_back({id, std::move(run), std::move(onCancel)});
+    m_queuedCount++;
+    lock.unlock();
+
+    m_workAvailable.notify_one();
+    return true;
+}
+
+bool WorkerPool::cancel(JobId id) {
+    QueuedJob cancelledJob;
+    bool found = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        for (auto& queue : m_queues) {
+            for (auto it = queue.begin(); it != queue.end(); ++it) {
+                if (it->id == id) {
+                    cancelledJob = std::move(*it);
+                    queue.erase(it);
+                    m_queuedCount--;
+                    m_stats.cancelledJobs++;
+                    found = true;
+                    break;
+                }
+            }
+            if (found) {
+                break;
+            }
+        }
+
+        if (!found) {
+            auto running = m_runningJobs.find(id);
+            if (running == m_runningJobs.end()) {
+                return false;
+            }
+            running->second->store(true);
+            return true;
+        }
+    }
+
+    m_spaceAvailable.notify_one();
+    if (cancelledJob.onCancel) {
+        cancelledJob.onCancel();
+    }
+    return true;
+}
+
+bool WorkerPool::isCurrentJobCancelled() {
+    return t_currentJobCancelled && t_currentJobCancelled->load(std::memory_order_relaxed);
+}
+
+size_t WorkerPool::getQueuedCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_queuedCount;
+}
+
+size_t WorkerPool::getOutstandingCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_queuedCount + m_runningJobs.size();
+}
+
+WorkerPoolStats WorkerPool::getStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    WorkerPoolStats stats = m_stats;
+    stats.queuedJobs = m_queuedCount;
+    stats.activeJobs = m_runningJobs.size();
+    return stats;
+}
+
+bool WorkerPool::popJob(QueuedJob& job) {
+    for (auto& queue : m_queues) {
+        if (!queue.empty()) {
+            job = std::move(queue.front());
+            queue.pop_front();
+            m_queuedCount--;
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkerPool::workerLoop(unsigned int workerIndex) {
+    Tracer::getInstance().setThreadName(m_config.name + " " + std::to_string(workerIndex));
+    if (m_config.onThreadStart) {
+        m_config.onThreadStart(workerIndex);
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (true) {
+        m_workAvailable.wait(lock, [this] { return !m_running || m_queuedCount > 0; });
+
+        QueuedJob job;
+        if (!m_running || !popJob(job)) {
+            if (!m_running) {
+                break;
+            }
+            continue;
+        }
+
+        auto cancelFlag = std::make_shared<std::atomic<bool>>(false);
+        m_runningJobs[job.id] = cancelFlag;
+        lock.unlock();
+        m_spaceAvailable.notify_one();
+
+        t_currentJobCancelled = cancelFlag.get();
+        try {
+            job.run();
+        } catch (const std::exception& e) {
+            LOG_ERROR(m_config.name, "Job " + std::to_string(job.id) +
+                      " threw exception: " + e.what());
+        } catch (...) {
+            LOG_ERROR(m_config.name, "Job " + std::to_string(job.id) +
+                      " threw unknown exception");
+        }
+        t_currentJobCancelled = nullptr;
+
+        lock.lock();
+        m_runningJobs.erase(job.id);
+        m_stats.completedJobs++;
+    }
+}
+
+} // namespace AIForge
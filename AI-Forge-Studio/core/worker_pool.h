@@ -0,0 +1,191 @@
+/**
+ * @file worker_pool.h
+ * @brief Bounded, priority-aware worker thread pool
+ *
+ * Provides a fixed set of worker threads fed from a bounded submission
+ * queue. Jobs are dequeued by priority (interactive work ahead of batch
+ * work) and in FIFO order within a priority.
+ *
+ * Features:
+ * - Fixed thread count, no per-job thread creation
+ * - Three priority levels
+ * - Backpressure: submission blocks (with timeout) when the queue is full
+ * - Cancellation of queued jobs and cooperative cancellation of running jobs
+ */
+
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <cstdint>
+
+namespace AIForge {
+
+/**
+ * @enum JobPriority
+ * @brief Scheduling priority for queued jobs (lower value runs first)
+ */
+enum class JobPriority {
+    INTERACTIVE = 0,    // UI previews and other latency-sensitive work
+    NORMAL = 1,         // Default priority
+    BATCH = 2           // Background and bulk jobs
+};
+
+/**
+ * @struct WorkerPoolConfig
+ * @brief Configuration for a worker pool
+ */
+struct WorkerPoolConfig {
+    std::string name = "WorkerPool";    // Used in log messages
+    unsigned int numThreads = 2;
+    size_t maxQueuedJobs = 256;         // Queue capacity across all priorities
+    unsigned int submitTimeoutMs = 5000; // Max time submit() blocks when full (0 = reject immediately)
+    std::function<void(unsigned int)> onThreadStart; // Called on each worker with its index
+};
+
+/**
+ * @struct WorkerPoolStats
+ * @brief Worker pool counters
+ */
+struct WorkerPoolStats {
+    size_t queuedJobs = 0;
+    size_t activeJobs = 0;
+    size_t completedJobs = 0;
+    size_t cancelledJobs = 0;
+    size_t rejectedJobs = 0;
+};
+
+/**
+ * @class WorkerPool
+ * @brief Fixed-size thread pool with a bounded priority queue
+ *
+ * Usage:
+ * pool.submit(id, JobPriority::NORMAL, [] { work(); }, [] { onCancelled(); });
+ */
+class WorkerPool {
+public:
+    using JobId = uint64_t;
+
+    WorkerPool();
+    ~WorkerPool();
+
+    // Disable copy and move
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+    WorkerPool(WorkerPool&&) = delete;
+    WorkerPool& operator=(WorkerPool&&) = delete;
+
+    /**
+     * @brief Start worker threads
+     * @param config Pool configuration
+     * @return true if started
+     */
+    bool start(const WorkerPoolConfig& config);
+
+    /**
+     * @brief Cancel queued jobs, wait for running jobs and join workers
+     */
+    void stop();
+
+    /**
+     * @brief Check if pool is running
+     * @return true if running
+     */
+    bool isRunning() const { return m_running; }
+
+    /**
+     * @brief Submit a job
+     *
+     * Blocks for up to submitTimeoutMs while the queue is full.
+     *
+     * @param id Caller-assigned job ID used for cancellation
+     * @param priority Scheduling priority
+     * @param run Job body, executed on a worker thread
+     * @param onCancel Called instead of run if the job is cancelled while queued
+     * @return true if queued, false if rejected (queue full or pool stopped)
+     */
+    bool submit(JobId id, JobPriority priority, std::function<void()> run,
+                std::function<void()> onCancel = nullptr);
+
+    /**
+     * @brief Cancel a job
+     *
+     * Queued jobs are removed and their onCancel handler is invoked. Running
+     * jobs are flagged; they observe this through isCurrentJobCancelled().
+     *
+     * @param id Job ID passed to submit()
+     * @return true if the job was found
+     */
+    bool cancel(JobId id);
+
+    /**
+     * @brief Check whether the job running on this thread was cancelled
+     * @return true if called from a worker whose current job was cancelled
+     */
+    static bool isCurrentJobCancelled();
+
+    /**
+     * @brief Get number of queued jobs
+     * @return Queued job count
+     */
+    size_t getQueuedCount() const;
+
+    /**
+     * @brief Get number of queued plus running jobs
+     * @return Outstanding job count
+     */
+    size_t getOutstandingCount() const;
+
+    /**
+     * @brief Get pool statistics
+     * @return WorkerPoolStats structure
+     */
+    WorkerPoolStats getStats() const;
+
+private:
+    static constexpr int PRIORITY_LEVELS = 3;
+
+    struct QueuedJob {
+        JobId id;
+        std::function<void()> run;
+        std::function<void()> onCancel;
+    };
+
+    WorkerPoolConfig m_config;
+    std::deque<QueuedJob> m_queues[PRIORITY_LEVELS];
+    std::map<JobId, std::shared_ptr<std::atomic<bool>>> m_runningJobs;
+    size_t m_queuedCount;
+    WorkerPoolStats m_stats;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_workAvailable;
+    std::condition_variable m_spaceAvailable;
+    std::atomic<bool> m_running;
+    std::vector<std::thread> m_workers;
+
+    /**
+     * @brief Worker thread main loop
+     * @param workerIndex Index of this worker
+     */
+    void workerLoop(unsigned int workerIndex);
+
+    /**
+     * @brief Pop the highest-priority queued job (lock must be held)
+     * @param job Receives the job
+     * @return true if a job was available
+     */
+    bool popJob(QueuedJob& job);
+};
+
+} // namespace AIForge
+
+#endif // WORKER_POOL_H
@@ -4,13 +4,38 @@
  *
  * نسخة تجريبية تعمل في سطر الأوامر لعرض قدرات البرنامج
  * بدون الحاجة لواجهة رسومية
+ *
+ * وضع الدفعات (بدون واجهة رسومية):
+ *   demo_cli --batch jobs.jsonl [--output DIR] [--concurrency N]
+ *            [--writers N] [--devices 0,1] [--pipelined]
+ *
+ * كل سطر في الملف مهمة JSON:
+ *   {"id": "cat", "model": "models/sdxl.onnx", "prompt": "a cat",
+ *    "width": 512, "height": 512, "steps": 30, "guidance": 7.5,
+ *    "seed": 42, "count": 4, "priority": "batch"}
+ * الحقلان model و prompt إلزاميان، والأسطر الفارغة أو التي تبدأ بـ # تُتجاهل.
  */
 
+#include "core/ai_engine.h"
+#include "core/image_sink.h"
+#include "core/json_value.h"
+#include "core/logger.h"
+#include "core/worker_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
 #include <iomanip>
+#include <map>
+#include <mutex>
+#include <sstream>
 #include <thread>
 #include <chrono>
 #include <string>
+#include <tuple>
 #include <vector>
 
 using namespace std;
@@ -184,7 +209,359 @@ void showMenu() {
     cout << "  5. Exit\n\n";
 }
 
-int main() {
+// ═══ وضع الدفعات ═══
+
+/**
+ * @brief مهمة واحدة من ملف المهام (صورة واحدة)
+ */
+struct BatchJob {
+    string name;                // اسم ملف الإخراج بدون الامتداد
+    string modelPath;
+    string prompt;
+    AIForge::InferenceConfig config;
+};
+
+/**
+ * @brief إعدادات وضع الدفعات من سطر الأوامر
+ */
+struct BatchOptions {
+    string manifestPath;
+    string outputDirectory = "output";
+    int concurrency = 4;        // مهام قيد التنفيذ في آن واحد
+    unsigned int writers = 2;   // خيوط ترميز الصور وكتابتها
+    vector<int> devices = {0};
+    bool pipelined = false;     // استخدام خط الأنابيب المرحلي للانتشار
+};
+
+/**
+ * @brief قراءة ملف المهام كاملاً قبل البدء، لتظهر الأخطاء فوراً لا بعد ساعات
+ * @return false عند وجود سطر غير صالح
+ */
+bool loadManifest(const string& path, vector<BatchJob>& jobs) {
+    ifstream file(path);
+    if (!file.is_open()) {
+        cerr << "Cannot open manifest: " << path << "\n";
+        return false;
+    }
+
+    const map<string, AIForge::JobPriority> priorities = {
+        {"interactive", AIForge::JobPriority::INTERACTIVE},
+        {"normal", AIForge::JobPriority::NORMAL},
+        {"batch", AIForge::JobPriority::BATCH}
+    };
+
+    string line;
+    int lineNumber = 0;
+    bool valid = true;
+    while (getline(file, line)) {
+        lineNumber++;
+        const size_t start = line.find_first_not_of(" \t\r");
+        if (start == string::npos || line[start] == '#') {
+            continue;
+        }
+
+        AIForge::JsonValue entry;
+        string error;
+        if (!AIForge::JsonValue::parse(line, entry, &error) || !entry.isObject()) {
+            cerr << path << ":" << lineNumber << ": invalid JSON" << (error.empty() ? "" : ": " + error) << "\n";
+            valid = false;
+            continue;
+        }
+
+        BatchJob job;
+        job.modelPath = entry.getString("model");
+        job.prompt = entry.getString("prompt");
+        const string priority = entry.getString("priority", "batch");
+        const int64_t count = entry.getInt("count", 1);
+        if (job.modelPath.empty() || job.prompt.empty() || count < 1 || !priorities.count(priority)) {
+            cerr << path << ":" << lineNumber << ": needs \"model\" and \"prompt\", count >= 1"
+                 << " and priority interactive, normal or batch\n";
+            valid = false;
+            continue;
+        }
+
+        job.config.width = static_cast<int>(entry.getInt("width", job.config.width));
+        job.config.height = static_cast<int>(entry.getInt("height", job.config.height));
+        job.config.numInferenceSteps = static_cast<int>(entry.getInt("steps", job.config.numInferenceSteps));
+        job.config.guidanceScale = static_cast<float>(entry.getNumber("guidance", job.config.guidanceScale));
+        job.config.priority = priorities.at(priority);
+        const unsigned int seed = static_cast<unsigned int>(entry.getInt("seed", 0));
+        const string id = entry.getString("id", "job" + to_string(lineNumber));
+
+        // بذرة ثابتة تعطي كل نسخة بذرة مختلفة، فتبقى النتائج قابلة للتكرار
+        for (int64_t i = 0; i < count; i++) {
+            BatchJob copy = job;
+            copy.name = count > 1 ? id + "_" + to_string(i) : id;
+            copy.config.seed = seed == 0 ? 0 : seed + static_cast<unsigned int>(i);
+            jobs.push_back(std::move(copy));
+        }
+    }
+
+    if (valid && jobs.empty()) {
+        cerr << "Manifest has no jobs: " << path << "\n";
+        return false;
+    }
+    return valid;
+}
+
+/**
+ * @brief ترميز الصورة وكتابتها إلى ملف PNM
+ */
+bool writeImage(const string& path, const AIForge::InferenceResult& result) {
+    AIForge::PnmFileSink sink(path);
+    return sink.begin(result.imageWidth, result.imageHeight, result.imageChannels) &&
+           sink.writeRows(0, result.imageHeight, result.imageData.data()) &&
+           sink.finish();
+}
+
+/**
+ * @brief قيمة المئين من عينات مرتبة
+ */
+double percentileOf(const vector<double>& sorted, double fraction) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    const size_t index = static_cast<size_t>(fraction * (sorted.size() - 1) + 0.5);
+    return sorted[min(index, sorted.size() - 1)];
+}
+
+/**
+ * @brief تشغيل ملف المهام على المحرك بدون واجهة رسومية
+ *
+ * تُحمَّل النماذج مرة واحدة وتبقى في الذاكرة، ويُبقي الخيط الرئيسي عدد
+ * المهام قيد التنفيذ عند concurrency حتى تبقى طوابير المحرك ممتلئة. تنتقل
+ * الصور المكتملة إلى مجمع خيوط منفصل للترميز والكتابة، فلا ينتظر عامل
+ * الاستدلال القرص، ولا يُحرَّر مكان المهمة إلا بعد كتابة صورتها، فتبقى
+ * الذاكرة محدودة.
+ *
+ * @return رمز الخروج (0 إذا نجحت كل المهام)
+ */
+int runBatch(const BatchOptions& options) {
+    using Clock = chrono::steady_clock;
+
+    vector<BatchJob> jobs;
+    if (!loadManifest(options.manifestPath, jobs)) {
+        return 1;
+    }
+
+    error_code ec;
+    filesystem::create_directories(options.outputDirectory, ec);
+    if (ec) {
+        cerr << "Cannot create output directory: " << options.outputDirectory << "\n";
+        return 1;
+    }
+
+    AIForge::Logger::getInstance().setMinLogLevel(AIForge::Logger::LogLevel::WARNING);
+
+    AIForge::AIEngine engine;
+    if (!engine.initialize(options.devices)) {
+        cerr << "Failed to initialize AI engine\n";
+        return 1;
+    }
+
+    // تحميل كل نموذج مرة واحدة ورفع أوزانه قبل البدء
+    map<string, string> models;
+    for (BatchJob& job : jobs) {
+        auto it = models.find(job.modelPath);
+        if (it == models.end()) {
+            const string id = engine.loadModel(job.modelPath, filesystem::path(job.modelPath).stem().string(),
+                                               AIForge::ModelType::TEXT_TO_IMAGE);
+            if (id.empty() || !engine.uploadModelWeights(id)) {
+                cerr << "Failed to load model: " << job.modelPath << "\n";
+                engine.shutdown();
+                return 1;
+            }
+            it = models.emplace(job.modelPath, id).first;
+        }
+        job.config.modelId = it->second;
+    }
+
+    AIForge::WorkerPool writers;
+    AIForge::WorkerPoolConfig writerConfig;
+    writerConfig.name = "ImageWriter";
+    writerConfig.numThreads = max(1u, options.writers);
+    writerConfig.maxQueuedJobs = static_cast<size_t>(options.concurrency) + 1;
+    if (!writers.start(writerConfig)) {
+        cerr << "Failed to start image writers\n";
+        engine.shutdown();
+        return 1;
+    }
+
+    mutex stateMutex;
+    condition_variable slotFree;
+    int inFlight = 0;
+    size_t completions = 0;              // المهام التي انتهت فعلاً، ناجحة أو فاشلة
+    deque<pair<size_t, size_t>> retries; // مهام رفضها طابور ممتلئ، مع completions عند الرفض
+    size_t succeeded = 0;
+    vector<string> failures;
+    vector<double> latencies;            // من الإرسال حتى اكتمال الكتابة
+    vector<double> writeTimes;
+
+    auto finish = [&](const string& name, Clock::time_point submitted, const string& error) {
+        lock_guard<mutex> lock(stateMutex);
+        completions++;
+        if (error.empty()) {
+            succeeded++;
+            latencies.push_back(chrono::duration<double, milli>(Clock::now() - submitted).count());
+        } else {
+            failures.push_back(name + ": " + error);
+        }
+        inFlight--;
+        slotFree.notify_one();
+    };
+
+    cout << "Running " << jobs.size() << " jobs on " << models.size() << " model(s), "
+         << options.concurrency << " in flight\n";
+    const Clock::time_point startTime = Clock::now();
+
+    // الطابور الممتلئ ضغط عكسي لا فشل: تعود المهمة المرفوضة إلى retries ولا
+    // تُرسل ثانية حتى تنتهي مهمة أخرى وتفرغ مكاناً في طوابير المحرك
+    size_t next = 0;
+    while (true) {
+        size_t i = 0;
+        {
+            unique_lock<mutex> lock(stateMutex);
+            auto retryReady = [&] {
+                return !retries.empty() && (retries.front().second != completions || inFlight == 0);
+            };
+            slotFree.wait(lock, [&] {
+                const bool work = retryReady() || next < jobs.size();
+                return (work && inFlight < options.concurrency) ||
+                       (inFlight == 0 && retries.empty() && next >= jobs.size());
+            });
+            if (retryReady()) {
+                i = retries.front().first;
+                retries.pop_front();
+            } else if (next < jobs.size()) {
+                i = next++;
+            } else {
+                break;
+            }
+            inFlight++;
+        }
+
+        const BatchJob& job = jobs[i];
+        const Clock::time_point submitted = Clock::now();
+        const string path = (filesystem::path(options.outputDirectory) / job.name).string();
+
+        AIForge::ImageJobCallbacks callbacks;
+        callbacks.finished = [&, i, name = job.name, path, submitted](AIForge::InferenceResult&& result) {
+            if (!result.success && result.errorMessage == "Inference queue full") {
+                lock_guard<mutex> lock(stateMutex);
+                retries.emplace_back(i, completions);
+                inFlight--;
+                slotFree.notify_one();
+                return;
+            }
+            if (!result.success) {
+                finish(name, submitted, result.errorMessage);
+                return;
+            }
+
+            // ينتقل الترميز والكتابة إلى مجمع الكتّاب، فيعود العامل إلى المحرك فوراً
+            auto image = make_shared<AIForge::InferenceResult>(std::move(result));
+            const string file = path + (image->imageChannels == 3 ? ".ppm" : ".pam");
+            bool queued = writers.submit(0, AIForge::JobPriority::NORMAL, [&, name, file, image, submitted] {
+                const Clock::time_point writeStart = Clock::now();
+                const bool written = writeImage(file, *image);
+                {
+                    lock_guard<mutex> lock(stateMutex);
+                    writeTimes.push_back(chrono::duration<double, milli>(Clock::now() - writeStart).count());
+                }
+                finish(name, submitted, written ? "" : "cannot write " + file);
+            }, [&, name, submitted] { finish(name, submitted, "Image writer stopped"); });
+            if (!queued) {
+                finish(name, submitted, "Image writer queue full");
+            }
+        };
+
+        if (options.pipelined) {
+            engine.submitPipelinedGeneration(job.config.modelId, job.prompt, job.config, std::move(callbacks));
+        } else {
+            engine.submitImageGeneration(job.config.modelId, job.prompt, job.config, std::move(callbacks));
+        }
+    }
+    const double elapsedSeconds = chrono::duration<double>(Clock::now() - startTime).count();
+
+    writers.stop();
+    engine.shutdown();
+
+    // ملخص الإنتاجية وزمن الاستجابة
+    sort(latencies.begin(), latencies.end());
+    double writeTotal = 0.0;
+    for (double time : writeTimes) {
+        writeTotal += time;
+    }
+
+    printSection("Batch Summary");
+    cout << fixed << setprecision(2);
+    cout << "Jobs:        " << succeeded << " succeeded, " << failures.size() << " failed\n";
+    cout << "Wall time:   " << elapsedSeconds << " s\n";
+    cout << "Throughput:  " << (elapsedSeconds > 0.0 ? succeeded / elapsedSeconds : 0.0) << " images/s\n";
+    if (!latencies.empty()) {
+        cout << "Latency:     p50 " << percentileOf(latencies, 0.50)
+             << "  p95 " << percentileOf(latencies, 0.95)
+             << "  p99 " << percentileOf(latencies, 0.99)
+             << "  max " << latencies.back() << " ms\n";
+    }
+    if (!writeTimes.empty()) {
+        cout << "Image write: " << writeTotal / writeTimes.size() << " ms average\n";
+    }
+    for (const string& failure : failures) {
+        cout << RED << "  " << failure << RESET << "\n";
+    }
+
+    return failures.empty() ? 0 : 1;
+}
+
+/**
+ * @brief قراءة خيارات وضع الدفعات
+ * @return false عند خيار غير معروف أو ناقص
+ */
+bool parseBatchOptions(int argc, char* argv[], BatchOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        const string arg = argv[i];
+        if (arg == "--pipelined") {
+            options.pipelined = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            return false;
+        }
+        const string value = argv[++i];
+        if (arg == "--batch") {
+            options.manifestPath = value;
+        } else if (arg == "--output") {
+            options.outputDirectory = value;
+        } else if (arg == "--concurrency") {
+            options.concurrency = max(1, atoi(value.c_str()));
+        } else if (arg == "--writers") {
+            options.writers = static_cast<unsigned int>(max(1, atoi(value.c_str())));
+        } else if (arg == "--devices") {
+            options.devices.clear();
+            stringstream list(value);
+            string device;
+            while (getline(list, device, ',')) {
+                options.devices.push_back(atoi(device.c_str()));
+            }
+        } else {
+            return false;
+        }
+    }
+    return !options.manifestPath.empty() && !options.devices.empty();
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1) {
+        BatchOptions options;
+        if (!parseBatchOptions(argc, argv, options)) {
+            cerr << "Usage: " << argv[0] << " --batch jobs.jsonl [--output DIR] [--concurrency N]"
+                 << " [--writers N] [--devices 0,1] [--pipelined]\n";
+            return 2;
+        }
+        return runBatch(options);
+    }
+
     printHeader();
 
     cout << CYAN << "Initializing AI Forge Studio..." << RESET << "\n";
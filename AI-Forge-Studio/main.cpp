@@ -13,6 +13,11 @@
 #include <QIcon>
 #include <QFont>
 #include <QFontDatabase>
+#include <QImage>
+#include <QMutex>
+#include <QPointer>
+#include <QQuickImageProvider>
+#include <deque>
 #include <iostream>
 #include <memory>
 
@@ -21,6 +26,7 @@
 #include "core/hardware_monitor.h"
 #include "core/ai_engine.h"
 #include "core/render_engine.h"
+#include "core/tracer.h"
 
 #ifdef PYTHON_AVAILABLE
 #include "python_bridge/bridge.h"
@@ -28,6 +34,59 @@
 
 using namespace AIForge;
 
+/**
+ * @class GeneratedImageProvider
+ * @brief Serves finished generations to QML as image://generated/<jobId>
+ *
+ * The images wrap the inference result's pixel buffer, so the render view
+ * displays them without a copy. The most recent few are kept.
+ */
+class GeneratedImageProvider : public QQuickImageProvider {
+public:
+    GeneratedImageProvider()
+        : QQuickImageProvider(QQuickImageProvider::Image)
+    {
+    }
+
+    /**
+     * @brief Publish a generated image
+     * @param jobId Job the image belongs to
+     * @param image Image sharing the result's buffer
+     */
+    void addImage(const QString& jobId, const QImage& image) {
+        QMutexLocker lock(&m_mutex);
+        m_images.emplace_back(jobId, image);
+        while (m_images.size() > MAX_IMAGES) {
+            m_images.pop_front();
+        }
+    }
+
+    QImage requestImage(const QString& id, QSize* size, const QSize& requestedSize) override {
+        QImage image;
+        {
+            QMutexLocker lock(&m_mutex);
+            for (const auto& entry : m_images) {
+                if (entry.first == id) {
+                    image = entry.second;
+                }
+            }
+        }
+        if (size) {
+            *size = image.size();
+        }
+        if (!image.isNull() && requestedSize.isValid()) {
+            return image.scaled(requestedSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        }
+        return image;
+    }
+
+private:
+    static constexpr size_t MAX_IMAGES = 4;
+
+    QMutex m_mutex;
+    std::deque<std::pair<QString, QImage>> m_images;
+};
+
 /**
  * @class BackendController
  * @brief QObject wrapper for C++ backend, exposed to QML
@@ -47,9 +106,10 @@ class BackendController : public QObject {
     Q_PROPERTY(bool isInitialized READ isInitialized NOTIFY initializationChanged)
 
 public:
-    explicit BackendController(QObject* parent = nullptr)
+    explicit BackendController(GeneratedImageProvider* imageProvider, QObject* parent = nullptr)
         : QObject(parent)
         , m_initialized(false)
+        , m_imageProvider(imageProvider)
     {
         // Initialize backend modules
         initializeBackend();
@@ -81,6 +141,28 @@ public slots:
             return;
         }
 
+        // Initialize AI engine on every detected GPU, before monitoring
+        // starts feeding it device load
+        m_aiEngine = std::make_unique<AIEngine>();
+        std::vector<int> deviceIds;
+        for (unsigned int i = 0; i < m_hardwareMonitor->getGPUCount(); i++) {
+            deviceIds.push_back(static_cast<int>(i));
+        }
+        if (deviceIds.empty()) {
+            deviceIds.push_back(0);
+        }
+        // Workers and offload memory go to each GPU's NUMA node
+        m_aiEngine->setDeviceTopology(m_hardwareMonitor->getGPUTopology());
+        if (!m_aiEngine->initialize(deviceIds)) {
+            LOG_ERROR("BackendController", "Failed to initialize AI engine");
+        }
+
+        // Throttling, memory pressure and Xid errors steer routing and
+        // batching as soon as the monitor sees them
+        m_hardwareMonitor->setEventCallback([this](const GPUEvent& event) {
+            m_aiEngine->handleGPUEvent(event);
+        });
+
         // Start monitoring with callback
         m_hardwareMonitor->startMonitoring(
             [this](const SystemMetrics& metrics) {
@@ -89,12 +171,6 @@ public slots:
             1000  // Update every 1 second
         );
 
-        // Initialize AI engine
-        m_aiEngine = std::make_unique<AIEngine>();
-        if (!m_aiEngine->initialize(0)) {  // Device 0
-            LOG_ERROR("BackendController", "Failed to initialize AI engine");
-        }
-
         // Initialize render engine (would need window handle in production)
         m_renderEngine = std::make_unique<RenderEngine>();
         // RenderConfig renderConfig;
@@ -173,15 +249,38 @@ public slots:
     }
 
     /**
-     * @brief Generate image from text prompt
-     * @param modelId Model to use
+     * @brief Find a loaded model by its display name
+     * @param name Display name given to loadModel
+     * @return Model ID, or empty string if no model of that name is loaded
+     */
+    Q_INVOKABLE QString findLoadedModel(const QString& name) {
+        if (!m_aiEngine || !m_aiEngine->isInitialized()) {
+            return "";
+        }
+
+        const std::string wanted = name.toStdString();
+        for (const auto& model : m_aiEngine->getLoadedModels()) {
+            if (model.name == wanted) {
+                return QString::fromStdString(model.id);
+            }
+        }
+        return "";
+    }
+
+    /**
+     * @brief Start generating an image from a text prompt
+     *
+     * Returns at once; generationProgress and generationFinished follow on
+     * the GUI thread.
+     *
+     * @param modelId ID of a loaded model (see findLoadedModel)
      * @param prompt Text prompt
-     * @return true if generation started
+     * @return Job ID, or empty string if the engine is not initialized
      */
-    Q_INVOKABLE bool generateImage(const QString& modelId, const QString& prompt) {
+    Q_INVOKABLE QString generateImage(const QString& modelId, const QString& prompt) {
         if (!m_aiEngine || !m_aiEngine->isInitialized()) {
             LOG_ERROR("BackendController", "AI engine not initialized");
-            return false;
+            return "";
         }
 
         LOG_INFO("BackendController", "Generating image: " + prompt.toStdString());
@@ -190,14 +289,47 @@ public slots:
         InferenceConfig config;
         config.modelId = modelId.toStdString();
 
-        // Generate image asynchronously
-        auto future = m_aiEngine->runInferenceAsync(config, {});
-
-        // In production, handle the async result properly
-        // For now, just return true to indicate generation started
-        emit generationStarted(modelId);
+        // The callbacks run on an inference worker; the job ID is set before
+        // the first of them is delivered, since both are queued to the GUI
+        // thread. They are posted to the application object, which outlives
+        // this controller, and dropped there if the controller is gone.
+        auto jobIdHolder = std::make_shared<QString>();
+        QPointer<BackendController> self(this);
+        ImageJobCallbacks callbacks;
+        callbacks.progress = [self, jobIdHolder](float progress) {
+            QMetaObject::invokeMethod(QCoreApplication::instance(), [self, jobIdHolder, progress] {
+                if (self) {
+                    emit self->generationProgress(*jobIdHolder, progress);
+                }
+            }, Qt::QueuedConnection);
+        };
+        callbacks.finished = [self, jobIdHolder](InferenceResult&& result) {
+            auto shared = std::make_shared<InferenceResult>(std::move(result));
+            QMetaObject::invokeMethod(QCoreApplication::instance(), [self, jobIdHolder, shared] {
+                if (self) {
+                    self->finishGeneration(*jobIdHolder, shared);
+                }
+            }, Qt::QueuedConnection);
+        };
+
+        uint64_t jobId = m_aiEngine->submitImageGeneration(
+            config.modelId, prompt.toStdString(), config, std::move(callbacks));
+        *jobIdHolder = QString::number(jobId);
+
+        emit generationStarted(*jobIdHolder, modelId);
+        return *jobIdHolder;
+    }
 
-        return true;
+    /**
+     * @brief Cancel a generation started with generateImage
+     * @param jobId Job ID from generateImage
+     * @return true if the job was still queued or running
+     */
+    Q_INVOKABLE bool cancelGeneration(const QString& jobId) {
+        if (!m_aiEngine || !m_aiEngine->isInitialized()) {
+            return false;
+        }
+        return m_aiEngine->cancelInference(jobId.toULongLong());
     }
 
     /**
@@ -226,15 +358,36 @@ public slots:
         return json;
     }
 
+    /**
+     * @brief Start recording trace spans
+     */
+    Q_INVOKABLE void startTrace() {
+        Tracer::getInstance().clear();
+        Tracer::getInstance().setEnabled(true);
+    }
+
+    /**
+     * @brief Stop recording and write the spans as a Chrome trace
+     * @param filepath Output path (open in chrome://tracing or ui.perfetto.dev)
+     * @return true if the trace was written
+     */
+    Q_INVOKABLE bool stopTrace(const QString& filepath) {
+        Tracer::getInstance().setEnabled(false);
+        return Tracer::getInstance().writeChromeTrace(filepath.toStdString());
+    }
+
 signals:
     void metricsUpdated();
     void initializationChanged();
     void modelLoaded(const QString& modelId, const QString& name);
-    void generationStarted(const QString& modelId);
-    void generationComplete(const QString& imagePath);
+    void generationStarted(const QString& jobId, const QString& modelId);
+    void generationProgress(const QString& jobId, float progress);
+    void generationFinished(const QString& jobId, bool success,
+                            const QString& imageSource, const QString& errorMessage);
 
 private:
     bool m_initialized;
+    GeneratedImageProvider* m_imageProvider;  // Owned by the QML engine
 
     // Backend modules
     std::unique_ptr<HardwareMonitor> m_hardwareMonitor;
@@ -254,10 +407,43 @@ private:
         float cpuUtilization = 0.0f;
     } m_currentMetrics;
 
+    /**
+     * @brief Publish a finished generation (GUI thread)
+     * @param jobId Job ID from generateImage
+     * @param result Result whose pixels the published image keeps alive
+     */
+    void finishGeneration(const QString& jobId, const std::shared_ptr<InferenceResult>& result) {
+        if (!result->success || result->imageData.empty()) {
+            LOG_ERROR("BackendController", "Generation " + jobId.toStdString() +
+                      " failed: " + result->errorMessage);
+            emit generationFinished(jobId, false, "",
+                                    QString::fromStdString(result->errorMessage));
+            return;
+        }
+
+        // The image keeps the result alive instead of copying its pixels
+        const QImage::Format format = result->imageChannels == 4 ?
+            QImage::Format_RGBA8888 : QImage::Format_RGB888;
+        QImage image(result->imageData.data(), result->imageWidth, result->imageHeight,
+                     result->imageWidth * result->imageChannels, format,
+                     [](void* info) { delete static_cast<std::shared_ptr<InferenceResult>*>(info); },
+                     new std::shared_ptr<InferenceResult>(result));
+
+        if (m_imageProvider) {
+            m_imageProvider->addImage(jobId, image);
+        }
+        emit generationFinished(jobId, true, "image://generated/" + jobId, "");
+    }
+
     /**
      * @brief Update metrics from hardware monitor
      */
     void updateMetrics(const SystemMetrics& metrics) {
+        // Request routing across GPUs follows live utilization and memory
+        if (m_aiEngine && m_aiEngine->isInitialized()) {
+            m_aiEngine->updateDeviceMetrics(metrics.gpus);
+        }
+
         if (!metrics.gpus.empty()) {
             const auto& gpu = metrics.gpus[0];
             m_currentMetrics.gpuUtilization = gpu.gpuUtilization;
@@ -294,6 +480,8 @@ int main(int argc, char *argv[])
     Logger::getInstance().setConsoleOutput(true);
     Logger::getInstance().setFileOutput(true);
     Logger::getInstance().setLogFilePath("ai_forge_studio.log");
+    // Keep formatting and file I/O off the inference workers
+    Logger::getInstance().enableAsync();
 
     LOG_INFO("Main", "=================================================");
     LOG_INFO("Main", "AI Forge Studio - RTX 50-Series Edition");
@@ -306,8 +494,12 @@ int main(int argc, char *argv[])
     // Create QML engine
     QQmlApplicationEngine engine;
 
+    // Generated images are served to QML from the inference results
+    auto* imageProvider = new GeneratedImageProvider();
+    engine.addImageProvider("generated", imageProvider);
+
     // Create backend controller
-    BackendController backendController;
+    BackendController backendController(imageProvider);
 
     // Expose backend to QML
     engine.rootContext()->setContextProperty("backend", &backendController);
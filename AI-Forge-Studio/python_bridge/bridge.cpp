@@ -7,19 +7,19 @@
  */
 
 #include "bridge.h"
+#include "python_worker_pool.h"
 #include "../core/logger.h"
-#include <sstream>
+#include "../core/tracer.h"
 #include <algorithm>
 
+#include <utility>
+
 // Pybind11 headers (include in production)
 // #include <pybind11/pybind11.h>
 // #include <pybind11/stl.h>
 // #include <pybind11/embed.h>
 // namespace py = pybind11;
 
-// JSON parsing (use nlohmann/json or similar in production)
-#include <cstring>
-
 namespace AIForge {
 
 // Simulated Python object
@@ -27,6 +27,167 @@ struct PythonModuleWrapper {
     bool initialized = false;
 };
 
+// In production, bind the config so Python reads the C++ struct's fields
+// directly (no JSON string built or parsed on either side):
+// PYBIND11_EMBEDDED_MODULE(aiforge_native, m) {
+//     py::class_<PythonInferenceConfig>(m, "InferenceConfig")
+//         .def_readonly("model_id", &PythonInferenceConfig::modelId)
+//         .def_readonly("prompt", &PythonInferenceConfig::prompt)
+//         .def_readonly("negative_prompt", &PythonInferenceConfig::negativePrompt)
+//         .def_readonly("num_inference_steps", &PythonInferenceConfig::numInferenceSteps)
+//         .def_readonly("guidance_scale", &PythonInferenceConfig::guidanceScale)
+//         .def_readonly("width", &PythonInferenceConfig::width)
+//         .def_readonly("height", &PythonInferenceConfig::height)
+//         .def_readonly("seed", &PythonInferenceConfig::seed)
+//         .def_readonly("batch_size", &PythonInferenceConfig::batchSize)
+//         .def_readonly("precision", &PythonInferenceConfig::precision);
+// }
+
+namespace {
+
+// DLPack ABI (dlpack.h v0.8, stable since v0.6); declared here so the
+// bridge builds without the header. Capsules named "dltensor" carry a
+// DLManagedTensor; the consumer renames the capsule to "used_dltensor"
+// and calls the deleter when done.
+enum DLDeviceType : int32_t {
+    kDLCPU = 1,
+    kDLCUDA = 2,
+    kDLCUDAHost = 3
+};
+
+enum DLDataTypeCode : uint8_t {
+    kDLInt = 0,
+    kDLUInt = 1,
+    kDLFloat = 2
+};
+
+struct DLDevice {
+    int32_t device_type;
+    int32_t device_id;
+};
+
+struct DLDataType {
+    uint8_t code;
+    uint8_t bits;
+    uint16_t lanes;
+};
+
+struct DLTensor {
+    void* data;
+    DLDevice device;
+    int32_t ndim;
+    DLDataType dtype;
+    int64_t* shape;
+    int64_t* strides;       // In elements; nullptr for compact row-major
+    uint64_t byte_offset;
+};
+
+struct DLManagedTensor {
+    DLTensor dl_tensor;
+    void* manager_ctx;
+    void (*deleter)(DLManagedTensor* self);
+};
+
+bool dataTypeFromDLPack(const DLDataType& type, DataType& dtype) {
+    if (type.lanes != 1) {
+        return false;
+    }
+    if (type.code == kDLUInt && type.bits == 8) {
+        dtype = DataType::UINT8;
+    } else if (type.code == kDLFloat && type.bits == 16) {
+        dtype = DataType::FLOAT16;
+    } else if (type.code == kDLFloat && type.bits == 32) {
+        dtype = DataType::FLOAT32;
+    } else if (type.code == kDLInt && type.bits == 32) {
+        dtype = DataType::INT32;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Stands in for the torch tensor the pipeline returns (simulated)
+struct SimulatedExport {
+    DLManagedTensor managed;
+    int64_t shape[4];
+    std::vector<unsigned char> pixels;
+};
+
+DLManagedTensor* exportSimulatedImages(int count, int height, int width, int channels) {
+    auto* exported = new SimulatedExport();
+    exported->shape[0] = count;
+    exported->shape[1] = height;
+    exported->shape[2] = width;
+    exported->shape[3] = channels;
+    exported->pixels.resize(static_cast<size_t>(count) * height * width * channels);
+
+    // Gradient pattern
+    unsigned char* pixel = exported->pixels.data();
+    for (int i = 0; i < count; i++) {
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                for (int c = 0; c < channels; c++) {
+                    *pixel++ = static_cast<unsigned char>(
+                        c == 0 ? (x * 255) / width : c == 1 ? (y * 255) / height : 128);
+                }
+            }
+        }
+    }
+
+    DLTensor& tensor = exported->managed.dl_tensor;
+    tensor.data = exported->pixels.data();
+    tensor.device = {kDLCPU, 0};
+    tensor.ndim = 4;
+    tensor.dtype = {kDLUInt, 8, 1};
+    tensor.shape = exported->shape;
+    tensor.strides = nullptr;
+    tensor.byte_offset = 0;
+    exported->managed.manager_ctx = exported;
+    exported->managed.deleter = [](DLManagedTensor* self) {
+        delete static_cast<SimulatedExport*>(self->manager_ctx);
+    };
+    return &exported->managed;
+}
+
+}
+
+PythonTensor::PythonTensor(const TensorView& view, std::function<void()> release)
+    : m_view(view)
+    , m_release(std::move(release))
+{
+}
+
+PythonTensor::~PythonTensor() {
+    reset();
+}
+
+PythonTensor::PythonTensor(PythonTensor&& other) noexcept
+    : m_view(other.m_view)
+    , m_release(std::move(other.m_release))
+{
+    other.m_view = TensorView();
+    other.m_release = nullptr;
+}
+
+PythonTensor& PythonTensor::operator=(PythonTensor&& other) noexcept {
+    if (this != &other) {
+        reset();
+        m_view = other.m_view;
+        m_release = std::move(other.m_release);
+        other.m_view = TensorView();
+        other.m_release = nullptr;
+    }
+    return *this;
+}
+
+void PythonTensor::reset() {
+    if (m_release) {
+        m_release();
+        m_release = nullptr;
+    }
+    m_view = TensorView();
+}
+
 PythonBridge::PythonBridge()
     : m_initialized(false)
     , m_pythonModule(nullptr)
@@ -58,7 +219,8 @@ bool PythonBridge::initialize(const std::string& pythonPath,
         // py::module sys = py::module::import("sys");
         // sys.attr("path").attr("insert")(0, pythonPath);
 
-        // Import model_runner module
+        // Register the native config type, then import model_runner
+        // py::module::import("aiforge_native");
         // py::module model_runner = py::module::import("model_runner");
 
         // Initialize the model runner
@@ -82,6 +244,25 @@ bool PythonBridge::initialize(const std::string& pythonPath,
     }
 }
 
+bool PythonBridge::initializeWorkers(const std::string& pythonPath,
+                                     const PythonWorkerPoolConfig& config) {
+    if (m_initialized) {
+        LOG_WARNING("PythonBridge", "Already initialized");
+        return true;
+    }
+
+    LOG_INFO("PythonBridge", "Initializing Python bridge with worker processes");
+    auto pool = std::make_unique<PythonWorkerPool>();
+    if (!pool->start(pythonPath, config)) {
+        LOG_ERROR("PythonBridge", "Failed to start Python workers");
+        return false;
+    }
+
+    m_workerPool = std::move(pool);
+    m_initialized = true;
+    return true;
+}
+
 void PythonBridge::shutdown() {
     if (!m_initialized) {
         return;
@@ -90,6 +271,11 @@ void PythonBridge::shutdown() {
     LOG_INFO("PythonBridge", "Shutting down Python bridge");
 
     try {
+        if (m_workerPool) {
+            m_workerPool->stop();
+            m_workerPool.reset();
+        }
+
         // Cleanup Python module
         if (m_pythonModule) {
             delete static_cast<PythonModuleWrapper*>(m_pythonModule);
@@ -107,52 +293,6 @@ void PythonBridge::shutdown() {
     }
 }
 
-std::string PythonBridge::callPythonFunction(const std::string& functionName,
-                                            const std::string& args) {
-    if (!m_initialized) {
-        return "{\"success\": false, \"error\": \"Not initialized\"}";
-    }
-
-    try {
-        // In production, call Python function:
-        // py::module model_runner = py::module::import("model_runner");
-        // py::object result = model_runner.attr(functionName.c_str())(args);
-        // return py::cast<std::string>(result);
-
-        LOG_INFO("PythonBridge", "Calling Python function: " + functionName);
-
-        // Simulate function call
-        if (functionName == "generate_image") {
-            // Simulate image generation result
-            return R"({
-                "success": true,
-                "inference_time": 1234.56,
-                "memory_used": 2048,
-                "image_width": 512,
-                "image_height": 512,
-                "image_base64": ""
-            })";
-        } else if (functionName == "get_memory_info") {
-            return R"({
-                "allocated": 2048,
-                "reserved": 4096,
-                "max_allocated": 3072,
-                "total": 24576
-            })";
-        } else if (functionName == "load_model") {
-            return "{\"success\": true}";
-        } else if (functionName == "unload_model") {
-            return "{\"success\": true}";
-        }
-
-        return "{\"success\": false, \"error\": \"Unknown function\"}";
-
-    } catch (...) {
-        LOG_ERROR("PythonBridge", "Error calling Python function: " + functionName);
-        return "{\"success\": false, \"error\": \"Python exception\"}";
-    }
-}
-
 bool PythonBridge::loadModel(const std::string& modelPath,
                              const std::string& modelId,
                              const std::string& modelType,
@@ -162,6 +302,10 @@ bool PythonBridge::loadModel(const std::string& modelPath,
         return false;
     }
 
+    if (m_workerPool) {
+        return m_workerPool->loadModel(modelPath, modelId, modelType, precision);
+    }
+
     LOG_INFO("PythonBridge", "Loading model via Python: " + modelPath);
 
     try {
@@ -188,6 +332,10 @@ bool PythonBridge::unloadModel(const std::string& modelId) {
         return false;
     }
 
+    if (m_workerPool) {
+        return m_workerPool->unloadModel(modelId);
+    }
+
     LOG_INFO("PythonBridge", "Unloading Python model: " + modelId);
 
     try {
@@ -203,15 +351,58 @@ bool PythonBridge::unloadModel(const std::string& modelId) {
     }
 }
 
-std::vector<unsigned char> PythonBridge::decodeBase64(const std::string& base64Data) {
-    // Simple base64 decoder (use proper library in production)
-    // For template, return empty vector
-    std::vector<unsigned char> result;
+bool PythonBridge::tensorFromDLPack(void* managedTensor, PythonTensor& tensor, std::string& error) {
+    auto* managed = static_cast<DLManagedTensor*>(managedTensor);
+    // Whatever happens, the export is released exactly once
+    auto release = [managed] {
+        // In production: py::gil_scoped_acquire gil; (torch's deleter drops a Python reference)
+        if (managed->deleter) {
+            managed->deleter(managed);
+        }
+    };
+    const DLTensor& dl = managed->dl_tensor;
+
+    DataType dtype;
+    if (!dataTypeFromDLPack(dl.dtype, dtype)) {
+        error = "Unsupported tensor type (code " + std::to_string(dl.dtype.code) +
+                ", " + std::to_string(dl.dtype.bits) + " bits)";
+        release();
+        return false;
+    }
+    if (dl.ndim < 0 || dl.ndim > TensorShape::MAX_DIMS) {
+        error = "Unsupported tensor rank " + std::to_string(dl.ndim);
+        release();
+        return false;
+    }
 
-    // In production, use base64 decoding library
-    // or Python's base64 module
+    MemoryLocation location;
+    switch (dl.device.device_type) {
+        case kDLCPU:      location = MemoryLocation::HOST; break;
+        case kDLCUDAHost: location = MemoryLocation::PINNED_HOST; break;
+        case kDLCUDA:     location = MemoryLocation::DEVICE; break;
+        default:
+            error = "Unsupported tensor device type " + std::to_string(dl.device.device_type);
+            release();
+            return false;
+    }
 
-    return result;
+    TensorShape shape;
+    shape.ndim = dl.ndim;
+    int64_t expectedStride = 1;
+    for (int i = dl.ndim - 1; i >= 0; i--) {
+        shape.dims[i] = dl.shape[i];
+        // Views are dense row-major; Python must call .contiguous() first
+        if (dl.strides && dl.shape[i] > 1 && dl.strides[i] != expectedStride) {
+            error = "Tensor is not contiguous";
+            release();
+            return false;
+        }
+        expectedStride *= dl.shape[i];
+    }
+
+    void* data = static_cast<unsigned char*>(dl.data) + dl.byte_offset;
+    tensor = PythonTensor(TensorView(data, dtype, shape, location, dl.device.device_id), release);
+    return true;
 }
 
 PythonInferenceResult PythonBridge::generateImage(const PythonInferenceConfig& config) {
@@ -224,46 +415,49 @@ PythonInferenceResult PythonBridge::generateImage(const PythonInferenceConfig& c
         return result;
     }
 
+    if (m_workerPool) {
+        return m_workerPool->generateImage(config);
+    }
+
+    // Covers GIL acquisition and the call into Python
+    TRACE_SCOPE_DETAIL("PythonBridge", "generateImage", config.modelId);
     LOG_INFO("PythonBridge", "Generating image with prompt: " + config.prompt);
 
     try {
-        // Build JSON config
-        std::ostringstream configJson;
-        configJson << "{"
-                   << "\"model_id\": \"" << config.modelId << "\","
-                   << "\"prompt\": \"" << config.prompt << "\","
-                   << "\"negative_prompt\": \"" << config.negativePrompt << "\","
-                   << "\"num_inference_steps\": " << config.numInferenceSteps << ","
-                   << "\"guidance_scale\": " << config.guidanceScale << ","
-                   << "\"width\": " << config.width << ","
-                   << "\"height\": " << config.height << ","
-                   << "\"seed\": " << (config.seed >= 0 ? config.seed : 0) << ","
-                   << "\"batch_size\": " << config.batchSize << ","
-                   << "\"precision\": \"" << config.precision << "\""
-                   << "}";
-
-        // Call Python function
-        std::string resultJson = callPythonFunction("generate_image", configJson.str());
-
-        // Parse result (in production, use JSON library)
-        // For template, simulate successful generation
-        result.success = true;
-        result.imageWidth = config.width;
-        result.imageHeight = config.height;
+        // In production:
+        // py::gil_scoped_acquire gil;
+        // py::object output = model_runner.attr("generate_image")(py::cast(&config, py::return_value_policy::reference));
+        // if (!output.attr("success").cast<bool>()) -> errorMessage from output.attr("error_message")
+        // py::capsule capsule = output.attr("image_data").attr("__dlpack__")();
+        // void* managed = PyCapsule_GetPointer(capsule.ptr(), "dltensor");
+        // PyCapsule_SetName(capsule.ptr(), "used_dltensor");  // We own it now
+        // result.inferenceTime / memoryUsed from output attributes
+        const int count = std::max(1, config.batchSize);
+        void* managed = exportSimulatedImages(count, config.height, config.width, 3);
         result.inferenceTime = 1234.56f;
         result.memoryUsed = 2048;
 
-        // Create dummy image data (gradient pattern)
-        result.imageData.resize(config.width * config.height * 3);
-        for (int y = 0; y < config.height; y++) {
-            for (int x = 0; x < config.width; x++) {
-                int idx = (y * config.width + x) * 3;
-                result.imageData[idx + 0] = static_cast<unsigned char>((x * 255) / config.width);
-                result.imageData[idx + 1] = static_cast<unsigned char>((y * 255) / config.height);
-                result.imageData[idx + 2] = 128;
-            }
+        std::string error;
+        if (!tensorFromDLPack(managed, result.images, error)) {
+            result.errorMessage = "Bad image tensor from Python: " + error;
+            LOG_ERROR("PythonBridge", result.errorMessage);
+            return result;
         }
 
+        // Images come back as [count, height, width, channels] uint8
+        const TensorView& images = result.images.view();
+        if (images.dtype != DataType::UINT8 || images.shape.ndim != 4) {
+            result.images.reset();
+            result.errorMessage = "Python returned images that are not uint8 NHWC";
+            LOG_ERROR("PythonBridge", result.errorMessage);
+            return result;
+        }
+        result.imageCount = static_cast<int>(images.shape.dims[0]);
+        result.imageHeight = static_cast<int>(images.shape.dims[1]);
+        result.imageWidth = static_cast<int>(images.shape.dims[2]);
+        result.imageChannels = static_cast<int>(images.shape.dims[3]);
+        result.success = true;
+
         LOG_INFO("PythonBridge", "Image generated successfully");
 
     } catch (...) {
@@ -277,16 +471,18 @@ PythonInferenceResult PythonBridge::generateImage(const PythonInferenceConfig& c
 PythonMemoryInfo PythonBridge::getMemoryInfo() {
     PythonMemoryInfo info = {0, 0, 0, 0};
 
-    if (!m_initialized) {
+    // Pool workers each have their own CUDA context; not reported here
+    if (!m_initialized || m_workerPool) {
         return info;
     }
 
     try {
-        // Call Python function
-        std::string resultJson = callPythonFunction("get_memory_info", "{}");
+        // In production:
+        // py::gil_scoped_acquire gil;
+        // py::dict memory = model_runner.attr("get_memory_info")();
+        // info.allocated = memory["allocated"].cast<size_t>(); ...
 
-        // Parse JSON result (in production, use JSON library)
-        // For template, return simulated values
+        // Simulated values
         info.allocated = 2048;
         info.reserved = 4096;
         info.maxAllocated = 3072;
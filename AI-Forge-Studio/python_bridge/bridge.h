@@ -9,7 +9,9 @@
  * - Initialize Python interpreter
  * - Load and manage Python AI models
  * - Execute inference operations
- * - Transfer data between C++ and Python
+ * - Zero-copy image and tensor transfer through DLPack (host or CUDA memory)
+ * - Configs passed as native objects instead of serialized strings
+ * - Optional pool of worker processes, one GIL each (python_worker_pool.h)
  * - Exception handling and error reporting
  */
 
@@ -20,9 +22,13 @@
 #include <vector>
 #include <memory>
 #include <functional>
+#include "../core/tensor.h"
 
 namespace AIForge {
 
+class PythonWorkerPool;
+struct PythonWorkerPoolConfig;
+
 /**
  * @struct PythonInferenceConfig
  * @brief Configuration for Python model inference
@@ -40,6 +46,50 @@ struct PythonInferenceConfig {
     std::string precision = "fp16";
 };
 
+/**
+ * @class PythonTensor
+ * @brief Tensor memory owned by Python, viewed in place
+ *
+ * Wraps a DLPack export (a torch or numpy array) without copying it. The
+ * exporter's reference is held until the tensor is destroyed, which takes
+ * the GIL, so destroy it before PythonBridge::shutdown().
+ */
+class PythonTensor {
+public:
+    PythonTensor() = default;
+
+    /**
+     * @brief Take ownership of an exported buffer
+     * @param view Memory, type and shape of the buffer
+     * @param release Returns the buffer to Python (the DLPack deleter)
+     */
+    PythonTensor(const TensorView& view, std::function<void()> release);
+    ~PythonTensor();
+
+    PythonTensor(PythonTensor&& other) noexcept;
+    PythonTensor& operator=(PythonTensor&& other) noexcept;
+
+    // Disable copy
+    PythonTensor(const PythonTensor&) = delete;
+    PythonTensor& operator=(const PythonTensor&) = delete;
+
+    /**
+     * @brief View of the buffer (host or device memory, see location)
+     */
+    const TensorView& view() const { return m_view; }
+
+    bool isValid() const { return m_view.isValid(); }
+
+    /**
+     * @brief Give the buffer back to Python now
+     */
+    void reset();
+
+private:
+    TensorView m_view;
+    std::function<void()> m_release;
+};
+
 /**
  * @struct PythonInferenceResult
  * @brief Result from Python inference
@@ -47,9 +97,11 @@ struct PythonInferenceConfig {
 struct PythonInferenceResult {
     bool success;
     std::string errorMessage;
-    std::vector<unsigned char> imageData;
+    PythonTensor images;        // uint8 [imageCount, height, width, channels], device memory on CUDA
     int imageWidth = 0;
     int imageHeight = 0;
+    int imageChannels = 0;
+    int imageCount = 0;
     float inferenceTime = 0.0f;
     size_t memoryUsed = 0;
 };
@@ -91,6 +143,18 @@ public:
      */
     bool initialize(const std::string& pythonPath, const std::string& device = "cuda");
 
+    /**
+     * @brief Initialize in pool mode: requests run in Python worker processes
+     *
+     * No interpreter is embedded. loadModel, unloadModel and generateImage
+     * go to the pool and may be called from several threads at once.
+     *
+     * @param pythonPath Path to Python scripts directory
+     * @param config Worker pool configuration
+     * @return true if at least one worker started
+     */
+    bool initializeWorkers(const std::string& pythonPath, const PythonWorkerPoolConfig& config);
+
     /**
      * @brief Shutdown Python interpreter
      */
@@ -116,8 +180,13 @@ public:
 
     /**
      * @brief Generate image using Python model
+     *
+     * The config is handed to Python as a bound native object and the
+     * images come back as the pipeline's own tensor, so neither side
+     * serializes, encodes or copies pixels.
+     *
      * @param config Inference configuration
-     * @return Result with generated image
+     * @return Result with generated images
      */
     PythonInferenceResult generateImage(const PythonInferenceConfig& config);
 
@@ -149,23 +218,17 @@ public:
 private:
     bool m_initialized;
     void* m_pythonModule;       // Opaque pointer to Python module
+    std::unique_ptr<PythonWorkerPool> m_workerPool;   // Pool mode
     std::function<void(float)> m_progressCallback;
 
     /**
-     * @brief Call a Python function and get result
-     * @param functionName Name of function to call
-     * @param args JSON string of arguments
-     * @return JSON string result
-     */
-    std::string callPythonFunction(const std::string& functionName,
-                                   const std::string& args);
-
-    /**
-     * @brief Decode base64 image data
-     * @param base64Data Base64 encoded string
-     * @return Decoded binary data
+     * @brief Wrap a DLPack tensor consumed from a Python capsule
+     * @param managed DLManagedTensor (ownership passes to the result)
+     * @param tensor Receives the view
+     * @param error Receives the reason on failure
+     * @return true if the type, device and layout are supported
      */
-    std::vector<unsigned char> decodeBase64(const std::string& base64Data);
+    bool tensorFromDLPack(void* managed, PythonTensor& tensor, std::string& error);
 };
 
 } // namespace AIForge
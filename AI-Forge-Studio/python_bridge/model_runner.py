@@ -10,12 +10,14 @@ Features:
 - Text generation (LLM inference)
 - Model caching and optimization
 - CUDA memory management
+- Zero-copy exchange with C++: configs arrive as bound native objects and
+  images leave as tensors the bridge reads through DLPack
+- Worker process mode (--worker) for the C++ worker pool, serving requests
+  through shared memory
 """
 
 import os
 import sys
-import json
-import numpy as np
 from typing import Dict, List, Optional, Tuple, Any
 from dataclasses import dataclass
 from enum import Enum
@@ -87,7 +89,7 @@ class InferenceResult:
     """Result from inference operation"""
     success: bool
     error_message: str = ""
-    image_data: Optional[np.ndarray] = None
+    image_data: Optional[Any] = None    # uint8 [N, H, W, C] tensor on the model's device
     text_output: str = ""
     inference_time: float = 0.0
     memory_used: int = 0
@@ -254,7 +256,8 @@ class ModelRunner:
                 width=config.width,
                 height=config.height,
                 generator=generator,
-                num_images_per_prompt=config.batch_size
+                num_images_per_prompt=config.batch_size,
+                output_type="pt"
             )
 
             # Get memory after inference
@@ -264,9 +267,11 @@ class ModelRunner:
             else:
                 mem_after = 0
 
-            # Convert to numpy array
-            image = output.images[0]
-            result.image_data = np.array(image)
+            # Float [N, C, H, W] in [0, 1] -> uint8 [N, H, W, C], still on the
+            # device; the bridge wraps this memory without copying it
+            images = output.images
+            result.image_data = (images * 255).round().clamp(0, 255).to(torch.uint8) \
+                .permute(0, 2, 3, 1).contiguous()
 
             # Calculate stats
             result.inference_time = (time.time() - start_time) * 1000  # ms
@@ -347,43 +352,34 @@ def load_model(model_path: str, model_id: str, model_type: str, precision: str =
     return False
 
 
-def generate_image(config_json: str) -> str:
-    """Generate image from JSON config"""
+def generate_image(native_config: Any) -> InferenceResult:
+    """
+    Generate images from the bridge's native config object
+
+    The result's image_data supports __dlpack__, which the bridge consumes
+    in place, so images are never encoded or copied to the host here.
+    """
     if _model_runner is None:
-        return json.dumps({"success": False, "error": "ModelRunner not initialized"})
+        return InferenceResult(success=False, error_message="ModelRunner not initialized")
 
     try:
-        config_dict = json.loads(config_json)
-        config = InferenceConfig(**config_dict)
-        result = _model_runner.generate_image(config)
-
-        # Convert result to JSON
-        result_dict = {
-            "success": result.success,
-            "error_message": result.error_message,
-            "inference_time": result.inference_time,
-            "memory_used": result.memory_used
-        }
-
-        # Convert image to base64 if present
-        if result.image_data is not None:
-            import base64
-            from io import BytesIO
-            from PIL import Image
-
-            img = Image.fromarray(result.image_data)
-            buffer = BytesIO()
-            img.save(buffer, format="PNG")
-            img_str = base64.b64encode(buffer.getvalue()).decode()
-            result_dict["image_base64"] = img_str
-            result_dict["image_width"] = result.image_data.shape[1]
-            result_dict["image_height"] = result.image_data.shape[0]
-
-        return json.dumps(result_dict)
+        config = InferenceConfig(
+            model_id=native_config.model_id,
+            prompt=native_config.prompt,
+            negative_prompt=native_config.negative_prompt,
+            num_inference_steps=native_config.num_inference_steps,
+            guidance_scale=native_config.guidance_scale,
+            width=native_config.width,
+            height=native_config.height,
+            seed=native_config.seed if native_config.seed >= 0 else None,
+            batch_size=native_config.batch_size,
+            precision=native_config.precision
+        )
+        return _model_runner.generate_image(config)
 
     except Exception as e:
         logger.error(f"Error in generate_image: {e}")
-        return json.dumps({"success": False, "error": str(e)})
+        return InferenceResult(success=False, error_message=str(e))
 
 
 def unload_model(model_id: str) -> bool:
@@ -393,14 +389,167 @@ def unload_model(model_id: str) -> bool:
     return _model_runner.unload_model(model_id)
 
 
-def get_memory_info() -> str:
-    """Get memory info as JSON"""
+def get_memory_info() -> Dict[str, int]:
+    """Get memory info in MB"""
     if _model_runner is None:
-        return json.dumps({})
-    return json.dumps(_model_runner.get_memory_info())
+        return {"allocated": 0, "reserved": 0, "max_allocated": 0, "total": 0}
+    return _model_runner.get_memory_info()
+
+
+# Worker process protocol (python_worker_pool.cpp). Requests and results
+# live in a shared memory segment split into fixed-size slots; the socket
+# only carries these fixed-size records.
+_REQUEST_RECORD = "<QIIII"          # request_id, type, slot, request_bytes, reserved
+_RESPONSE_RECORD = "<QiIQfIiiii"    # request_id, status, slot, response_bytes, inference_time,
+                                    # memory_used, count, height, width, channels
+_MSG_LOAD_MODEL = 1
+_MSG_UNLOAD_MODEL = 2
+_MSG_GENERATE_IMAGE = 3
+
+
+def _unpack_strings(payload: bytes, offset: int, count: int) -> Tuple[List[str], int]:
+    """Read length-prefixed UTF-8 strings from a request payload"""
+    import struct
+    values = []
+    for _ in range(count):
+        (length,) = struct.unpack_from("<I", payload, offset)
+        offset += 4
+        values.append(payload[offset:offset + length].decode("utf-8"))
+        offset += length
+    return values, offset
+
+
+def run_worker(shm_fd: int, shm_bytes: int, slot_bytes: int, channel_fd: int, device: str) -> int:
+    """
+    Serve requests from the C++ worker pool until the socket closes
+
+    Generated images are copied straight from the model's tensor into the
+    request's slot; the application reads them there without another copy.
+    """
+    import mmap
+    import struct
+    import numpy as np
+
+    shm = mmap.mmap(shm_fd, shm_bytes)
+    request_record = struct.Struct(_REQUEST_RECORD)
+    response_record = struct.Struct(_RESPONSE_RECORD)
+
+    if not initialize(device):
+        logger.error("Worker could not initialize its ModelRunner; requests will fail")
+
+    def read_exact(size: int) -> Optional[bytes]:
+        data = b""
+        while len(data) < size:
+            chunk = os.read(channel_fd, size - len(data))
+            if not chunk:
+                return None
+            data += chunk
+        return data
+
+    def write_all(data: bytes):
+        view = memoryview(data)
+        while view:
+            written = os.write(channel_fd, view)
+            view = view[written:]
+
+    logger.info(f"Worker {os.getpid()} ready ({shm_bytes // slot_bytes} slots)")
+    while True:
+        header = read_exact(request_record.size)
+        if header is None:
+            break
+        request_id, msg_type, slot, request_bytes, _ = request_record.unpack(header)
+        base = slot * slot_bytes
+        payload = bytes(shm[base:base + request_bytes])
+
+        error = ""
+        inference_time = 0.0
+        memory_used = 0
+        shape = (0, 0, 0, 0)
+        response_bytes = 0
+        try:
+            if msg_type == _MSG_LOAD_MODEL:
+                (model_path, model_id, model_type, precision), _ = _unpack_strings(payload, 0, 4)
+                if not load_model(model_path, model_id, model_type, precision):
+                    error = f"Failed to load model: {model_id}"
+
+            elif msg_type == _MSG_UNLOAD_MODEL:
+                (model_id,), _ = _unpack_strings(payload, 0, 1)
+                unload_model(model_id)
+
+            elif msg_type == _MSG_GENERATE_IMAGE:
+                steps, guidance, width, height, seed, batch_size = struct.unpack_from("<ifiiii", payload, 0)
+                (model_id, prompt, negative_prompt, precision), _ = _unpack_strings(payload, 24, 4)
+                config = InferenceConfig(
+                    model_id=model_id,
+                    prompt=prompt,
+                    negative_prompt=negative_prompt,
+                    num_inference_steps=steps,
+                    guidance_scale=guidance,
+                    width=width,
+                    height=height,
+                    seed=seed if seed >= 0 else None,
+                    batch_size=batch_size,
+                    precision=precision
+                )
+                if _model_runner is None:
+                    error = "ModelRunner not initialized"
+                else:
+                    result = _model_runner.generate_image(config)
+                    if not result.success:
+                        error = result.error_message or "Image generation failed"
+                    else:
+                        images = result.image_data
+                        shape = tuple(images.shape)
+                        response_bytes = int(np.prod(shape))
+                        if len(shape) != 4 or response_bytes > slot_bytes:
+                            error = f"Image batch {shape} does not fit a {slot_bytes >> 20} MB slot"
+                            shape = (0, 0, 0, 0)
+                            response_bytes = 0
+                        else:
+                            target = np.frombuffer(shm, dtype=np.uint8, count=response_bytes,
+                                                   offset=base).reshape(shape)
+                            if TORCH_AVAILABLE and isinstance(images, torch.Tensor):
+                                torch.from_numpy(target).copy_(images)
+                            else:
+                                np.copyto(target, images)
+                            del target
+                        inference_time = result.inference_time
+                        memory_used = max(0, result.memory_used)
+            else:
+                error = f"Unknown request type {msg_type}"
+
+        except Exception as e:
+            error = str(e)
+            logger.error(f"Worker request failed: {e}")
+
+        status = 0
+        if error:
+            message = error.encode("utf-8")[:slot_bytes]
+            shm[base:base + len(message)] = message
+            status = 1
+            response_bytes = len(message)
+            shape = (0, 0, 0, 0)
+
+        write_all(response_record.pack(request_id, status, slot, response_bytes,
+                                       inference_time, memory_used, *shape))
+
+    logger.info(f"Worker {os.getpid()} exiting")
+    return 0
 
 
 if __name__ == "__main__":
+    if "--worker" in sys.argv:
+        import argparse
+        parser = argparse.ArgumentParser(description="AI Forge Studio Python worker")
+        parser.add_argument("--worker", action="store_true")
+        parser.add_argument("--shm-fd", type=int, required=True)
+        parser.add_argument("--shm-bytes", type=int, required=True)
+        parser.add_argument("--slot-bytes", type=int, required=True)
+        parser.add_argument("--channel-fd", type=int, required=True)
+        parser.add_argument("--device", default="cuda")
+        args = parser.parse_args()
+        sys.exit(run_worker(args.shm_fd, args.shm_bytes, args.slot_bytes, args.channel_fd, args.device))
+
     # Test the model runner
     print("AI Forge Studio - Model Runner Test")
     print("=" * 50)
@@ -0,0 +1,1060 @@
+/**
+ * @file python_worker_pool.cpp
+ * @brief Implementation of the Python worker process pool
+ */
+
+#include "python_worker_pool.h"
+#include "../core/logger.h"
+#include "../core/tracer.h"
+#include <map>
+#include <set>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <functional>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+
+#ifndef _WIN32
+#include <spawn.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+extern char** environ;
+#endif
+
+namespace AIForge {
+
+namespace {
+
+// Message kinds on the worker socket (mirrored in model_runner.py)
+enum class MessageType : uint32_t {
+    LOAD_MODEL = 1,
+    UNLOAD_MODEL = 2,
+    GENERATE_IMAGE = 3
+};
+
+// Application -> worker, struct "<QIIII"
+struct RequestRecord {
+    uint64_t requestId;
+    uint32_t type;
+    uint32_t slot;
+    uint32_t requestBytes;
+    uint32_t reserved;
+};
+
+// Worker -> application, struct "<QiIQfIiiii". On failure the slot holds
+// responseBytes of UTF-8 error message.
+struct ResponseRecord {
+    uint64_t requestId;
+    int32_t status;             // 0 on success
+    uint32_t slot;
+    uint64_t responseBytes;
+    float inferenceTime;        // ms
+    uint32_t memoryUsed;        // MB
+    int32_t count;              // Image batch shape
+    int32_t height;
+    int32_t width;
+    int32_t channels;
+};
+
+static_assert(sizeof(RequestRecord) == 24, "RequestRecord must match model_runner.py");
+static_assert(sizeof(ResponseRecord) == 48, "ResponseRecord must match model_runner.py");
+
+// Descriptors the worker finds its shared segment and socket on
+constexpr int CHILD_SHM_FD = 3;
+constexpr int CHILD_CHANNEL_FD = 4;
+
+// How long stop() lets workers drain their requests before killing them
+constexpr auto STOP_TIMEOUT = std::chrono::seconds(5);
+
+// Payloads are little-endian, like every platform we ship on
+template <typename T>
+void appendValue(std::vector<unsigned char>& payload, T value) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&value);
+    payload.insert(payload.end(), bytes, bytes + sizeof(T));
+}
+
+void appendString(std::vector<unsigned char>& payload, const std::string& value) {
+    appendValue(payload, static_cast<uint32_t>(value.size()));
+    payload.insert(payload.end(), value.begin(), value.end());
+}
+
+/**
+ * @brief A worker's shared memory mapping, alive while results point into it
+ */
+struct SharedSegment {
+    unsigned char* base = nullptr;
+    size_t bytes = 0;
+
+    ~SharedSegment() {
+#ifndef _WIN32
+        if (base) {
+            munmap(base, bytes);
+        }
+#endif
+    }
+};
+
+/**
+ * @brief A request waiting for its response record
+ */
+struct PendingRequest {
+    std::shared_ptr<SharedSegment> segment;
+    uint32_t slot = 0;
+    bool done = false;
+    bool detached = false;      // Nobody waits; the reader frees the slot
+    ResponseRecord response = {};
+    std::string error;
+};
+
+/**
+ * @brief A started worker process
+ */
+struct WorkerProcess {
+    long pid = -1;
+    int channel = -1;
+    std::shared_ptr<SharedSegment> segment;
+};
+
+void closeChannel(int channel) {
+#ifndef _WIN32
+    if (channel >= 0) {
+        close(channel);
+    }
+#endif
+}
+
+bool sendRecord(int channel, const RequestRecord& record) {
+#ifndef _WIN32
+    const char* data = reinterpret_cast<const char*>(&record);
+    size_t sent = 0;
+    while (sent < sizeof(record)) {
+#ifdef MSG_NOSIGNAL
+        ssize_t n = send(channel, data + sent, sizeof(record) - sent, MSG_NOSIGNAL);
+#else
+        ssize_t n = send(channel, data + sent, sizeof(record) - sent, 0);
+#endif
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool receiveRecord(int channel, ResponseRecord& record) {
+#ifndef _WIN32
+    char* data = reinterpret_cast<char*>(&record);
+    size_t received = 0;
+    while (received < sizeof(record)) {
+        ssize_t n = recv(channel, data + received, sizeof(record) - received, 0);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;       // Closed: the worker exited
+        }
+        received += static_cast<size_t>(n);
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+}
+
+/**
+ * @brief Bookkeeping for one worker process (restarted in place)
+ */
+struct PythonWorkerPool::Worker {
+    int index = 0;
+    int deviceId = -1;              // CUDA device, -1 on CPU
+    long pid = -1;
+    int channel = -1;               // Socket to the process
+    std::shared_ptr<SharedSegment> segment;
+    std::vector<bool> slotBusy;
+    bool running = false;           // Accepting requests
+    bool givenUp = false;           // Crashed more than maxRestarts times in a row
+    int consecutiveCrashes = 0;
+    std::set<std::string> models;
+    std::map<uint64_t, std::shared_ptr<PendingRequest>> pending;
+    std::thread reader;
+};
+
+/**
+ * @brief Pool state shared with reader threads and outstanding results
+ */
+struct PythonWorkerPool::State {
+    struct ModelEntry {
+        std::string path;
+        std::string type;
+        std::string precision;
+        std::vector<int> workers;
+    };
+
+    PythonWorkerPoolConfig config;
+    std::string script;
+    size_t slotBytes = 0;
+
+    mutable std::mutex mutex;
+    std::condition_variable changed;    // Slot freed, reply arrived or worker state changed
+    bool running = false;
+    bool stopping = false;
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::map<std::string, ModelEntry> models;
+    uint64_t nextRequestId = 1;
+    size_t restarts = 0;
+    size_t completed = 0;
+    size_t failed = 0;
+
+    using PickFunction = std::function<Worker*(bool& canWait)>;
+
+    /**
+     * @brief Start a worker process with a fresh shared segment (no lock needed)
+     */
+    bool spawn(const Worker& worker, WorkerProcess& process);
+
+    /**
+     * @brief Wait for a worker with a free slot and send it a request (lock held)
+     * @param pick Returns a usable worker, or nullptr and whether one may free up
+     * @return Pending request, or nullptr with error set
+     */
+    std::shared_ptr<PendingRequest> submit(std::unique_lock<std::mutex>& lock, const PickFunction& pick,
+                                           MessageType type, const std::vector<unsigned char>& payload,
+                                           std::chrono::steady_clock::time_point until,
+                                           Worker*& worker, std::string& error);
+
+    /**
+     * @brief Write a request into a free slot of a worker (lock held)
+     */
+    std::shared_ptr<PendingRequest> send(Worker& worker, MessageType type,
+                                         const std::vector<unsigned char>& payload,
+                                         bool detached, std::string& error);
+
+    /**
+     * @brief Wait for a reply (lock held)
+     * @return true if the worker reported success
+     */
+    bool await(std::unique_lock<std::mutex>& lock, std::shared_ptr<PendingRequest>& pending,
+               std::chrono::steady_clock::time_point until, std::string& error);
+
+    /**
+     * @brief Return a slot (lock held); slots of a replaced segment are ignored
+     */
+    void releaseSlot(Worker& worker, const std::shared_ptr<SharedSegment>& segment, uint32_t slot);
+
+    /**
+     * @brief Worker holding the model with a free slot and the fewest requests (lock held)
+     */
+    Worker* pickWorker(const std::string& modelId, bool& canWait);
+
+    /**
+     * @brief Reader thread: completes requests, restarts the process when it dies
+     */
+    void readerLoop(Worker* worker);
+
+    /**
+     * @brief Handle a response record (lock held)
+     */
+    void complete(Worker& worker, const ResponseRecord& record);
+
+    /**
+     * @brief Fail every request sent to a worker (lock held)
+     */
+    void failPending(Worker& worker, const std::string& reason);
+
+    /**
+     * @brief Forget a model a restarted worker could not reload (lock held)
+     */
+    void dropReplica(Worker& worker, const std::string& modelId, const std::string& error);
+
+    std::chrono::steady_clock::time_point deadline() const {
+        return std::chrono::steady_clock::now() + std::chrono::milliseconds(config.requestTimeoutMs);
+    }
+};
+
+bool PythonWorkerPool::State::spawn(const Worker& worker, WorkerProcess& process) {
+#ifdef _WIN32
+    // In production: CreateFileMapping for the segment, a named pipe for the
+    // channel and CreateProcess with both handles inherited
+    LOG_ERROR("PythonWorkerPool", "Python worker processes are not supported on Windows yet");
+    return false;
+#else
+    const size_t bytes = slotBytes * static_cast<size_t>(config.slotsPerWorker);
+
+    // Descriptors start above the child's fixed numbers so dup2 never
+    // lands on itself (which would leave close-on-exec set)
+    auto moveHigh = [](int fd) {
+        if (fd < 0) {
+            return fd;
+        }
+        int high = fcntl(fd, F_DUPFD_CLOEXEC, 16);
+        close(fd);
+        return high;
+    };
+
+#ifdef __linux__
+    int shm = moveHigh(memfd_create("aiforge-python-worker", MFD_CLOEXEC));
+#else
+    const std::string shmName = "/aiforge-python-worker-" + std::to_string(getpid()) + "-" +
+                                std::to_string(worker.index);
+    int shm = moveHigh(shm_open(shmName.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600));
+    shm_unlink(shmName.c_str());
+#endif
+    if (shm < 0 || ftruncate(shm, static_cast<off_t>(bytes)) != 0) {
+        LOG_ERROR("PythonWorkerPool", "Failed to create shared memory: " + std::string(strerror(errno)));
+        closeChannel(shm);
+        return false;
+    }
+
+    void* base = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, shm, 0);
+    if (base == MAP_FAILED) {
+        LOG_ERROR("PythonWorkerPool", "Failed to map shared memory: " + std::string(strerror(errno)));
+        close(shm);
+        return false;
+    }
+    auto segment = std::make_shared<SharedSegment>();
+    segment->base = static_cast<unsigned char*>(base);
+    segment->bytes = bytes;
+
+    int sockets[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0) {
+        LOG_ERROR("PythonWorkerPool", "Failed to create worker socket: " + std::string(strerror(errno)));
+        close(shm);
+        return false;
+    }
+    sockets[0] = moveHigh(sockets[0]);
+    sockets[1] = moveHigh(sockets[1]);
+
+    std::vector<std::string> args = {
+        config.pythonExecutable, script, "--worker",
+        "--shm-fd", std::to_string(CHILD_SHM_FD),
+        "--shm-bytes", std::to_string(bytes),
+        "--slot-bytes", std::to_string(slotBytes),
+        "--channel-fd", std::to_string(CHILD_CHANNEL_FD),
+        "--device", config.device
+    };
+    std::vector<char*> argv;
+    for (auto& arg : args) {
+        argv.push_back(&arg[0]);
+    }
+    argv.push_back(nullptr);
+
+    // One GPU per worker; the runner then simply uses "cuda"
+    std::vector<std::string> env;
+    for (char** entry = environ; *entry; entry++) {
+        if (std::strncmp(*entry, "CUDA_VISIBLE_DEVICES=", 21) != 0) {
+            env.emplace_back(*entry);
+        }
+    }
+    if (worker.deviceId >= 0) {
+        env.push_back("CUDA_VISIBLE_DEVICES=" + std::to_string(worker.deviceId));
+    }
+    std::vector<char*> envp;
+    for (auto& entry : env) {
+        envp.push_back(&entry[0]);
+    }
+    envp.push_back(nullptr);
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, shm, CHILD_SHM_FD);
+    posix_spawn_file_actions_adddup2(&actions, sockets[1], CHILD_CHANNEL_FD);
+
+    pid_t pid = -1;
+    int error = posix_spawnp(&pid, config.pythonExecutable.c_str(), &actions, nullptr,
+                             argv.data(), envp.data());
+    posix_spawn_file_actions_destroy(&actions);
+
+    // The child holds its own copies now; the mapping keeps the segment alive
+    close(shm);
+    close(sockets[1]);
+    if (error != 0) {
+        LOG_ERROR("PythonWorkerPool", "Failed to start " + config.pythonExecutable + ": " + strerror(error));
+        close(sockets[0]);
+        return false;
+    }
+
+    process.pid = pid;
+    process.channel = sockets[0];
+    process.segment = segment;
+    LOG_INFO("PythonWorkerPool", "Worker " + std::to_string(worker.index) + " started (pid " +
+             std::to_string(pid) + (worker.deviceId >= 0 ? ", GPU " + std::to_string(worker.deviceId) : "") + ")");
+    return true;
+#endif
+}
+
+std::shared_ptr<PendingRequest> PythonWorkerPool::State::submit(std::unique_lock<std::mutex>& lock,
+                                                                const PickFunction& pick, MessageType type,
+                                                                const std::vector<unsigned char>& payload,
+                                                                std::chrono::steady_clock::time_point until,
+                                                                Worker*& worker, std::string& error) {
+    if (payload.size() > slotBytes) {
+        error = "Request larger than a worker slot (" + std::to_string(config.slotMB) + " MB)";
+        return nullptr;
+    }
+
+    while (true) {
+        if (stopping || !running) {
+            error = "Python worker pool stopped";
+            return nullptr;
+        }
+        bool canWait = false;
+        worker = pick(canWait);
+        if (worker) {
+            break;
+        }
+        if (!canWait) {
+            error = "No Python worker available";
+            return nullptr;
+        }
+        if (changed.wait_until(lock, until) == std::cv_status::timeout) {
+            error = "Timed out waiting for a free Python worker";
+            return nullptr;
+        }
+    }
+    return send(*worker, type, payload, false, error);
+}
+
+std::shared_ptr<PendingRequest> PythonWorkerPool::State::send(Worker& worker, MessageType type,
+                                                              const std::vector<unsigned char>& payload,
+                                                              bool detached, std::string& error) {
+    auto freeSlot = std::find(worker.slotBusy.begin(), worker.slotBusy.end(), false);
+    if (freeSlot == worker.slotBusy.end()) {
+        error = "No free slot on Python worker " + std::to_string(worker.index);
+        return nullptr;
+    }
+    const uint32_t slot = static_cast<uint32_t>(freeSlot - worker.slotBusy.begin());
+
+    if (!payload.empty()) {
+        std::memcpy(worker.segment->base + slot * slotBytes, payload.data(), payload.size());
+    }
+
+    RequestRecord record = {};
+    record.requestId = nextRequestId++;
+    record.type = static_cast<uint32_t>(type);
+    record.slot = slot;
+    record.requestBytes = static_cast<uint32_t>(payload.size());
+    if (!sendRecord(worker.channel, record)) {
+        error = "Lost connection to Python worker " + std::to_string(worker.index);
+        return nullptr;
+    }
+
+    auto pending = std::make_shared<PendingRequest>();
+    pending->segment = worker.segment;
+    pending->slot = slot;
+    pending->detached = detached;
+    worker.slotBusy[slot] = true;
+    worker.pending[record.requestId] = pending;
+    return pending;
+}
+
+bool PythonWorkerPool::State::await(std::unique_lock<std::mutex>& lock, std::shared_ptr<PendingRequest>& pending,
+                                    std::chrono::steady_clock::time_point until, std::string& error) {
+    if (!changed.wait_until(lock, until, [&pending] { return pending->done; })) {
+        // The reader frees the slot if the reply still comes
+        pending->detached = true;
+        pending = nullptr;
+        error = "Timed out waiting for the Python worker";
+        return false;
+    }
+    if (!pending->error.empty() || pending->response.status != 0) {
+        error = pending->error.empty() ? "Python worker failed the request" : pending->error;
+        return false;
+    }
+    return true;
+}
+
+void PythonWorkerPool::State::releaseSlot(Worker& worker, const std::shared_ptr<SharedSegment>& segment,
+                                          uint32_t slot) {
+    if (worker.segment == segment && slot < worker.slotBusy.size()) {
+        worker.slotBusy[slot] = false;
+        changed.notify_all();
+    }
+}
+
+PythonWorkerPool::Worker* PythonWorkerPool::State::pickWorker(const std::string& modelId, bool& canWait) {
+    canWait = false;
+    auto it = models.find(modelId);
+    if (it == models.end()) {
+        return nullptr;
+    }
+
+    Worker* best = nullptr;
+    for (int index : it->second.workers) {
+        Worker& worker = *workers[index];
+        if (worker.givenUp) {
+            continue;
+        }
+        canWait = true;     // Busy or restarting workers come back
+        if (!worker.running ||
+            std::find(worker.slotBusy.begin(), worker.slotBusy.end(), false) == worker.slotBusy.end()) {
+            continue;
+        }
+        if (!best || worker.pending.size() < best->pending.size()) {
+            best = &worker;
+        }
+    }
+    return best;
+}
+
+void PythonWorkerPool::State::complete(Worker& worker, const ResponseRecord& record) {
+    // A reply means the process is healthy again
+    worker.consecutiveCrashes = 0;
+
+    auto it = worker.pending.find(record.requestId);
+    if (it == worker.pending.end()) {
+        LOG_WARNING("PythonWorkerPool", "Reply to unknown request " + std::to_string(record.requestId));
+        return;
+    }
+    std::shared_ptr<PendingRequest> pending = it->second;
+    worker.pending.erase(it);
+
+    pending->response = record;
+    if (record.status != 0) {
+        const size_t length = std::min<size_t>(record.responseBytes, slotBytes);
+        pending->error.assign(reinterpret_cast<const char*>(pending->segment->base + pending->slot * slotBytes),
+                              length);
+        if (pending->error.empty()) {
+            pending->error = "Python worker failed the request";
+        }
+    }
+    pending->done = true;
+
+    if (pending->detached) {
+        if (!pending->error.empty()) {
+            LOG_WARNING("PythonWorkerPool", "Worker " + std::to_string(worker.index) + ": " + pending->error);
+        }
+        releaseSlot(worker, pending->segment, pending->slot);
+    }
+    changed.notify_all();
+}
+
+void PythonWorkerPool::State::failPending(Worker& worker, const std::string& reason) {
+    for (auto& pair : worker.pending) {
+        pair.second->error = reason;
+        pair.second->done = true;
+    }
+    worker.pending.clear();
+    changed.notify_all();
+}
+
+void PythonWorkerPool::State::readerLoop(Worker* worker) {
+    while (true) {
+        // Only this thread replaces the channel, so it is read without the lock
+        ResponseRecord record;
+        if (receiveRecord(worker->channel, record)) {
+            std::lock_guard<std::mutex> lock(mutex);
+            complete(*worker, record);
+            continue;
+        }
+
+        // The process exited: reap it before anyone can reuse its pid
+        int status = 0;
+#ifndef _WIN32
+        waitpid(static_cast<pid_t>(worker->pid), &status, 0);
+#endif
+
+        std::unique_lock<std::mutex> lock(mutex);
+        worker->running = false;
+        closeChannel(worker->channel);
+        worker->channel = -1;
+        worker->pid = -1;
+        failPending(*worker, stopping ? "Python worker pool stopped" : "Python worker exited unexpectedly");
+        if (stopping) {
+            return;
+        }
+
+        std::string reason = "status " + std::to_string(status);
+#ifndef _WIN32
+        if (WIFEXITED(status)) {
+            reason = "exit code " + std::to_string(WEXITSTATUS(status));
+        } else if (WIFSIGNALED(status)) {
+            reason = "signal " + std::to_string(WTERMSIG(status));
+        }
+#endif
+        LOG_WARNING("PythonWorkerPool", "Worker " + std::to_string(worker->index) +
+                    " exited (" + reason + "), restarting");
+
+        WorkerProcess process;
+        while (true) {
+            if (++worker->consecutiveCrashes > config.maxRestarts) {
+                worker->givenUp = true;
+                changed.notify_all();
+                LOG_ERROR("PythonWorkerPool", "Worker " + std::to_string(worker->index) + " crashed " +
+                          std::to_string(config.maxRestarts) + " times in a row, giving up");
+                return;
+            }
+            changed.wait_for(lock, std::chrono::milliseconds(config.restartDelayMs),
+                             [this] { return stopping; });
+            if (stopping) {
+                return;
+            }
+
+            lock.unlock();
+            bool started = spawn(*worker, process);
+            lock.lock();
+            if (started) {
+                break;
+            }
+        }
+
+        restarts++;
+        worker->pid = process.pid;
+        worker->channel = process.channel;
+        worker->segment = process.segment;
+        worker->slotBusy.assign(config.slotsPerWorker, false);
+
+        if (stopping) {
+#ifndef _WIN32
+            shutdown(worker->channel, SHUT_WR);
+#endif
+            continue;
+        }
+
+        // Reload one model at a time before the worker takes requests again.
+        // Nothing else can reach it meanwhile, and this thread is its only
+        // reader, so it takes each reply here instead of in complete().
+        bool exited = false;
+        const std::vector<std::string> held(worker->models.begin(), worker->models.end());
+        for (const std::string& modelId : held) {
+            // Unloaded while this thread waited for a reply
+            auto found = models.find(modelId);
+            if (found == models.end() || worker->models.count(modelId) == 0) {
+                continue;
+            }
+            const ModelEntry& entry = found->second;
+            std::vector<unsigned char> payload;
+            appendString(payload, entry.path);
+            appendString(payload, modelId);
+            appendString(payload, entry.type);
+            appendString(payload, entry.precision);
+
+            std::string error;
+            std::shared_ptr<PendingRequest> pending = send(*worker, MessageType::LOAD_MODEL, payload, false, error);
+            if (pending) {
+                lock.unlock();
+                ResponseRecord reply;
+                const bool replied = receiveRecord(worker->channel, reply);
+                lock.lock();
+                if (!replied) {
+                    // Crashed again: the models not yet back are retried on the next restart
+                    exited = true;
+                    break;
+                }
+                complete(*worker, reply);
+                releaseSlot(*worker, pending->segment, pending->slot);
+                error = pending->error;
+            }
+            if (!error.empty()) {
+                dropReplica(*worker, modelId, error);
+            }
+        }
+        if (exited) {
+            continue;
+        }
+        worker->running = true;
+        changed.notify_all();
+    }
+}
+
+void PythonWorkerPool::State::dropReplica(Worker& worker, const std::string& modelId,
+                                          const std::string& error) {
+    LOG_WARNING("PythonWorkerPool", "Failed to reload " + modelId + " on worker " +
+                std::to_string(worker.index) + ": " + error);
+    worker.models.erase(modelId);
+
+    auto it = models.find(modelId);
+    if (it == models.end()) {
+        return;
+    }
+    std::vector<int>& holders = it->second.workers;
+    holders.erase(std::remove(holders.begin(), holders.end(), worker.index), holders.end());
+    if (holders.empty()) {
+        LOG_ERROR("PythonWorkerPool", "Model " + modelId + " is no longer loaded on any worker");
+        models.erase(it);
+    }
+    changed.notify_all();
+}
+
+PythonWorkerPool::PythonWorkerPool()
+{
+}
+
+PythonWorkerPool::~PythonWorkerPool() {
+    stop();
+}
+
+bool PythonWorkerPool::start(const std::string& pythonPath, const PythonWorkerPoolConfig& config) {
+    if (isRunning()) {
+        LOG_WARNING("PythonWorkerPool", "Worker pool already running");
+        return true;
+    }
+
+    // A fresh state: results from an earlier run keep the old one alive
+    auto state = std::make_shared<State>();
+    state->config = config;
+    state->config.workersPerDevice = std::max(1, config.workersPerDevice);
+    state->config.modelReplicas = std::max(1, config.modelReplicas);
+    state->config.slotsPerWorker = std::max(1, config.slotsPerWorker);
+    state->script = pythonPath + "/model_runner.py";
+    state->slotBytes = std::max<size_t>(1, config.slotMB) * 1024 * 1024;
+
+    std::vector<int> devices = config.devices;
+    if (config.device != "cuda") {
+        devices = {-1};
+    } else if (devices.empty()) {
+        devices = {0};
+    }
+
+    // Interleave devices so consecutive workers (and replicas) sit on different GPUs
+    for (int i = 0; i < state->config.workersPerDevice; i++) {
+        for (int device : devices) {
+            auto worker = std::make_unique<Worker>();
+            worker->index = static_cast<int>(state->workers.size());
+            worker->deviceId = device;
+            state->workers.push_back(std::move(worker));
+        }
+    }
+
+    int started = 0;
+    for (auto& worker : state->workers) {
+        WorkerProcess process;
+        if (!state->spawn(*worker, process)) {
+            worker->givenUp = true;
+            continue;
+        }
+        worker->pid = process.pid;
+        worker->channel = process.channel;
+        worker->segment = process.segment;
+        worker->slotBusy.assign(state->config.slotsPerWorker, false);
+        worker->running = true;
+        started++;
+    }
+    if (started == 0) {
+        LOG_ERROR("PythonWorkerPool", "No Python worker could be started");
+        return false;
+    }
+
+    state->running = true;
+    for (auto& worker : state->workers) {
+        if (worker->running) {
+            worker->reader = std::thread(&State::readerLoop, state, worker.get());
+        }
+    }
+    m_state = state;
+
+    LOG_INFO("PythonWorkerPool", "Started " + std::to_string(started) + " Python workers (" +
+             std::to_string(state->config.slotsPerWorker) + " x " + std::to_string(config.slotMB) +
+             " MB shared slots each)");
+    return true;
+}
+
+void PythonWorkerPool::stop() {
+    if (!m_state) {
+        return;
+    }
+    State& state = *m_state;
+
+    std::unique_lock<std::mutex> lock(state.mutex);
+    if (!state.running) {
+        return;
+    }
+    state.stopping = true;
+
+    // Workers read to the end of their queue, then exit
+#ifndef _WIN32
+    for (auto& worker : state.workers) {
+        if (worker->channel >= 0) {
+            shutdown(worker->channel, SHUT_WR);
+        }
+    }
+#endif
+    state.changed.notify_all();
+
+    auto exited = [&state] {
+        for (auto& worker : state.workers) {
+            if (worker->pid > 0) {
+                return false;
+            }
+        }
+        return true;
+    };
+    if (!state.changed.wait_for(lock, STOP_TIMEOUT, exited)) {
+        // Still unreaped, so the pid cannot have been reused
+        for (auto& worker : state.workers) {
+            if (worker->pid > 0) {
+                LOG_WARNING("PythonWorkerPool", "Killing worker " + std::to_string(worker->index));
+#ifndef _WIN32
+                kill(static_cast<pid_t>(worker->pid), SIGKILL);
+#endif
+            }
+        }
+    }
+    lock.unlock();
+
+    for (auto& worker : state.workers) {
+        if (worker->reader.joinable()) {
+            worker->reader.join();
+        }
+    }
+
+    lock.lock();
+    state.running = false;
+    state.models.clear();
+    LOG_INFO("PythonWorkerPool", "Worker pool stopped");
+}
+
+bool PythonWorkerPool::isRunning() const {
+    if (!m_state) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    return m_state->running && !m_state->stopping;
+}
+
+bool PythonWorkerPool::loadModel(const std::string& modelPath, const std::string& modelId,
+                                 const std::string& modelType, const std::string& precision) {
+    if (!isRunning()) {
+        LOG_ERROR("PythonWorkerPool", "Cannot load model: worker pool not running");
+        return false;
+    }
+
+    TRACE_SCOPE_DETAIL("PythonWorkerPool", "loadModel", modelId);
+    State& state = *m_state;
+    std::unique_lock<std::mutex> lock(state.mutex);
+    if (state.models.count(modelId)) {
+        LOG_WARNING("PythonWorkerPool", "Model already loaded: " + modelId);
+        return true;
+    }
+
+    // Replicas go to the workers holding the fewest models
+    std::vector<Worker*> candidates;
+    for (auto& worker : state.workers) {
+        if (!worker->givenUp) {
+            candidates.push_back(worker.get());
+        }
+    }
+    std::stable_sort(candidates.begin(), candidates.end(), [](const Worker* a, const Worker* b) {
+        return a->models.size() < b->models.size();
+    });
+    candidates.resize(std::min<size_t>(candidates.size(), state.config.modelReplicas));
+
+    std::vector<unsigned char> payload;
+    appendString(payload, modelPath);
+    appendString(payload, modelId);
+    appendString(payload, modelType);
+    appendString(payload, precision);
+
+    // Send to every replica first so they load in parallel
+    const auto until = state.deadline();
+    std::vector<std::pair<Worker*, std::shared_ptr<PendingRequest>>> sent;
+    for (Worker* target : candidates) {
+        auto pick = [target](bool& canWait) -> Worker* {
+            canWait = !target->givenUp;
+            bool free = std::find(target->slotBusy.begin(), target->slotBusy.end(), false) !=
+                        target->slotBusy.end();
+            return target->running && free ? target : nullptr;
+        };
+        Worker* worker = nullptr;
+        std::string error;
+        auto pending = state.submit(lock, pick, MessageType::LOAD_MODEL, payload, until, worker, error);
+        if (!pending) {
+            LOG_ERROR("PythonWorkerPool", "Failed to load " + modelId + " on worker " +
+                      std::to_string(target->index) + ": " + error);
+            continue;
+        }
+        sent.emplace_back(worker, pending);
+    }
+
+    State::ModelEntry entry;
+    entry.path = modelPath;
+    entry.type = modelType;
+    entry.precision = precision;
+    for (auto& pair : sent) {
+        std::string error;
+        std::shared_ptr<PendingRequest> pending = pair.second;
+        bool loaded = state.await(lock, pending, until, error);
+        if (pending) {
+            state.releaseSlot(*pair.first, pending->segment, pending->slot);
+        }
+        if (!loaded) {
+            LOG_ERROR("PythonWorkerPool", "Failed to load " + modelId + " on worker " +
+                      std::to_string(pair.first->index) + ": " + error);
+            continue;
+        }
+        pair.first->models.insert(modelId);
+        entry.workers.push_back(pair.first->index);
+    }
+
+    if (entry.workers.empty()) {
+        return false;
+    }
+    state.models[modelId] = entry;
+    LOG_INFO("PythonWorkerPool", "Model " + modelId + " loaded on " +
+             std::to_string(entry.workers.size()) + " worker(s)");
+    return true;
+}
+
+bool PythonWorkerPool::unloadModel(const std::string& modelId) {
+    if (!isRunning()) {
+        return false;
+    }
+
+    State& state = *m_state;
+    std::unique_lock<std::mutex> lock(state.mutex);
+    auto it = state.models.find(modelId);
+    if (it == state.models.end()) {
+        return false;
+    }
+    std::vector<int> holders = it->second.workers;
+    state.models.erase(it);
+
+    std::vector<unsigned char> payload;
+    appendString(payload, modelId);
+
+    // New requests no longer route here; requests already queued on the
+    // workers run before the unload
+    const auto until = state.deadline();
+    for (int index : holders) {
+        Worker* target = state.workers[index].get();
+        target->models.erase(modelId);
+        auto pick = [target](bool& canWait) -> Worker* {
+            canWait = !target->givenUp;
+            bool free = std::find(target->slotBusy.begin(), target->slotBusy.end(), false) !=
+                        target->slotBusy.end();
+            return target->running && free ? target : nullptr;
+        };
+        Worker* worker = nullptr;
+        std::string error;
+        auto pending = state.submit(lock, pick, MessageType::UNLOAD_MODEL, payload, until, worker, error);
+        if (pending) {
+            pending->detached = true;
+        } else {
+            LOG_WARNING("PythonWorkerPool", "Failed to unload " + modelId + " on worker " +
+                        std::to_string(index) + ": " + error);
+        }
+    }
+
+    LOG_INFO("PythonWorkerPool", "Model unloaded: " + modelId);
+    return true;
+}
+
+PythonInferenceResult PythonWorkerPool::generateImage(const PythonInferenceConfig& config) {
+    PythonInferenceResult result;
+    result.success = false;
+
+    if (!isRunning()) {
+        result.errorMessage = "Worker pool not running";
+        LOG_ERROR("PythonWorkerPool", result.errorMessage);
+        return result;
+    }
+
+    TRACE_SCOPE_DETAIL("PythonWorkerPool", "generateImage", config.modelId);
+
+    // Fixed-layout binary config, parsed with struct.unpack on the worker
+    std::vector<unsigned char> payload;
+    appendValue<int32_t>(payload, config.numInferenceSteps);
+    appendValue<float>(payload, config.guidanceScale);
+    appendValue<int32_t>(payload, config.width);
+    appendValue<int32_t>(payload, config.height);
+    appendValue<int32_t>(payload, config.seed);
+    appendValue<int32_t>(payload, config.batchSize);
+    appendString(payload, config.modelId);
+    appendString(payload, config.prompt);
+    appendString(payload, config.negativePrompt);
+    appendString(payload, config.precision);
+
+    std::shared_ptr<State> state = m_state;
+    std::unique_lock<std::mutex> lock(state->mutex);
+    if (!state->models.count(config.modelId)) {
+        state->failed++;
+        result.errorMessage = "Model not loaded: " + config.modelId;
+        LOG_ERROR("PythonWorkerPool", result.errorMessage);
+        return result;
+    }
+
+    auto pick = [&state, &config](bool& canWait) {
+        return state->pickWorker(config.modelId, canWait);
+    };
+    const auto until = state->deadline();
+    Worker* worker = nullptr;
+    std::string error;
+    std::shared_ptr<PendingRequest> pending =
+        state->submit(lock, pick, MessageType::GENERATE_IMAGE, payload, until, worker, error);
+    if (pending && state->await(lock, pending, until, error)) {
+        const ResponseRecord response = pending->response;
+        const size_t bytes = static_cast<size_t>(std::max(0, response.count)) * std::max(0, response.height) *
+                             std::max(0, response.width) * std::max(0, response.channels);
+        if (bytes == 0 || bytes != response.responseBytes || bytes > state->slotBytes) {
+            error = "Python worker returned a malformed image batch";
+        } else {
+            // The images stay in the slot until the result is destroyed
+            std::shared_ptr<SharedSegment> segment = pending->segment;
+            const uint32_t slot = pending->slot;
+            TensorView view(segment->base + slot * state->slotBytes, DataType::UINT8,
+                            {response.count, response.height, response.width, response.channels});
+            result.images = PythonTensor(view, [state, worker, segment, slot] {
+                std::lock_guard<std::mutex> releaseLock(state->mutex);
+                state->releaseSlot(*worker, segment, slot);
+            });
+            pending = nullptr;
+
+            result.success = true;
+            result.imageCount = response.count;
+            result.imageHeight = response.height;
+            result.imageWidth = response.width;
+            result.imageChannels = response.channels;
+            result.inferenceTime = response.inferenceTime;
+            result.memoryUsed = response.memoryUsed;
+        }
+    }
+
+    if (pending) {
+        state->releaseSlot(*worker, pending->segment, pending->slot);
+    }
+    if (result.success) {
+        state->completed++;
+    } else {
+        state->failed++;
+        result.errorMessage = error;
+        LOG_ERROR("PythonWorkerPool", "Image generation failed: " + error);
+    }
+    return result;
+}
+
+PythonWorkerPoolStats PythonWorkerPool::getStats() const {
+    PythonWorkerPoolStats stats;
+    if (!m_state) {
+        return stats;
+    }
+
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    stats.workers = static_cast<int>(m_state->workers.size());
+    for (const auto& worker : m_state->workers) {
+        if (worker->running) {
+            stats.runningWorkers++;
+        }
+        stats.inFlight += worker->pending.size();
+    }
+    stats.restarts = m_state->restarts;
+    stats.completed = m_state->completed;
+    stats.failed = m_state->failed;
+    return stats;
+}
+
+} // namespace AIForge
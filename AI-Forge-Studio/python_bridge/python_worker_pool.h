@@ -0,0 +1,148 @@
+/**
+ * @file python_worker_pool.h
+ * @brief Out-of-process Python model runners
+ *
+ * The embedded interpreter serializes every call on one GIL, so the
+ * diffusers fallback runs one request per host. The pool starts N Python
+ * processes (optionally spread over GPUs), each hosting its own
+ * ModelRunner, and routes requests to the workers that have the model
+ * loaded.
+ *
+ * Each worker shares one memory segment with the application, split into
+ * a ring of fixed-size slots. A request is written into a free slot and
+ * announced with a small record on a socket; the worker parses it, writes
+ * the generated images into the same slot and answers with a record on the
+ * socket. The images are handed to the caller in place and the slot is
+ * reused once the result is destroyed.
+ *
+ * Features:
+ * - Model affinity: requests go to a worker that already holds the model
+ * - Least-loaded replica selection and waiting for free slots
+ * - Crashed workers are restarted and their models reloaded
+ *
+ * Thread-safe: requests may be issued from any number of threads.
+ */
+
+#ifndef PYTHON_WORKER_POOL_H
+#define PYTHON_WORKER_POOL_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include "bridge.h"
+
+namespace AIForge {
+
+/**
+ * @struct PythonWorkerPoolConfig
+ * @brief Configuration for the Python worker processes
+ */
+struct PythonWorkerPoolConfig {
+    std::string pythonExecutable = "python3";
+    std::string device = "cuda";            // "cuda" or "cpu"
+    std::vector<int> devices;               // GPUs to spread workers over (empty = GPU 0)
+    int workersPerDevice = 1;
+    int modelReplicas = 1;                  // Workers that load each model
+    int slotsPerWorker = 4;                 // Requests in flight plus results held, per worker
+    size_t slotMB = 64;                     // Largest request or image batch (1024x1024 RGB = 3 MB per image)
+    unsigned int requestTimeoutMs = 600000; // Max wait for a free slot and for the reply
+    int maxRestarts = 5;                    // Consecutive crashes before a worker is given up
+    unsigned int restartDelayMs = 1000;
+};
+
+/**
+ * @struct PythonWorkerPoolStats
+ * @brief Worker pool counters
+ */
+struct PythonWorkerPoolStats {
+    int workers = 0;
+    int runningWorkers = 0;
+    size_t restarts = 0;
+    size_t inFlight = 0;
+    size_t completed = 0;
+    size_t failed = 0;
+};
+
+/**
+ * @class PythonWorkerPool
+ * @brief Pool of Python worker processes fed through shared memory
+ */
+class PythonWorkerPool {
+public:
+    PythonWorkerPool();
+    ~PythonWorkerPool();
+
+    // Disable copy and move
+    PythonWorkerPool(const PythonWorkerPool&) = delete;
+    PythonWorkerPool& operator=(const PythonWorkerPool&) = delete;
+    PythonWorkerPool(PythonWorkerPool&&) = delete;
+    PythonWorkerPool& operator=(PythonWorkerPool&&) = delete;
+
+    /**
+     * @brief Start the worker processes
+     * @param pythonPath Directory containing model_runner.py
+     * @param config Pool configuration
+     * @return true if at least one worker started
+     */
+    bool start(const std::string& pythonPath, const PythonWorkerPoolConfig& config);
+
+    /**
+     * @brief Ask the workers to exit, killing those that do not, and join
+     *
+     * Results already returned stay valid until destroyed.
+     */
+    void stop();
+
+    /**
+     * @brief Check if pool is running
+     * @return true if running
+     */
+    bool isRunning() const;
+
+    /**
+     * @brief Load a model on the least-loaded workers
+     * @param modelPath Path to model file or HuggingFace ID
+     * @param modelId Unique identifier for model
+     * @param modelType Type of model ("text_to_image", etc.)
+     * @param precision Precision mode ("fp16", "fp32")
+     * @return true if at least one worker loaded it
+     */
+    bool loadModel(const std::string& modelPath, const std::string& modelId,
+                   const std::string& modelType, const std::string& precision);
+
+    /**
+     * @brief Unload a model from the workers holding it
+     * @param modelId Model identifier
+     * @return true if the model was loaded
+     */
+    bool unloadModel(const std::string& modelId);
+
+    /**
+     * @brief Generate images on a worker holding the model
+     *
+     * Blocks the calling thread only; other threads' requests run on
+     * other workers at the same time.
+     *
+     * @param config Inference configuration
+     * @return Result whose images live in the worker's shared memory
+     */
+    PythonInferenceResult generateImage(const PythonInferenceConfig& config);
+
+    /**
+     * @brief Get pool statistics
+     * @return PythonWorkerPoolStats structure
+     */
+    PythonWorkerPoolStats getStats() const;
+
+private:
+    struct State;
+    struct Worker;
+
+    // Shared with the results handed out, which return their slots to it
+    std::shared_ptr<State> m_state;
+};
+
+} // namespace AIForge
+
+#endif // PYTHON_WORKER_POOL_H
@@ -0,0 +1,269 @@
+/**
+ * @file benchmark.h
+ * @brief Minimal benchmark harness: warmup, repetitions, percentiles, JSON
+ *
+ * A single timed run says little about code whose cost varies with caches,
+ * thread scheduling and GPU clocks. Each benchmark here runs a number of
+ * untimed warmup iterations, then times every repetition separately and
+ * reports the distribution, so two builds can be compared on p50 and tail
+ * latency rather than on one lucky or unlucky sample.
+ *
+ * Features:
+ * - Warmup and repetition counts shared by every benchmark in a suite
+ * - Mean, standard deviation, min, p50, p95, p99 and max per benchmark
+ * - Extra named metrics (throughput, bandwidth) next to the latencies
+ * - Machine-readable JSON report for regression tracking
+ *
+ * Not thread-safe: benchmarks are registered from the main thread.
+ */
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include "../core/json_value.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace AIForge {
+namespace Bench {
+
+/**
+ * @struct Options
+ * @brief Suite-wide settings, usually from the command line
+ */
+struct Options {
+    int warmup = 2;                 // Untimed iterations before measuring
+    int repetitions = 10;           // Timed iterations
+    bool quick = false;             // Smallest workloads, for CI smoke runs
+    std::string filter;             // Only benchmarks whose name contains this
+    std::string outputPath;         // JSON report (empty = none)
+    int thermalSeconds = 0;         // Thermal stress duration (0 = skipped)
+};
+
+/**
+ * @struct Summary
+ * @brief Distribution of one benchmark's samples
+ */
+struct Summary {
+    size_t count = 0;
+    double mean = 0.0;
+    double stddev = 0.0;            // Sample standard deviation
+    double min = 0.0;
+    double p50 = 0.0;
+    double p95 = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+};
+
+/**
+ * @brief Percentile of sorted samples, interpolated between neighbours
+ */
+inline double percentile(const std::vector<double>& sorted, double fraction) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    const double position = fraction * (sorted.size() - 1);
+    const size_t lower = static_cast<size_t>(position);
+    const size_t upper = std::min(lower + 1, sorted.size() - 1);
+    return sorted[lower] + (sorted[upper] - sorted[lower]) * (position - lower);
+}
+
+/**
+ * @brief Summarize a set of samples
+ */
+inline Summary summarize(std::vector<double> samples) {
+    Summary summary;
+    summary.count = samples.size();
+    if (samples.empty()) {
+        return summary;
+    }
+
+    std::sort(samples.begin(), samples.end());
+    double sum = 0.0;
+    for (double sample : samples) {
+        sum += sample;
+    }
+    summary.mean = sum / samples.size();
+
+    double squares = 0.0;
+    for (double sample : samples) {
+        squares += (sample - summary.mean) * (sample - summary.mean);
+    }
+    summary.stddev = samples.size() > 1 ? std::sqrt(squares / (samples.size() - 1)) : 0.0;
+
+    summary.min = samples.front();
+    summary.max = samples.back();
+    summary.p50 = percentile(samples, 0.50);
+    summary.p95 = percentile(samples, 0.95);
+    summary.p99 = percentile(samples, 0.99);
+    return summary;
+}
+
+/**
+ * @struct Result
+ * @brief One benchmark's samples and derived metrics
+ */
+struct Result {
+    std::string name;
+    std::string unit = "ms";
+    std::vector<double> samples;
+    size_t failures = 0;            // Repetitions whose operation reported failure
+    std::vector<std::pair<std::string, double>> metrics;
+};
+
+/**
+ * @class Suite
+ * @brief Runs benchmarks and collects their results
+ */
+class Suite {
+public:
+    explicit Suite(const Options& options) : m_options(options) {}
+
+    const Options& options() const { return m_options; }
+
+    /**
+     * @brief Check a benchmark against the filter
+     */
+    bool enabled(const std::string& name) const {
+        return m_options.filter.empty() || name.find(m_options.filter) != std::string::npos;
+    }
+
+    /**
+     * @brief Time an operation after warming it up
+     *
+     * @param name Benchmark name
+     * @param operation Returns false if the run failed (it is still timed)
+     * @param repetitions Timed runs (0 = the suite's count)
+     * @return The recorded result, for adding metrics
+     */
+    Result& measure(const std::string& name, const std::function<bool()>& operation,
+                    int repetitions = 0) {
+        Result result;
+        result.name = name;
+        const int runs = repetitions > 0 ? repetitions : m_options.repetitions;
+        for (int i = 0; i < m_options.warmup; i++) {
+            operation();
+        }
+        for (int i = 0; i < runs; i++) {
+            const auto start = std::chrono::steady_clock::now();
+            const bool ok = operation();
+            const auto end = std::chrono::steady_clock::now();
+            result.samples.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+            if (!ok) {
+                result.failures++;
+            }
+        }
+        return record(std::move(result));
+    }
+
+    /**
+     * @brief Record samples measured by the caller
+     * @return The recorded result, for adding metrics
+     */
+    Result& record(Result result) {
+        m_results.push_back(std::move(result));
+        print(m_results.back());
+        return m_results.back();
+    }
+
+    /**
+     * @brief Add a named metric to a result and print it
+     */
+    void addMetric(Result& result, const std::string& key, double value) {
+        result.metrics.emplace_back(key, value);
+        std::cout << "    " << std::left << std::setw(24) << key << std::right
+                  << std::fixed << std::setprecision(2) << value << "\n";
+    }
+
+    /**
+     * @brief Count results with failed repetitions
+     */
+    size_t failedBenchmarks() const {
+        size_t failed = 0;
+        for (const Result& result : m_results) {
+            if (result.failures > 0 || result.samples.empty()) {
+                failed++;
+            }
+        }
+        return failed;
+    }
+
+    /**
+     * @brief Write every result as JSON
+     * @param suiteName Name stored in the report
+     * @return false if the file could not be written
+     */
+    bool writeJson(const std::string& suiteName) const {
+        if (m_options.outputPath.empty()) {
+            return true;
+        }
+
+        std::ostringstream json;
+        json << std::setprecision(6) << std::fixed;
+        json << "{\n  \"suite\": \"" << JsonValue::escape(suiteName) << "\",\n"
+             << "  \"timestamp\": " << static_cast<long long>(std::time(nullptr)) << ",\n"
+             << "  \"warmup\": " << m_options.warmup << ",\n"
+             << "  \"repetitions\": " << m_options.repetitions << ",\n"
+             << "  \"quick\": " << (m_options.quick ? "true" : "false") << ",\n"
+             << "  \"benchmarks\": [";
+        for (size_t i = 0; i < m_results.size(); i++) {
+            const Result& result = m_results[i];
+            const Summary s = summarize(result.samples);
+            json << (i ? ",\n" : "\n")
+                 << "    {\"name\": \"" << JsonValue::escape(result.name) << "\", "
+                 << "\"unit\": \"" << JsonValue::escape(result.unit) << "\", "
+                 << "\"samples\": " << s.count << ", \"failures\": " << result.failures << ", "
+                 << "\"mean\": " << s.mean << ", \"stddev\": " << s.stddev << ", "
+                 << "\"min\": " << s.min << ", \"p50\": " << s.p50 << ", "
+                 << "\"p95\": " << s.p95 << ", \"p99\": " << s.p99 << ", "
+                 << "\"max\": " << s.max << ", \"metrics\": {";
+            for (size_t m = 0; m < result.metrics.size(); m++) {
+                json << (m ? ", " : "") << "\"" << JsonValue::escape(result.metrics[m].first)
+                     << "\": " << result.metrics[m].second;
+            }
+            json << "}}";
+        }
+        json << "\n  ]\n}\n";
+
+        std::ofstream file(m_options.outputPath, std::ios::out | std::ios::trunc);
+        if (!file.is_open()) {
+            std::cerr << "Cannot write benchmark report: " << m_options.outputPath << "\n";
+            return false;
+        }
+        file << json.str();
+        std::cout << "\nReport written to " << m_options.outputPath << "\n";
+        return static_cast<bool>(file);
+    }
+
+private:
+    static void print(const Result& result) {
+        const Summary s = summarize(result.samples);
+        std::cout << std::fixed << std::setprecision(3)
+                  << "  " << std::left << std::setw(28) << result.name << std::right
+                  << " n=" << s.count
+                  << "  p50 " << s.p50 << "  p95 " << s.p95 << "  p99 " << s.p99
+                  << "  mean " << s.mean << " +- " << s.stddev << " " << result.unit;
+        if (result.failures > 0) {
+            std::cout << "  (" << result.failures << " failed)";
+        }
+        std::cout << "\n";
+    }
+
+    Options m_options;
+    std::vector<Result> m_results;
+};
+
+} // namespace Bench
+} // namespace AIForge
+
+#endif // BENCHMARK_H
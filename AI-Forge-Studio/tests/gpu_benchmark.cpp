@@ -2,25 +2,45 @@
  * @file gpu_benchmark.cpp
  * @brief GPU performance benchmark suite
  *
- * Tests GPU capabilities and measures performance metrics for:
- * - Memory bandwidth
- * - Compute throughput
- * - AI inference speed
- * - Thermal characteristics
+ * Measures the engine paths the rest of the application depends on, each
+ * with warmup and repeated timing (see benchmark.h):
+ * - Hardware monitor collection overhead
+ * - Engine initialization and model load latency
+ * - Single vs batched inference throughput
+ * - Concurrent clients through the async queue and dynamic batching
+ * - Texture upload bandwidth
+ * - Logger throughput, synchronous and asynchronous
+ * - Thermal characteristics (optional, --thermal N)
+ *
+ * Usage: gpu_benchmark [--quick] [--warmup N] [--repetitions N]
+ *                      [--filter NAME] [--output report.json] [--thermal N]
+ *
+ * Exits non-zero if any benchmark failed, so CTest can run --quick as a
+ * smoke test.
  */
 
+#include "benchmark.h"
 #include "../core/hardware_monitor.h"
 #include "../core/ai_engine.h"
+#include "../core/render_engine.h"
 #include "../core/logger.h"
 #include <iostream>
 #include <chrono>
 #include <iomanip>
 #include <vector>
 #include <numeric>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <thread>
+#include <atomic>
+#include <cstdlib>
 
 using namespace AIForge;
 using namespace std::chrono;
 
+namespace {
+
 /**
  * @brief Print benchmark header
  */
@@ -40,145 +60,292 @@ void printSection(const std::string& name) {
     std::cout << "\n--- " << name << " ---\n";
 }
 
+/**
+ * @brief Scratch directory for model files and caches, removed on exit
+ */
+class ScratchDirectory {
+public:
+    ScratchDirectory() {
+        std::error_code ec;
+        m_path = std::filesystem::temp_directory_path(ec) /
+                 ("aiforge_benchmark_" + std::to_string(std::rand()));
+        std::filesystem::create_directories(m_path, ec);
+    }
+
+    ~ScratchDirectory() {
+        std::error_code ec;
+        std::filesystem::remove_all(m_path, ec);
+    }
+
+    std::string file(const std::string& name) const { return (m_path / name).string(); }
+
+private:
+    std::filesystem::path m_path;
+};
+
+/**
+ * @brief Write a model file of a given size for load benchmarks
+ */
+bool writeModelFile(const std::string& path, size_t bytes) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    std::vector<char> block(1024 * 1024);
+    for (size_t i = 0; i < block.size(); i++) {
+        block[i] = static_cast<char>(i * 31);
+    }
+    for (size_t written = 0; written < bytes; written += block.size()) {
+        file.write(block.data(), static_cast<std::streamsize>(std::min(block.size(), bytes - written)));
+    }
+    return static_cast<bool>(file);
+}
+
 /**
  * @brief Benchmark hardware monitoring overhead
  */
-void benchmarkHardwareMonitor() {
+void benchmarkHardwareMonitor(Bench::Suite& suite) {
+    if (!suite.enabled("monitor_overhead")) {
+        return;
+    }
     printSection("Hardware Monitor Benchmark");
 
     HardwareMonitor monitor;
     if (!monitor.initialize()) {
-        std::cout << "❌ Failed to initialize hardware monitor\n";
+        std::cout << "  Failed to initialize hardware monitor\n";
+        suite.record(Bench::Result{"monitor_overhead", "ms", {}, 1, {}});
         return;
     }
-
-    std::cout << "✓ Hardware monitor initialized\n";
     std::cout << "  GPUs detected: " << monitor.getGPUCount() << "\n";
 
-    // Measure collection time
-    std::vector<double> timings;
-    for (int i = 0; i < 100; i++) {
-        auto start = high_resolution_clock::now();
+    // Collection is cheap, so it gets far more samples than inference
+    const int repetitions = suite.options().quick ? 20 : 200;
+    suite.measure("monitor_overhead", [&monitor] {
         SystemMetrics metrics = monitor.collectMetrics();
-        auto end = high_resolution_clock::now();
-
-        double duration = duration_cast<microseconds>(end - start).count() / 1000.0;
-        timings.push_back(duration);
-    }
-
-    double avgTime = std::accumulate(timings.begin(), timings.end(), 0.0) / timings.size();
-    double minTime = *std::min_element(timings.begin(), timings.end());
-    double maxTime = *std::max_element(timings.begin(), timings.end());
-
-    std::cout << std::fixed << std::setprecision(3);
-    std::cout << "  Collection time:\n";
-    std::cout << "    Average: " << avgTime << " ms\n";
-    std::cout << "    Min: " << minTime << " ms\n";
-    std::cout << "    Max: " << maxTime << " ms\n";
-
-    // Display current metrics
-    SystemMetrics metrics = monitor.collectMetrics();
-    if (!metrics.gpus.empty()) {
-        const auto& gpu = metrics.gpus[0];
-        std::cout << "\n  Current GPU Status:\n";
-        std::cout << "    Model: " << gpu.name << "\n";
-        std::cout << "    Utilization: " << gpu.gpuUtilization << "%\n";
-        std::cout << "    Temperature: " << gpu.temperature << "°C\n";
-        std::cout << "    VRAM: " << gpu.memoryUsed << " / " << gpu.memoryTotal << " MB\n";
-        std::cout << "    Power: " << gpu.powerUsage << " W\n";
-        std::cout << "    Clock: " << gpu.clockSpeed << " MHz\n";
-    }
+        return !metrics.gpus.empty() || monitor.getGPUCount() == 0;
+    }, repetitions);
 
     monitor.shutdown();
 }
 
 /**
- * @brief Benchmark AI engine initialization and operations
+ * @brief Benchmark engine startup, model loading and inference
  */
-void benchmarkAIEngine() {
+void benchmarkAIEngine(Bench::Suite& suite, const ScratchDirectory& scratch) {
     printSection("AI Engine Benchmark");
+    const bool quick = suite.options().quick;
+
+    // Keep the engine cache out of the working directory
+    EngineCacheConfig cacheConfig;
+    cacheConfig.directory = scratch.file("engine_cache");
+
+    if (suite.enabled("engine_init")) {
+        suite.measure("engine_init", [&cacheConfig] {
+            AIEngine engine;
+            engine.setEngineCacheConfig(cacheConfig);
+            const bool ok = engine.initialize(0);
+            engine.shutdown();
+            return ok;
+        });
+    }
 
     AIEngine engine;
+    engine.setEngineCacheConfig(cacheConfig);
+    if (!engine.initialize(0)) {
+        std::cout << "  Failed to initialize AI engine\n";
+        suite.record(Bench::Result{"engine", "ms", {}, 1, {}});
+        return;
+    }
 
-    // Test initialization time
-    auto initStart = high_resolution_clock::now();
-    bool initSuccess = engine.initialize(0);
-    auto initEnd = high_resolution_clock::now();
-
-    if (!initSuccess) {
-        std::cout << "❌ Failed to initialize AI engine\n";
+    const std::string modelPath = scratch.file("benchmark_model.onnx");
+    const size_t modelBytes = (quick ? 4 : 64) * 1024 * 1024;
+    if (!writeModelFile(modelPath, modelBytes)) {
+        std::cout << "  Cannot write model file: " << modelPath << "\n";
+        suite.record(Bench::Result{"model_load", "ms", {}, 1, {}});
         return;
     }
 
-    double initTime = duration_cast<milliseconds>(initEnd - initStart).count();
-    std::cout << "✓ AI engine initialized in " << initTime << " ms\n";
-
-    // Test model loading (simulated)
-    auto loadStart = high_resolution_clock::now();
-    std::string modelId = engine.loadModel(
-        "test_model.safetensors",
-        "Test Model",
-        ModelType::TEXT_TO_IMAGE
-    );
-    auto loadEnd = high_resolution_clock::now();
-
-    if (!modelId.empty()) {
-        double loadTime = duration_cast<milliseconds>(loadEnd - loadStart).count();
-        std::cout << "✓ Model loaded in " << loadTime << " ms\n";
-
-        ModelInfo info = engine.getModelInfo(modelId);
-        std::cout << "  Model Info:\n";
-        std::cout << "    ID: " << info.id << "\n";
-        std::cout << "    Name: " << info.name << "\n";
-        std::cout << "    Type: " << modelTypeToString(info.type) << "\n";
-        std::cout << "    Format: " << modelFormatToString(info.format) << "\n";
-        std::cout << "    VRAM: " << info.memoryUsage << " MB\n";
+    if (suite.enabled("model_load")) {
+        // Load latency includes hashing the file for the engine cache lookup
+        Bench::Result& result = suite.measure("model_load", [&engine, &modelPath] {
+            std::string id = engine.loadModel(modelPath, "Load Benchmark", ModelType::TEXT_TO_IMAGE);
+            return !id.empty() && engine.unloadModel(id);
+        });
+        suite.addMetric(result, "model_mb", static_cast<double>(modelBytes) / (1024.0 * 1024.0));
+    }
+
+    std::string modelId = engine.loadModel(modelPath, "Benchmark Model", ModelType::TEXT_TO_IMAGE);
+    if (modelId.empty()) {
+        suite.record(Bench::Result{"inference", "ms", {}, 1, {}});
+        return;
     }
 
-    // Test inference speed
     InferenceConfig config;
     config.modelId = modelId;
+    const std::vector<float> input(3 * 512 * 512, 0.5f);
+
+    double singleMs = 0.0;
+    if (suite.enabled("inference_single")) {
+        Bench::Result& result = suite.measure("inference_single", [&engine, &config, &input] {
+            return engine.runInference(config, input).success;
+        });
+        singleMs = Bench::summarize(result.samples).mean;
+        if (singleMs > 0.0) {
+            suite.addMetric(result, "items_per_second", 1000.0 / singleMs);
+        }
+    }
 
-    std::vector<double> inferenceTimes;
-    const int numRuns = 10;
+    const int batchSize = 8;
+    if (suite.enabled("inference_batched")) {
+        const std::vector<std::vector<float>> inputs(batchSize, input);
+        Bench::Result& result = suite.measure("inference_batched", [&engine, &config, &inputs] {
+            std::vector<InferenceResult> results = engine.runInferenceBatch(config, inputs);
+            for (const InferenceResult& item : results) {
+                if (!item.success) {
+                    return false;
+                }
+            }
+            return results.size() == inputs.size();
+        });
+        const double batchMs = Bench::summarize(result.samples).mean;
+        suite.addMetric(result, "batch_size", batchSize);
+        if (batchMs > 0.0) {
+            suite.addMetric(result, "items_per_second", batchSize * 1000.0 / batchMs);
+            if (singleMs > 0.0) {
+                suite.addMetric(result, "speedup_vs_single", batchSize * singleMs / batchMs);
+            }
+        }
+    }
 
-    std::cout << "\n  Running " << numRuns << " inference iterations...\n";
+    if (suite.enabled("concurrent_clients")) {
+        // Clients submit independently; dynamic batching merges what overlaps
+        BatchingConfig batching;
+        batching.enabled = true;
+        batching.maxBatchSize = batchSize;
+        engine.setBatchingConfig(batching);
+
+        const int clients = 4;
+        const int requestsPerClient = quick ? 2 : 4;
+        Bench::Result& result = suite.measure("concurrent_clients",
+            [&engine, &config, &input, clients, requestsPerClient] {
+                std::atomic<int> failures(0);
+                std::vector<std::thread> threads;
+                for (int c = 0; c < clients; c++) {
+                    threads.emplace_back([&] {
+                        for (int r = 0; r < requestsPerClient; r++) {
+                            if (!engine.runInferenceAsync(config, input).get().success) {
+                                failures++;
+                            }
+                        }
+                    });
+                }
+                for (std::thread& thread : threads) {
+                    thread.join();
+                }
+                return failures == 0;
+            });
+
+        const double wallMs = Bench::summarize(result.samples).mean;
+        const BatchingStats stats = engine.getBatchingStats();
+        suite.addMetric(result, "clients", clients);
+        if (wallMs > 0.0) {
+            suite.addMetric(result, "requests_per_second", clients * requestsPerClient * 1000.0 / wallMs);
+        }
+        suite.addMetric(result, "average_batch_size", stats.averageBatchSize);
 
-    for (int i = 0; i < numRuns; i++) {
-        std::vector<float> dummyInput(512 * 512 * 3, 0.5f);
+        batching.enabled = false;
+        engine.setBatchingConfig(batching);
+    }
 
-        auto start = high_resolution_clock::now();
-        InferenceResult result = engine.runInference(config, dummyInput);
-        auto end = high_resolution_clock::now();
+    engine.unloadModel(modelId);
+    engine.shutdown();
+}
 
-        if (result.success) {
-            inferenceTimes.push_back(result.inferenceTime);
-        }
+/**
+ * @brief Benchmark image upload to GPU textures
+ */
+void benchmarkUpload(Bench::Suite& suite) {
+    if (!suite.enabled("upload_bandwidth")) {
+        return;
+    }
+    printSection("Upload Benchmark");
+
+    RenderEngine renderer;
+    RenderConfig config;
+    config.enableVSync = false;
+    if (!renderer.initialize(config, nullptr)) {
+        std::cout << "  Failed to initialize render engine\n";
+        suite.record(Bench::Result{"upload_bandwidth", "ms", {}, 1, {}});
+        return;
     }
 
-    if (!inferenceTimes.empty()) {
-        double avgInference = std::accumulate(inferenceTimes.begin(), inferenceTimes.end(), 0.0) / inferenceTimes.size();
-        double minInference = *std::min_element(inferenceTimes.begin(), inferenceTimes.end());
-        double maxInference = *std::max_element(inferenceTimes.begin(), inferenceTimes.end());
+    const int width = 1920;
+    const int height = 1080;
+    const int channels = 4;
+    const std::vector<unsigned char> image(static_cast<size_t>(width) * height * channels, 128);
 
-        std::cout << std::fixed << std::setprecision(2);
-        std::cout << "  Inference Performance:\n";
-        std::cout << "    Average: " << avgInference << " ms (" << (1000.0 / avgInference) << " FPS)\n";
-        std::cout << "    Min: " << minInference << " ms\n";
-        std::cout << "    Max: " << maxInference << " ms\n";
+    Bench::Result& result = suite.measure("upload_bandwidth", [&renderer, &image] {
+        void* texture = renderer.uploadImageToGPU(image.data(), width, height, channels);
+        if (!texture) {
+            return false;
+        }
+        renderer.freeGPUTexture(texture);
+        return true;
+    });
+
+    const double uploadMs = Bench::summarize(result.samples).p50;
+    if (uploadMs > 0.0) {
+        suite.addMetric(result, "megabytes_per_second",
+                        image.size() / (1024.0 * 1024.0) / (uploadMs / 1000.0));
     }
 
-    // VRAM usage
-    size_t vramUsage = engine.getVRAMUsage();
-    std::cout << "  Total VRAM Usage: " << vramUsage << " MB\n";
+    renderer.shutdown();
+}
 
-    engine.shutdown();
+/**
+ * @brief Benchmark logging throughput
+ */
+void benchmarkLogger(Bench::Suite& suite, const ScratchDirectory& scratch) {
+    Logger& logger = Logger::getInstance();
+    const int messages = suite.options().quick ? 2000 : 20000;
+    const std::string text = "Benchmark message with a typical amount of detail: 12345";
+
+    printSection("Logger Benchmark");
+    logger.setLogFilePath(scratch.file("benchmark.log"));
+    logger.setConsoleOutput(false);
+    logger.setMinLogLevel(Logger::LogLevel::INFO);
+
+    for (bool async : {false, true}) {
+        const std::string name = async ? "logger_async" : "logger_sync";
+        if (!suite.enabled(name)) {
+            continue;
+        }
+        if (async) {
+            logger.enableAsync();
+        }
+
+        // Time spent in the calling thread, which is what logging costs callers
+        Bench::Result& result = suite.measure(name, [&logger, &text, messages] {
+            for (int i = 0; i < messages; i++) {
+                logger.log(Logger::LogLevel::INFO, "Benchmark", text);
+            }
+            return true;
+        });
+        const double batchMs = Bench::summarize(result.samples).p50;
+        if (batchMs > 0.0) {
+            suite.addMetric(result, "messages_per_second", messages * 1000.0 / batchMs);
+        }
+
+        if (async) {
+            logger.disableAsync();
+        }
+    }
+
+    logger.setMinLogLevel(Logger::LogLevel::WARNING);
+    logger.setConsoleOutput(true);
 }
 
 /**
  * @brief Stress test for thermal monitoring
  */
-void thermalStressTest(int durationSeconds = 30) {
+void thermalStressTest(Bench::Suite& suite, int durationSeconds) {
     printSection("Thermal Stress Test");
 
     std::cout << "Running " << durationSeconds << " second stress test...\n";
@@ -186,24 +353,24 @@ void thermalStressTest(int durationSeconds = 30) {
 
     HardwareMonitor monitor;
     if (!monitor.initialize()) {
-        std::cout << "❌ Failed to initialize hardware monitor\n";
+        std::cout << "  Failed to initialize hardware monitor\n";
+        suite.record(Bench::Result{"thermal", "C", {}, 1, {}});
         return;
     }
 
-    std::vector<float> temperatures;
-    std::vector<float> powerReadings;
+    Bench::Result temperatures{"thermal_temperature", "C", {}, 0, {}};
+    Bench::Result power{"thermal_power", "W", {}, 0, {}};
 
-    auto startTime = high_resolution_clock::now();
-
-    while (duration_cast<seconds>(high_resolution_clock::now() - startTime).count() < durationSeconds) {
+    auto startTime = steady_clock::now();
+    while (duration_cast<seconds>(steady_clock::now() - startTime).count() < durationSeconds) {
         SystemMetrics metrics = monitor.collectMetrics();
 
         if (!metrics.gpus.empty()) {
-            temperatures.push_back(metrics.gpus[0].temperature);
-            powerReadings.push_back(metrics.gpus[0].powerUsage);
+            temperatures.samples.push_back(metrics.gpus[0].temperature);
+            power.samples.push_back(metrics.gpus[0].powerUsage);
 
             // Print progress every 5 seconds
-            int elapsed = duration_cast<seconds>(high_resolution_clock::now() - startTime).count();
+            auto elapsed = duration_cast<seconds>(steady_clock::now() - startTime).count();
             if (elapsed % 5 == 0) {
                 std::cout << "  [" << elapsed << "s] "
                          << "Temp: " << metrics.gpus[0].temperature << "°C, "
@@ -214,35 +381,66 @@ void thermalStressTest(int durationSeconds = 30) {
         std::this_thread::sleep_for(std::chrono::seconds(1));
     }
 
-    // Calculate statistics
-    float avgTemp = std::accumulate(temperatures.begin(), temperatures.end(), 0.0f) / temperatures.size();
-    float maxTemp = *std::max_element(temperatures.begin(), temperatures.end());
-    float avgPower = std::accumulate(powerReadings.begin(), powerReadings.end(), 0.0f) / powerReadings.size();
-    float maxPower = *std::max_element(powerReadings.begin(), powerReadings.end());
-
-    std::cout << "\n  Thermal Statistics:\n";
-    std::cout << std::fixed << std::setprecision(1);
-    std::cout << "    Average Temperature: " << avgTemp << "°C\n";
-    std::cout << "    Peak Temperature: " << maxTemp << "°C\n";
-    std::cout << "    Average Power: " << avgPower << "W\n";
-    std::cout << "    Peak Power: " << maxPower << "W\n";
+    const double maxTemp = Bench::summarize(temperatures.samples).max;
+    suite.record(std::move(temperatures));
+    suite.record(std::move(power));
 
     // Thermal evaluation
-    if (maxTemp < 75.0f) {
-        std::cout << "  ✓ Excellent thermal performance\n";
-    } else if (maxTemp < 85.0f) {
-        std::cout << "  ⚠ Acceptable thermal performance\n";
+    if (maxTemp < 75.0) {
+        std::cout << "  Excellent thermal performance\n";
+    } else if (maxTemp < 85.0) {
+        std::cout << "  Acceptable thermal performance\n";
     } else {
-        std::cout << "  ❌ High temperatures detected - check cooling\n";
+        std::cout << "  High temperatures detected - check cooling\n";
     }
 
     monitor.shutdown();
 }
 
+/**
+ * @brief Parse command line options
+ * @return false on an unknown or incomplete option
+ */
+bool parseOptions(int argc, char* argv[], Bench::Options& options) {
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--quick") {
+            options.quick = true;
+        } else if (arg == "--warmup" && hasValue) {
+            options.warmup = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--repetitions" && hasValue) {
+            options.repetitions = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--filter" && hasValue) {
+            options.filter = argv[++i];
+        } else if (arg == "--output" && hasValue) {
+            options.outputPath = argv[++i];
+        } else if (arg == "--thermal" && hasValue) {
+            options.thermalSeconds = std::max(0, std::atoi(argv[++i]));
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
 /**
  * @brief Main benchmark entry point
  */
 int main(int argc, char* argv[]) {
+    Bench::Options options;
+    if (!parseOptions(argc, argv, options)) {
+        std::cerr << "Usage: " << argv[0] << " [--quick] [--warmup N] [--repetitions N]"
+                  << " [--filter NAME] [--output report.json] [--thermal SECONDS]\n";
+        return 2;
+    }
+    if (options.quick) {
+        options.warmup = std::min(options.warmup, 1);
+        options.repetitions = std::min(options.repetitions, 3);
+    }
+
     // Initialize logger
     Logger::getInstance().setMinLogLevel(Logger::LogLevel::WARNING);
     Logger::getInstance().setConsoleOutput(true);
@@ -250,27 +448,33 @@ int main(int argc, char* argv[]) {
     printHeader();
 
     try {
-        // Run benchmarks
-        benchmarkHardwareMonitor();
-        benchmarkAIEngine();
+        Bench::Suite suite(options);
+        ScratchDirectory scratch;
 
-        // Optional: Run stress test
-        std::cout << "\nRun thermal stress test? (y/n): ";
-        char response;
-        std::cin >> response;
+        // Run benchmarks
+        benchmarkHardwareMonitor(suite);
+        benchmarkAIEngine(suite, scratch);
+        benchmarkUpload(suite);
+        benchmarkLogger(suite, scratch);
 
-        if (response == 'y' || response == 'Y') {
-            thermalStressTest(30);
+        if (options.thermalSeconds > 0) {
+            thermalStressTest(suite, options.thermalSeconds);
         }
 
+        const bool written = suite.writeJson("gpu_benchmark");
+        const size_t failed = suite.failedBenchmarks();
+
         std::cout << "\n========================================\n";
-        std::cout << " Benchmark Complete\n";
-        std::cout << "========================================\n\n";
+        std::cout << " Benchmark Complete";
+        if (failed > 0) {
+            std::cout << " (" << failed << " failed)";
+        }
+        std::cout << "\n========================================\n\n";
 
-        return 0;
+        return failed == 0 && written ? 0 : 1;
 
     } catch (const std::exception& e) {
-        std::cerr << "❌ Benchmark failed with exception: " << e.what() << "\n";
+        std::cerr << "Benchmark failed with exception: " << e.what() << "\n";
         return 1;
     }
 }
@@ -15,6 +15,33 @@ Rectangle {
     property color accentCyan: "#00FFFF"
     property color accentPurple: "#AA00FF"
     property bool isGenerating: false
+    property string currentJobId: ""
+    property real generationProgress: 0.0
+
+    // Results arrive queued on the GUI thread; the image is served by the
+    // "generated" image provider straight from the inference result
+    Connections {
+        target: backend
+
+        function onGenerationProgress(jobId, progress) {
+            if (jobId === renderView.currentJobId) {
+                renderView.generationProgress = progress
+            }
+        }
+
+        function onGenerationFinished(jobId, success, imageSource, errorMessage) {
+            if (jobId !== renderView.currentJobId) {
+                return
+            }
+            renderView.isGenerating = false
+            renderView.currentJobId = ""
+            if (success) {
+                previewImage.source = imageSource
+            } else {
+                console.log("Generation failed:", errorMessage)
+            }
+        }
+    }
 
     RowLayout {
         anchors.fill: parent
@@ -74,7 +101,7 @@ Rectangle {
 
                             Rectangle {
                                 id: progressBar
-                                width: parent.width * 0.5  // Animated
+                                width: parent.width * renderView.generationProgress
                                 height: parent.height
                                 color: renderView.accentCyan
                                 radius: 5
@@ -84,15 +111,6 @@ Rectangle {
                                     GradientStop { position: 0.0; color: renderView.accentCyan }
                                     GradientStop { position: 1.0; color: renderView.accentPurple }
                                 }
-
-                                // Animate progress
-                                NumberAnimation on width {
-                                    running: renderView.isGenerating
-                                    from: 0
-                                    to: parent.width
-                                    duration: 5000
-                                    loops: 1
-                                }
                             }
                         }
                     }
@@ -433,10 +451,23 @@ Rectangle {
 
                         onClicked: {
                             console.log("Generate image with prompt:", promptText.text)
-                            renderView.isGenerating = true
 
-                            // Simulate generation (in production, call C++ backend)
-                            generateTimer.start()
+                            // The engine knows models by ID; until the selected one
+                            // is loaded, only simulate the run
+                            var modelId = backend.findLoadedModel(modelCombo.currentText)
+                            if (modelId === "") {
+                                console.log("Model not loaded, simulating:", modelCombo.currentText)
+                                renderView.isGenerating = true
+                                simulatedProgress.restart()
+                                return
+                            }
+
+                            var jobId = backend.generateImage(modelId, promptText.text)
+                            if (jobId !== "") {
+                                renderView.generationProgress = 0.0
+                                renderView.currentJobId = jobId
+                                renderView.isGenerating = true
+                            }
                         }
                     }
 
@@ -462,12 +493,16 @@ Rectangle {
         }
     }
 
-    // Simulate generation timer
-    Timer {
-        id: generateTimer
-        interval: 5000
-        repeat: false
-        onTriggered: {
+    // Simulate generation while no matching model is loaded
+    NumberAnimation {
+        id: simulatedProgress
+        target: renderView
+        property: "generationProgress"
+        from: 0.0
+        to: 1.0
+        duration: 5000
+
+        onFinished: {
             renderView.isGenerating = false
             console.log("Generation complete")
         }